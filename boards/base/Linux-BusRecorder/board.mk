@@ -0,0 +1,9 @@
+GFXINC  += $(GFXLIB)/boards/base/Linux-BusRecorder
+GFXSRC  += $(GFXLIB)/boards/base/Linux-BusRecorder/bus_recorder.c
+GFXDEFS += -DGFX_USE_OS_LINUX=GFXON
+GFXLIBS += rt
+
+# The controller driver to record - ILI93xx, ILI9325, ILI9341, ILI9342, LGDP4532, SSD1963 or ST7735
+BUSRECORDER_DRIVER ?= ILI9341
+
+include $(GFXLIB)/drivers/gdisp/$(BUSRECORDER_DRIVER)/driver.mk
@@ -0,0 +1,21 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+#include "board_busrecorder.h"
+
+static GFXINLINE void set_backlight(GDisplay *g, gU8 percent) {
+	(void) g;
+	(void) percent;
+}
+
+// The ILI9325 driver turns the backlight off through this name for gPowerSleep and gPowerDeepSleep
+#define gdisp_lld_backlight(g, percent)		set_backlight(g, percent)
+
+#endif /* _GDISP_LLD_BOARD_H */
@@ -0,0 +1,18 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+#include "board_busrecorder.h"
+
+static GFXINLINE void set_backlight(GDisplay *g, gU8 percent) {
+	(void) g;
+	(void) percent;
+}
+
+#endif /* _GDISP_LLD_BOARD_H */
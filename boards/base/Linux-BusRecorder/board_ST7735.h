@@ -0,0 +1,26 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+#include "board_busrecorder.h"
+
+static GFXINLINE void set_backlight(GDisplay *g, gU8 percent) {
+	(void) g;
+	(void) percent;
+}
+
+static GFXINLINE void write_cmd(GDisplay *g, gU8 cmd) {
+	write_index(g, cmd);
+}
+
+static GFXINLINE void write_data_byte(GDisplay *g, gU8 data) {
+	write_data(g, data);
+}
+
+#endif /* _GDISP_LLD_BOARD_H */
@@ -0,0 +1,115 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * The board interface shared by the recording boards. Nothing is sent anywhere,
+ * each bus transaction is just counted in busRecord.
+ */
+
+#ifndef _BOARD_BUSRECORDER_H
+#define _BOARD_BUSRECORDER_H
+
+#include "bus_recorder.h"
+
+// Set this to GFXOFF to record what the driver does when a board has no burst routines
+#ifndef GDISP_BUSRECORDER_BURST
+	#define GDISP_BUSRECORDER_BURST		GFXON
+#endif
+
+static GFXINLINE void init_board(GDisplay *g) {
+	g->board = 0;
+}
+
+static GFXINLINE void post_init_board(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void setpin_reset(GDisplay *g, gBool state) {
+	(void) g;
+	(void) state;
+}
+
+static GFXINLINE void acquire_bus(GDisplay *g) {
+	(void) g;
+	busRecord.acquires++;
+}
+
+static GFXINLINE void release_bus(GDisplay *g) {
+	(void) g;
+	BUSRECORD_TOUCH();
+}
+
+static GFXINLINE void write_index(GDisplay *g, gU16 index) {
+	(void) g;
+	(void) index;
+	BUSRECORD_TOUCH();
+	busRecord.indexes++;
+}
+
+static GFXINLINE void write_data(GDisplay *g, gU16 data) {
+	(void) g;
+	(void) data;
+	BUSRECORD_TOUCH();
+	busRecord.datas++;
+}
+
+static GFXINLINE void setreadmode(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void setwritemode(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE gU16 read_data(GDisplay *g) {
+	(void) g;
+	BUSRECORD_TOUCH();
+	busRecord.reads++;
+	return 0;
+}
+
+#if GDISP_BUSRECORDER_BURST
+	#define write_data_repeat(g, data, count)			board_write_repeat(g, data, count)
+	#define write_data_buffer(g, buffer, count)			board_write_buffer(g, buffer, count)
+	#define write_data_buffer_async(g, buffer, count)	board_write_buffer_async(g, buffer, count)
+	#define write_data_wait(g)							board_write_wait(g)
+
+	static GFXINLINE void board_write_repeat(GDisplay *g, gU16 data, gU32 count) {
+		(void) g;
+		(void) data;
+		BUSRECORD_TOUCH();
+		busRecord.repeats++;
+		busRecord.repeatwords += count;
+	}
+
+	static GFXINLINE void board_write_buffer(GDisplay *g, const gU16 *buffer, gU32 count) {
+		(void) g;
+		(void) buffer;
+		BUSRECORD_TOUCH();
+		busRecord.buffers++;
+		busRecord.bufferwords += count;
+	}
+
+	static GFXINLINE void board_write_buffer_async(GDisplay *g, const gU16 *buffer, gU32 count) {
+		(void) g;
+		(void) buffer;
+		BUSRECORD_TOUCH();
+		busRecord.asyncs++;
+		busRecord.asyncwords += count;
+		busRecord.busy = gTrue;
+	}
+
+	static GFXINLINE void board_write_wait(GDisplay *g) {
+		(void) g;
+		if (busRecord.busy) {
+			busRecord.waits++;
+			busRecord.busy = gFalse;
+		}
+	}
+#endif
+
+#endif /* _BOARD_BUSRECORDER_H */
@@ -0,0 +1,32 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "gfx.h"
+#include "bus_recorder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+BusRecord	busRecord;
+
+void busRecordClear(void) {
+	memset(&busRecord, 0, sizeof(busRecord));
+}
+
+void busRecordPrint(const char *title) {
+	gU32	calls, words;
+
+	calls = busRecord.indexes + busRecord.datas + busRecord.reads + busRecord.repeats + busRecord.buffers + busRecord.asyncs;
+	words = busRecord.indexes + busRecord.datas + busRecord.reads + busRecord.repeatwords + busRecord.bufferwords + busRecord.asyncwords;
+	printf("%s: %u bus calls moving %u words\n", title ? title : "Bus", (unsigned)calls, (unsigned)words);
+	printf("\tacquire %u, index %u, data %u, read %u\n", (unsigned)busRecord.acquires,
+		(unsigned)busRecord.indexes, (unsigned)busRecord.datas, (unsigned)busRecord.reads);
+	printf("\trepeat %u (%u words), buffer %u (%u words), async %u (%u words)\n",
+		(unsigned)busRecord.repeats, (unsigned)busRecord.repeatwords, (unsigned)busRecord.buffers, (unsigned)busRecord.bufferwords,
+		(unsigned)busRecord.asyncs, (unsigned)busRecord.asyncwords);
+	printf("\twait %u, stall %u\n", (unsigned)busRecord.waits, (unsigned)busRecord.stalls);
+}
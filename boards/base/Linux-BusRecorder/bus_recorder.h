@@ -0,0 +1,50 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _BUS_RECORDER_H
+#define _BUS_RECORDER_H
+
+/**
+ * The bus transactions counted by the recording board.
+ * Each "calls" count is one board call. Each "words" count is the data moved by those calls.
+ */
+typedef struct BusRecord {
+	gU32	acquires;				// acquire_bus() calls
+	gU32	indexes;				// write_index() or write_cmd() calls
+	gU32	datas;					// write_data() and write_data_byte() calls
+	gU32	reads;					// read_data() calls
+	gU32	repeats;				// write_data_repeat() calls
+	gU32	repeatwords;			//		and the words they sent
+	gU32	buffers;				// write_data_buffer() calls
+	gU32	bufferwords;			//		and the words they sent
+	gU32	asyncs;					// write_data_buffer_async() calls
+	gU32	asyncwords;				//		and the words they sent
+	gU32	waits;					// write_data_wait() calls that had a transfer to wait for
+	gU32	stalls;					// Other bus calls made while an asynchronous transfer was running
+	gBool	busy;					// An asynchronous transfer is running
+} BusRecord;
+
+extern BusRecord	busRecord;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	void busRecordClear(void);
+	void busRecordPrint(const char *title);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * Called by each bus routine of the board. A real board would have to wait for any
+ * asynchronous transfer to finish first.
+ */
+#define BUSRECORD_TOUCH()		{ if (busRecord.busy) { busRecord.stalls++; busRecord.busy = gFalse; } }
+
+#endif /* _BUS_RECORDER_H */
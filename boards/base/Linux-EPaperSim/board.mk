@@ -0,0 +1,9 @@
+GFXINC  += $(GFXLIB)/boards/base/Linux-EPaperSim
+GFXSRC  += $(GFXLIB)/boards/base/Linux-EPaperSim/epaper_sim.c
+GFXDEFS += -DGFX_USE_OS_LINUX=GFXON
+GFXLIBS += rt
+
+# The e-paper driver to simulate - UC8173 or WS29EPD
+EPAPERSIM_DRIVER ?= UC8173
+
+include $(GFXLIB)/drivers/gdisp/$(EPAPERSIM_DRIVER)/driver.mk
@@ -0,0 +1,147 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+#include "epaper_sim.h"
+#include "UC8173.h"
+
+// Define options for this driver
+#define UC8173_REVERSEAXIS_Y		GFXOFF
+#define UC8173_REVERSEAXIS_X		GFXOFF
+#define UC8173_USE_OTP_LUT			GFXOFF
+#ifndef UC8173_DEFAULT_MODE
+	#define UC8173_DEFAULT_MODE		0			/* Start with the fast A2 waveform for partial refreshes */
+#endif
+#ifndef UC8173_FULL_MODE
+	#define UC8173_FULL_MODE		3			/* The GC waveform clears ghosting with a full refresh */
+#endif
+#define UC8173_CAN_READ				GFXOFF
+#define UC8173_VCOM_VOLTAGE			-2.80
+#define UC8171_BORDER				0
+
+// Define the waveform table
+#include "UC8173_waveform_examples.h"
+static UC8173Lut	UC8173_ModeTable[] = {
+	// 32 bytes,				512 bytes,			128 bytes,	regal
+	{ _lut_KWvcom_DC_A2_240ms,	_lut_kw_A2_240ms,	_lut_ft, 	gFalse },
+	{ _lut_KWvcom_DC_A2_120ms,	_lut_kw_A2_120ms,	_lut_ft, 	gFalse },
+	{ _lut_KWvcom_DC_GU,		_lut_kw_GU,			_lut_ft, 	gTrue  },
+	{ _lut_KWvcom_GC,			_lut_kw_GC,			_lut_ft, 	gFalse }
+	};
+
+static GFXINLINE gBool init_board(GDisplay* g)
+{
+	g->board = 0;
+	epaperSimInit(240, 240);
+	return gTrue;
+}
+
+static GFXINLINE void post_init_board(GDisplay* g)
+{
+	(void) g;
+}
+
+static GFXINLINE void setpin_reset(GDisplay *g, gBool state)
+{
+	(void) g;
+	(void) state;
+}
+
+// The busy pin is high while the DC/DC converter is powered and idle
+static GFXINLINE gBool getpin_busy(GDisplay* g)
+{
+	(void) g;
+	return epaperSim.powered;
+}
+
+static GFXINLINE void acquire_bus(GDisplay* g)
+{
+	(void) g;
+}
+
+static GFXINLINE void release_bus(GDisplay* g)
+{
+	(void) g;
+}
+
+static GFXINLINE void write_cmd(GDisplay* g, gU8 cmd)
+{
+	(void) g;
+	epaperSim.bytes++;
+	epaperSim.cmd = cmd;
+	epaperSim.nargs = 0;
+	switch(cmd) {
+	case PON:
+		epaperSim.powered = gTrue;
+		break;
+	case POF:
+		epaperSim.powered = gFalse;
+		break;
+	case DTM2:
+	case DTM4:
+		epaperSim.wx = epaperSim.wx0;
+		epaperSim.wy = epaperSim.wy0;
+		break;
+	}
+}
+
+static GFXINLINE void write_data(GDisplay* g, gU8 data)
+{
+	gU8		*a;
+
+	(void) g;
+	epaperSim.bytes++;
+	if (epaperSim.nargs >= sizeof(epaperSim.args))
+		return;
+	a = epaperSim.args;
+	a[epaperSim.nargs++] = data;
+	if (epaperSim.cmd == DTMW && epaperSim.nargs == 6) {
+		// x, y, w-1, h-1
+		epaperSim.wx0 = a[0];
+		epaperSim.wy0 = ((gCoord)a[1] << 8) | a[2];
+		epaperSim.wx1 = epaperSim.wx0 + a[3];
+		epaperSim.wy1 = epaperSim.wy0 + (((gCoord)a[4] << 8) | a[5]);
+	} else if (epaperSim.cmd == DRF && epaperSim.nargs == 7) {
+		// flags, x, y, w-1, h-1
+		gCoord	x, y;
+
+		x = a[1];
+		y = ((gCoord)a[2] << 8) | a[3];
+		epaperSimRefresh(x, y, x + a[4] + 1, y + (((gCoord)a[5] << 8) | a[6]) + 1);
+	}
+}
+
+static GFXINLINE void write_data_burst(GDisplay* g, const gU8* data, unsigned length)
+{
+	unsigned	i;
+
+	(void) g;
+	epaperSim.bytes += length;
+	switch(epaperSim.cmd) {
+	case LUT_KW:
+		epaperSim.fullwaveform = data == UC8173_ModeTable[UC8173_FULL_MODE].lutFW;
+		break;
+	case DTM4:
+		// 1 bit per pixel, most significant first
+		for (; length; length--, data++) {
+			for (i = 0; i < 8; i++)
+				epaperSimWrite((*data >> (7-i)) & 1);
+		}
+		break;
+	case DTM2:
+		// 2 bits per pixel, most significant first
+		for (; length; length--, data++) {
+			for (i = 0; i < 4; i++)
+				epaperSimWrite((*data >> (6-i*2)) & 3);
+		}
+		break;
+	}
+}
+
+#endif /* _GDISP_LLD_BOARD_H */
@@ -0,0 +1,120 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef GDISP_LLD_BOARD_H
+#define GDISP_LLD_BOARD_H
+
+#include "epaper_sim.h"
+#include "WS29EPD.h"
+
+// The full refresh waveform in the driver
+extern gU8 LUTDefault_full[];
+
+static GFXINLINE void init_board(GDisplay *g) {
+	g->board = 0;
+	epaperSimInit(128, 296);
+}
+
+static GFXINLINE void post_init_board(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void setpin_reset(GDisplay *g, gBool state) {
+	(void) g;
+	(void) state;
+}
+
+// Refreshes happen straight away so the controller is never busy
+static GFXINLINE gBool getpin_busy(GDisplay *g) {
+	(void) g;
+	return gFalse;
+}
+
+static GFXINLINE void acquire_bus(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void release_bus(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void write_cmd(GDisplay *g, gU8 reg){
+	(void) g;
+	epaperSim.bytes++;
+	epaperSim.cmd = reg;
+	epaperSim.nargs = 0;
+	if (reg == MASTER_ACTIVATION && (epaperSim.update & 0x04)) {
+		// Show the memory being written and swap to the other one
+		epaperSimRefresh(0, 0, epaperSim.width, epaperSim.height);
+		epaperSim.bank ^= 1;
+	}
+}
+
+static GFXINLINE void write_data(GDisplay *g, gU8 data) {
+	gU8			*a;
+	unsigned	i;
+
+	(void) g;
+	epaperSim.bytes++;
+	if (epaperSim.cmd == WRITE_RAM) {
+		// 8 pixels per byte, most significant first. The position moves on in bytes.
+		if (epaperSim.wy < epaperSim.height && epaperSim.wx * 8 < epaperSim.width) {
+			for (i = 0; i < 8; i++)
+				epaperSim.ram[epaperSim.bank][epaperSim.wy * epaperSim.width + epaperSim.wx * 8 + i] = (data >> (7-i)) & 1;
+		}
+		if (++epaperSim.wx > epaperSim.wx1) {
+			epaperSim.wx = epaperSim.wx0;
+			if (++epaperSim.wy > epaperSim.wy1)
+				epaperSim.wy = epaperSim.wy0;
+		}
+		return;
+	}
+	if (epaperSim.nargs >= sizeof(epaperSim.args))
+		return;
+	a = epaperSim.args;
+	a[epaperSim.nargs++] = data;
+	switch(epaperSim.cmd) {
+	case SET_RAM_X_ADR:
+		if (epaperSim.nargs == 2) {
+			epaperSim.wx0 = a[0];
+			epaperSim.wx1 = a[1];
+		}
+		break;
+	case SET_RAM_Y_ADR:
+		if (epaperSim.nargs == 4) {
+			epaperSim.wy0 = a[0] | ((gCoord)a[1] << 8);
+			epaperSim.wy1 = a[2] | ((gCoord)a[3] << 8);
+		}
+		break;
+	case SET_RAM_X_CNT:
+		epaperSim.wx = a[0];
+		break;
+	case SET_RAM_Y_CNT:
+		if (epaperSim.nargs == 2)
+			epaperSim.wy = a[0] | ((gCoord)a[1] << 8);
+		break;
+	case DISPLAY_UPDATE_CTRL2:
+		// Remembered for the MASTER_ACTIVATION
+		epaperSim.update = data;
+		break;
+	}
+}
+
+static GFXINLINE void write_reg(GDisplay *g, gU8 reg, gU8 data){
+	write_cmd(g, reg);
+	write_data(g, data);
+}
+
+static GFXINLINE void write_reg_data(GDisplay *g, gU8 reg, gU8 *data, gU8 len) {
+	if (reg == WRITE_LUT_REG)
+		epaperSim.fullwaveform = data == LUTDefault_full;
+	write_cmd(g, reg);
+	for (; len; len--, data++)
+		write_data(g, *data);
+}
+
+#endif /* GDISP_LLD_BOARD_H */
@@ -0,0 +1,95 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "gfx.h"
+#include "epaper_sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+EPaperSim	epaperSim;
+
+void epaperSimInit(gCoord width, gCoord height) {
+	memset(&epaperSim, 0, sizeof(epaperSim));
+	epaperSim.width = width;
+	epaperSim.height = height;
+	epaperSim.wx1 = width-1;
+	epaperSim.wy1 = height-1;
+}
+
+void epaperSimClear(void) {
+	epaperSim.fulls = epaperSim.partials = 0;
+	epaperSim.pixels = epaperSim.bytes = epaperSim.ms = 0;
+}
+
+void epaperSimPrint(const char *title) {
+	printf("%s: %u full and %u partial refreshes of %u pixels in about %u ms\n", title ? title : "EPaper",
+		(unsigned)epaperSim.fulls, (unsigned)epaperSim.partials, (unsigned)epaperSim.pixels,
+		(unsigned)(epaperSim.ms + epaperSim.bytes * 8 / EPAPERSIM_BUS_KHZ));
+	printf("\t%u bytes sent, %u pixels ghosted (worst %u)\n", (unsigned)epaperSim.bytes,
+		(unsigned)epaperSim.ghosted, (unsigned)epaperSim.maxghost);
+}
+
+unsigned epaperSimPixel(gCoord x, gCoord y) {
+	if (x < 0 || y < 0 || x >= epaperSim.width || y >= epaperSim.height)
+		return 0;
+	return epaperSim.panel[y * epaperSim.width + x];
+}
+
+void epaperSimWrite(unsigned value) {
+	if (epaperSim.wx >= 0 && epaperSim.wx < epaperSim.width && epaperSim.wy >= 0 && epaperSim.wy < epaperSim.height)
+		epaperSim.ram[epaperSim.bank][epaperSim.wy * epaperSim.width + epaperSim.wx] = (gU8)value;
+	if (++epaperSim.wx > epaperSim.wx1) {
+		epaperSim.wx = epaperSim.wx0;
+		if (++epaperSim.wy > epaperSim.wy1)
+			epaperSim.wy = epaperSim.wy0;
+	}
+}
+
+void epaperSimRefresh(gCoord x0, gCoord y0, gCoord x1, gCoord y1) {
+	gCoord		x, y;
+	unsigned	i;
+	gU8			*ram;
+
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > epaperSim.width) x1 = epaperSim.width;
+	if (y1 > epaperSim.height) y1 = epaperSim.height;
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	ram = epaperSim.ram[epaperSim.bank];
+	for(y = y0; y < y1; y++) {
+		for(x = x0; x < x1; x++) {
+			i = y * epaperSim.width + x;
+			if (epaperSim.fullwaveform)
+				epaperSim.ghost[i] = 0;
+			else if (ram[i] != epaperSim.panel[i] && epaperSim.ghost[i] < 255)
+				epaperSim.ghost[i]++;
+			epaperSim.panel[i] = ram[i];
+		}
+	}
+	epaperSim.pixels += (gU32)(x1 - x0) * (gU32)(y1 - y0);
+	if (epaperSim.fullwaveform) {
+		epaperSim.fulls++;
+		epaperSim.ms += EPAPERSIM_FULL_MS;
+	} else {
+		epaperSim.partials++;
+		epaperSim.ms += EPAPERSIM_PARTIAL_MS;
+	}
+
+	// Count the ghosting left on the panel
+	epaperSim.ghosted = 0;
+	epaperSim.maxghost = 0;
+	for(i = 0; i < (unsigned)(epaperSim.width * epaperSim.height); i++) {
+		if (epaperSim.ghost[i]) {
+			epaperSim.ghosted++;
+			if (epaperSim.ghost[i] > epaperSim.maxghost)
+				epaperSim.maxghost = epaperSim.ghost[i];
+		}
+	}
+}
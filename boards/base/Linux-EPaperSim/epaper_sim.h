@@ -0,0 +1,74 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _EPAPER_SIM_H
+#define _EPAPER_SIM_H
+
+#ifndef EPAPERSIM_FULL_MS
+	#define EPAPERSIM_FULL_MS		1000
+#endif
+#ifndef EPAPERSIM_PARTIAL_MS
+	#define EPAPERSIM_PARTIAL_MS	250
+#endif
+#ifndef EPAPERSIM_BUS_KHZ
+	#define EPAPERSIM_BUS_KHZ		4000
+#endif
+
+// Big enough for either of the supported panels
+#define EPAPERSIM_MAXPIXELS		(296*240)
+
+/**
+ * The simulated controller and panel.
+ * Pixels are stored one per byte as the value sent by the driver.
+ */
+typedef struct EPaperSim {
+	gCoord	width, height;
+	gU32	fulls;					// Full refreshes
+	gU32	partials;				// Partial refreshes
+	gU32	pixels;					// Pixels refreshed
+	gU32	bytes;					// Command and data bytes sent
+	gU32	ms;						// Estimated refresh and transfer time
+	gU32	ghosted;				// Pixels that have been changed by a partial refresh since their last full refresh
+	gU8		maxghost;				// The most partial changes to one pixel since its last full refresh
+
+	// The simulated controller state used by the board
+	gU8		cmd;					// The last command
+	unsigned nargs;					// Bytes of data since the command
+	gU8		args[8];
+	gBool	powered;
+	gBool	fullwaveform;			// The loaded waveform is the full refresh one
+	gU8		update;					// The update sequence to run (WS29EPD)
+	unsigned bank;					// The controller memory being written
+	gCoord	wx0, wy0, wx1, wy1;		// The controller memory window (inclusive)
+	gCoord	wx, wy;					// The controller memory position
+
+	gU8		ram[2][EPAPERSIM_MAXPIXELS];
+	gU8		panel[EPAPERSIM_MAXPIXELS];
+	gU8		ghost[EPAPERSIM_MAXPIXELS];
+} EPaperSim;
+
+extern EPaperSim	epaperSim;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	void epaperSimInit(gCoord width, gCoord height);
+	void epaperSimClear(void);
+	void epaperSimPrint(const char *title);
+	unsigned epaperSimPixel(gCoord x, gCoord y);
+
+	// Used by the board. Write one pixel at the memory position and move to the next.
+	void epaperSimWrite(unsigned value);
+	// Used by the board. Show a window (x1, y1 exclusive) of the controller memory on the panel.
+	void epaperSimRefresh(gCoord x0, gCoord y0, gCoord x1, gCoord y1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EPAPER_SIM_H */
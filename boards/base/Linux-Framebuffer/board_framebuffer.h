@@ -10,6 +10,25 @@
 	#define GDISP_LLD_PIXELFORMAT		GDISP_PIXELFORMAT_RGB888
 #endif
 
+// Set this to GFXON to draw into a shadow buffer in normal (cached) memory. Only the changed areas are copied to the
+//	framebuffer device when the display is flushed. Framebuffer memory is often uncached so this makes reading back
+//	pixels (eg. for anti-aliased text) much faster. You must call gdispFlush() or use GDISP_NEED_AUTOFLUSH or GDISP_NEED_TIMERFLUSH.
+#ifndef GDISP_LINUXFB_SHADOW
+	#define GDISP_LINUXFB_SHADOW		GFXOFF
+#endif
+// When using a shadow buffer, flip between two framebuffer pages using FBIOPAN_DISPLAY if the device supports it.
+#ifndef GDISP_LINUXFB_PAGEFLIP
+	#define GDISP_LINUXFB_PAGEFLIP		GFXON
+#endif
+// The number of separate changed areas remembered between flushes. More areas than this are merged.
+#ifndef GDISP_LINUXFB_DAMAGE_RECTS
+	#define GDISP_LINUXFB_DAMAGE_RECTS	8
+#endif
+#if GDISP_LINUXFB_SHADOW
+	#define GDISP_HARDWARE_FLUSH		GFXON
+	#define GDISP_FRAMEBUFFER_DAMAGE	GFXON
+#endif
+
 #ifdef GDISP_DRIVER_VMT
 
 	#define FBDEV_PATH1		"/dev/fb0"
@@ -34,6 +53,35 @@
 	#include <sys/types.h>
 	#include <unistd.h>
 
+	// The display size when the "framebuffer" is a plain file (or memfd) rather than a device. Useful for testing.
+	#ifndef GDISP_SCREEN_WIDTH
+		#define GDISP_SCREEN_WIDTH		640
+	#endif
+	#ifndef GDISP_SCREEN_HEIGHT
+		#define GDISP_SCREEN_HEIGHT		480
+	#endif
+
+	#if GDISP_LINUXFB_SHADOW
+		typedef struct fbRect {
+			gCoord		x, y, cx, cy;
+		} fbRect;
+
+		typedef struct fbBoard {
+			char *		shadow;								// The buffer we draw in
+			char *		device;								// The framebuffer device memory (all pages)
+			size_t		pagelen;							// Bytes per framebuffer page
+			gCoord		linelen;							// Bytes per line (for both the shadow and the device)
+			int			fd;									// The framebuffer device (only kept open for page flipping)
+			int			pages;								// 1 or 2
+			int			page;								// The page currently being shown
+			struct fb_var_screeninfo	var;				// Used to pan between pages
+			int			ndamage;							// Areas changed since the last flush
+			fbRect		damage[GDISP_LINUXFB_DAMAGE_RECTS];
+			int			nprev;								// Areas changed in the previous flush. These are missing
+			fbRect		prev[GDISP_LINUXFB_DAMAGE_RECTS];	//	from the back page when page flipping.
+		} fbBoard;
+	#endif
+
 	#if VTDEV_PATH
 		static void board_revert2textmode(void) {
 			int tty;
@@ -66,7 +114,10 @@
 	static void board_init(GDisplay *g, fbInfo *fbi) {
 		int							fb;
 		char *						env;
+		void *						pixels;
 		size_t						fblen;
+		int							pages;
+		struct stat					fb_stat;
 		struct fb_fix_screeninfo	fb_fix;
 		struct fb_var_screeninfo	fb_var;
 
@@ -83,101 +134,136 @@
 			fprintf(stderr, "GDISP Framebuffer: Error opening the framebuffer device\n");
 			exit(-1);
 		}
+		pages = 1;
 
-		// Get screen info
-		if (ioctl(fb, FBIOGET_FSCREENINFO, &fb_fix) == -1 || ioctl(fb, FBIOGET_VSCREENINFO, &fb_var) == -1) {
-			fprintf(stderr, "GDISP Framebuffer: Error getting screen info\n");
-			exit(-1);
-		}
+		if (fstat(fb, &fb_stat) == 0 && S_ISREG(fb_stat.st_mode)) {
+			// A plain file (eg. FRAMEBUFFER=/proc/self/fd/N for a memfd) is standing in for the device
+			memset(&fb_fix, 0, sizeof(fb_fix));
+			memset(&fb_var, 0, sizeof(fb_var));
+			fb_var.xres = GDISP_SCREEN_WIDTH;
+			fb_var.yres = GDISP_SCREEN_HEIGHT;
+			fb_fix.line_length = GDISP_SCREEN_WIDTH * sizeof(LLDCOLOR_TYPE);
+			fblen = fb_var.yres * fb_fix.line_length;
+			if ((size_t)fb_stat.st_size < fblen && ftruncate(fb, fblen) == -1) {
+				fprintf(stderr, "GDISP Framebuffer: Unable to size the framebuffer file\n");
+				exit(-1);
+			}
+			pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_SHARED, fb, 0);
 
-		#ifdef USE_SET_MODE
-			fb_var.reserved[0] = 0;
-			fb_var.reserved[1] = 0;
-			fb_var.reserved[2] = 0;
-			fb_var.xoffset = 0;
-			fb_var.yoffset = 0;
-			#if LLDCOLOR_BITS == 15
-				fb_var.bits_per_pixel = LLDCOLOR_BITS;				// Handle RGB555 & BGR555
-			#else
-				fb_var.bits_per_pixel = sizeof(LLDCOLOR_TYPE)*8;
-			#endif
-			fb_var.grayscale = 0;
-			fb_var.activate = FB_ACTIVATE_NOW;
-			if (ioctl(fb, FBIOPUT_VSCREENINFO, &fb_var) == -1 || ioctl (fb, FBIOGET_VSCREENINFO, &fb_var) == -1) {
-				fprintf(stderr, "GDISP Framebuffer: Failed to set video mode\n");
+		} else {
+			// Get screen info
+			if (ioctl(fb, FBIOGET_FSCREENINFO, &fb_fix) == -1 || ioctl(fb, FBIOGET_VSCREENINFO, &fb_var) == -1) {
+				fprintf(stderr, "GDISP Framebuffer: Error getting screen info\n");
 				exit(-1);
 			}
-		#endif
 
-		// Check things are as they should be
-		if (fb_fix.type != FB_TYPE_PACKED_PIXELS) {
-			fprintf(stderr, "GDISP Framebuffer: The display is not in a single plane graphics mode\n");
-			exit(-1);
-		}
-		if (fb_fix.visual != FB_VISUAL_TRUECOLOR) {
-			fprintf(stderr, "GDISP Framebuffer: The display is not in TRUECOLOR mode\n");
-			exit(-1);
-		}
-		if (fb_var.bits_per_pixel != sizeof(LLDCOLOR_TYPE)*8) {
-			fprintf(stderr, "GDISP Framebuffer: The display is %u not %u bits per pixel\n", fb_var.bits_per_pixel, LLDCOLOR_TYPE_BITS);
-			exit(-1);
-		}
-		if (fb_var.red.length != LLDCOLOR_BITS_R || fb_var.green.length != LLDCOLOR_BITS_G || fb_var.blue.length != LLDCOLOR_BITS_B) {
-			fprintf(stderr, "GDISP Framebuffer: The display pixel format is not %d%d%d\n", LLDCOLOR_BITS_R, LLDCOLOR_BITS_G, LLDCOLOR_BITS_B);
-			exit(-1);
-		}
-		if (fb_var.red.offset != LLDCOLOR_SHIFT_R || fb_var.green.offset != LLDCOLOR_SHIFT_G || fb_var.blue.offset != LLDCOLOR_SHIFT_B) {
-			#if LLDCOLOR_SHIFT_B == 0
-				fprintf(stderr, "GDISP Framebuffer: The display pixel format is not RGB\n");
-			#else
-				fprintf(stderr, "GDISP Framebuffer: The display pixel format is not BGR\n");
+			#ifdef USE_SET_MODE
+				fb_var.reserved[0] = 0;
+				fb_var.reserved[1] = 0;
+				fb_var.reserved[2] = 0;
+				fb_var.xoffset = 0;
+				fb_var.yoffset = 0;
+				#if LLDCOLOR_BITS == 15
+					fb_var.bits_per_pixel = LLDCOLOR_BITS;				// Handle RGB555 & BGR555
+				#else
+					fb_var.bits_per_pixel = sizeof(LLDCOLOR_TYPE)*8;
+				#endif
+				fb_var.grayscale = 0;
+				fb_var.activate = FB_ACTIVATE_NOW;
+				if (ioctl(fb, FBIOPUT_VSCREENINFO, &fb_var) == -1 || ioctl (fb, FBIOGET_VSCREENINFO, &fb_var) == -1) {
+					fprintf(stderr, "GDISP Framebuffer: Failed to set video mode\n");
+					exit(-1);
+				}
 			#endif
-			exit(-1);
-		}
 
-		// Ensure we are at the origin of the virtual display area
-		if (fb_var.xoffset || fb_var.yoffset) {
-			fb_var.xoffset = 0;
-			fb_var.yoffset = 0;
-			ioctl(fb, FBIOPAN_DISPLAY, &fb_var);
-		}
+			#if GDISP_LINUXFB_SHADOW && GDISP_LINUXFB_PAGEFLIP
+				// We need a virtual display twice the real height that we can pan over
+				if (fb_var.yres_virtual < fb_var.yres*2) {
+					struct fb_var_screeninfo	fb_var2;
 
-		// Switch to graphics mode (if required)
-		#ifdef VTDEV_PATH
-			board_switch2graphicsmode();
-		#endif
+					fb_var2 = fb_var;
+					fb_var2.yres_virtual = fb_var.yres*2;
+					fb_var2.activate = FB_ACTIVATE_NOW;
+					if (ioctl(fb, FBIOPUT_VSCREENINFO, &fb_var2) != -1) {
+						ioctl(fb, FBIOGET_VSCREENINFO, &fb_var);
+						ioctl(fb, FBIOGET_FSCREENINFO, &fb_fix);
+					}
+				}
+				if (fb_var.yres_virtual >= fb_var.yres*2 && fb_fix.ypanstep && !(fb_var.yres % fb_fix.ypanstep)
+						&& fb_fix.smem_len >= 2 * fb_var.yres * fb_fix.line_length)
+					pages = 2;
+			#endif
 
-		// Calculate the frame buffer length
-		fblen = fb_var.yres * fb_fix.line_length;
-
-		// Different systems need mapping in slightly different ways - Yuck!
-		#ifdef ARCH_LINUX_SPARC
-			#define CG3_MMAP_OFFSET 0x4000000
-			#define CG6_RAM    		0x70016000
-			#define TCX_RAM8BIT		0x00000000
-			#define TCX_RAM24BIT	0x01000000
-			switch (fb_fix.accel) {
-			case FB_ACCEL_SUN_CGTHREE:
-				fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_SHARED, fb, CG3_MMAP_OFFSET);
-				break;
-			case FB_ACCEL_SUN_CGSIX:
-				fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_SHARED, fb, CG6_RAM);
-				break;
-			case FB_ACCEL_SUN_TCX:
-				fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_SHARED, fb, TCX_RAM24BIT);
-				break;
-			default:
-				fprintf(stderr, "GDISP Framebuffer: Don't know how to mmap with accel %d\n", fb_fix.accel);
+			// Check things are as they should be
+			if (fb_fix.type != FB_TYPE_PACKED_PIXELS) {
+				fprintf(stderr, "GDISP Framebuffer: The display is not in a single plane graphics mode\n");
 				exit(-1);
 			}
-		#elif defined(BLACKFIN)
-			fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FILE, fb, 0);
-		#elif defined(__uClinux__)
-			fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, 0, fb, 0);
-		#else
-			fbi->pixels = mmap(0, fblen, PROT_READ|PROT_WRITE, MAP_SHARED, fb, 0);
-		#endif
-		if(!fbi->pixels || fbi->pixels == (void *)-1) {
+			if (fb_fix.visual != FB_VISUAL_TRUECOLOR) {
+				fprintf(stderr, "GDISP Framebuffer: The display is not in TRUECOLOR mode\n");
+				exit(-1);
+			}
+			if (fb_var.bits_per_pixel != sizeof(LLDCOLOR_TYPE)*8) {
+				fprintf(stderr, "GDISP Framebuffer: The display is %u not %u bits per pixel\n", fb_var.bits_per_pixel, LLDCOLOR_TYPE_BITS);
+				exit(-1);
+			}
+			if (fb_var.red.length != LLDCOLOR_BITS_R || fb_var.green.length != LLDCOLOR_BITS_G || fb_var.blue.length != LLDCOLOR_BITS_B) {
+				fprintf(stderr, "GDISP Framebuffer: The display pixel format is not %d%d%d\n", LLDCOLOR_BITS_R, LLDCOLOR_BITS_G, LLDCOLOR_BITS_B);
+				exit(-1);
+			}
+			if (fb_var.red.offset != LLDCOLOR_SHIFT_R || fb_var.green.offset != LLDCOLOR_SHIFT_G || fb_var.blue.offset != LLDCOLOR_SHIFT_B) {
+				#if LLDCOLOR_SHIFT_B == 0
+					fprintf(stderr, "GDISP Framebuffer: The display pixel format is not RGB\n");
+				#else
+					fprintf(stderr, "GDISP Framebuffer: The display pixel format is not BGR\n");
+				#endif
+				exit(-1);
+			}
+
+			// Ensure we are at the origin of the virtual display area
+			if (fb_var.xoffset || fb_var.yoffset) {
+				fb_var.xoffset = 0;
+				fb_var.yoffset = 0;
+				ioctl(fb, FBIOPAN_DISPLAY, &fb_var);
+			}
+
+			// Switch to graphics mode (if required)
+			#ifdef VTDEV_PATH
+				board_switch2graphicsmode();
+			#endif
+
+			// Calculate the frame buffer length
+			fblen = fb_var.yres * fb_fix.line_length;
+
+			// Different systems need mapping in slightly different ways - Yuck!
+			#ifdef ARCH_LINUX_SPARC
+				#define CG3_MMAP_OFFSET 0x4000000
+				#define CG6_RAM    		0x70016000
+				#define TCX_RAM8BIT		0x00000000
+				#define TCX_RAM24BIT	0x01000000
+				switch (fb_fix.accel) {
+				case FB_ACCEL_SUN_CGTHREE:
+					pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, MAP_SHARED, fb, CG3_MMAP_OFFSET);
+					break;
+				case FB_ACCEL_SUN_CGSIX:
+					pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, MAP_SHARED, fb, CG6_RAM);
+					break;
+				case FB_ACCEL_SUN_TCX:
+					pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, MAP_SHARED, fb, TCX_RAM24BIT);
+					break;
+				default:
+					fprintf(stderr, "GDISP Framebuffer: Don't know how to mmap with accel %d\n", fb_fix.accel);
+					exit(-1);
+				}
+			#elif defined(BLACKFIN)
+				pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FILE, fb, 0);
+			#elif defined(__uClinux__)
+				pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, 0, fb, 0);
+			#else
+				pixels = mmap(0, fblen*pages, PROT_READ|PROT_WRITE, MAP_SHARED, fb, 0);
+			#endif
+		}
+		if(!pixels || pixels == (void *)-1) {
 			fprintf(stderr, "GDISP Framebuffer: mmap of display buffer failed\n");
 			exit(-1);
 		}
@@ -185,10 +271,42 @@
 		// If this program gets children they should not inherit this file descriptor
 		fcntl(fb, F_SETFD, FD_CLOEXEC);
 
-		// We are finished with the file descriptor
-		close(fb);
+		#if GDISP_LINUXFB_SHADOW
+			{
+				fbBoard *	fbb;
+
+				if (!(fbb = gfxAlloc(sizeof(fbBoard))) || !(fbb->shadow = gfxAlloc(fblen))) {
+					fprintf(stderr, "GDISP Framebuffer: Unable to allocate the shadow buffer\n");
+					exit(-1);
+				}
+				memset(fbb->shadow, 0, fblen);
+				fbb->device = (char *)pixels;
+				fbb->pagelen = fblen;
+				fbb->linelen = fb_fix.line_length;
+				fbb->pages = pages;
+				fbb->page = 0;
+				fbb->var = fb_var;
+				fbb->ndamage = 0;
+				fbb->nprev = 0;
+				g->board = fbb;
+
+				// We draw into the shadow buffer
+				pixels = fbb->shadow;
+
+				// We need the device to pan between pages
+				fbb->fd = fb;
+				if (pages == 1) {
+					fbb->fd = -1;
+					close(fb);
+				}
+			}
+		#else
+			// We are finished with the file descriptor
+			close(fb);
+		#endif
 
 		// Set the rest of the details of the frame buffer
+		fbi->pixels = pixels;
 		g->g.Width = fb_var.xres;
 		g->g.Height = fb_var.yres;
 		g->g.Backlight = 100;
@@ -196,7 +314,108 @@
 		fbi->linelen = fb_fix.line_length;
 	}
 
-	#if GDISP_HARDWARE_FLUSH
+	#if GDISP_LINUXFB_SHADOW
+		// Remember an area of the shadow buffer that has changed
+		static void board_damage(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+			fbBoard *	fbb;
+			fbRect *	r;
+			int			i, best;
+			long		area, bestarea;
+			gCoord		x0, y0, x1, y1;
+
+			fbb = (fbBoard *)g->board;
+			best = 0;
+			bestarea = 0;
+			for(i = 0, r = fbb->damage; i < fbb->ndamage; i++, r++) {
+				// Merge with an area it overlaps or touches
+				if (x <= r->x+r->cx && x+cx >= r->x && y <= r->y+r->cy && y+cy >= r->y)
+					break;
+
+				// Otherwise remember which area would grow the least
+				x0 = r->x < x ? r->x : x;
+				y0 = r->y < y ? r->y : y;
+				x1 = r->x+r->cx > x+cx ? r->x+r->cx : x+cx;
+				y1 = r->y+r->cy > y+cy ? r->y+r->cy : y+cy;
+				area = (long)(x1-x0)*(y1-y0) - (long)r->cx*r->cy;
+				if (!i || area < bestarea) {
+					best = i;
+					bestarea = area;
+				}
+			}
+			if (i >= fbb->ndamage) {
+				if (fbb->ndamage < GDISP_LINUXFB_DAMAGE_RECTS) {
+					r = fbb->damage + fbb->ndamage++;
+					r->x = x;	r->y = y;
+					r->cx = cx;	r->cy = cy;
+					return;
+				}
+				r = fbb->damage + best;
+			}
+			x0 = r->x < x ? r->x : x;
+			y0 = r->y < y ? r->y : y;
+			x1 = r->x+r->cx > x+cx ? r->x+r->cx : x+cx;
+			y1 = r->y+r->cy > y+cy ? r->y+r->cy : y+cy;
+			r->x = x0;		r->y = y0;
+			r->cx = x1-x0;	r->cy = y1-y0;
+		}
+
+		// Copy areas of the shadow buffer to a page of the device
+		static void board_copy(fbBoard *fbb, char *page, const fbRect *r, int cnt) {
+			size_t		pos, len;
+			gCoord		y;
+
+			for(; cnt; cnt--, r++) {
+				pos = r->y * fbb->linelen + r->x * sizeof(LLDCOLOR_TYPE);
+				len = r->cx * sizeof(LLDCOLOR_TYPE);
+				for(y = 0; y < r->cy; y++, pos += fbb->linelen)
+					memcpy(page + pos, fbb->shadow + pos, len);
+			}
+		}
+
+		static void board_flush(GDisplay *g) {
+			fbBoard *	fbb;
+			int			page;
+
+			fbb = (fbBoard *)g->board;
+			if (!fbb->ndamage)
+				return;
+
+			if (fbb->pages == 1) {
+				board_copy(fbb, fbb->device, fbb->damage, fbb->ndamage);
+				fbb->ndamage = 0;
+				return;
+			}
+
+			// Bring the hidden page up to date - it also missed what changed on the last flush
+			page = 1 - fbb->page;
+			board_copy(fbb, fbb->device + page * fbb->pagelen, fbb->prev, fbb->nprev);
+			board_copy(fbb, fbb->device + page * fbb->pagelen, fbb->damage, fbb->ndamage);
+
+			// Show it
+			fbb->var.xoffset = 0;
+			fbb->var.yoffset = page * fbb->var.yres;
+			if (ioctl(fbb->fd, FBIOPAN_DISPLAY, &fbb->var) == -1) {
+				// Panning has stopped working - just use the page being shown
+				fbb->pages = 1;
+				fbb->device += fbb->page * fbb->pagelen;
+				memcpy(fbb->device, fbb->shadow, fbb->pagelen);
+				fbb->ndamage = 0;
+				return;
+			}
+			#ifdef FBIO_WAITFORVSYNC
+				{
+					gU32	crtc = 0;
+
+					// Don't start drawing on the old page until it is no longer being shown
+					ioctl(fbb->fd, FBIO_WAITFORVSYNC, &crtc);
+				}
+			#endif
+			fbb->page = page;
+			memcpy(fbb->prev, fbb->damage, fbb->ndamage * sizeof(fbRect));
+			fbb->nprev = fbb->ndamage;
+			fbb->ndamage = 0;
+		}
+	#elif GDISP_HARDWARE_FLUSH
 		static void board_flush(GDisplay *g) {
 			(void) g;
 		}
@@ -0,0 +1,3 @@
+DEMODIR = $(GFXLIB)/demos/modules/gdisp/accel
+GFXINC +=   $(DEMODIR)
+GFXSRC +=	$(DEMODIR)/main.c
@@ -0,0 +1,87 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * Draw frames into two pixmaps in turn and let an accelerator copy each finished frame to
+ * the display while the CPU is drawing the next one.
+ *
+ * The drawing here stands in for any CPU heavy work such as decoding an image. When the
+ * display keeps its pixels in memory (eg. the framebuffer driver) the copy is a job for the
+ * accelerator. Otherwise the frame is blitted to the display in the usual way.
+ */
+
+#include "gfx.h"
+
+#define TILE_WIDTH		96
+#define TILE_HEIGHT		64
+
+static GDisplay			*tile[2];
+static gdispAccelFence	fence[2];
+
+// The CPU work for a frame
+static void drawFrame(GDisplay *g, unsigned frame) {
+	static const gColor	colors[] = { GFX_RED, GFX_LIME, GFX_BLUE, GFX_YELLOW };
+	gCoord				i;
+
+	gdispGFillArea(g, 0, 0, TILE_WIDTH, TILE_HEIGHT, GFX_BLACK);
+	for(i = 0; i < TILE_WIDTH; i += 4)
+		gdispGDrawLine(g, i, 0, (i + frame) % TILE_WIDTH, TILE_HEIGHT-1, colors[(frame >> 4) & 3]);
+}
+
+int main(void) {
+	gdispAccel		*accel;
+	gdispSurface	screen;
+	gdispAccelJob	job;
+	gCoord			x, y;
+	unsigned		frame, i;
+
+	// Initialize and clear the display
+	gfxInit();
+
+	// The tiles and the engine that copies them
+	tile[0] = gdispPixmapCreate(TILE_WIDTH, TILE_HEIGHT);
+	tile[1] = gdispPixmapCreate(TILE_WIDTH, TILE_HEIGHT);
+	accel = gdispAccelSoftwareCreate();
+
+	// Let the display use the same engine for its own large fills.
+	//	Its driver then waits for our copies before drawing on the display itself.
+	gdispSetAccel(accel);
+
+	x = y = 0;
+	for(frame = 0; ; frame++) {
+		i = frame & 1;
+
+		// Don't draw on a tile the accelerator is still copying
+		gdispAccelWait(accel, fence[i], gDelayForever);
+		drawFrame(tile[i], frame);
+
+		if (gdispGetSurface(&screen)) {
+			// Wait for the drawing to be finished with the pixels, then queue the copy and carry on
+			gdispGAccelSync(tile[i]);
+			gdispGGetSurface(tile[i], &job.src);
+			job.op = job.src.format == screen.format ? GDISP_ACCEL_COPY : GDISP_ACCEL_CONVERT;
+			job.dst = screen;
+			job.dx = x;
+			job.dy = y;
+			job.sx = job.sy = 0;
+			job.cx = TILE_WIDTH;
+			job.cy = TILE_HEIGHT;
+			fence[i] = gdispAccelSubmit(accel, &job);
+		} else
+			gdispBlitArea(x, y, TILE_WIDTH, TILE_HEIGHT, gdispPixmapGetBits(tile[i]));
+
+		// Move along the screen
+		x += TILE_WIDTH;
+		if (x + TILE_WIDTH > gdispGetWidth()) {
+			x = 0;
+			y += TILE_HEIGHT;
+			if (y + TILE_HEIGHT > gdispGetHeight())
+				y = 0;
+		}
+		gfxSleepMilliseconds(20);
+	}
+}
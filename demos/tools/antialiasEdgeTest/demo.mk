@@ -0,0 +1,3 @@
+DEMODIR = $(GFXLIB)/demos/tools/antialiasEdgeTest
+GFXINC +=   $(DEMODIR)
+GFXSRC +=	$(DEMODIR)/main.c
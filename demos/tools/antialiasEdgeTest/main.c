@@ -0,0 +1,119 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * Check that anti-aliased text drawn across the right and bottom edges of the display
+ * looks the same as the part of it that is on the display.
+ *
+ * Anti-aliased text reads back the pixels it blends with, including pixels beyond the edge
+ * of the display. A driver must not read outside its framebuffer for those so run this
+ * with a memory checker (eg. -fsanitize=address) as well.
+ * With the uGFXnet driver and no viewer connected it checks the driver's shadow copy.
+ *
+ * Each orientation is checked in turn. The results are shown on the display and the
+ * program returns the number of failures.
+ */
+
+#include "gfx.h"
+
+#define TEXT			"Edge"
+#define REF_X			4
+#define REF_Y			4
+
+static gFont		font;
+static unsigned		failures;
+
+/**
+ * Compare a cx by cy area at (x, y) with the same size area at the reference position.
+ * The reference area must have some text in it.
+ */
+static gBool sameArea(gCoord x, gCoord y, gCoord cx, gCoord cy) {
+	gCoord	i, j;
+	gColor	c;
+	gBool	drawn;
+
+	drawn = gFalse;
+	for(j = 0; j < cy; j++) {
+		for(i = 0; i < cx; i++) {
+			c = gdispGetPixelColor(REF_X+i, REF_Y+j);
+			if (gdispGetPixelColor(x+i, y+j) != c)
+				return gFalse;
+			if (c != GFX_BLACK)
+				drawn = gTrue;
+		}
+	}
+	return drawn;
+}
+
+static unsigned checkOrientation(gOrientation o) {
+	gCoord		w, h, sw, fh;
+	unsigned	bad;
+
+	gdispSetOrientation(o);
+	if (gdispGetOrientation() != o)
+		return 1;
+	w = gdispGetWidth();
+	h = gdispGetHeight();
+	sw = gdispGetStringWidth(TEXT, font);
+	fh = gdispGetFontMetric(font, gFontHeight);
+	bad = 0;
+
+	// The reference and the text at the right edge
+	gdispClear(GFX_BLACK);
+	gdispDrawString(REF_X, REF_Y, TEXT, font, GFX_WHITE);
+	gdispDrawString(w - sw/2, REF_Y, TEXT, font, GFX_WHITE);
+	if (!sameArea(w - sw/2, REF_Y, sw/2, fh))
+		bad++;
+
+	// The text at the bottom edge
+	gdispDrawString(REF_X, h - fh/2, TEXT, font, GFX_WHITE);
+	if (!sameArea(REF_X, h - fh/2, sw, fh/2))
+		bad++;
+
+	// The text at the bottom right corner
+	gdispDrawString(w - sw/2, h - fh/2, TEXT, font, GFX_WHITE);
+	if (!sameArea(w - sw/2, h - fh/2, sw/2, fh/2))
+		bad++;
+
+	return bad;
+}
+
+static void report(gCoord y, const char *name, unsigned bad) {
+	gFont	f;
+
+	f = gdispOpenFont("UI2");
+	gdispDrawString(0, y, name, f, GFX_WHITE);
+	gdispDrawString(gdispGetWidth()/2, y, bad ? "FAIL" : "Pass", f, bad ? GFX_RED : GFX_LIME);
+	gdispCloseFont(f);
+	failures += bad;
+}
+
+int main(void) {
+	unsigned	r0, r90, r180, r270;
+
+	gfxInit();
+
+	font = gdispOpenFont("DejaVuSans16_aa");
+	if (!font)
+		return 1;
+
+	r0 = checkOrientation(gOrientation0);
+	r90 = checkOrientation(gOrientation90);
+	r180 = checkOrientation(gOrientation180);
+	r270 = checkOrientation(gOrientation270);
+	gdispCloseFont(font);
+
+	gdispSetOrientation(gOrientation0);
+	gdispClear(GFX_BLACK);
+	failures = 0;
+	report(0, "Orientation 0", r0);
+	report(20, "Orientation 90", r90);
+	report(40, "Orientation 180", r180);
+	report(60, "Orientation 270", r270);
+
+	return (int)failures;
+}
@@ -0,0 +1,3 @@
+DEMODIR = $(GFXLIB)/demos/tools/gdispTraceReplay
+GFXINC +=   $(DEMODIR)
+GFXSRC +=	$(DEMODIR)/main.c
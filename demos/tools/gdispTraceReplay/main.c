@@ -0,0 +1,592 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * Replay a trace recorded with gdispTraceStart() onto a display and report the time taken by
+ * each type of low level driver call.
+ *
+ * The calls are made directly to the low level driver of the display (or of a pixmap with -p)
+ * so the times are for the driver alone. Calls the driver doesn't support are made with the
+ * equivalent high level GDISP call instead, just as GDISP itself would have to.
+ */
+
+#include "gfx.h"
+#include "src/gdisp/gdisp_driver.h"
+
+// This definition is only required for for O/S's that don't support a command line eg ChibiOS
+// It is ignored by those that do support a command line.
+#ifndef TRACE_FILE
+	#define TRACE_FILE		"trace.bin"
+#endif
+
+// Which operating systems support a command line
+#if defined(WIN32) || GFX_USE_OS_WIN32 || GFX_USE_OS_OSX || GFX_USE_OS_LINUX
+	#define EMBEDED_OS	GFXOFF
+#else
+	#define EMBEDED_OS	GFXON
+#endif
+
+// The trace file format. gdisp.h only includes this when tracing is turned on.
+#include "src/gdisp/gdisp_trace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if GFX_USE_OS_LINUX || GFX_USE_OS_OSX
+	#include <sys/time.h>
+#endif
+
+/**
+ * The low level driver calls each display can make.
+ * Anything the driver doesn't have is made into a call that does nothing and is never used.
+ */
+#if !GDISP_HARDWARE_FLUSH
+	#define HAS_FLUSH(g)				gFalse
+	#undef gdisp_lld_flush
+	#define gdisp_lld_flush(g)
+#elif GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
+	#define HAS_FLUSH(g)				(gvmt(g)->flush != 0)
+#else
+	#define HAS_FLUSH(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_STREAM_WRITE
+	#define HAS_STREAM_WRITE(g)			gFalse
+	#undef gdisp_lld_write_start
+	#define gdisp_lld_write_start(g)
+	#undef gdisp_lld_write_color
+	#define gdisp_lld_write_color(g)
+	#undef gdisp_lld_write_stop
+	#define gdisp_lld_write_stop(g)
+#elif GDISP_HARDWARE_STREAM_WRITE == HARDWARE_AUTODETECT
+	#define HAS_STREAM_WRITE(g)			(gvmt(g)->writestart != 0)
+#else
+	#define HAS_STREAM_WRITE(g)			gTrue
+#endif
+#if !GDISP_HARDWARE_STREAM_WRITE || !GDISP_HARDWARE_STREAM_POS
+	#define HAS_STREAM_POS(g)			gFalse
+	#undef gdisp_lld_write_pos
+	#define gdisp_lld_write_pos(g)
+#elif GDISP_HARDWARE_STREAM_POS == HARDWARE_AUTODETECT
+	#define HAS_STREAM_POS(g)			(gvmt(g)->writepos != 0)
+#else
+	#define HAS_STREAM_POS(g)			gTrue
+#endif
+#if !GDISP_HARDWARE_STREAM_READ
+	#define HAS_STREAM_READ(g)			gFalse
+	#undef gdisp_lld_read_start
+	#define gdisp_lld_read_start(g)
+	#undef gdisp_lld_read_color
+	#define gdisp_lld_read_color(g)		0
+	#undef gdisp_lld_read_stop
+	#define gdisp_lld_read_stop(g)
+#elif GDISP_HARDWARE_STREAM_READ == HARDWARE_AUTODETECT
+	#define HAS_STREAM_READ(g)			(gvmt(g)->readstart != 0)
+#else
+	#define HAS_STREAM_READ(g)			gTrue
+#endif
+#if !GDISP_HARDWARE_DRAWPIXEL
+	#define HAS_PIXEL(g)				gFalse
+	#undef gdisp_lld_draw_pixel
+	#define gdisp_lld_draw_pixel(g)
+#elif GDISP_HARDWARE_DRAWPIXEL == HARDWARE_AUTODETECT
+	#define HAS_PIXEL(g)				(gvmt(g)->pixel != 0)
+#else
+	#define HAS_PIXEL(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_CLEARS
+	#define HAS_CLEAR(g)				gFalse
+	#undef gdisp_lld_clear
+	#define gdisp_lld_clear(g)
+#elif GDISP_HARDWARE_CLEARS == HARDWARE_AUTODETECT
+	#define HAS_CLEAR(g)				(gvmt(g)->clear != 0)
+#else
+	#define HAS_CLEAR(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_FILLS
+	#define HAS_FILL(g)					gFalse
+	#undef gdisp_lld_fill_area
+	#define gdisp_lld_fill_area(g)
+#elif GDISP_HARDWARE_FILLS == HARDWARE_AUTODETECT
+	#define HAS_FILL(g)					(gvmt(g)->fill != 0)
+#else
+	#define HAS_FILL(g)					gTrue
+#endif
+#if !GDISP_HARDWARE_BITFILLS
+	#define HAS_BLIT(g)					gFalse
+	#undef gdisp_lld_blit_area
+	#define gdisp_lld_blit_area(g)
+#elif GDISP_HARDWARE_BITFILLS == HARDWARE_AUTODETECT
+	#define HAS_BLIT(g)					(gvmt(g)->blit != 0)
+#else
+	#define HAS_BLIT(g)					gTrue
+#endif
+#if !GDISP_HARDWARE_PIXELREAD
+	#define HAS_GET(g)					gFalse
+	#undef gdisp_lld_get_pixel_color
+	#define gdisp_lld_get_pixel_color(g)	0
+#elif GDISP_HARDWARE_PIXELREAD == HARDWARE_AUTODETECT
+	#define HAS_GET(g)					(gvmt(g)->get != 0)
+#else
+	#define HAS_GET(g)					gTrue
+#endif
+#if !GDISP_HARDWARE_SCROLL || !GDISP_NEED_SCROLL
+	#define HAS_SCROLL(g)				gFalse
+	#undef gdisp_lld_vertical_scroll
+	#define gdisp_lld_vertical_scroll(g)
+#elif GDISP_HARDWARE_SCROLL == HARDWARE_AUTODETECT
+	#define HAS_SCROLL(g)				(gvmt(g)->vscroll != 0)
+#else
+	#define HAS_SCROLL(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_CONTROL || !GDISP_NEED_CONTROL
+	#define HAS_CONTROL(g)				gFalse
+	#undef gdisp_lld_control
+	#define gdisp_lld_control(g)
+#elif GDISP_HARDWARE_CONTROL == HARDWARE_AUTODETECT
+	#define HAS_CONTROL(g)				(gvmt(g)->control != 0)
+#else
+	#define HAS_CONTROL(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_QUERY || !GDISP_NEED_QUERY
+	#define HAS_QUERY(g)				gFalse
+	#undef gdisp_lld_query
+	#define gdisp_lld_query(g)			0
+#elif GDISP_HARDWARE_QUERY == HARDWARE_AUTODETECT
+	#define HAS_QUERY(g)				(gvmt(g)->query != 0)
+#else
+	#define HAS_QUERY(g)				gTrue
+#endif
+#if !GDISP_HARDWARE_CLIP || !(GDISP_NEED_CLIP || GDISP_NEED_VALIDATION)
+	#define HAS_CLIP(g)					gFalse
+	#undef gdisp_lld_set_clip
+	#define gdisp_lld_set_clip(g)
+#elif GDISP_HARDWARE_CLIP == HARDWARE_AUTODETECT
+	#define HAS_CLIP(g)					(gvmt(g)->setclip != 0)
+#else
+	#define HAS_CLIP(g)					gTrue
+#endif
+
+#define TRACE_CODES		(GDISP_TRACE_SETCLIP+1)
+
+typedef struct replayStat {
+	gU32			calls;
+	gU32			emulated;			// Calls made with high level GDISP calls
+	gU32			pixels;
+	double			usecs;
+} replayStat;
+
+static const char *const names[TRACE_CODES] = {
+	0,
+	"init", "end", "flush",
+	"writestart", "writepos", "writecolor", "writestop",
+	"readstart", "readcolor", "readstop",
+	"pixel", "clear", "fill", "blit", "get", "scroll",
+	"control", "query", "setclip"
+};
+static replayStat stats[TRACE_CODES];
+
+static GFILE *		tf;
+static gU8			rbuf[512];
+static unsigned		rpos, rlen;
+static gBool		reof;
+static gPixel *		pixbuf;
+static unsigned		pixsize;
+
+/**
+ * Get the current time in microseconds
+ */
+static double usecs(void) {
+	#if GFX_USE_OS_LINUX || GFX_USE_OS_OSX
+		struct timeval	tv;
+
+		gettimeofday(&tv, 0);
+		return tv.tv_sec * 1000000.0 + tv.tv_usec;
+	#else
+		return gfxSystemTicks() * 1000000.0 / gfxMillisecondsToTicks(1000);
+	#endif
+}
+
+static int getbyte(void) {
+	if (rpos >= rlen) {
+		rpos = 0;
+		if (!(rlen = gfileRead(tf, rbuf, sizeof(rbuf)))) {
+			reof = gTrue;
+			return -1;
+		}
+	}
+	return rbuf[rpos++];
+}
+
+static gU32 getnum(void) {
+	gU32		v;
+	unsigned	shift;
+	int			b;
+
+	for(v = 0, shift = 0; (b = getbyte()) >= 0; shift += 7) {
+		v |= (gU32)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			break;
+	}
+	return v;
+}
+
+static gCoord getcoord(void) {
+	gU32	v;
+
+	v = getnum();
+	return (v & 1) ? (gCoord)-(gI32)((v >> 1) + 1) : (gCoord)(v >> 1);
+}
+
+static gColor getcolor(void) {
+	int		r, g, b;
+
+	r = getbyte();
+	g = getbyte();
+	b = getbyte();
+	return RGB2COLOR(r, g, b);
+}
+
+/**
+ * Read n colors into the pixel buffer
+ */
+static gPixel *getcolors(unsigned n) {
+	unsigned	i;
+
+	if (n > pixsize) {
+		if (pixbuf)
+			gfxFree(pixbuf);
+		if (!(pixbuf = gfxAlloc(n * sizeof(gPixel))))
+			gfxHalt("Out of memory");
+		pixsize = n;
+	}
+	for(i = 0; i < n; i++)
+		pixbuf[i] = getcolor();
+	return pixbuf;
+}
+
+/**
+ * Where the next pixel of a stream goes when the stream is emulated
+ */
+typedef struct replayStream {
+	gBool		emulated;
+	gCoord		x0, y0, x1, y1;			// The stream window. x1 and y1 are exclusive.
+	gCoord		x, y;
+} replayStream;
+
+static void streamstart(replayStream *s, GDisplay *g, gBool emulated) {
+	s->emulated = emulated;
+	s->x0 = s->x = g->p.x;
+	s->y0 = s->y = g->p.y;
+	s->x1 = g->p.x + g->p.cx;
+	s->y1 = g->p.y + g->p.cy;
+}
+
+static void streamnext(replayStream *s) {
+	if (++s->x >= s->x1) {
+		s->x = s->x0;
+		if (++s->y >= s->y1)
+			s->y = s->y0;
+	}
+}
+
+/*------------------------------------------------------------------------*
+ * GDISP Trace Replay                                                     *
+ *------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+	GDisplay *		g;
+	const char *	fname;
+	gBool			usepixmap, emulated;
+	replayStream	ws, rs;
+	gU8				hdr[5];
+	gU32			tickspersec, rectime, n, i, w, h;
+	gColor			c;
+	gPixel *		p;
+	double			start, total;
+	int				code;
+
+	// Parse the command line
+	usepixmap = gFalse;
+	fname = TRACE_FILE;
+	#if !EMBEDED_OS
+		for(fname = 0; *++argv;) {
+			if (!strcmp(argv[0], "-p"))
+				usepixmap = gTrue;
+			else if (!fname)
+				fname = argv[0];
+			else
+				fname = 0, argc = 0;
+		}
+		if (!fname || !argc) {
+			fprintf(stderr, "Usage: gdispTraceReplay [-p] tracefile\n\t-p\tReplay onto a pixmap rather than the display\n");
+			exit(1);
+		}
+	#else
+		(void) argc;
+		(void) argv;
+	#endif
+
+	gfxInit();
+
+	// Check the header and the first record describing the traced display
+	if (!(tf = gfileOpen(fname, "rb")))
+		gfxHalt("Can't open the trace file");
+	for(i = 0; i < sizeof(hdr); i++)
+		hdr[i] = getbyte();
+	if (reof || memcmp(hdr, GDISP_TRACE_MAGIC, 4) || hdr[4] != GDISP_TRACE_VERSION)
+		gfxHalt("Not a trace file this replay understands");
+	tickspersec = getnum();
+	if (getbyte() != GDISP_TRACE_INIT)
+		gfxHalt("The trace file has no display description");
+	getnum();
+	w = getnum();
+	h = getnum();
+	for(i = 0; i < 4; i++)
+		getnum();									// orientation, powermode, backlight, contrast
+
+	// Choose the display to replay onto
+	if (usepixmap) {
+		if (!(g = gdispPixmapCreate(w, h)))
+			gfxHalt("Can't create the pixmap");
+	} else {
+		g = GDISP;
+		if ((gU32)g->g.Width != w || (gU32)g->g.Height != h)
+			fprintf(stderr, "Warning: The trace was recorded on a %ux%u display. This display is %ux%u.\n",
+				(unsigned)w, (unsigned)h, (unsigned)g->g.Width, (unsigned)g->g.Height);
+	}
+
+	// Replay each record
+	memset(&ws, 0, sizeof(ws));
+	memset(&rs, 0, sizeof(rs));
+	rectime = 0;
+	total = 0;
+	while((code = getbyte()) >= 0 && code != GDISP_TRACE_END) {
+		if (code >= TRACE_CODES || code == GDISP_TRACE_INIT)
+			gfxHalt("The trace file is corrupt");
+		rectime += getnum();
+		n = 1;
+		p = 0;
+		c = 0;
+
+		// Get the parameters
+		switch(code) {
+		case GDISP_TRACE_WRITESTART:
+		case GDISP_TRACE_READSTART:
+		case GDISP_TRACE_SETCLIP:
+		case GDISP_TRACE_FILL:
+		case GDISP_TRACE_BLIT:
+		case GDISP_TRACE_SCROLL:
+			g->p.x = getcoord();
+			g->p.y = getcoord();
+			g->p.cx = getcoord();
+			g->p.cy = getcoord();
+			n = (gU32)g->p.cx * g->p.cy;
+			break;
+		case GDISP_TRACE_WRITEPOS:
+		case GDISP_TRACE_GET:
+		case GDISP_TRACE_PIXEL:
+			g->p.x = getcoord();
+			g->p.y = getcoord();
+			break;
+		case GDISP_TRACE_WRITECOLOR:
+			n = getbyte();
+			p = getcolors(n);
+			break;
+		case GDISP_TRACE_READCOLOR:
+			n = getbyte();
+			break;
+		case GDISP_TRACE_CONTROL:
+			g->p.x = getnum();
+			g->p.ptr = (void *)(gPtrDiff)getnum();
+			break;
+		case GDISP_TRACE_QUERY:
+			g->p.x = getnum();
+			break;
+		case GDISP_TRACE_CLEAR:
+			n = (gU32)g->g.Width * g->g.Height;
+			break;
+		}
+		switch(code) {
+		case GDISP_TRACE_PIXEL:
+		case GDISP_TRACE_CLEAR:
+		case GDISP_TRACE_FILL:
+			g->p.color = c = getcolor();
+			break;
+		case GDISP_TRACE_BLIT:
+			p = getcolors(n);
+			g->p.x1 = 0;
+			g->p.y1 = 0;
+			g->p.x2 = g->p.cx;
+			g->p.ptr = (void *)p;
+			break;
+		case GDISP_TRACE_SCROLL:
+			g->p.y1 = getcoord();
+			g->p.color = c = getcolor();
+			break;
+		}
+		if (reof)
+			gfxHalt("The trace file is truncated");
+
+		// Make the call
+		start = usecs();
+		switch(code) {
+		case GDISP_TRACE_FLUSH:
+			if (HAS_FLUSH(g))
+				gdisp_lld_flush(g);
+			break;
+		case GDISP_TRACE_WRITESTART:
+			streamstart(&ws, g, !HAS_STREAM_WRITE(g));
+			if (!ws.emulated)
+				gdisp_lld_write_start(g);
+			break;
+		case GDISP_TRACE_WRITEPOS:
+			ws.x = g->p.x;
+			ws.y = g->p.y;
+			if (!ws.emulated) {
+				if (HAS_STREAM_POS(g))
+					gdisp_lld_write_pos(g);
+				else {
+					// Finish the stream with single pixels
+					gdisp_lld_write_stop(g);
+					ws.emulated = gTrue;
+				}
+			}
+			break;
+		case GDISP_TRACE_WRITECOLOR:
+			for(i = 0; i < n; i++) {
+				if (!ws.emulated) {
+					g->p.color = p[i];
+					gdisp_lld_write_color(g);
+				} else {
+					gdispGDrawPixel(g, ws.x, ws.y, p[i]);
+					streamnext(&ws);
+				}
+			}
+			break;
+		case GDISP_TRACE_WRITESTOP:
+			if (!ws.emulated)
+				gdisp_lld_write_stop(g);
+			break;
+		case GDISP_TRACE_READSTART:
+			streamstart(&rs, g, !HAS_STREAM_READ(g));
+			if (!rs.emulated)
+				gdisp_lld_read_start(g);
+			break;
+		case GDISP_TRACE_READCOLOR:
+			for(i = 0; i < n; i++) {
+				if (!rs.emulated)
+					(void)gdisp_lld_read_color(g);
+				else {
+					#if GDISP_NEED_PIXELREAD
+						gdispGGetPixelColor(g, rs.x, rs.y);
+					#endif
+					streamnext(&rs);
+				}
+			}
+			break;
+		case GDISP_TRACE_READSTOP:
+			if (!rs.emulated)
+				gdisp_lld_read_stop(g);
+			break;
+		case GDISP_TRACE_PIXEL:
+			if (HAS_PIXEL(g))
+				gdisp_lld_draw_pixel(g);
+			else
+				gdispGDrawPixel(g, g->p.x, g->p.y, c);
+			break;
+		case GDISP_TRACE_CLEAR:
+			if (HAS_CLEAR(g))
+				gdisp_lld_clear(g);
+			else
+				gdispGClear(g, c);
+			break;
+		case GDISP_TRACE_FILL:
+			if (HAS_FILL(g))
+				gdisp_lld_fill_area(g);
+			else
+				gdispGFillArea(g, g->p.x, g->p.y, g->p.cx, g->p.cy, c);
+			break;
+		case GDISP_TRACE_BLIT:
+			if (HAS_BLIT(g))
+				gdisp_lld_blit_area(g);
+			else
+				gdispGBlitArea(g, g->p.x, g->p.y, g->p.cx, g->p.cy, 0, 0, g->p.cx, p);
+			break;
+		case GDISP_TRACE_GET:
+			if (HAS_GET(g))
+				(void)gdisp_lld_get_pixel_color(g);
+			#if GDISP_NEED_PIXELREAD
+				else
+					gdispGGetPixelColor(g, g->p.x, g->p.y);
+			#endif
+			break;
+		case GDISP_TRACE_SCROLL:
+			if (HAS_SCROLL(g))
+				gdisp_lld_vertical_scroll(g);
+			#if GDISP_NEED_SCROLL
+				else
+					gdispGVerticalScroll(g, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.y1, c);
+			#endif
+			break;
+		case GDISP_TRACE_CONTROL:
+			// Driver specific controls usually pass pointers which can't be replayed
+			if (HAS_CONTROL(g) && g->p.x < GDISP_CONTROL_LLD)
+				gdisp_lld_control(g);
+			break;
+		case GDISP_TRACE_QUERY:
+			if (HAS_QUERY(g))
+				(void)gdisp_lld_query(g);
+			break;
+		case GDISP_TRACE_SETCLIP:
+			if (HAS_CLIP(g))
+				gdisp_lld_set_clip(g);
+			#if GDISP_NEED_CLIP
+				else
+					gdispGSetClip(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+			#endif
+			break;
+		}
+		start = usecs() - start;
+
+		// Account for it
+		stats[code].calls++;
+		stats[code].usecs += start;
+		total += start;
+		switch(code) {
+		case GDISP_TRACE_WRITEPOS:		emulated = ws.emulated;		break;
+		case GDISP_TRACE_WRITECOLOR:	emulated = ws.emulated;		stats[code].pixels += n;	break;
+		case GDISP_TRACE_READCOLOR:		emulated = rs.emulated;		stats[code].pixels += n;	break;
+		case GDISP_TRACE_PIXEL:			emulated = !HAS_PIXEL(g);	stats[code].pixels += n;	break;
+		case GDISP_TRACE_CLEAR:			emulated = !HAS_CLEAR(g);	stats[code].pixels += n;	break;
+		case GDISP_TRACE_FILL:			emulated = !HAS_FILL(g);	stats[code].pixels += n;	break;
+		case GDISP_TRACE_BLIT:			emulated = !HAS_BLIT(g);	stats[code].pixels += n;	break;
+		case GDISP_TRACE_GET:			emulated = !HAS_GET(g);		stats[code].pixels += n;	break;
+		case GDISP_TRACE_SCROLL:		emulated = !HAS_SCROLL(g);	stats[code].pixels += n;	break;
+		case GDISP_TRACE_SETCLIP:		emulated = !HAS_CLIP(g);	break;
+		default:						emulated = gFalse;			break;
+		}
+		if (emulated)
+			stats[code].emulated++;
+	}
+	gfileClose(tf);
+	gdispGFlush(g);
+
+	// Report
+	printf("%-12s %10s %10s %12s %10s %10s\n", "call", "count", "emulated", "pixels", "total ms", "us/call");
+	for(code = 1; code < TRACE_CODES; code++) {
+		if (!stats[code].calls)
+			continue;
+		printf("%-12s %10u %10u %12u %10.3f %10.3f\n", names[code], (unsigned)stats[code].calls, (unsigned)stats[code].emulated,
+			(unsigned)stats[code].pixels, stats[code].usecs / 1000.0, stats[code].usecs / stats[code].calls);
+	}
+	printf("Replayed in %.3f ms. Recorded over %.3f ms.\n", total / 1000.0, tickspersec ? rectime * 1000.0 / tickspersec : 0.0);
+
+	if (usepixmap)
+		gdispPixmapDelete(g);
+	return 0;
+}
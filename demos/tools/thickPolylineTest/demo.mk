@@ -0,0 +1,3 @@
+DEMODIR = $(GFXLIB)/demos/tools/thickPolylineTest
+GFXINC +=   $(DEMODIR)
+GFXSRC +=	$(DEMODIR)/main.c
@@ -0,0 +1,99 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * Check that gdispGDrawThickPolyline() draws the same dot as gdispGDrawThickLine() when
+ * there is nothing to join - a single point or points that are all the same.
+ *
+ * Each shape is drawn into a pixmap and compared with a zero length thick line.
+ * The results are shown on the display and the program returns the number of failures.
+ */
+
+#include "gfx.h"
+
+#define PIXMAP_SIZE		64
+#define DOT_X			30
+#define DOT_Y			30
+#define DOT_WIDTH		6
+
+static GDisplay		*pixmap;
+static gPixel		expected[PIXMAP_SIZE*PIXMAP_SIZE];
+static unsigned		failures;
+static gCoord		texty;
+
+static unsigned countPixels(const gPixel *p) {
+	unsigned	i, cnt;
+
+	for(cnt = i = 0; i < PIXMAP_SIZE*PIXMAP_SIZE; i++) {
+		if (p[i] != GFX_BLACK)
+			cnt++;
+	}
+	return cnt;
+}
+
+static gBool samePixels(const gPixel *a, const gPixel *b) {
+	unsigned	i;
+
+	for(i = 0; i < PIXMAP_SIZE*PIXMAP_SIZE; i++) {
+		if (a[i] != b[i])
+			return gFalse;
+	}
+	return gTrue;
+}
+
+static void report(const char *name, gBool ok) {
+	gFont	font;
+
+	font = gdispOpenFont("UI2");
+	gdispDrawString(0, texty, name, font, GFX_WHITE);
+	gdispDrawString(gdispGetWidth()/2, texty, ok ? "Pass" : "FAIL", font, ok ? GFX_LIME : GFX_RED);
+	texty += gdispGetFontMetric(font, gFontHeight) + 2;
+	gdispCloseFont(font);
+	if (!ok)
+		failures++;
+}
+
+static void checkPolyline(const char *name, const gPoint *pts, unsigned cnt, gBool round) {
+	gPixel		*bits;
+	unsigned	i;
+
+	// The zero length thick line
+	gdispGClear(pixmap, GFX_BLACK);
+	gdispGDrawThickLine(pixmap, DOT_X, DOT_Y, DOT_X, DOT_Y, GFX_WHITE, DOT_WIDTH, round);
+	bits = gdispPixmapGetBits(pixmap);
+	for(i = 0; i < PIXMAP_SIZE*PIXMAP_SIZE; i++)
+		expected[i] = bits[i];
+
+	// The polyline
+	gdispGClear(pixmap, GFX_BLACK);
+	gdispGDrawThickPolyline(pixmap, DOT_X, DOT_Y, pts, cnt, GFX_WHITE, DOT_WIDTH, gLineJoinMiter, round);
+	bits = gdispPixmapGetBits(pixmap);
+
+	report(name, countPixels(expected) > 0 && samePixels(bits, expected));
+}
+
+int main(void) {
+	static const gPoint	one[] = { {0, 0} };
+	static const gPoint	same[] = { {0, 0}, {0, 0}, {0, 0} };
+
+	gfxInit();
+	gdispClear(GFX_BLACK);
+
+	pixmap = gdispPixmapCreate(PIXMAP_SIZE, PIXMAP_SIZE);
+	if (!pixmap)
+		return 1;
+
+	texty = 0;
+	failures = 0;
+	checkPolyline("One point", one, 1, gFalse);
+	checkPolyline("Same points", same, 3, gFalse);
+	checkPolyline("One point (round)", one, 1, gTrue);
+	checkPolyline("Same points (round)", same, 3, gTrue);
+
+	gdispPixmapDelete(pixmap);
+	return (int)failures;
+}
@@ -30,8 +30,20 @@
 	#define EMBEDED_OS	GFXON
 #endif
 
-#if GNETCODE_VERSION != GNETCODE_VERSION_1_0
-	#error "This uGFXnet display only supports protocol V1.0"
+// How many received commands and blit pixels can be waiting to be drawn
+#ifndef RENDER_COMMANDS
+	#define RENDER_COMMANDS		256
+#endif
+#ifndef RENDER_PIXELS
+	#if EMBEDED_OS
+		#define RENDER_PIXELS	8192
+	#else
+		#define RENDER_PIXELS	65536
+	#endif
+#endif
+
+#if GNETCODE_VERSION != GNETCODE_VERSION_2_0
+	#error "This uGFXnet display only supports protocol V1.0 and V2.0"
 #endif
 #if GDISP_PIXELFORMAT != GNETCODE_PIXELFORMAT
 	#error "Oops - The uGFXnet protocol requires a different pixel format. Try defining GDISP_PIXELFORMAT in your gfxconf.h file."
@@ -112,6 +124,42 @@
 #endif
 static SOCKET_TYPE				netfd = (SOCKET_TYPE)-1;
 static gFont					font;
+static gBool					framed;				// The host is sending V2.0 frames
+static char *					frame;				// The current frame
+static unsigned					framelen, framepos, framesize;
+static gU16 *					encbuf;				// An encoded blit
+static unsigned					encsize;
+static gPixel *					blitbuf;			// A decoded blit
+static unsigned					blitsize;
+
+/**
+ * A received command waiting to be drawn.
+ * The pixels of a blit are held in the pixel ring in the same order as the commands.
+ */
+typedef struct renderCmd {
+	gU16		code;
+	gU16		args[5];
+	unsigned	pixpos;				// Where the blit pixels start in the pixel ring
+	unsigned	pixused;			// Pixel ring space freed once drawn (including any skipped at the end of the ring)
+} renderCmd;
+
+#define RENDER_END		GNETCODE_INIT		// Never queued otherwise - the connection has closed
+#define RENDER_BAND		(RENDER_PIXELS/2)	// The most pixels queued as one blit. Bigger blits are queued in bands of rows.
+
+static renderCmd *				cmdring;
+static gPixel *					pixring;
+static unsigned					cmdin, pixin;		// Only used by the receiver
+static unsigned					cmdout;				// Only used by the renderer
+static unsigned					cmdcount, pixcount;	// Protected by ringlock
+static unsigned					flushcount;			// Protected by ringlock
+static gBool					roomwait;			// Protected by ringlock
+static gMutex					ringlock;
+static gSem						readysem;			// Wakes the renderer when the ring is no longer empty
+static gSem						roomsem;			// Wakes the receiver when there is room in the ring
+static gU32						rxcmds;				// Commands received
+#if !EMBEDED_OS
+	static gBool				showstats;
+#endif
 
 #define STRINGOF_RAW(s)		#s
 #define STRINGOF(s)			STRINGOF_RAW(s)
@@ -132,28 +180,79 @@ static gFont					font;
 	#endif
 #endif
 
+/**
+ * Get a block of bytes straight from the connection.
+ * If the connection closes before we get all the data - the call returns gFalse.
+ */
+static gBool getbytes(char *p, unsigned len) {
+	int		got;
+
+	while(len && (got = recv(netfd, p, len, 0)) > 0) {
+		p += got;
+		len -= got;
+	}
+	return len ? gFalse : gTrue;
+}
+
+/**
+ * Make sure a buffer is at least size bytes.
+ */
+static void *growbuf(void *p, unsigned *psize, unsigned size) {
+	if (size <= *psize)
+		return p;
+	if (!(p = p ? gfxRealloc(p, *psize, size) : gfxAlloc(size)))
+		gfxHalt("Oops - Out of memory");
+	*psize = size;
+	return p;
+}
+
+/**
+ * Get the next V2.0 frame from the connection.
+ */
+static gBool getframe(void) {
+	gU16	hdr[2];
+
+	if (!getbytes((char *)hdr, sizeof(hdr)))
+		return gFalse;
+	framelen = ((unsigned)ntohs(hdr[0]) << 16) | ntohs(hdr[1]);
+	frame = growbuf(frame, &framesize, framelen);
+	framepos = 0;
+	return getbytes(frame, framelen);
+}
+
 /**
  * Get a whole packet of data.
  * Len is specified in the number of gU16's we want as our protocol only talks gU16's.
  * If the connection closes before we get all the data - the call returns gFalse.
  */
 static gBool getpkt(gU16 *pkt, int len) {
-	int		got;
-	int		have;
+	char *		p;
+	unsigned	want, n;
+	int			i;
 
 	// Get the packet of data
-	len *= sizeof(gU16);
-	have = 0;
-	while(len && (got = recv(netfd, ((char *)pkt)+have, len, 0)) > 0) {
-		have += got;
-		len -= got;
+	want = len * sizeof(gU16);
+	if (!framed) {
+		if (!getbytes((char *)pkt, want))
+			return gFalse;
+	} else {
+		// The packet may be split across frames
+		for(p = (char *)pkt; want; p += n, want -= n) {
+			while (framepos >= framelen) {
+				if (!getframe())
+					return gFalse;
+			}
+			n = framelen - framepos;
+			if (n > want)
+				n = want;
+			memcpy(p, frame+framepos, n);
+			framepos += n;
+		}
 	}
-	if (len)
-		return gFalse;
 
 	// Convert each gU16 to host order
-	for(got = 0, have /= 2; got < have; got++)
-		pkt[got] = ntohs(pkt[got]);
+	for(i = 0; i < len; i++)
+		pkt[i] = ntohs(pkt[i]);
 
 	return gTrue;
 }
@@ -176,6 +275,61 @@ static gBool sendpkt(gU16 *pkt, int len) {
 	return send(netfd, (const char *)pkt, len, 0) == len;
 }
 
+/**
+ * Decode an encoded blit of n pixels into out.
+ * Returns gFalse if the data is not valid.
+ */
+static gBool decodeblit(gU16 encoding, const gU16 *enc, unsigned len, gPixel *out, unsigned n) {
+	const gU16 *	pal;
+	unsigned		i, j, cnt, dist, bits, ncol, idx;
+
+	switch(encoding) {
+	case GNETCODE_ENC_RLE:
+		for(i = j = 0; i + 1 < len; i += 2) {
+			if ((cnt = enc[i]) > n - j)
+				return gFalse;
+			for(; cnt; cnt--)
+				out[j++] = enc[i+1];
+		}
+		return j == n;
+
+	case GNETCODE_ENC_PALETTE:
+		ncol = enc[0];
+		if (!len || !ncol || ncol > 256 || len < 1 + ncol)
+			return gFalse;
+		bits = ncol <= 2 ? 1 : (ncol <= 4 ? 2 : (ncol <= 16 ? 4 : 8));
+		if (len - 1 - ncol < (n * bits + 15) / 16)
+			return gFalse;
+		pal = enc + 1;
+		for(enc = pal + ncol, j = 0; j < n; j++) {
+			idx = (enc[(j*bits)/16] >> (16 - bits - (j*bits)%16)) & ((1 << bits) - 1);
+			if (idx >= ncol)
+				return gFalse;
+			out[j] = pal[idx];
+		}
+		return gTrue;
+
+	case GNETCODE_ENC_LZ:
+		for(i = j = 0; i < len;) {
+			cnt = enc[i++];
+			if ((cnt & 0x8000)) {
+				cnt &= 0x7FFF;
+				if (i >= len || !(dist = enc[i++]) || dist > j || cnt > n - j)
+					return gFalse;
+				for(; cnt; cnt--, j++)
+					out[j] = out[j - dist];
+			} else {
+				if (cnt > len - i || cnt > n - j)
+					return gFalse;
+				for(; cnt; cnt--)
+					out[j++] = enc[i++];
+			}
+		}
+		return j == n;
+	}
+	return gFalse;
+}
+
 #if GFX_USE_GINPUT && GINPUT_NEED_MOUSE
 	/**
 	 * We use a separate thread to capture mouse events and send them down the pipe.
@@ -233,6 +387,235 @@ static gBool sendpkt(gU16 *pkt, int len) {
 	}
 #endif
 
+/**
+ * Wait for room in the ring for another command with n blit pixels.
+ * Returns the command to fill in. Pass it to putcmd() once it is filled in.
+ */
+static renderCmd *getroom(unsigned n) {
+	renderCmd *	c;
+	unsigned	skip;
+
+	// The pixels of a blit must not wrap around the end of the ring
+	skip = pixin + n > RENDER_PIXELS ? RENDER_PIXELS - pixin : 0;
+	gfxMutexEnter(&ringlock);
+	while(cmdcount >= RENDER_COMMANDS || pixcount + skip + n > RENDER_PIXELS) {
+		roomwait = gTrue;
+		gfxMutexExit(&ringlock);
+		gfxSemWait(&roomsem, gDelayForever);
+		gfxMutexEnter(&ringlock);
+	}
+	gfxMutexExit(&ringlock);
+
+	c = cmdring + cmdin;
+	c->pixpos = (pixin + skip) % RENDER_PIXELS;
+	c->pixused = skip + n;
+	pixin = (c->pixpos + n) % RENDER_PIXELS;
+	return c;
+}
+
+/**
+ * Hand a command filled in after getroom() to the renderer
+ */
+static void putcmd(renderCmd *c) {
+	gBool	wake;
+
+	cmdin = (cmdin + 1) % RENDER_COMMANDS;
+	gfxMutexEnter(&ringlock);
+	wake = !cmdcount;
+	cmdcount++;
+	pixcount += c->pixused;
+	if (c->code == GNETCODE_FLUSH)
+		flushcount++;
+	gfxMutexExit(&ringlock);
+	if (wake)
+		gfxSemSignal(&readysem);
+}
+
+/**
+ * Queue a blit from a buffer, in bands of rows if it is too big for the pixel ring
+ */
+static void putblit(gU16 x, gU16 y, gU16 cx, gU16 cy, const gPixel *buffer) {
+	renderCmd *	c;
+	gU16		rows;
+
+	for(rows = RENDER_BAND / cx; cy; y += rows, cy -= rows, buffer += (unsigned)rows * cx) {
+		if (rows > cy)
+			rows = cy;
+		c = getroom((unsigned)rows * cx);
+		c->code = GNETCODE_BLIT;
+		c->args[0] = x;
+		c->args[1] = y;
+		c->args[2] = cx;
+		c->args[3] = rows;
+		memcpy(pixring + c->pixpos, buffer, (unsigned)rows * cx * sizeof(gPixel));
+		putcmd(c);
+	}
+}
+
+/**
+ * Free drawn commands and their pixels
+ */
+static void freecmds(unsigned n, unsigned pixels) {
+	gBool	wake;
+
+	cmdout = (cmdout + n) % RENDER_COMMANDS;
+	gfxMutexEnter(&ringlock);
+	cmdcount -= n;
+	pixcount -= pixels;
+	wake = roomwait;
+	roomwait = gFalse;
+	gfxMutexExit(&ringlock);
+	if (wake)
+		gfxSemSignal(&roomsem);
+}
+
+/**
+ * Draw what the receiver has queued.
+ * Runs of fills or blits that together make one rectangle are drawn with a single call
+ * and a flush is skipped if another is already queued behind it.
+ */
+static GFX_THREAD_STACK(waRenderThread, 1024);
+static GFX_THREAD_FUNCTION(RenderThread, param) {
+	renderCmd *	c;
+	renderCmd *	n;
+	gU16		cmd[2];
+	unsigned	avail, used, pixels;
+	gU16		x, y, cx, cy;
+	gU32		draws, frames;
+	gBool		drawn, later;
+	#if !EMBEDED_OS
+		gTicks		statstime;
+		gU32		lastdraws, lastframes, lastrx;
+	#endif
+	(void)		param;
+
+	draws = frames = 0;
+	drawn = gFalse;
+	#if !EMBEDED_OS
+		statstime = gfxSystemTicks();
+		lastdraws = lastframes = lastrx = 0;
+	#endif
+
+	for(;;) {
+		gfxMutexEnter(&ringlock);
+		avail = cmdcount;
+		gfxMutexExit(&ringlock);
+
+		// An empty ring finishes a frame
+		if (!avail) {
+			if (drawn) {
+				frames++;
+				drawn = gFalse;
+			}
+			#if !EMBEDED_OS
+				if (showstats && gfxSystemTicks() - statstime >= gfxMillisecondsToTicks(1000)) {
+					fprintf(stderr, "%u fps, %u commands/s, %u draws/s\n", (unsigned)(frames - lastframes), (unsigned)(rxcmds - lastrx), (unsigned)(draws - lastdraws));
+					lastframes = frames;
+					lastrx = rxcmds;
+					lastdraws = draws;
+					statstime = gfxSystemTicks();
+				}
+			#endif
+			gfxSemWait(&readysem, gDelayForever);
+			continue;
+		}
+
+		c = cmdring + cmdout;
+		used = 1;
+		pixels = c->pixused;
+		x = c->args[0];
+		y = c->args[1];
+		cx = c->args[2];
+		cy = c->args[3];
+		switch(c->code) {
+		case RENDER_END:
+			freecmds(used, pixels);
+			return 0;
+		case GNETCODE_FLUSH:
+			gfxMutexEnter(&ringlock);
+			later = --flushcount != 0;
+			gfxMutexExit(&ringlock);
+			if (!later) {
+				gdispFlush();
+				if (drawn) {
+					frames++;
+					drawn = gFalse;
+				}
+			}
+			break;
+		case GNETCODE_FILL:
+			// Grow the area down or across while the next fill continues it
+			for(; used < avail; used++) {
+				n = cmdring + (cmdout + used) % RENDER_COMMANDS;
+				if (n->code != GNETCODE_FILL || n->args[4] != c->args[4])
+					break;
+				if (n->args[0] == x && n->args[2] == cx && n->args[1] == (gU16)(y + cy))
+					cy += n->args[3];
+				else if (n->args[1] == y && n->args[3] == cy && n->args[0] == (gU16)(x + cx))
+					cx += n->args[2];
+				else
+					break;
+			}
+			if (cx == 1 && cy == 1)
+				gdispDrawPixel(x, y, c->args[4]);
+			else
+				gdispFillArea(x, y, cx, cy, c->args[4]);
+			draws++;
+			drawn = gTrue;
+			break;
+		case GNETCODE_BLIT:
+			// Grow the area down while the next blit continues it and its pixels follow on in the ring
+			for(; used < avail; used++) {
+				n = cmdring + (cmdout + used) % RENDER_COMMANDS;
+				if (n->code != GNETCODE_BLIT || n->args[0] != x || n->args[2] != cx || n->args[1] != (gU16)(y + cy)
+						|| n->pixpos != c->pixpos + (unsigned)cx * cy)
+					break;
+				cy += n->args[3];
+				pixels += n->pixused;
+			}
+			gdispBlitArea(x, y, cx, cy, pixring + c->pixpos);
+			draws++;
+			drawn = gTrue;
+			break;
+		#if GDISP_NEED_PIXELREAD
+			case GNETCODE_READ:
+				cmd[0] = GNETCODE_READ;
+				cmd[1] = gdispGetPixelColor(x, y);
+				sendpkt(cmd, 2);
+				break;
+		#endif
+		#if GDISP_NEED_SCROLL
+			case GNETCODE_SCROLL:
+				gdispVerticalScroll(x, y, cx, cy, (gI16)c->args[4], GFX_BLACK);
+				draws++;
+				drawn = gTrue;
+				break;
+		#endif
+		case GNETCODE_CONTROL:
+			gdispControl(x, (void *)(unsigned)y);
+			switch(x) {
+			case GDISP_CONTROL_ORIENTATION:
+				cmd[1] = (gU16)gdispGetOrientation() == y ? 1 : 0;
+				break;
+			case GDISP_CONTROL_POWER:
+				cmd[1] = (gU16)gdispGetPowerMode() == y ? 1 : 0;
+				break;
+			case GDISP_CONTROL_BACKLIGHT:
+				cmd[1] = (gU16)gdispGetBacklight() == y ? 1 : 0;
+				break;
+			default:
+				cmd[1] = 0;
+				break;
+			}
+			cmd[0] = GNETCODE_CONTROL;
+			sendpkt(cmd, 2);
+			break;
+		}
+		freecmds(used, pixels);
+	}
+	return 0;
+}
+
 /**
  * Do the connection to the remote host.
  * We have two prototypes here - one for embedded systems and one for systems with a command line.
@@ -248,7 +631,9 @@ static SOCKET_TYPE doConnect(proto_args) {
 		xhost = 0;
 		xport = 0;
 		while (*++argv) {
-			if (!xhost)
+			if (!strcmp(argv[0], "-s"))
+				showstats = gTrue;
+			else if (!xhost)
 				xhost = argv[0];
 			else if (!xport) {
 				xport = argv[0];
@@ -269,7 +654,7 @@ static SOCKET_TYPE doConnect(proto_args) {
 			xport = STRINGOF(GDISP_GFXNET_PORT);
 		if (!xhost) {
 		usage:
-			fprintf(stderr, "Usage: uGFXnetDisplay host [port]\n");
+			fprintf(stderr, "Usage: uGFXnetDisplay [-s] host [port]\n\t-s\tPrint frames, commands and draws per second\n");
 			exit(1);
 		}
 	#endif
@@ -325,10 +710,16 @@ static SOCKET_TYPE doConnect(proto_args) {
 /**
  * Our main function.
  * There are two prototypes - one for systems with a command line and one for embedded systems without one.
+ * Once connected this thread receives and decodes commands and a render thread draws them.
  */
 int main(proto_args) {
-	gU16			cmd[5];
-	unsigned			cnt;
+	gU16			cmd[6];
+	unsigned			cnt, rows;
+	renderCmd *			c;
+	gThread				hRender;
+	gBool				rendering;
+
+	rendering = gFalse;
 
 
 	// Initialize and clear the display
@@ -345,7 +736,7 @@ int main(proto_args) {
 
 	// Get the initial packet from the host
 	if (!getpkt(cmd, 2)) goto alldone;
-	if (cmd[0] != GNETCODE_INIT || cmd[1] != GNETCODE_VERSION)
+	if (cmd[0] != GNETCODE_INIT || cmd[1] != GNETCODE_VERSION_1_0)
 		gfxHalt("Oops - The protocol doesn't look like one we understand");
 
 	// Get the rest of the initial arguments
@@ -355,68 +746,134 @@ int main(proto_args) {
 	if (cmd[2] != GDISP_PIXELFORMAT)
 		gfxHalt("Oops - The remote display is using a different pixel format to us.\nTry defining GDISP_PIXELFORMAT in your gfxconf.h file.");
 
+	// Ask for protocol V2.0 and tell the host which blit encodings we can decode.
+	//	The host tells us where in the command stream it switches. An older host just ignores this.
+	{
+		gU16	req[4];
+
+		req[0] = GNETCODE_INIT;
+		req[1] = GNETCODE_VERSION_2_0;
+		req[2] = GNETCODE_ENCODINGS;
+		req[3] = GNETCODE_ENC_RLE|GNETCODE_ENC_PALETTE|GNETCODE_ENC_LZ;
+		if (!sendpkt(req, 4)) goto alldone;
+	}
+
 	#if GFX_USE_GINPUT && GINPUT_NEED_MOUSE
 		// Start the mouse thread if needed
 		if (cmd[3])
 			gfxThreadClose(gfxThreadCreate(waNetThread, sizeof(waNetThread), gThreadpriorityHigh, NetThread, 0));
 	#endif
 
-	// Process incoming instructions
+	// Start the render thread
+	if (!(cmdring = gfxAlloc(RENDER_COMMANDS * sizeof(renderCmd))) || !(pixring = gfxAlloc(RENDER_PIXELS * sizeof(gPixel))))
+		gfxHalt("Oops - Out of memory");
+	gfxMutexInit(&ringlock);
+	gfxSemInit(&readysem, 0, 1);
+	gfxSemInit(&roomsem, 0, 1);
+	hRender = gfxThreadCreate(waRenderThread, sizeof(waRenderThread), gThreadpriorityNormal, RenderThread, 0);
+	rendering = gTrue;
+
+	// Queue incoming instructions for the render thread
 	while(getpkt(cmd, 1)) {
+		rxcmds++;
 		switch(cmd[0]) {
+		case GNETCODE_INIT:
+			if (!getpkt(cmd, 1)) goto alldone;				// cmd[] = version
+			if (cmd[0] != GNETCODE_VERSION_2_0)
+				gfxHalt("Oops - The host switched to a protocol version we don't understand");
+			framed = gTrue;
+			break;
 		case GNETCODE_FLUSH:
-			gdispFlush();
+			c = getroom(0);
+			c->code = GNETCODE_FLUSH;
+			putcmd(c);
 			break;
 		case GNETCODE_PIXEL:
 			if (!getpkt(cmd, 3)) goto alldone;				// cmd[] = x, y, color
-			gdispDrawPixel(cmd[0], cmd[1], cmd[2]);
+			// Queued as a fill so runs of pixels can be drawn together
+			c = getroom(0);
+			c->code = GNETCODE_FILL;
+			c->args[0] = cmd[0];
+			c->args[1] = cmd[1];
+			c->args[2] = 1;
+			c->args[3] = 1;
+			c->args[4] = cmd[2];
+			putcmd(c);
 			break;
 		case GNETCODE_FILL:
-			if (!getpkt(cmd, 5)) goto alldone;				// cmd[] = x, y, cx, cy, color
-			gdispFillArea(cmd[0], cmd[1], cmd[2], cmd[3], cmd[4]);
+			c = getroom(0);
+			if (!getpkt(c->args, 5)) goto alldone;			// args[] = x, y, cx, cy, color
+			c->code = GNETCODE_FILL;
+			putcmd(c);
 			break;
 		case GNETCODE_BLIT:
 			if (!getpkt(cmd, 4)) goto alldone;				// cmd[] = x, y, cx, cy		- Followed by cx * cy pixels
-			gdispStreamStart(cmd[0],cmd[1],cmd[2],cmd[3]);
-			for(cnt = (unsigned)cmd[2] * cmd[3]; cnt; cnt--) {
-				if (!getpkt(cmd, 1)) goto alldone;
-				gdispStreamColor(cmd[0]);
+			if (!cmd[2])
+				break;
+			if (cmd[2] > RENDER_BAND)
+				gfxHalt("Oops - The host has sent a blit wider than RENDER_PIXELS/2");
+			// Read the pixels straight into the pixel ring
+			for(rows = RENDER_BAND / cmd[2]; cmd[3]; cmd[1] += rows, cmd[3] -= rows) {
+				if (rows > cmd[3])
+					rows = cmd[3];
+				c = getroom(rows * cmd[2]);
+				if (!getpkt((gU16 *)(pixring + c->pixpos), rows * cmd[2])) goto alldone;
+				c->code = GNETCODE_BLIT;
+				c->args[0] = cmd[0];
+				c->args[1] = cmd[1];
+				c->args[2] = cmd[2];
+				c->args[3] = rows;
+				putcmd(c);
+			}
+			break;
+		case GNETCODE_BLITENC:
+			if (!getpkt(cmd, 6)) goto alldone;				// cmd[] = x, y, cx, cy, encoding, length	- Followed by length words of data
+			encbuf = growbuf(encbuf, &encsize, cmd[5] * sizeof(gU16));
+			if (!getpkt(encbuf, cmd[5])) goto alldone;
+			cnt = (unsigned)cmd[2] * cmd[3];
+			if (!cnt)
+				break;
+			if (cnt <= RENDER_BAND) {
+				// Decode straight into the pixel ring
+				c = getroom(cnt);
+				if (!decodeblit(cmd[4], encbuf, cmd[5], pixring + c->pixpos, cnt))
+					gfxHalt("Oops - The host has sent an invalid encoded blit");
+				c->code = GNETCODE_BLIT;
+				c->args[0] = cmd[0];
+				c->args[1] = cmd[1];
+				c->args[2] = cmd[2];
+				c->args[3] = cmd[3];
+				putcmd(c);
+			} else {
+				if (cmd[2] > RENDER_BAND)
+					gfxHalt("Oops - The host has sent a blit wider than RENDER_PIXELS/2");
+				blitbuf = growbuf(blitbuf, &blitsize, cnt * sizeof(gPixel));
+				if (!decodeblit(cmd[4], encbuf, cmd[5], blitbuf, cnt))
+					gfxHalt("Oops - The host has sent an invalid encoded blit");
+				putblit(cmd[0], cmd[1], cmd[2], cmd[3], blitbuf);
 			}
-			gdispStreamStop();
 			break;
 		#if GDISP_NEED_PIXELREAD
 			case GNETCODE_READ:
-				if (!getpkt(cmd, 2)) goto alldone;				// cmd[] = x, y				- Response is GNETCODE_READ,color
-				cmd[1] = gdispGetPixelColor(cmd[0], cmd[1]);
-				cmd[0] = GNETCODE_READ;
-				if (!sendpkt(cmd, 2)) goto alldone;
+				c = getroom(0);
+				if (!getpkt(c->args, 2)) goto alldone;			// args[] = x, y			- Response is GNETCODE_READ,color
+				c->code = GNETCODE_READ;
+				putcmd(c);
 				break;
 		#endif
 		#if GDISP_NEED_SCROLL
 			case GNETCODE_SCROLL:
-				if (!getpkt(cmd, 5)) goto alldone;				// cmd[] = x, y, cx, cy, lines
-				gdispVerticalScroll(cmd[0], cmd[1], cmd[2], cmd[3], cmd[4], GFX_BLACK);
+				c = getroom(0);
+				if (!getpkt(c->args, 5)) goto alldone;			// args[] = x, y, cx, cy, lines
+				c->code = GNETCODE_SCROLL;
+				putcmd(c);
 				break;
 		#endif
 		case GNETCODE_CONTROL:
-			if (!getpkt(cmd, 2)) goto alldone;				// cmd[] = what,data		- Response is GNETCODE_CONTROL, 0x0000 (fail) or GNETCODE_CONTROL, 0x0001 (success)
-			gdispControl(cmd[0], (void *)(unsigned)cmd[1]);
-			switch(cmd[0]) {
-			case GDISP_CONTROL_ORIENTATION:
-				cmd[1] = (gU16)gdispGetOrientation() == cmd[1] ? 1 : 0;
-				break;
-			case GDISP_CONTROL_POWER:
-				cmd[1] = (gU16)gdispGetPowerMode() == cmd[1] ? 1 : 0;
-				break;
-			case GDISP_CONTROL_BACKLIGHT:
-				cmd[1] = (gU16)gdispGetBacklight() == cmd[1] ? 1 : 0;
-				break;
-			default:
-				cmd[1] = 0;
-				break;
-			}
-			cmd[0] = GNETCODE_CONTROL;
-			if (!sendpkt(cmd, 2)) goto alldone;
+			c = getroom(0);
+			if (!getpkt(c->args, 2)) goto alldone;			// args[] = what,data		- Response is GNETCODE_CONTROL, 0x0000 (fail) or GNETCODE_CONTROL, 0x0001 (success)
+			c->code = GNETCODE_CONTROL;
+			putcmd(c);
 			break;
 		default:
 			gfxHalt("Oops - The host has sent invalid commands");
@@ -425,6 +882,13 @@ int main(proto_args) {
 	}
 
 alldone:
+	// Let the render thread draw everything that was received
+	if (rendering) {
+		c = getroom(0);
+		c->code = RENDER_END;
+		putcmd(c);
+		gfxThreadWait(hRender);
+	}
 	closesocket(netfd);
 	gfxHalt("Connection closed");
 	return 0;
@@ -57,4 +57,39 @@ static GFXINLINE gU16 read_data(GDisplay *g) {
 	return 0;
 }
 
+// Optional - Define any of these if your board can send pixels faster than one write_data() call
+// each (eg. using DMA). Any that aren't defined are done by the driver with write_data().
+
+// Send the same pixel count times. The board must take its own copy of the pixel
+// if the transfer is still running when this returns.
+//#define write_data_repeat(g, data, count)				board_write_repeat(g, data, count)
+static GFXINLINE void board_write_repeat(GDisplay *g, gU16 data, gU32 count) {
+	(void) g;
+	(void) data;
+	(void) count;
+}
+
+// Send count pixels from a buffer. The buffer must have been sent when this returns.
+// Blits from a buffer in the controller's pixel format are passed straight to this.
+//#define write_data_buffer(g, buffer, count)			board_write_buffer(g, buffer, count)
+static GFXINLINE void board_write_buffer(GDisplay *g, const gU16 *buffer, gU32 count) {
+	(void) g;
+	(void) buffer;
+	(void) count;
+}
+
+// Start sending count pixels from a buffer and return without waiting. The driver calls write_data_wait()
+// before it touches the buffer again. Anything else that uses the bus must also wait for the transfer.
+// If GDISP_NO_DMA_FROM_STACK is GFXON the driver only passes buffers that are not on the stack.
+//#define write_data_buffer_async(g, buffer, count)		board_write_buffer_async(g, buffer, count)
+//#define write_data_wait(g)							board_write_wait(g)
+static GFXINLINE void board_write_buffer_async(GDisplay *g, const gU16 *buffer, gU32 count) {
+	(void) g;
+	(void) buffer;
+	(void) count;
+}
+static GFXINLINE void board_write_wait(GDisplay *g) {
+	(void) g;
+}
+
 #endif /* GDISP_LLD_BOARD_H */
@@ -17,6 +17,8 @@
 #define GDISP_HARDWARE_STREAM_WRITE		GFXON
 //#define GDISP_HARDWARE_STREAM_READ		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
+#define GDISP_HARDWARE_FILLS			GFXON
+#define GDISP_HARDWARE_BITFILLS			GFXON
 
 #define GDISP_LLD_PIXELFORMAT			GDISP_PIXELFORMAT_RGB565
 
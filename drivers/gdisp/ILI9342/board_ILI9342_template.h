@@ -0,0 +1,101 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+static GFXINLINE void init_board(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void post_init_board(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void setpin_reset(GDisplay *g, gBool state) {
+	(void) g;
+	(void) state;
+}
+
+static GFXINLINE void set_backlight(GDisplay *g, gU8 percent) {
+	(void) g;
+	(void) percent;
+}
+
+static GFXINLINE void acquire_bus(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void release_bus(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void write_index(GDisplay *g, gU16 index) {
+	(void) g;
+	(void) index;
+}
+
+static GFXINLINE void write_data(GDisplay *g, gU16 data) {
+	(void) g;
+	(void) data;
+}
+
+// Send one pixel. The driver sends each RGB565 pixel with this.
+static GFXINLINE void write_pixel(GDisplay *g, gU16 data) {
+	(void) g;
+	(void) data;
+}
+
+static GFXINLINE void setreadmode(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE void setwritemode(GDisplay *g) {
+	(void) g;
+}
+
+static GFXINLINE gU16 read_data(GDisplay *g) {
+	(void) g;
+	return 0;
+}
+
+// Optional - Define any of these if your board can send pixels faster than one write_pixel() call
+// each (eg. using DMA or a 16 bit SPI transfer). Each pixel is sent high byte first.
+// Any that aren't defined are done by the driver with write_pixel().
+
+// Send the same pixel count times. The board must take its own copy of the pixel
+// if the transfer is still running when this returns.
+//#define write_data_repeat(g, data, count)				board_write_repeat(g, data, count)
+static GFXINLINE void board_write_repeat(GDisplay *g, gU16 data, gU32 count) {
+	(void) g;
+	(void) data;
+	(void) count;
+}
+
+// Send count pixels from a buffer. The buffer must have been sent when this returns.
+//#define write_data_buffer(g, buffer, count)			board_write_buffer(g, buffer, count)
+static GFXINLINE void board_write_buffer(GDisplay *g, const gU16 *buffer, gU32 count) {
+	(void) g;
+	(void) buffer;
+	(void) count;
+}
+
+// Start sending count pixels from a buffer and return without waiting. The driver calls write_data_wait()
+// before it touches the buffer again. Anything else that uses the bus must also wait for the transfer.
+// If GDISP_NO_DMA_FROM_STACK is GFXON the driver only passes buffers that are not on the stack.
+//#define write_data_buffer_async(g, buffer, count)		board_write_buffer_async(g, buffer, count)
+//#define write_data_wait(g)							board_write_wait(g)
+static GFXINLINE void board_write_buffer_async(GDisplay *g, const gU16 *buffer, gU32 count) {
+	(void) g;
+	(void) buffer;
+	(void) count;
+}
+static GFXINLINE void board_write_wait(GDisplay *g) {
+	(void) g;
+}
+
+#endif /* _GDISP_LLD_BOARD_H */
@@ -0,0 +1,2 @@
+GFXINC += $(GFXLIB)/drivers/gdisp/ILI9342
+GFXSRC += $(GFXLIB)/drivers/gdisp/ILI9342/gdisp_lld_ILI9342.c
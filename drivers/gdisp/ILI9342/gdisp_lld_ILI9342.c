@@ -41,6 +41,12 @@
 #ifndef GDISP_INITIAL_BACKLIGHT
 	#define GDISP_INITIAL_BACKLIGHT	100
 #endif
+#ifndef GDISP_NO_DMA_FROM_STACK
+	#define GDISP_NO_DMA_FROM_STACK	GFXOFF
+#endif
+#ifndef ILI9342_BURST_PIXELS
+	#define ILI9342_BURST_PIXELS	64		// The size of each half of the buffer used to convert blits
+#endif
 
 #include "drivers/gdisp/ILI9342/ILI9342.h"
 
@@ -52,6 +58,18 @@
 #define dummy_read(g)				{ volatile gU16 dummy; dummy = read_data(g); (void) dummy; }
 #define write_reg(g, reg, data)		{ write_index(g, reg); write_data(g, data); }
 
+// Bursts of pixels. A board can define any of these to send pixels faster than one write_pixel() at a time.
+#ifndef write_data_repeat
+	#define write_data_repeat(g, data, count)			{ gU32 i; for(i = 0; i < (gU32)(count); i++) write_pixel(g, (data)); }
+#endif
+#ifndef write_data_buffer
+	#define write_data_buffer(g, buffer, count)			{ gU32 i; for(i = 0; i < (gU32)(count); i++) write_pixel(g, (buffer)[i]); }
+#endif
+#ifndef write_data_buffer_async
+	#define write_data_buffer_async(g, buffer, count)	write_data_buffer(g, buffer, count)
+	#define write_data_wait(g)
+#endif
+
 static void set_viewport(GDisplay *g) {
 	write_index(g, 0x2A);
 	write_data(g, (g->p.x >> 8));
@@ -252,6 +270,66 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	}
 #endif
 
+#if GDISP_HARDWARE_FILLS
+	LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
+		LLDCOLOR_TYPE	c;
+
+		c = gdispColor2Native(g->p.color);
+		acquire_bus(g);
+		set_viewport(g);
+		write_index(g, 0x2C);
+		write_data_repeat(g, c, (gU32)g->p.cx * g->p.cy);
+		release_bus(g);
+	}
+#endif
+
+#if GDISP_HARDWARE_BITFILLS
+	LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+		const gPixel	*buffer;
+		gCoord			y;
+
+		buffer = (const gPixel *)g->p.ptr + g->p.x1 + g->p.y1 * g->p.x2;
+		acquire_bus(g);
+		set_viewport(g);
+		write_index(g, 0x2C);
+		#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+			if (g->p.x2 == g->p.cx) {
+				write_data_buffer(g, buffer, (gU32)g->p.cx * g->p.cy);
+			} else {
+				for(y = 0; y < g->p.cy; y++, buffer += g->p.x2)
+					write_data_buffer(g, buffer, g->p.cx);
+			}
+		#else
+			{
+				#if GDISP_NO_DMA_FROM_STACK
+					static LLDCOLOR_TYPE	lbuf[2][ILI9342_BURST_PIXELS];
+				#else
+					LLDCOLOR_TYPE			lbuf[2][ILI9342_BURST_PIXELS];
+				#endif
+				gCoord		x;
+				unsigned	half, n;
+
+				// Convert into one half of the buffer while the board sends the other half
+				for(half = n = 0, y = 0; y < g->p.cy; y++, buffer += g->p.x2) {
+					for(x = 0; x < g->p.cx; x++) {
+						lbuf[half][n++] = gdispColor2Native(buffer[x]);
+						if (n == ILI9342_BURST_PIXELS) {
+							write_data_wait(g);
+							write_data_buffer_async(g, lbuf[half], n);
+							half ^= 1;
+							n = 0;
+						}
+					}
+				}
+				write_data_wait(g);
+				if (n)
+					write_data_buffer(g, lbuf[half], n);
+			}
+		#endif
+		release_bus(g);
+	}
+#endif
+
 #if GDISP_HARDWARE_STREAM_READ
 	LLDSPEC	void gdisp_lld_read_start(GDisplay *g) {
 		acquire_bus(g);
@@ -14,6 +14,8 @@
 #define GDISP_HARDWARE_STREAM_READ		GFXON
 #define GDISP_HARDWARE_STREAM_POS		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
+#define GDISP_HARDWARE_FILLS			GFXON
+#define GDISP_HARDWARE_BITFILLS			GFXON
 
 #define GDISP_LLD_PIXELFORMAT			GDISP_PIXELFORMAT_RGB565
 
@@ -68,4 +68,23 @@ static GFXINLINE gU16 read_data(GDisplay *g)
 	return 0;
 }
 
+// Send the same pixel count times. Fills are passed straight to this.
+//#define write_data_repeat(g, data, count)			board_write_repeat(g, data, count)
+static GFXINLINE void board_write_repeat(GDisplay *g, gU16 data, gU32 count)
+{
+	(void) g;
+	(void) data;
+	(void) count;
+}
+
+// Send count pixels from a buffer. The buffer must have been sent when this returns.
+// Blits from a buffer in the controller's pixel format are passed straight to this.
+//#define write_data_buffer(g, buffer, count)			board_write_buffer(g, buffer, count)
+static GFXINLINE void board_write_buffer(GDisplay *g, const gU16 *buffer, gU32 count)
+{
+	(void) g;
+	(void) buffer;
+	(void) count;
+}
+
 #endif /* GDISP_LLD_BOARD_H */
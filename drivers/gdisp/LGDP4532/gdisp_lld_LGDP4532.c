@@ -57,10 +57,15 @@
 
 // Serial write data for fast fill.
 #ifndef write_data_repeat
-#define write_data_repeat(g, data, count) { int i; for (i = 0; i < count; ++i) write_data (g, data) }
+#define write_data_repeat(g, data, count) { gU32 i; for (i = 0; i < (gU32)(count); ++i) write_data (g, (data)); }
 /* TODO: should use DMA mem2mem */
 #endif
 
+// Serial write data for blits. A board can define this to send a buffer of pixels faster than one write_data() at a time.
+#ifndef write_data_buffer
+#define write_data_buffer(g, buffer, count) { gU32 i; for (i = 0; i < (gU32)(count); ++i) write_data (g, (buffer)[i]); }
+#endif
+
 static void set_cursor(GDisplay *g) {
 	switch(g->g.Orientation) {
 		default:
@@ -201,6 +206,20 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	LLDSPEC void gdisp_lld_write_pos(GDisplay *g) {
 		set_cursor(g);
 	}
+	#if GDISP_HARDWARE_STREAM_BUFFER
+		LLDSPEC	void gdisp_lld_write_buffer(GDisplay *g) {
+			#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+				// The pixels are already in the controller format
+				write_data_buffer(g, (const gPixel *)g->p.ptr, g->p.cx);
+			#else
+				const gPixel	*p;
+				gCoord			i;
+
+				for(p = (const gPixel *)g->p.ptr, i = 0; i < g->p.cx; i++)
+					write_data(g, gdispColor2Native(p[i]));
+			#endif
+		}
+	#endif
 #endif
 
 #if GDISP_HARDWARE_STREAM_READ
@@ -369,23 +388,9 @@ LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
 	LLDCOLOR_TYPE c = gdispColor2Native(g->p.color);
 
 	acquire_bus(g);
-
-	// Set view port if drawing more than 1 line, or write not started
-	if (g->p.cy != 1 || !ws) {
-		set_viewport(g);
-	}
-
+	set_viewport(g);
 	set_cursor(g);
-	write_data_repeat (g,c,g->p.cx*g->p.cy);
-
-	// Restore view port if write started and drawed more than 1 line
-	if (g->p.cy != 1 && ws)
-	{
-		write_reg(g, LGDP4532_HORIZONTAL_WINDOW_ADDR2, svx);
-		write_reg(g, LGDP4532_HORIZONTAL_WINDOW_ADDR1, svx + svcx - 1);
-		write_reg(g, LGDP4532_VERTICAL_WINDOW_ADDR2, svy);
-		write_reg(g, LGDP4532_VERTICAL_WINDOW_ADDR1, svy + svcy - 1);
-	}
+	write_data_repeat (g, c, (gU32)g->p.cx * g->p.cy);
 	release_bus(g);
 }
 #endif // GDISP_HARDWARE_FILLS
@@ -13,6 +13,7 @@
 #define GDISP_HARDWARE_STREAM_WRITE		GFXON
 #define GDISP_HARDWARE_STREAM_READ		GFXON
 #define GDISP_HARDWARE_STREAM_POS		GFXON
+#define GDISP_HARDWARE_STREAM_BUFFER	GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
 #define GDISP_HARDWARE_FILLS			GFXON
 
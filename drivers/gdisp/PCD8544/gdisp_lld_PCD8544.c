@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT		GDISPVMT_PCD8544
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 #include "board_PCD8544.h"
 
 /*===========================================================================*/
@@ -25,6 +26,7 @@
 #define GDISP_INITIAL_BACKLIGHT		100
 
 #define GDISP_FLG_NEEDFLUSH		(GDISP_FLG_DRIVER << 0)
+#define PCD8544_PAGES			(GDISP_SCREEN_HEIGHT / 8)
 
 #include "PCD8544.h"
 
@@ -33,7 +35,9 @@
 /*===========================================================================*/
 
 // Some common routines and macros
-#define RAM(g)			((gU8 *)g->priv)
+#define PRIV(g)			((PCD8544_Private *)g->priv)
+#define RAM(g)			(PRIV(g)->ram)
+#define DIRTY(g)		(PRIV(g)->dirty)
 
 #define xyaddr(x, y)		((x) + ((y) >> 3) * GDISP_SCREEN_WIDTH)
 #define xybit(y)		(1 << ((y) & 7))
@@ -51,10 +55,16 @@
 
 #define GDISP_SCREEN_BYTES ((GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT) / 8)
 
+typedef struct PCD8544_Private {
+	gdispPageDirty	dirty[PCD8544_PAGES];		// The columns of each page changed since the last flush
+	gU8				ram[GDISP_SCREEN_BYTES];		// The display surface
+} PCD8544_Private;
+
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
-	// The private area is the display surface.
-	if (!(g->priv = gfxAlloc(GDISP_SCREEN_BYTES)))
+	// The private area is the display surface and the record of what has changed on it.
+	if (!(g->priv = gfxAlloc(sizeof(PCD8544_Private))))
 		gfxHalt("GDISP PCD8544: Failed to allocate private memory");
+	gdispPagesClean(DIRTY(g), PCD8544_PAGES);
 
 	// Initialise the board interface
 	init_board(g);
@@ -96,6 +106,8 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		gdispPageDirty	*d;
+		unsigned		p;
 
 		// Don't flush if we don't need it.
 		if (!(g->flags & GDISP_FLG_NEEDFLUSH)) {
@@ -104,13 +116,18 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 		acquire_bus(g);
 
-		write_cmd(g, PCD8544_SET_X | 0);  // X = 0
-		write_cmd(g, PCD8544_SET_Y | 0);  // Y = 0
-
-		write_data(g, RAM(g), GDISP_SCREEN_BYTES);
+		// Only send the changed columns of the changed pages
+		for (p = 0, d = DIRTY(g); p < PCD8544_PAGES; p++, d++) {
+			if (d->start >= d->end)
+				continue;
+			write_cmd(g, PCD8544_SET_X | d->start);  // X = first changed column
+			write_cmd(g, PCD8544_SET_Y | p);         // Y = page
+			write_data(g, RAM(g) + p * GDISP_SCREEN_WIDTH + d->start, d->end - d->start);
+		}
 
 		release_bus(g);
 
+		gdispPagesClean(DIRTY(g), PCD8544_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -149,6 +166,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		} else {
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
 		}
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT		GDISPVMT_PCF8812
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 #include "board_PCF8812.h"
 
 /*===========================================================================*/
@@ -28,6 +29,7 @@
 #define GDISP_INITIAL_BACKLIGHT		100
 
 #define GDISP_FLG_NEEDFLUSH		(GDISP_FLG_DRIVER << 0)
+#define PCF8812_PAGES			(GDISP_MATRIX_HEIGHT / 8)
 
 #include "PCF8812.h"
 
@@ -36,7 +38,9 @@
 /*===========================================================================*/
 
 // Some common routines and macros
-#define RAM(g)				((gU8 *)g->priv)
+#define PRIV(g)				((PCF8812_Private *)g->priv)
+#define RAM(g)				(PRIV(g)->ram)
+#define DIRTY(g)			(PRIV(g)->dirty)
 
 #define xyaddr(x, y)			((x) + ((y) >> 3) * GDISP_MATRIX_WIDTH)
 #define xybit(y)			(1 << ((y) & 7))
@@ -56,10 +60,16 @@
 //#define GDISP_SCREEN_BYTES ((GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT) / 8)
 #define GDISP_MATRIX_BYTES ((GDISP_MATRIX_WIDTH * GDISP_MATRIX_HEIGHT) / 8) // real height 65 pixels, this fix 65 / 8 != 9
 
+typedef struct PCF8812_Private {
+	gdispPageDirty	dirty[PCF8812_PAGES];		// The columns of each page changed since the last flush
+	gU8				ram[GDISP_MATRIX_BYTES];		// The display surface
+} PCF8812_Private;
+
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
-	// The private area is the display surface.
-	if (!(g->priv = gfxAlloc(GDISP_MATRIX_BYTES)))
+	// The private area is the display surface and the record of what has changed on it.
+	if (!(g->priv = gfxAlloc(sizeof(PCF8812_Private))))
 		gfxHalt("GDISP PCF8812: Failed to allocate private memory");
+	gdispPagesClean(DIRTY(g), PCF8812_PAGES);
 
 	// Initialise the board interface
 	init_board(g);
@@ -106,6 +116,8 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		gdispPageDirty	*d;
+		unsigned		p;
 
 		// Don't flush if we don't need it.
 		if (!(g->flags & GDISP_FLG_NEEDFLUSH)) {
@@ -114,13 +126,18 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 		acquire_bus(g);
 
-		write_cmd(g, PCF8812_SET_X | 0);  // X = 0
-		write_cmd(g, PCF8812_SET_Y | 0);  // Y = 0
-
-		write_data(g, RAM(g), GDISP_MATRIX_BYTES);
+		// Only send the changed columns of the changed pages
+		for (p = 0, d = DIRTY(g); p < PCF8812_PAGES; p++, d++) {
+			if (d->start >= d->end)
+				continue;
+			write_cmd(g, PCF8812_SET_X | d->start);  // X = first changed column
+			write_cmd(g, PCF8812_SET_Y | p);         // Y = page
+			write_data(g, RAM(g) + p * GDISP_MATRIX_WIDTH + d->start, d->end - d->start);
+		}
 
 		release_bus(g);
 
+		gdispPagesClean(DIRTY(g), PCF8812_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -159,6 +176,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		} else {
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
 		}
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_SSD1306
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 
 #include "board_SSD1306.h"
 #include <string.h>   // for memset
@@ -41,6 +42,7 @@
 #endif
 
 #define GDISP_FLG_NEEDFLUSH			(GDISP_FLG_DRIVER<<0)
+#define SSD1306_PAGES				(GDISP_SCREEN_HEIGHT/8)
 
 #include "SSD1306.h"
 
@@ -48,8 +50,19 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+typedef struct SSD1306_Private {
+	gdispPageDirty	dirty[SSD1306_PAGES];					// The columns of each page changed since the last flush
+	gU8				ram[SSD1306_PAGES * SSD1306_PAGE_WIDTH];	// The display surface
+	#if GDISP_HARDWARE_FLUSHSEND
+		gdispPageDirty	senddirty[SSD1306_PAGES];				// The columns of each page waiting to be sent
+		gU8				send[SSD1306_PAGES * SSD1306_PAGE_WIDTH];	// The changes waiting to be sent
+	#endif
+} SSD1306_Private;
+
 // Some common routines and macros
-#define RAM(g)							((gU8 *)g->priv)
+#define PRIV(g)							((SSD1306_Private *)g->priv)
+#define RAM(g)							(PRIV(g)->ram)
+#define DIRTY(g)						(PRIV(g)->dirty)
 #define write_cmd2(g, cmd1, cmd2)		{ write_cmd(g, cmd1); write_cmd(g, cmd2); }
 #define write_cmd3(g, cmd1, cmd2, cmd3)	{ write_cmd(g, cmd1); write_cmd(g, cmd2); write_cmd(g, cmd3); }
 
@@ -72,8 +85,13 @@
  */
 
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
-	// The private area is the display surface.
-	g->priv = gfxAlloc(GDISP_SCREEN_HEIGHT/8 * SSD1306_PAGE_WIDTH);
+	// The private area is the display surface and the record of what has changed on it.
+	if (!(g->priv = gfxAlloc(sizeof(SSD1306_Private))))
+		return gFalse;
+	gdispPagesClean(DIRTY(g), SSD1306_PAGES);
+	#if GDISP_HARDWARE_FLUSHSEND
+		gdispPagesClean(PRIV(g)->senddirty, SSD1306_PAGES);
+	#endif
 
 	// Fill in the prefix command byte on each page line of the display buffer
 	// We can do it during initialisation as this byte is never overwritten.
@@ -81,7 +99,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		{
 			unsigned	i;
 
-			for(i=0; i < GDISP_SCREEN_HEIGHT/8 * SSD1306_PAGE_WIDTH; i+=SSD1306_PAGE_WIDTH)
+			for(i=0; i < SSD1306_PAGES * SSD1306_PAGE_WIDTH; i+=SSD1306_PAGE_WIDTH)
 				RAM(g)[i] = SSD1306_PAGE_PREFIX;
 		}
 	#endif
@@ -138,35 +156,83 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 }
 
 #if GDISP_HARDWARE_FLUSH
-	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
-		gU8 * ram;
-		unsigned pages;
-
-		// Don't flush if we don't need it.
-		if (!(g->flags & GDISP_FLG_NEEDFLUSH))
-			return;
-		ram = RAM(g);
-		pages = GDISP_SCREEN_HEIGHT/8;
+	// Send the changed columns of the changed pages in buf
+	static void send_pages(GDisplay *g, gU8 *buf, const gdispPageDirty *d) {
+		gU8 *			ram;
+		unsigned		page;
+		gCoord			sx, cnt;
 
 		acquire_bus(g);
 		write_cmd(g, SSD1306_SETSTARTLINE | 0);
 
-		while (pages--) {
+		for (page = 0; page < SSD1306_PAGES; page++, d++) {
+			if (d->start >= d->end)
+				continue;
+			sx = d->start;
+			cnt = d->end - d->start;
+
 			#if SSD1306_SH1106
-				write_cmd(g, SSD1306_PAM_PAGE_START + (7 - pages));
-				write_cmd(g, SSD1306_SETLOWCOLUMN + 2);
-				write_cmd(g, SSD1306_SETHIGHCOLUMN);
+				write_cmd(g, SSD1306_PAM_PAGE_START + page);
+				write_cmd(g, SSD1306_SETLOWCOLUMN + ((sx + 2) & 0x0F));
+				write_cmd(g, SSD1306_SETHIGHCOLUMN + ((sx + 2) >> 4));
+			#else
+				write_cmd3(g, SSD1306_HV_COLUMN_ADDRESS, sx, sx + cnt - 1);
+				write_cmd3(g, SSD1306_HV_PAGE_ADDRESS, page, page);
 			#endif
 
-			write_data(g, ram, SSD1306_PAGE_WIDTH);
-			ram += SSD1306_PAGE_WIDTH;
+			ram = buf + page * SSD1306_PAGE_WIDTH + sx;
+			#ifdef SSD1306_PAGE_PREFIX
+				{
+					gU8		save;
+
+					// The prefix must come just before the data. Borrow the byte before the first column.
+					save = ram[0];
+					ram[0] = SSD1306_PAGE_PREFIX;
+					write_data(g, ram, cnt + 1);
+					ram[0] = save;
+				}
+			#else
+				write_data(g, ram, cnt);
+			#endif
 		}
 		release_bus(g);
+	}
 
+	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		// Don't flush if we don't need it.
+		if (!(g->flags & GDISP_FLG_NEEDFLUSH))
+			return;
+
+		#if GDISP_HARDWARE_FLUSHSEND
+			{
+				gdispPageDirty	*d;
+				unsigned		page, pos;
+
+				// Just copy the changes. They are sent by gdisp_lld_flush_send() once the display is unlocked.
+				for (page = 0, d = DIRTY(g); page < SSD1306_PAGES; page++, d++) {
+					if (d->start >= d->end)
+						continue;
+					pos = SSD1306_PAGE_OFFSET + page * SSD1306_PAGE_WIDTH + d->start;
+					memcpy(PRIV(g)->send + pos, RAM(g) + pos, d->end - d->start);
+				}
+				memcpy(PRIV(g)->senddirty, DIRTY(g), sizeof(PRIV(g)->senddirty));
+			}
+		#else
+			send_pages(g, RAM(g), DIRTY(g));
+		#endif
+
+		gdispPagesClean(DIRTY(g), SSD1306_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
 
+#if GDISP_HARDWARE_FLUSHSEND
+	LLDSPEC void gdisp_lld_flush_send(GDisplay *g) {
+		send_pages(g, PRIV(g)->send, PRIV(g)->senddirty);
+		gdispPagesClean(PRIV(g)->senddirty, SSD1306_PAGES);
+	}
+#endif
+
 #if GDISP_HARDWARE_FILLS
 	LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
 		gCoord		sy, ey;
@@ -230,6 +296,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 			for (col = sx; col <= ex; col++)
 				base[col] |= mask;
 		}
+		gdispPagesMark(DIRTY(g), sx, ex, sy, ey);
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -261,6 +328,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 			RAM(g)[xyaddr(x, y)] |= xybit(y);
 		else
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
 #endif
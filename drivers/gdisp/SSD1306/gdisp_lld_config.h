@@ -15,6 +15,7 @@
 /*===========================================================================*/
 
 #define GDISP_HARDWARE_FLUSH			GFXON		// This controller requires flushing
+#define GDISP_HARDWARE_FLUSHSEND		GFXON		// Flushed frames can be sent from a back buffer
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_CONTROL      	GFXON
@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_SSD1312
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 
 #include "board_SSD1312.h"
 
@@ -40,13 +41,21 @@
 #endif
 
 #define GDISP_FLG_NEEDFLUSH			(GDISP_FLG_DRIVER<<0)
+#define SSD1312_PAGES				(GDISP_SCREEN_HEIGHT/8)
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+typedef struct SSD1312_Private {
+	gdispPageDirty	dirty[SSD1312_PAGES];					// The columns of each page changed since the last flush
+	gU8				ram[SSD1312_PAGES * SSD1312_PAGE_WIDTH];	// The display surface
+} SSD1312_Private;
+
 // Some common routines and macros
-#define RAM(g)						((gU8 *)g->priv)
+#define PRIV(g)						((SSD1312_Private *)g->priv)
+#define RAM(g)						(PRIV(g)->ram)
+#define DIRTY(g)					(PRIV(g)->dirty)
 #define xyaddr(x, y)        		(SSD1312_PAGE_OFFSET + (x) + ((y)>>3)*SSD1312_PAGE_WIDTH)
 #define xybit(y)            		(1<<((y)&7))
 
@@ -66,15 +75,16 @@
 
 LLDSPEC gBool gdisp_lld_init(GDisplay *g)
 {
-	// The private area is the display surface.
-	g->priv = gfxAlloc(GDISP_SCREEN_HEIGHT/8 * SSD1312_PAGE_WIDTH);
+	// The private area is the display surface and the record of what has changed on it.
+	g->priv = gfxAlloc(sizeof(SSD1312_Private));
 	if (!g->priv)
 		return gFalse;
+	gdispPagesClean(DIRTY(g), SSD1312_PAGES);
 
 	// Fill in the prefix command byte on each page line of the display buffer
 	// We can do this during initialisation as we're being careful that this byte is never overwritten.
 	#ifdef SSD1312_PAGE_PREFIX
-		for (unsigned i = 0; i < GDISP_SCREEN_HEIGHT/8 * SSD1312_PAGE_WIDTH; i += SSD1312_PAGE_WIDTH)
+		for (unsigned i = 0; i < SSD1312_PAGES * SSD1312_PAGE_WIDTH; i += SSD1312_PAGE_WIDTH)
 			RAM(g)[i] = SSD1312_PAGE_PREFIX;
 	#endif
 
@@ -163,27 +173,44 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g)
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g)
     {
+		gdispPageDirty * d;
 		gU8 * ram;
-		unsigned pages;
+		unsigned page;
+		gCoord cnt;
 
 		// Only flush if necessary
 		if (!(g->flags & GDISP_FLG_NEEDFLUSH))
 			return;
 
-		ram = RAM(g);
-		pages = GDISP_SCREEN_HEIGHT/8;
-
 		acquire_bus(g);
 		write_cmd_1(g, 0x40 | 0);
-		while (pages--) {
-			write_cmd_1(g, 0xB0 + (((GDISP_SCREEN_HEIGHT/8)-1)-pages));
-			write_cmd_1(g, 0x00);
-			write_cmd_1(g, 0x10);
-			write_data(g, ram, SSD1312_PAGE_WIDTH);
-			ram += SSD1312_PAGE_WIDTH;
+
+		// Only send the changed columns of the changed pages
+		for (page = 0, d = DIRTY(g); page < SSD1312_PAGES; page++, d++) {
+			if (d->start >= d->end)
+				continue;
+			cnt = d->end - d->start;
+			write_cmd_1(g, 0xB0 + page);
+			write_cmd_1(g, 0x00 | (d->start & 0x0F));
+			write_cmd_1(g, 0x10 | (d->start >> 4));
+			ram = RAM(g) + page * SSD1312_PAGE_WIDTH + d->start;
+			#ifdef SSD1312_PAGE_PREFIX
+				{
+					gU8 save;
+
+					// The prefix must come just before the data. Borrow the byte before the first column.
+					save = ram[0];
+					ram[0] = SSD1312_PAGE_PREFIX;
+					write_data(g, ram, cnt + 1);
+					ram[0] = save;
+				}
+			#else
+				write_data(g, ram, cnt);
+			#endif
 		}
 		release_bus(g);
 
+		gdispPagesClean(DIRTY(g), SSD1312_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -216,6 +243,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g)
 			RAM(g)[xyaddr(x, y)] |= xybit(y);
 		else
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -314,6 +342,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g)
 			for (col = sx; col <= ex; col++)
 				base[col] |= mask;
 		}
+		gdispPagesMark(DIRTY(g), sx, ex, sy, ey);
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
 #endif
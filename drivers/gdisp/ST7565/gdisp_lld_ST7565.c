@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_ST7565
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 
 #include "board_ST7565.h"
 
@@ -33,6 +34,7 @@
 #endif
 
 #define GDISP_FLG_NEEDFLUSH			(GDISP_FLG_DRIVER<<0)
+#define ST7565_PAGES				(GDISP_SCREEN_HEIGHT/8)
 
 #include "st7565.h"
 
@@ -56,8 +58,15 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+typedef struct ST7565_Private {
+	gdispPageDirty	dirty[ST7565_PAGES];					// The columns of each page changed since the last flush
+	gU8				ram[ST7565_PAGES * GDISP_SCREEN_WIDTH];	// The display surface
+} ST7565_Private;
+
 // Some common routines and macros
-#define RAM(g)							((gU8 *)g->priv)
+#define PRIV(g)							((ST7565_Private *)g->priv)
+#define RAM(g)							(PRIV(g)->ram)
+#define DIRTY(g)						(PRIV(g)->dirty)
 #define write_cmd2(g, cmd1, cmd2)		{ write_cmd(g, cmd1); write_cmd(g, cmd2); }
 #define write_cmd3(g, cmd1, cmd2, cmd3)	{ write_cmd(g, cmd1); write_cmd(g, cmd2); write_cmd(g, cmd3); }
 
@@ -80,11 +89,12 @@
  */
 
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
-	// The private area is the display surface.
-	g->priv = gfxAlloc(GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8);
+	// The private area is the display surface and the record of what has changed on it.
+	g->priv = gfxAlloc(sizeof(ST7565_Private));
 	if (!g->priv) {
 		return gFalse;
 	}
+	gdispPagesClean(DIRTY(g), ST7565_PAGES);
 
 	// Initialise the board interface
 	init_board(g);
@@ -143,7 +153,8 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
-		unsigned	p;
+		gdispPageDirty	*d;
+		unsigned		p;
 
 		// Don't flush if we don't need it.
 		if (!(g->flags & GDISP_FLG_NEEDFLUSH))
@@ -151,15 +162,19 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 		acquire_bus(g);
 		gU8 pagemap[8]={ST7565_PAGE_ORDER};
-		for (p = 0; p < 8; p++) {
+		// Only send the changed columns of the changed pages
+		for (p = 0, d = DIRTY(g); p < ST7565_PAGES; p++, d++) {
+			if (d->start >= d->end)
+				continue;
 			write_cmd(g, ST7565_PAGE | pagemap[p]);
-			write_cmd(g, ST7565_COLUMN_MSB | 0);
-			write_cmd(g, ST7565_COLUMN_LSB | 0);
+			write_cmd(g, ST7565_COLUMN_MSB | ((d->start >> 4) & 0x0F));
+			write_cmd(g, ST7565_COLUMN_LSB | (d->start & 0x0F));
 			write_cmd(g, ST7565_RMW);
-			write_data(g, RAM(g) + (p*GDISP_SCREEN_WIDTH), GDISP_SCREEN_WIDTH);
+			write_data(g, RAM(g) + (p*GDISP_SCREEN_WIDTH) + d->start, d->end - d->start);
 		}
 		release_bus(g);
 
+		gdispPagesClean(DIRTY(g), ST7565_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -191,6 +206,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 			RAM(g)[xyaddr(x, y)] |= xybit(y);
 		else
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -97,9 +97,24 @@
 #define dummy_read(g)				{ volatile gU16 dummy; dummy = read_data(g); (void) dummy; }
 #define write_reg(g, reg, data)		{ write_cmd(g, reg); write_data(g, data); }
 
-// Serial write data for fast fill.
+// Serial write data for fast fill and blit. A board can define any of these to send pixels
+// faster than one write_data() at a time. write_data_buffer_async() may return before the buffer
+// is sent and write_data_wait() waits for it.
 #ifndef write_data_repeat
-#define write_data_repeat(g, data, count) { int i; for (i = 0; i < count; ++i) write_data (g, data); }
+#define write_data_repeat(g, data, count) { gU32 i; for (i = 0; i < (gU32)(count); ++i) write_data (g, data); }
+#endif
+#ifndef write_data_buffer
+#define write_data_buffer(g, buffer, count) { gU32 i; for (i = 0; i < (gU32)(count); ++i) write_data (g, (buffer)[i]); }
+#endif
+#ifndef write_data_buffer_async
+#define write_data_buffer_async(g, buffer, count) write_data_buffer(g, buffer, count)
+#define write_data_wait(g)
+#endif
+#ifndef GDISP_NO_DMA_FROM_STACK
+	#define GDISP_NO_DMA_FROM_STACK	GFXOFF
+#endif
+#ifndef ST7735_BURST_PIXELS
+	#define ST7735_BURST_PIXELS	64		// The size of each half of the buffer used to convert blits
 #endif
 
 // Commands list copied from https://github.com/adafruit/Adafruit-ST7735-Library
@@ -306,11 +321,57 @@ LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
 
 	acquire_bus(g);
 	set_viewport (g);
-	write_data_repeat (g,c,g->p.cx*g->p.cy);
+	write_data_repeat (g,c,(gU32)g->p.cx*g->p.cy);
 	release_bus(g);
 }
 #endif // GDISP_HARDWARE_FILLS
 
+#if GDISP_HARDWARE_BITFILLS
+LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+	const gPixel	*buffer;
+	gCoord			y;
+
+	buffer = (const gPixel *)g->p.ptr + g->p.x1 + g->p.y1 * g->p.x2;
+	acquire_bus(g);
+	set_viewport(g);
+	#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+		if (g->p.x2 == g->p.cx) {
+			write_data_buffer(g, buffer, (gU32)g->p.cx * g->p.cy);
+		} else {
+			for(y = 0; y < g->p.cy; y++, buffer += g->p.x2)
+				write_data_buffer(g, buffer, g->p.cx);
+		}
+	#else
+		{
+			#if GDISP_NO_DMA_FROM_STACK
+				static LLDCOLOR_TYPE	lbuf[2][ST7735_BURST_PIXELS];
+			#else
+				LLDCOLOR_TYPE			lbuf[2][ST7735_BURST_PIXELS];
+			#endif
+			gCoord		x;
+			unsigned	half, n;
+
+			// Convert into one half of the buffer while the board sends the other half
+			for(half = n = 0, y = 0; y < g->p.cy; y++, buffer += g->p.x2) {
+				for(x = 0; x < g->p.cx; x++) {
+					lbuf[half][n++] = gdispColor2Native(buffer[x]);
+					if (n == ST7735_BURST_PIXELS) {
+						write_data_wait(g);
+						write_data_buffer_async(g, lbuf[half], n);
+						half ^= 1;
+						n = 0;
+					}
+				}
+			}
+			write_data_wait(g);
+			if (n)
+				write_data_buffer(g, lbuf[half], n);
+		}
+	#endif
+	release_bus(g);
+}
+#endif // GDISP_HARDWARE_BITFILLS
+
 #if GDISP_NEED_CONTROL && GDISP_HARDWARE_CONTROL
 LLDSPEC void gdisp_lld_control(GDisplay *g) {
 	switch(g->p.x) {
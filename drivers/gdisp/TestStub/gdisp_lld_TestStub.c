@@ -26,9 +26,109 @@
 	#define GDISP_INITIAL_BACKLIGHT	100
 #endif
 
+#if GDISP_TESTSTUB_SIMULATE
+	#include <string.h>
+	#if GDISP_TESTSTUB_REPORT
+		#include <stdio.h>
+	#endif
+
+	typedef struct simPriv {
+		LLDCOLOR_TYPE	*fb;				// The display memory of the simulated controller
+		gdispBusStats	bus;				// The totals since the display started
+		gdispBusStats	frame;				// The last frame
+		gdispBusStats	framestart;			// The totals when the current frame started
+		gU32			frames;
+		gBool			indata;				// A data transaction is open (streaming)
+		gCoord			x0, y0, x1, y1;		// The current stream window. x1 and y1 are exclusive.
+		gCoord			x, y;				// The current stream position
+	} simPriv;
+
+	#define PRIV(g)					((simPriv *)(g)->priv)
+	#define PIXEL(g, px, py)		PRIV(g)->fb[(py) * (g)->g.Width + (px)]
+
+	// The bus cycles to move a number of bytes
+	#define BYTECYCLES(n)			(((gU32)(n) * 8 + GDISP_TESTSTUB_BUSWIDTH - 1) / GDISP_TESTSTUB_BUSWIDTH)
+
+	static void busSetup(GDisplay *g) {
+		simPriv		*priv;
+
+		priv = PRIV(g);
+		priv->indata = gFalse;
+		priv->bus.transactions++;
+		priv->bus.setupBytes += GDISP_TESTSTUB_SETUPBYTES;
+		priv->bus.cycles += GDISP_TESTSTUB_OVERHEAD + BYTECYCLES(GDISP_TESTSTUB_SETUPBYTES);
+	}
+
+	// Pixels following a setup. Consecutive calls while streaming are the one transaction.
+	static void busPixels(GDisplay *g, gU32 cnt, gBool isread) {
+		simPriv		*priv;
+
+		priv = PRIV(g);
+		if (!priv->indata) {
+			priv->indata = gTrue;
+			priv->bus.transactions++;
+			priv->bus.cycles += GDISP_TESTSTUB_OVERHEAD;
+		}
+		if (isread)
+			priv->bus.readBytes += cnt * GDISP_TESTSTUB_PIXELBYTES;
+		else
+			priv->bus.writeBytes += cnt * GDISP_TESTSTUB_PIXELBYTES;
+		priv->bus.cycles += BYTECYCLES(cnt * GDISP_TESTSTUB_PIXELBYTES);
+	}
+
+	static void busEnd(GDisplay *g) {
+		PRIV(g)->indata = gFalse;
+	}
+
+	static gU32 busUsecs(gU32 cycles) {
+		#if GFX_TYPE_64
+			return (gU32)((gU64)cycles * 1000000 / GDISP_TESTSTUB_BUSCLOCK);
+		#else
+			return (gU32)((float)cycles * 1000000.0f / GDISP_TESTSTUB_BUSCLOCK);
+		#endif
+	}
+
+	#if GDISP_HARDWARE_STREAM_WRITE || GDISP_HARDWARE_STREAM_READ
+		static void setwindow(GDisplay *g) {
+			simPriv		*priv;
+
+			priv = PRIV(g);
+			priv->x0 = priv->x = g->p.x;
+			priv->y0 = priv->y = g->p.y;
+			priv->x1 = g->p.x + g->p.cx;
+			priv->y1 = g->p.y + g->p.cy;
+			busSetup(g);
+		}
+
+		static void nextpos(simPriv *priv) {
+			if (++priv->x >= priv->x1) {
+				priv->x = priv->x0;
+				if (++priv->y >= priv->y1)
+					priv->y = priv->y0;
+			}
+		}
+	#endif
+#endif
+
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
-	/* No board interface and no private driver area */
-	g->priv = g->board = 0;
+	#if GDISP_TESTSTUB_SIMULATE
+		simPriv		*priv;
+
+		/* No board interface. The private area holds the simulated controller. */
+		g->board = 0;
+		if (!(priv = gfxAlloc(sizeof(simPriv))))
+			return gFalse;
+		memset(priv, 0, sizeof(simPriv));
+		if (!(priv->fb = gfxAlloc((gMemSize)GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT * sizeof(LLDCOLOR_TYPE)))) {
+			gfxFree(priv);
+			return gFalse;
+		}
+		memset(priv->fb, 0, (gMemSize)GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT * sizeof(LLDCOLOR_TYPE));
+		g->priv = priv;
+	#else
+		/* No board interface and no private driver area */
+		g->priv = g->board = 0;
+	#endif
 
 	/* Initialise the GDISP structure */
 	g->g.Width = GDISP_SCREEN_WIDTH;
@@ -40,17 +140,196 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	return gTrue;
 }
 
-#if GDISP_HARDWARE_DRAWPIXEL
-	void gdisp_lld_draw_pixel(GDisplay *g) {
-		(void) g;
+#if GDISP_TESTSTUB_SIMULATE
+	#if GDISP_HARDWARE_FLUSH
+		LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+			simPriv		*priv;
+
+			priv = PRIV(g);
+			priv->frame.transactions = priv->bus.transactions - priv->framestart.transactions;
+			priv->frame.setupBytes = priv->bus.setupBytes - priv->framestart.setupBytes;
+			priv->frame.writeBytes = priv->bus.writeBytes - priv->framestart.writeBytes;
+			priv->frame.readBytes = priv->bus.readBytes - priv->framestart.readBytes;
+			priv->frame.cycles = priv->bus.cycles - priv->framestart.cycles;
+			priv->frame.usecs = busUsecs(priv->frame.cycles);
+			priv->framestart = priv->bus;
+			priv->frames++;
+
+			// An empty frame is not worth reporting
+			if (!priv->frame.transactions)
+				return;
+			#if GDISP_TESTSTUB_REPORT
+				printf("TestStub frame %u: %u transactions, %u setup, %u write and %u read bytes, %u.%03u ms\n",
+					(unsigned)priv->frames, (unsigned)priv->frame.transactions, (unsigned)priv->frame.setupBytes,
+					(unsigned)priv->frame.writeBytes, (unsigned)priv->frame.readBytes,
+					(unsigned)(priv->frame.usecs / 1000), (unsigned)(priv->frame.usecs % 1000));
+			#endif
+		}
+	#endif
+
+	#if GDISP_HARDWARE_STREAM_WRITE
+		LLDSPEC	void gdisp_lld_write_start(GDisplay *g) {
+			setwindow(g);
+		}
+		LLDSPEC	void gdisp_lld_write_color(GDisplay *g) {
+			simPriv		*priv;
+
+			priv = PRIV(g);
+			PIXEL(g, priv->x, priv->y) = gdispColor2Native(g->p.color);
+			nextpos(priv);
+			busPixels(g, 1, gFalse);
+		}
+		LLDSPEC	void gdisp_lld_write_stop(GDisplay *g) {
+			busEnd(g);
+		}
+	#endif
+
+	#if GDISP_HARDWARE_STREAM_POS
+		LLDSPEC void gdisp_lld_write_pos(GDisplay *g) {
+			simPriv		*priv;
+
+			// The controller needs the whole window resent to move
+			priv = PRIV(g);
+			priv->x = g->p.x;
+			priv->y = g->p.y;
+			busSetup(g);
+		}
+	#endif
+
+	#if GDISP_HARDWARE_STREAM_READ
+		LLDSPEC	void gdisp_lld_read_start(GDisplay *g) {
+			setwindow(g);
+			busPixels(g, 1, gTrue);					// The dummy read
+		}
+		LLDSPEC	gColor gdisp_lld_read_color(GDisplay *g) {
+			simPriv		*priv;
+			gColor		c;
+
+			priv = PRIV(g);
+			c = gdispNative2Color(PIXEL(g, priv->x, priv->y));
+			nextpos(priv);
+			busPixels(g, 1, gTrue);
+			return c;
+		}
+		LLDSPEC	void gdisp_lld_read_stop(GDisplay *g) {
+			busEnd(g);
+		}
+	#endif
+
+	LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
+		PIXEL(g, g->p.x, g->p.y) = gdispColor2Native(g->p.color);
+		busSetup(g);
+		busPixels(g, 1, gFalse);
+		busEnd(g);
 	}
-#endif
 
-#if GDISP_HARDWARE_PIXELREAD
-	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
-		(void) g;
-		return 0;
+	LLDSPEC gColor gdisp_lld_get_pixel_color(GDisplay *g) {
+		busSetup(g);
+		busPixels(g, 2, gTrue);					// Including the dummy read
+		busEnd(g);
+		return gdispNative2Color(PIXEL(g, g->p.x, g->p.y));
 	}
+
+	#if GDISP_HARDWARE_FILLS
+		LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
+			LLDCOLOR_TYPE	c, *p;
+			gCoord			x, y;
+
+			c = gdispColor2Native(g->p.color);
+			for(y = 0; y < g->p.cy; y++) {
+				p = &PIXEL(g, g->p.x, g->p.y + y);
+				for(x = 0; x < g->p.cx; x++)
+					p[x] = c;
+			}
+			busSetup(g);
+			busPixels(g, (gU32)g->p.cx * g->p.cy, gFalse);
+			busEnd(g);
+		}
+	#endif
+
+	#if GDISP_HARDWARE_BITFILLS
+		LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+			const gPixel	*buffer;
+			LLDCOLOR_TYPE	*p;
+			gCoord			x, y;
+
+			buffer = (const gPixel *)g->p.ptr + g->p.x1 + g->p.y1 * g->p.x2;
+			for(y = 0; y < g->p.cy; y++, buffer += g->p.x2) {
+				p = &PIXEL(g, g->p.x, g->p.y + y);
+				for(x = 0; x < g->p.cx; x++)
+					p[x] = gdispColor2Native(buffer[x]);
+			}
+			busSetup(g);
+			busPixels(g, (gU32)g->p.cx * g->p.cy, gFalse);
+			busEnd(g);
+		}
+	#endif
+
+	#if GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL
+		LLDSPEC void gdisp_lld_vertical_scroll(GDisplay *g) {
+			gCoord		lines, y;
+
+			// Only the lines that move are copied. GDISP fills the rest.
+			lines = g->p.y1;
+			if (lines > 0) {
+				for(y = 0; y < g->p.cy - lines; y++)
+					memmove(&PIXEL(g, g->p.x, g->p.y + y), &PIXEL(g, g->p.x, g->p.y + y + lines), g->p.cx * sizeof(LLDCOLOR_TYPE));
+			} else {
+				for(y = g->p.cy - 1; y >= -lines; y--)
+					memmove(&PIXEL(g, g->p.x, g->p.y + y), &PIXEL(g, g->p.x, g->p.y + y + lines), g->p.cx * sizeof(LLDCOLOR_TYPE));
+			}
+
+			// A controller side copy - a source and a destination window
+			busSetup(g);
+			busSetup(g);
+		}
+	#endif
+
+	#if GDISP_NEED_CONTROL && GDISP_HARDWARE_CONTROL
+		LLDSPEC void gdisp_lld_control(GDisplay *g) {
+			simPriv		*priv;
+
+			if (g->p.x != GDISP_TESTSTUB_CONTROL_RESET)
+				return;
+
+			// The frame start must be reset with the totals it is taken from
+			priv = PRIV(g);
+			memset(&priv->bus, 0, sizeof(priv->bus));
+			memset(&priv->framestart, 0, sizeof(priv->framestart));
+		}
+	#endif
+
+	#if GDISP_NEED_QUERY && GDISP_HARDWARE_QUERY
+		LLDSPEC void *gdisp_lld_query(GDisplay *g) {
+			simPriv		*priv;
+
+			priv = PRIV(g);
+			switch(g->p.x) {
+			case GDISP_TESTSTUB_QUERY_BUS:
+				priv->bus.usecs = busUsecs(priv->bus.cycles);
+				return &priv->bus;
+			case GDISP_TESTSTUB_QUERY_FRAME:
+				return &priv->frame;
+			}
+			return 0;
+		}
+	#endif
+
+#else
+
+	#if GDISP_HARDWARE_DRAWPIXEL
+		void gdisp_lld_draw_pixel(GDisplay *g) {
+			(void) g;
+		}
+	#endif
+
+	#if GDISP_HARDWARE_PIXELREAD
+		gColor gdisp_lld_get_pixel_color(GDisplay *g) {
+			(void) g;
+			return 0;
+		}
+	#endif
+
 #endif
 
 #endif /* GFX_USE_GDISP */
@@ -10,6 +10,55 @@
 
 #if GFX_USE_GDISP
 
+/*===========================================================================*/
+/* Driver options.                                                           */
+/*===========================================================================*/
+
+// Simulate a controller on a bus rather than being a NULL driver. The display contents are kept in
+//	memory and the cost of each bus transaction is estimated from the settings below.
+#ifndef GDISP_TESTSTUB_SIMULATE
+	#define GDISP_TESTSTUB_SIMULATE		GFXOFF
+#endif
+
+#if GDISP_TESTSTUB_SIMULATE
+	// The bus clock in cycles per second and the number of bits moved per cycle (1 for SPI, 8 or 16 for a parallel bus)
+	#ifndef GDISP_TESTSTUB_BUSCLOCK
+		#define GDISP_TESTSTUB_BUSCLOCK		10000000
+	#endif
+	#ifndef GDISP_TESTSTUB_BUSWIDTH
+		#define GDISP_TESTSTUB_BUSWIDTH		8
+	#endif
+	// Extra bus cycles for each transaction (chip select, command/data line changes etc)
+	#ifndef GDISP_TESTSTUB_OVERHEAD
+		#define GDISP_TESTSTUB_OVERHEAD		2
+	#endif
+	// The bytes of commands needed to set a window and start a memory write or read (11 for an ILI9341)
+	#ifndef GDISP_TESTSTUB_SETUPBYTES
+		#define GDISP_TESTSTUB_SETUPBYTES	11
+	#endif
+	// The bytes sent for each pixel
+	#ifndef GDISP_TESTSTUB_PIXELBYTES
+		#define GDISP_TESTSTUB_PIXELBYTES	2
+	#endif
+	// What the simulated controller supports. Turn these off to see what GDISP does without them.
+	#ifndef GDISP_TESTSTUB_STREAM
+		#define GDISP_TESTSTUB_STREAM		GFXON
+	#endif
+	#ifndef GDISP_TESTSTUB_FILLS
+		#define GDISP_TESTSTUB_FILLS		GFXON
+	#endif
+	#ifndef GDISP_TESTSTUB_BITFILLS
+		#define GDISP_TESTSTUB_BITFILLS		GFXON
+	#endif
+	#ifndef GDISP_TESTSTUB_SCROLL
+		#define GDISP_TESTSTUB_SCROLL		GFXON		// A controller side copy costing two window setups
+	#endif
+	// Print the estimated bus time for each frame (each flush) to stdout
+	#ifndef GDISP_TESTSTUB_REPORT
+		#define GDISP_TESTSTUB_REPORT		GFXOFF
+	#endif
+#endif
+
 /*===========================================================================*/
 /* Driver hardware support.                                                  */
 /*===========================================================================*/
@@ -17,8 +66,61 @@
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 
+#if GDISP_TESTSTUB_SIMULATE
+	#define GDISP_HARDWARE_FLUSH			GFXON
+	#define GDISP_HARDWARE_QUERY			GFXON
+	#define GDISP_HARDWARE_CONTROL			GFXON
+	#if GDISP_TESTSTUB_STREAM
+		#define GDISP_HARDWARE_STREAM_WRITE		GFXON
+		#define GDISP_HARDWARE_STREAM_READ		GFXON
+		#define GDISP_HARDWARE_STREAM_POS		GFXON
+	#endif
+	#if GDISP_TESTSTUB_FILLS
+		#define GDISP_HARDWARE_FILLS			GFXON
+	#endif
+	#if GDISP_TESTSTUB_BITFILLS
+		#define GDISP_HARDWARE_BITFILLS			GFXON
+	#endif
+	#if GDISP_TESTSTUB_SCROLL
+		#define GDISP_HARDWARE_SCROLL			GFXON
+	#endif
+#endif
+
 #define GDISP_LLD_PIXELFORMAT			GDISP_PIXELFORMAT_RGB565
 
+/*===========================================================================*/
+/* Driver specific queries.                                                  */
+/*===========================================================================*/
+
+#if GDISP_TESTSTUB_SIMULATE
+	// gdispGQuery(g, GDISP_TESTSTUB_QUERY_BUS) returns a (gdispBusStats *) with the totals since the display started.
+	//	The counters are live. Use GDISP_TESTSTUB_CONTROL_RESET rather than changing them to restart them.
+	#define GDISP_TESTSTUB_QUERY_BUS		(GDISP_CONTROL_LLD+0)
+
+	// gdispGQuery(g, GDISP_TESTSTUB_QUERY_FRAME) returns a (gdispBusStats *) for the last frame.
+	//	A frame ends each time the display is flushed.
+	#define GDISP_TESTSTUB_QUERY_FRAME		(GDISP_CONTROL_LLD+1)
+
+	typedef struct gdispBusStats {
+		gU32	transactions;		// The number of bus transactions
+		gU32	setupBytes;			// The bytes of commands sent to set windows
+		gU32	writeBytes;			// The bytes of pixels written
+		gU32	readBytes;			// The bytes of pixels read
+		gU32	cycles;				// The estimated bus cycles for all of the above
+		gU32	usecs;				// The estimated bus time in microseconds (updated by the query)
+	} gdispBusStats;
+#endif
+
+/*===========================================================================*/
+/* Driver specific controls.                                                 */
+/*===========================================================================*/
+
+#if GDISP_TESTSTUB_SIMULATE
+	// gdispGControl(g, GDISP_TESTSTUB_CONTROL_RESET, 0) zeroes the bus totals and starts a new frame.
+	//	Other controls are ignored.
+	#define GDISP_TESTSTUB_CONTROL_RESET	(GDISP_CONTROL_LLD+0)
+#endif
+
 #endif	/* GFX_USE_GDISP */
 
 #endif	/* _GDISP_LLD_CONFIG_H */
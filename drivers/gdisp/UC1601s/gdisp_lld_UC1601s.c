@@ -23,6 +23,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_UC1601s
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_pages.h"
 
 #include "board_UC1601s.h"
 #include <string.h>   // for memset
@@ -53,7 +54,9 @@
 /*===========================================================================*/
 
 // Some common routines and macros
-#define RAM(g)                      		((gU8 *)g->priv)
+#define PRIV(g)                      		((UC1601s_Private *)g->priv)
+#define RAM(g)                      		(PRIV(g)->ram)
+#define DIRTY(g)                      		(PRIV(g)->dirty)
 
 #define xyaddr(x, y)		        		((x) + ((y) >> 3) * GDISP_SCREEN_WIDTH)
 #define xybit(y)			        		(1 << ((y) & 7))
@@ -67,19 +70,26 @@
 #define GDISP_SCREEN_BYTES          ((GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT) / 8)
 #define GDISP_SCREEN_PAGE_SIZE		8
 #define GDISP_SCREEN_PAGES			GDISP_SCREEN_HEIGHT / GDISP_SCREEN_PAGE_SIZE
+
+typedef struct UC1601s_Private {
+	gdispPageDirty	dirty[GDISP_SCREEN_PAGES];		// The columns of each page changed since the last flush
+	gU8				ram[GDISP_SCREEN_BYTES];		// The display surface
+} UC1601s_Private;
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
 
 LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
     
-	// The private area is the display surface.
-	if (!(g->priv = gfxAlloc(GDISP_SCREEN_BYTES)))
+	// The private area is the display surface and the record of what has changed on it.
+	if (!(g->priv = gfxAlloc(sizeof(UC1601s_Private))))
     {
 		gfxHalt("GDISP UC1601s: Failed to allocate private memory");
     }
     
     memset(RAM(g), 0, GDISP_SCREEN_BYTES);
+    gdispPagesClean(DIRTY(g), GDISP_SCREEN_PAGES);
 
 	// Initialise the board interface
 	init_board(g);
@@ -124,14 +134,19 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 
 		acquire_bus(g);
 
-		for (int i = 0; i < GDISP_SCREEN_PAGES; ++i)
+		// Only send the changed columns of the changed pages
+		gdispPageDirty *d = DIRTY(g);
+		for (int i = 0; i < GDISP_SCREEN_PAGES; ++i, ++d)
 		{
-   			write_cmd3(g, UC1601s_SET_PAGE | i, UC1601s_SET_COL_L | (0 & 0x0f), UC1601s_SET_COL_H | ((0 >> 4) & 0x0f)); // Y, XL, XH
-			write_data(g, RAM(g) + (i * GDISP_SCREEN_WIDTH), GDISP_SCREEN_WIDTH);
+			if (d->start >= d->end)
+				continue;
+   			write_cmd3(g, UC1601s_SET_PAGE | i, UC1601s_SET_COL_L | (d->start & 0x0f), UC1601s_SET_COL_H | ((d->start >> 4) & 0x0f)); // Y, XL, XH
+			write_data(g, RAM(g) + (i * GDISP_SCREEN_WIDTH) + d->start, d->end - d->start);
 		}
 
 		release_bus(g);
 
+		gdispPagesClean(DIRTY(g), GDISP_SCREEN_PAGES);
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
 #endif
@@ -170,6 +185,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		} else {
 			RAM(g)[xyaddr(x, y)] &= ~xybit(y);
 		}
+		gdispPagesMarkPixel(DIRTY(g), x, y);
 
 		g->flags |= GDISP_FLG_NEEDFLUSH;
 	}
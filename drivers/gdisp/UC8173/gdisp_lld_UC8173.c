@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_UC8173
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_epaper.h"
 
 #if defined(GDISP_SCREEN_HEIGHT) || defined(GDISP_SCREEN_HEIGHT)
 	#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
@@ -43,6 +44,9 @@ typedef struct UC8173Lut {
 #ifndef UC8173_DEFAULT_MODE
 	#define UC8173_DEFAULT_MODE		0
 #endif
+#ifndef UC8173_FULL_MODE
+	#define UC8173_FULL_MODE		UC8173_DEFAULT_MODE
+#endif
 #ifndef UC8173_USE_OTP_LUT
 	#define UC8173_USE_OTP_LUT		GFXOFF
 #endif
@@ -60,6 +64,10 @@ typedef struct UC8173Lut {
 #endif
 #define UC8173_HEIGHT				240
 #define UC8173_WIDTH				240
+// Each refresh takes the full waveform time whatever its size so by default changed areas are always merged
+#ifndef UC8173_WINDOW_OVERHEAD
+	#define UC8173_WINDOW_OVERHEAD	(UC8173_WIDTH*UC8173_HEIGHT)
+#endif
 
 /*------------------ Set FB parameters ------------------*/
 #define FB_REVERSEAXIS_Y			UC8173_REVERSEAXIS_Y
@@ -81,17 +89,9 @@ typedef struct UC8173Lut {
 #else
 	#define FB_COLOR(px, py, c)		((c) << (((px) & FB_AXIS_MASK)<<(LLDCOLOR_BITS-1)))
 #endif
-#define FB_FLUSH_REQUIRED(fbp)		((fbp)->fa0.x < (fbp)->fa1.x)
-#define FB_FLUSH_WIDTH(fbp)			((fbp)->fa1.x - (fbp)->fa0.x + 1)
-#define FB_FLUSH_HEIGHT(fbp)		((fbp)->fa1.y - (fbp)->fa0.y + 1)
-#define FB_FLUSH_ALL(fbp)			{ (fbp)->fa0.x = (fbp)->fa0.y = 0; (fbp)->fa1.x = FB_WIDTH-1; (fbp)->fa1.y = FB_HEIGHT-1; }
-#define FB_FLUSH_NONE(fbp)			{ (fbp)->fa0.x = FB_WIDTH; (fbp)->fa0.y = FB_HEIGHT; (fbp)->fa1.x = (fbp)->fa1.y = -1; }
-#define FB_FLUSH_POINT(fbp, px, py)	{											\
-			if ((px) < (fbp)->fa0.x) (fbp)->fa0.x = (px) & ~FB_AXIS_MASK;		\
-			if ((px) > (fbp)->fa1.x) (fbp)->fa1.x = (px) | FB_AXIS_MASK;		\
-			if ((py) < (fbp)->fa0.y) (fbp)->fa0.y = (py);						\
-			if ((py) > (fbp)->fa1.y) (fbp)->fa1.y = (py);						\
-		}
+#define FB_FLUSH_INIT(fbp)			gdispEpaperInit(&(fbp)->epd, FB_WIDTH, FB_HEIGHT, FB_TYPE_PIXELS, 1, UC8173_WINDOW_OVERHEAD)
+#define FB_FLUSH_ALL(fbp)			gdispEpaperDamageAll(&(fbp)->epd)
+#define FB_FLUSH_POINT(fbp, px, py)	gdispEpaperDamagePixel(&(fbp)->epd, (px), (py))
 #define FB_SETPIXEL(fbp, pg, px, py, c)	{										\
 			LLDCOLOR_TYPE	*p, oc;												\
 			p = FB_ADDR((fbp), (pg), (px), (py));								\
@@ -100,7 +100,7 @@ typedef struct UC8173Lut {
 		}
 
 typedef struct FBpriv {
-	gPoint			fa0, fa1;
+	gdispEpaper		epd;				// The areas waiting to be refreshed
 	LLDCOLOR_TYPE	fb[FB_PAGE_TYPES * FB_PAGES];
 	} FBpriv;
 
@@ -136,9 +136,9 @@ LLDSPEC gBool gdisp_lld_init(GDisplay* g)
 	priv = (UC8173_Private *)g->priv;
 
 	// Initialize the private area
-	// As the display is non-volatile we need to ensure a full flush on the first draw
+	// As the display is non-volatile the refresh scheduler starts with a full flush on the first draw
 	priv->lut = &UC8173_ModeTable[UC8173_DEFAULT_MODE];
-	FB_FLUSH_ALL(&priv->fb);
+	FB_FLUSH_INIT(&priv->fb);
 
 	// Initialise the board interface
 	if (!init_board(g))
@@ -307,73 +307,84 @@ LLDSPEC gBool gdisp_lld_init(GDisplay* g)
 }
 
 #if GDISP_HARDWARE_FLUSH
+	// Send a window as x, y, w-1, h-1
+	// Datasheet says x,y,w,h but in practice it needs to be x,y,w-1,h-1
+	static void send_window(GDisplay* g, const gdispEpaperWindow *w)
+	{
+		write_data(g, (gU8)((w->x0 >> 0) & 0xFF));
+		write_data(g, (gU8)((w->y0 >> 8) & 0x03));
+		write_data(g, (gU8)((w->y0 >> 0) & 0xFF));
+		write_data(g, (gU8)(((w->x1 - w->x0 - 1) >> 0) & 0xFF));
+		write_data(g, (gU8)(((w->y1 - w->y0 - 1) >> 8) & 0x03));
+		write_data(g, (gU8)(((w->y1 - w->y0 - 1) >> 0) & 0xFF));
+	}
+
 	LLDSPEC void gdisp_lld_flush(GDisplay* g)
 	{
-		gCoord 		cy, cx, dx, dy;
+		gCoord 		dx, dy;
 		LLDCOLOR_TYPE	*fb;
 		UC8173_Private	*priv;
+		UC8173Lut		*lut;
+		gdispEpaper		*epd;
+		const gdispEpaperWindow	*w;
+		static const gdispEpaperWindow	whole = { 0, 0, FB_WIDTH, FB_HEIGHT };
+		unsigned		n;
+		gU8				mode;
 
 		priv = (UC8173_Private *)g->priv;
+		epd = &priv->fb.epd;
 
-		if (!FB_FLUSH_REQUIRED(&priv->fb))
+		// Merge what has changed into refresh windows and pick the waveform
+		if ((mode = gdispEpaperPlan(epd)) == GDISP_EPAPER_NONE)
 			return;
+		lut = mode == GDISP_EPAPER_FULL ? &UC8173_ModeTable[UC8173_FULL_MODE] : priv->lut;
 
-		#if 0
-			FB_FLUSH_ALL(&priv->fb);
-		#endif
-		
 		// Acquire the bus to communicate with the display controller
 		acquire_bus(g);
 		
 		// Upload the new temperature LUT
 		write_cmd(g, LUT_KWVCOM);
-		write_data_burst(g, priv->lut->lutVCOM, 32);
+		write_data_burst(g, lut->lutVCOM, 32);
 		write_cmd(g, LUT_KW);
-		write_data_burst(g, priv->lut->lutFW, 512);
+		write_data_burst(g, lut->lutFW, 512);
 		write_cmd(g, LUT_FT);
-		write_data_burst(g, priv->lut->lutFT, 128);
+		write_data_burst(g, lut->lutFT, 128);
 
-		// Calculate the width, height
-		cx = FB_FLUSH_WIDTH(&priv->fb);
-		cy = FB_FLUSH_HEIGHT(&priv->fb);
-
-		// Setup the window
-		// Datasheet says x,y,w,h but in practice it needs to be x,y,w-1,h-1
-		write_cmd(g, DTMW);
-		write_data(g, (gU8)((priv->fb.fa0.x >> 0) & 0xFF));
-		write_data(g, (gU8)((priv->fb.fa0.y >> 8) & 0x03));
-		write_data(g, (gU8)((priv->fb.fa0.y >> 0) & 0xFF));
-		write_data(g, (gU8)(((cx-1) >> 0) & 0xFF));
-		write_data(g, (gU8)(((cy-1) >> 8) & 0x03));
-		write_data(g, (gU8)(((cy-1) >> 0) & 0xFF));
-
-		// Transfer the buffer
-		#if GDISP_LLD_PIXELFORMAT == GDISP_PIXELFORMAT_MONO
-			write_cmd(g, DTM4);
-		#elif  GDISP_LLD_PIXELFORMAT == GDISP_PIXELFORMAT_GRAY4
-			write_cmd(g, DTM2);
-		#else
-			#error "UC8173: Unsupported driver color format"
-		#endif
-		dx = (cx+FB_TYPE_PIXELS-1)/FB_TYPE_PIXELS * (LLDCOLOR_TYPE_BITS/8);
-		for (fb = FB_ADDR(&priv->fb, 0, priv->fb.fa0.x, priv->fb.fa0.y), dy = cy; dy; dy--, fb += FB_LINE_TYPES)
-			write_data_burst(g, (gU8 *)fb, dx);
+		// Transfer the changed windows of the buffer. The rest of the controller memory is already correct.
+		for (w = epd->win; w < epd->win + epd->nwin; w++) {
+			write_cmd(g, DTMW);
+			send_window(g, w);
+
+			#if GDISP_LLD_PIXELFORMAT == GDISP_PIXELFORMAT_MONO
+				write_cmd(g, DTM4);
+			#elif  GDISP_LLD_PIXELFORMAT == GDISP_PIXELFORMAT_GRAY4
+				write_cmd(g, DTM2);
+			#else
+				#error "UC8173: Unsupported driver color format"
+			#endif
+			dx = (w->x1 - w->x0 + FB_TYPE_PIXELS-1)/FB_TYPE_PIXELS * (LLDCOLOR_TYPE_BITS/8);
+			for (fb = FB_ADDR(&priv->fb, 0, w->x0, w->y0), dy = w->y1 - w->y0; dy; dy--, fb += FB_LINE_TYPES)
+				write_data_burst(g, (gU8 *)fb, dx);
+		}
 
 		// Power-up the DC/DC converter to update the display panel
 		write_cmd(g, PON);
 		while (!getpin_busy(g));
 
-		// Refresh the panel contents
-		// Datasheet says x,y,w,h but in practice it needs to be x,y,w-1,h-1
-		write_cmd(g, DRF);		// data: Partial Scan = 0x10, REGAL = 0x08, VCOM_DoNothing = 0x04 (GC4/A2 = 0x00, GU4 = 0x08)
-		write_data(g, (priv->lut->regal ? 0x08 : 0x00));
-		write_data(g, (gU8)((priv->fb.fa0.x >> 0) & 0xFF));
-		write_data(g, (gU8)((priv->fb.fa0.y >> 8) & 0x03));
-		write_data(g, (gU8)((priv->fb.fa0.y >> 0) & 0xFF));
-		write_data(g, (gU8)(((cx-1) >> 0) & 0xFF));
-		write_data(g, (gU8)(((cy-1) >> 8) & 0x03));
-		write_data(g, (gU8)(((cy-1) >> 0) & 0xFF));
-		while (!getpin_busy(g));
+		// Refresh the panel contents - either each window or the whole panel
+		if (mode == GDISP_EPAPER_FULL) {
+			w = &whole;
+			n = 1;
+		} else {
+			w = epd->win;
+			n = epd->nwin;
+		}
+		for (; n; n--, w++) {
+			write_cmd(g, DRF);		// data: Partial Scan = 0x10, REGAL = 0x08, VCOM_DoNothing = 0x04 (GC4/A2 = 0x00, GU4 = 0x08)
+			write_data(g, (lut->regal ? 0x08 : 0x00));
+			send_window(g, w);
+			while (!getpin_busy(g));
+		}
 
 		// Power-down the DC/DC converter
 		write_cmd(g, POF);
@@ -383,7 +394,7 @@ LLDSPEC gBool gdisp_lld_init(GDisplay* g)
 		release_bus(g);
 
 		// Mark as flushed
-		FB_FLUSH_NONE(&priv->fb);
+		gdispEpaperDone(epd, mode);
 	}
 #endif
 
@@ -488,6 +499,11 @@ LLDSPEC gBool gdisp_lld_init(GDisplay* g)
 				FB_FLUSH_ALL(&priv->fb);
 			}
 			break;
+
+		// Custom gdispControl() to make the next flush a full refresh to clear any ghosting
+		case GDISP_CONTROL_FULLREFRESH:
+			FB_FLUSH_ALL(&priv->fb);
+			break;
 		
 		// Custom gdispControl() to set which EINK Mode (waveform) to use
 		case GDISP_CONTROL_SETMODE:
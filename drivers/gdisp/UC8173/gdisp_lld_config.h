@@ -26,6 +26,7 @@
 #define GDISP_CONTROL_INVERT			(GDISP_CONTROL_LLD+0)
 #define GDISP_CONTROL_SETMODE			(GDISP_CONTROL_LLD+1)		/* Parameter: 0..n (as defined by the board file) */
 #define GDISP_CONTROL_SETBORDER			(GDISP_CONTROL_LLD+2)		/* Parameter: 0=Border Hi-Z, 1=Border Black, 2=Border White */
+#define GDISP_CONTROL_FULLREFRESH		(GDISP_CONTROL_LLD+3)		/* Make the next flush refresh the whole panel with the full waveform */
 
 #endif	/* GFX_USE_GDISP */
 
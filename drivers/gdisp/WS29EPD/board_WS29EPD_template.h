@@ -23,6 +23,12 @@ static GFXINLINE void setpin_reset(GDisplay *g, gBool state) {
   (void) state;
 }
 
+// Return gTrue while the BUSY pin says the controller is busy (eg. refreshing the panel)
+static GFXINLINE gBool getpin_busy(GDisplay *g) {
+	(void) g;
+	return gFalse;
+}
+
 static GFXINLINE void acquire_bus(GDisplay *g) {
 	(void) g;
 }
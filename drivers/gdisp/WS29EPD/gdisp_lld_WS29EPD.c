@@ -12,6 +12,7 @@
 #define GDISP_DRIVER_VMT			GDISPVMT_WS29EPD
 #include "gdisp_lld_config.h"
 #include "../../../src/gdisp/gdisp_driver.h"
+#include "../../../src/gdisp/gdisp_epaper.h"
 
 #include "board_WS29EPD.h"
 #include "WS29EPD.h"
@@ -32,6 +33,20 @@
   #define WS29EPD_PPB   8
 #endif
 
+/* The cost of sending one more window to the controller in pixels. Every update refreshes the whole panel
+ * so a window only costs the commands that set it up. */
+#ifndef WS29EPD_WINDOW_OVERHEAD
+  #define WS29EPD_WINDOW_OVERHEAD   128
+#endif
+
+typedef struct WS29EPD_Private {
+	gdispEpaper	epd;			// The areas waiting to be sent and the refresh scheduler
+	gU8			lutmode;		// Which LUT is loaded - GDISP_EPAPER_FULL or GDISP_EPAPER_PARTIAL
+	gU8			fb[(GDISP_SCREEN_WIDTH / WS29EPD_PPB) * GDISP_SCREEN_HEIGHT];
+} WS29EPD_Private;
+
+#define PRIV(g)		((WS29EPD_Private *)g->priv)
+
 /*===========================================================================*/
 /* Driver local variables.                                                   */
 /*===========================================================================*/
@@ -40,6 +55,7 @@
 gU8 GDOControl[]        = {(GDISP_SCREEN_HEIGHT-1)%256,(GDISP_SCREEN_HEIGHT-1)/256,0x00};
 gU8 softstart[]         = {0xd7,0xd6,0x9d};
 gU8 LUTDefault_full[]    = {0x02,0x02,0x01,0x11,0x12,0x12,0x22,0x22,0x66,0x69,0x69,0x59,0x58,0x99,0x99,0x88,0x00,0x00,0x00,0x00,0xF8,0xB4,0x13,0x51,0x35,0x51,0x51,0x19,0x01,0x00}; // Initialize the full display
+gU8 LUTDefault_part[]    = {0x10,0x18,0x18,0x08,0x18,0x18,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13,0x14,0x44,0x12,0x00,0x00,0x00,0x00,0x00,0x00}; // Fast partial update
 
 /*===========================================================================*/
 /* Driver local functions.                                                   */
@@ -54,10 +70,13 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	* And every x-line contains GDISP_SCREEN_HEIGHT y-values:
 	* [y=0; y=1; y=2; y=3; ...; y=GDISP_SCREEN_HEIGHT][y=0; y=1; y=2; y=3; ...; y=GDISP_SCREEN_HEIGHT]...
 	*
+	* The private area also holds the refresh scheduler. As the display is non-volatile it starts with a full refresh.
 	*/
-	g->priv = gfxAlloc((GDISP_SCREEN_WIDTH / WS29EPD_PPB) * GDISP_SCREEN_HEIGHT * sizeof(gU8));
+	g->priv = gfxAlloc(sizeof(WS29EPD_Private));
 	if (!g->priv)
 		return gFalse;
+	gdispEpaperInit(&PRIV(g)->epd, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, WS29EPD_PPB, 1, WS29EPD_WINDOW_OVERHEAD);
+	PRIV(g)->lutmode = GDISP_EPAPER_FULL;
 
 	/* Initialize the LL hardware. */
 	init_board(g);
@@ -186,34 +205,87 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
 	}
 	/* There is only black and no black (white). */
 	if (gdispColor2Native(g->p.color) != Black) // Indexing in the array is done as described in the init routine
-		((gU8 *)g->priv)[(GDISP_SCREEN_HEIGHT*(x/WS29EPD_PPB)) + y] |= (1 << (WS29EPD_PPB-1 - (x % WS29EPD_PPB)));
+		PRIV(g)->fb[(GDISP_SCREEN_HEIGHT*(x/WS29EPD_PPB)) + y] |= (1 << (WS29EPD_PPB-1 - (x % WS29EPD_PPB)));
 	else
-		((gU8 *)g->priv)[(GDISP_SCREEN_HEIGHT*(x/WS29EPD_PPB)) + y] &= ~(1 << (WS29EPD_PPB-1 - (x % WS29EPD_PPB)));
+		PRIV(g)->fb[(GDISP_SCREEN_HEIGHT*(x/WS29EPD_PPB)) + y] &= ~(1 << (WS29EPD_PPB-1 - (x % WS29EPD_PPB)));
+	gdispEpaperDamagePixel(&PRIV(g)->epd, x, y);
 }
 #endif
 
 #if GDISP_HARDWARE_FLUSH
+/* Wait for the controller to finish what it is doing (eg. refreshing the panel). */
+static void wait_busy(GDisplay *g) {
+	while(getpin_busy(g))
+		gfxSleepMilliseconds(1);
+}
+
+/* Write the changed windows of the frame buffer to the controller ram. */
+static void write_windows(GDisplay *g) {
+	gdispEpaperWindow	*w;
+	gU8					dataX[2];
+	gU8					dataY[4];
+
+	for(w = PRIV(g)->epd.win; w < PRIV(g)->epd.win + PRIV(g)->epd.nwin; w++) {
+		dataX[0] = w->x0 / WS29EPD_PPB;
+		dataX[1] = (w->x1 - 1) / WS29EPD_PPB;
+		dataY[0] = w->y0 % 256;  // Y-data is 9-bits so send in two bytes
+		dataY[1] = w->y0 / 256;
+		dataY[2] = (w->y1 - 1) % 256;
+		dataY[3] = (w->y1 - 1) / 256;
+		write_reg_data(g, SET_RAM_X_ADR, dataX, 2);
+		write_reg_data(g, SET_RAM_Y_ADR, dataY, 4);
+		write_reg(g, SET_RAM_X_CNT, dataX[0]);
+		write_reg_data(g, SET_RAM_Y_CNT, dataY, 2);
+
+		/* Start writing frame buffer to ram. */
+		write_cmd(g, WRITE_RAM);
+		for(int i = w->y0; i < w->y1; i++)
+			for(int j = dataX[0]; j <= dataX[1]; j++)
+				write_data(g, PRIV(g)->fb[(GDISP_SCREEN_HEIGHT*j) + i]);
+	}
+}
+
 LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+	gU8		mode;
+
+	/* Nothing to do if nothing has changed. */
+	if ((mode = gdispEpaperPlan(&PRIV(g)->epd)) == GDISP_EPAPER_NONE)
+		return;
+
 	acquire_bus(g);
-	
-	/* Start writing frame buffer to ram. */
-	write_cmd(g, WRITE_RAM);
-	
-	for(int i=0; i<GDISP_SCREEN_HEIGHT; i++)
-		for(int j=0; j<=((GDISP_SCREEN_WIDTH-1)/8); j++)
-			write_data(g, ((gU8 *)g->priv)[(GDISP_SCREEN_HEIGHT*j) + i]);
-		
+
+	/* Load the waveform for the update if it isn't already. */
+	if (PRIV(g)->lutmode != mode) {
+		write_reg_data(g, WRITE_LUT_REG, mode == GDISP_EPAPER_FULL ? LUTDefault_full : LUTDefault_part, sizeof(LUTDefault_full)/sizeof(LUTDefault_full[0]));
+		PRIV(g)->lutmode = mode;
+	}
+
+	/* Only the changed windows are written. */
+	write_windows(g);
+
 	/* Update the screen. */
-	write_reg(g, DISPLAY_UPDATE_CTRL2, 0xc7);  // Full update (partial hasn't been implemented yet)
+	write_reg(g, DISPLAY_UPDATE_CTRL2, 0xc7);
 	write_cmd(g, MASTER_ACTIVATION);
 	write_cmd(g, NOP);
+
+	/* The controller has two ram areas and swaps them on each update. The partial waveform
+	 * compares them, so write the windows again to bring the other area up to date too.
+	 * That must wait until the panel has finished refreshing. */
+	wait_busy(g);
+	write_windows(g);
 	release_bus(g);
+
+	gdispEpaperDone(&PRIV(g)->epd, mode);
 }
 #endif
 
 #if GDISP_NEED_CONTROL && GDISP_HARDWARE_CONTROL
 LLDSPEC void gdisp_lld_control(GDisplay *g) {
 	switch(g->p.x) {
+	case GDISP_CONTROL_FULLREFRESH:
+		gdispEpaperDamageAll(&PRIV(g)->epd);
+		return;
+
 	case GDISP_CONTROL_POWER:
 		if (g->g.Powermode == (gPowermode)g->p.ptr)
 			return;
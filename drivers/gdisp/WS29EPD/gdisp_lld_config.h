@@ -17,6 +17,8 @@
 
 #define GDISP_LLD_PIXELFORMAT           GDISP_PIXELFORMAT_MONO
 
+#define GDISP_CONTROL_FULLREFRESH       (GDISP_CONTROL_LLD+0)   // Make the next flush refresh the whole panel with the full waveform
+
 #endif
 
 #endif
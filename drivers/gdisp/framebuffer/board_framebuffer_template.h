@@ -13,6 +13,9 @@
 // Uncomment this if your frame buffer device requires flushing
 //#define GDISP_HARDWARE_FLUSH		GFXON
 
+// Uncomment this if you want board_damage() to be told which framebuffer areas have changed
+//#define GDISP_FRAMEBUFFER_DAMAGE	GFXON
+
 #ifdef GDISP_DRIVER_VMT
 
 	static void board_init(GDisplay *g, fbInfo *fbi) {
@@ -25,6 +28,11 @@
 		g->g.Contrast = 50;
 		fbi->linelen = g->g.Width * sizeof(LLDCOLOR_TYPE);				// bytes per row
 		fbi->pixels = 0;												// pointer to the memory frame buffer
+
+		// Optionally hand large fills and blits to a 2D engine (eg. gdispAccelSoftwareCreate() or a hardware one)
+		#if GDISP_NEED_ACCEL
+			g->accel = 0;
+		#endif
 	}
 
 	#if GDISP_HARDWARE_FLUSH
@@ -34,6 +42,17 @@
 		}
 	#endif
 
+	#if GDISP_FRAMEBUFFER_DAMAGE
+		static void board_damage(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+			// TODO: Remember the changed area. It is in framebuffer coordinates (not rotated by the orientation).
+			(void) g;
+			(void) x;
+			(void) y;
+			(void) cx;
+			(void) cy;
+		}
+	#endif
+
 	#if GDISP_NEED_CONTROL
 		static void board_backlight(GDisplay *g, gU8 percent) {
 			// TODO: Can be an empty function if your hardware doesn't support this
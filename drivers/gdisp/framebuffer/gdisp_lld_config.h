@@ -15,6 +15,9 @@
 /*===========================================================================*/
 
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
+#define GDISP_HARDWARE_FILLS			GFXON
+#define GDISP_HARDWARE_BITFILLS			GFXON
+#define GDISP_HARDWARE_SCROLL			GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
 
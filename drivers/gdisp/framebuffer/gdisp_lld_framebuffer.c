@@ -20,6 +20,26 @@ typedef struct fbInfo {
 
 #include "board_framebuffer.h"
 
+#include <string.h>			// for memcpy() etc
+
+// The board can ask to be told which areas of the framebuffer have changed (eg. to copy a shadow buffer
+//	to the real device on flush). The area passed to board_damage() is in framebuffer (not display) coordinates.
+#ifndef GDISP_FRAMEBUFFER_DAMAGE
+	#define GDISP_FRAMEBUFFER_DAMAGE		GFXOFF
+#endif
+#if GDISP_FRAMEBUFFER_DAMAGE
+	#define FB_DAMAGE(g, px, py, pcx, pcy)	board_damage(g, px, py, pcx, pcy)
+#else
+	#define FB_DAMAGE(g, px, py, pcx, pcy)
+#endif
+
+// With an accelerator the CPU must wait for it before touching the framebuffer
+#if GDISP_NEED_ACCEL
+	#define FB_SYNC(g)						gdispGAccelSync(g)
+#else
+	#define FB_SYNC(g)
+#endif
+
 typedef struct fbPriv {
 	fbInfo			fbi;			// Display information
 	} fbPriv;
@@ -30,6 +50,71 @@ typedef struct fbPriv {
 
 #define PIXIL_POS(g, x, y)		((y) * ((fbPriv *)(g)->priv)->fbi.linelen + (x) * sizeof(LLDCOLOR_TYPE))
 #define PIXEL_ADDR(g, pos)		((LLDCOLOR_TYPE *)(((char *)((fbPriv *)(g)->priv)->fbi.pixels)+pos))
+#define LINE_LEN(g)				(((fbPriv *)(g)->priv)->fbi.linelen)
+
+// Convert a display area into the matching physical framebuffer rectangle
+#if GDISP_NEED_CONTROL
+	static void phys_rect(GDisplay *g, gCoord *px, gCoord *py, gCoord *pcx, gCoord *pcy) {
+		switch(g->g.Orientation) {
+		case gOrientation0:
+		default:
+			*px = g->p.x;							*py = g->p.y;
+			*pcx = g->p.cx;							*pcy = g->p.cy;
+			break;
+		case gOrientation90:
+			*px = g->p.y;							*py = g->g.Width-g->p.x-g->p.cx;
+			*pcx = g->p.cy;							*pcy = g->p.cx;
+			break;
+		case gOrientation180:
+			*px = g->g.Width-g->p.x-g->p.cx;		*py = g->g.Height-g->p.y-g->p.cy;
+			*pcx = g->p.cx;							*pcy = g->p.cy;
+			break;
+		case gOrientation270:
+			*px = g->g.Height-g->p.y-g->p.cy;		*py = g->p.x;
+			*pcx = g->p.cy;							*pcy = g->p.cx;
+			break;
+		}
+	}
+#else
+	#define phys_rect(g, px, py, pcx, pcy)	{ *(px) = g->p.x; *(py) = g->p.y; *(pcx) = g->p.cx; *(pcy) = g->p.cy; }
+#endif
+
+// Fill a single row of pixels
+static GFXINLINE void row_fill(LLDCOLOR_TYPE *dst, LLDCOLOR_TYPE c, gCoord cx) {
+	#if LLDCOLOR_TYPE_BITS == 8
+		memset(dst, c, cx);
+	#else
+		// Unrolled by 4 as most rows are long
+		for(; cx >= 4; cx -= 4, dst += 4) {
+			dst[0] = c; dst[1] = c; dst[2] = c; dst[3] = c;
+		}
+		for(; cx; cx--)
+			*dst++ = c;
+	#endif
+}
+
+// Copy a row of source pixels to the framebuffer moving forwards
+static GFXINLINE void row_copy(LLDCOLOR_TYPE *dst, const gPixel *src, gCoord cx) {
+	#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+		memcpy(dst, src, cx * sizeof(LLDCOLOR_TYPE));
+	#else
+		for(; cx; cx--, src++)
+			*dst++ = gdispColor2Native(*src);
+	#endif
+}
+
+// Copy a row of source pixels to the framebuffer moving backwards (180 degrees)
+static GFXINLINE void row_copy_reverse(LLDCOLOR_TYPE *dst, const gPixel *src, gCoord cx) {
+	for(; cx; cx--, src++)
+		*dst-- = gdispColor2Native(*src);
+}
+
+// Copy a row of source pixels to a column of the framebuffer (90 and 270 degrees).
+//	The step is in bytes and may be negative.
+static GFXINLINE void row_copy_column(char *dst, const gPixel *src, gCoord cx, gCoord step) {
+	for(; cx; cx--, dst += step, src++)
+		*(LLDCOLOR_TYPE *)dst = gdispColor2Native(*src);
+}
 
 /*===========================================================================*/
 /* Driver exported functions.                                                */
@@ -49,41 +134,181 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	g->board = 0;							// preinitialize
 	board_init(g, &((fbPriv *)g->priv)->fbi);
 
+	// Describe the framebuffer so it can be drawn on by an accelerator
+	#if GDISP_NEED_ACCEL
+		g->surface.pixels = ((fbPriv *)g->priv)->fbi.pixels;
+		g->surface.width = g->g.Width;
+		g->surface.height = g->g.Height;
+		g->surface.linelen = ((fbPriv *)g->priv)->fbi.linelen;
+		g->surface.format = GDISP_LLD_PIXELFORMAT;
+	#endif
+
 	return gTrue;
 }
 
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		FB_SYNC(g);
 		board_flush(g);
 	}
 #endif
 
 LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
-	unsigned	pos;
+	gCoord		px, py;
 
 	#if GDISP_NEED_CONTROL
 		switch(g->g.Orientation) {
 		case gOrientation0:
 		default:
-			pos = PIXIL_POS(g, g->p.x, g->p.y);
+			px = g->p.x;				py = g->p.y;
 			break;
 		case gOrientation90:
-			pos = PIXIL_POS(g, g->p.y, g->g.Width-g->p.x-1);
+			px = g->p.y;				py = g->g.Width-g->p.x-1;
 			break;
 		case gOrientation180:
-			pos = PIXIL_POS(g, g->g.Width-g->p.x-1, g->g.Height-g->p.y-1);
+			px = g->g.Width-g->p.x-1;	py = g->g.Height-g->p.y-1;
 			break;
 		case gOrientation270:
-			pos = PIXIL_POS(g, g->g.Height-g->p.y-1, g->p.x);
+			px = g->g.Height-g->p.y-1;	py = g->p.x;
 			break;
 		}
 	#else
-		pos = PIXIL_POS(g, g->p.x, g->p.y);
+		px = g->p.x;
+		py = g->p.y;
 	#endif
 
-		PIXEL_ADDR(g, pos)[0] = gdispColor2Native(g->p.color);
+	FB_SYNC(g);
+	PIXEL_ADDR(g, PIXIL_POS(g, px, py))[0] = gdispColor2Native(g->p.color);
+	FB_DAMAGE(g, px, py, 1, 1);
 }
 
+LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
+	gCoord			px, py, pcx, pcy;
+	LLDCOLOR_TYPE	c, *row;
+
+	phys_rect(g, &px, &py, &pcx, &pcy);
+	FB_DAMAGE(g, px, py, pcx, pcy);
+
+	// Large fills go to the accelerator and we don't wait for them
+	#if GDISP_NEED_ACCEL
+		if (_gdispAccelFill(g, px, py, pcx, pcy, g->p.color))
+			return;
+		FB_SYNC(g);
+	#endif
+
+	c = gdispColor2Native(g->p.color);
+	row = PIXEL_ADDR(g, PIXIL_POS(g, px, py));
+
+	// Fill the first row and then copy it to the others - memcpy() is faster than any loop we can write
+	row_fill(row, c, pcx);
+	if (pcx >= 8) {
+		for(pcy--; pcy; pcy--) {
+			memcpy((char *)row + LINE_LEN(g), row, pcx * sizeof(LLDCOLOR_TYPE));
+			row = (LLDCOLOR_TYPE *)((char *)row + LINE_LEN(g));
+		}
+	} else {
+		for(pcy--; pcy; pcy--) {
+			row = (LLDCOLOR_TYPE *)((char *)row + LINE_LEN(g));
+			row_fill(row, c, pcx);
+		}
+	}
+}
+
+LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+	const gPixel	*src;
+	gCoord			y;
+
+	src = (const gPixel *)g->p.ptr + g->p.y1 * g->p.x2 + g->p.x1;
+
+	#if GDISP_FRAMEBUFFER_DAMAGE
+		{
+			gCoord	px, py, pcx, pcy;
+
+			phys_rect(g, &px, &py, &pcx, &pcy);
+			FB_DAMAGE(g, px, py, pcx, pcy);
+		}
+	#endif
+
+	// The accelerator copies and converts rows but can't rotate them
+	#if GDISP_NEED_ACCEL
+		if (g->g.Orientation == gOrientation0 && _gdispAccelBlit(g, g->p.x, g->p.y, g->p.cx, g->p.cy, (const gPixel *)g->p.ptr, g->p.x1, g->p.y1, g->p.x2))
+			return;
+		FB_SYNC(g);
+	#endif
+
+	#if GDISP_NEED_CONTROL
+		switch(g->g.Orientation) {
+		case gOrientation0:
+		default:
+			break;
+		case gOrientation90:
+			// Each source row becomes a framebuffer column moving up
+			for(y = 0; y < g->p.cy; y++, src += g->p.x2)
+				row_copy_column((char *)PIXEL_ADDR(g, PIXIL_POS(g, g->p.y+y, g->g.Width-g->p.x-1)), src, g->p.cx, -LINE_LEN(g));
+			return;
+		case gOrientation180:
+			for(y = 0; y < g->p.cy; y++, src += g->p.x2)
+				row_copy_reverse(PIXEL_ADDR(g, PIXIL_POS(g, g->g.Width-g->p.x-1, g->g.Height-g->p.y-y-1)), src, g->p.cx);
+			return;
+		case gOrientation270:
+			// Each source row becomes a framebuffer column moving down
+			for(y = 0; y < g->p.cy; y++, src += g->p.x2)
+				row_copy_column((char *)PIXEL_ADDR(g, PIXIL_POS(g, g->g.Height-g->p.y-y-1, g->p.x)), src, g->p.cx, LINE_LEN(g));
+			return;
+		}
+	#endif
+
+	for(y = 0; y < g->p.cy; y++, src += g->p.x2)
+		row_copy(PIXEL_ADDR(g, PIXIL_POS(g, g->p.x, g->p.y+y)), src, g->p.cx);
+}
+
+#if GDISP_NEED_SCROLL
+	LLDSPEC void gdisp_lld_vertical_scroll(GDisplay *g) {
+		gCoord		px, py, pcx, pcy, lines, i;
+		char		*row;
+
+		phys_rect(g, &px, &py, &pcx, &pcy);
+		FB_DAMAGE(g, px, py, pcx, pcy);
+		FB_SYNC(g);
+		lines = g->p.y1;
+
+		#if GDISP_NEED_CONTROL
+			switch(g->g.Orientation) {
+			case gOrientation0:
+			default:
+				break;
+			case gOrientation180:
+				lines = -lines;
+				break;
+			case gOrientation90:
+			case gOrientation270:
+				// Display lines are framebuffer columns so move the pixels along each framebuffer row
+				if (g->g.Orientation == gOrientation270)
+					lines = -lines;
+				row = (char *)PIXEL_ADDR(g, PIXIL_POS(g, px, py));
+				for(i = 0; i < pcy; i++, row += LINE_LEN(g)) {
+					if (lines > 0)
+						memmove(row, row + lines * sizeof(LLDCOLOR_TYPE), (pcx - lines) * sizeof(LLDCOLOR_TYPE));
+					else
+						memmove(row - lines * sizeof(LLDCOLOR_TYPE), row, (pcx + lines) * sizeof(LLDCOLOR_TYPE));
+				}
+				return;
+			}
+		#endif
+
+		// Display lines are framebuffer rows so move whole rows
+		if (lines > 0) {
+			row = (char *)PIXEL_ADDR(g, PIXIL_POS(g, px, py));
+			for(i = lines; i < pcy; i++, row += LINE_LEN(g))
+				memcpy(row, row + lines * LINE_LEN(g), pcx * sizeof(LLDCOLOR_TYPE));
+		} else {
+			row = (char *)PIXEL_ADDR(g, PIXIL_POS(g, px, py+pcy-1));
+			for(i = -lines; i < pcy; i++, row -= LINE_LEN(g))
+				memcpy(row, row + lines * LINE_LEN(g), pcx * sizeof(LLDCOLOR_TYPE));
+		}
+	}
+#endif
+
 LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
 	unsigned		pos;
 	LLDCOLOR_TYPE	color;
@@ -108,6 +333,7 @@ LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
 		pos = PIXIL_POS(g, g->p.x, g->p.y);
 	#endif
 
+	FB_SYNC(g);
 	color = PIXEL_ADDR(g, pos)[0];
 	return gdispNative2Color(color);
 }
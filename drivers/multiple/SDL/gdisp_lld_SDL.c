@@ -33,6 +33,20 @@
 #ifndef GDISP_SCREEN_HEIGHT
 	#define GDISP_SCREEN_HEIGHT			480
 #endif
+#ifndef GDISP_SDL_FRAME_PERIOD
+	/**
+	 * The minimum time (in milliseconds) between presenting frames to the SDL window.
+	 * Drawing is never slowed down by this, changes are just collected until the next frame.
+	 */
+	#define GDISP_SDL_FRAME_PERIOD		20
+#endif
+#ifndef GDISP_SDL_DAMAGE_RECTS
+	/**
+	 * How many separate changed rectangles are remembered between frames.
+	 * When there are more than this they are merged.
+	 */
+	#define GDISP_SDL_DAMAGE_RECTS		8
+#endif
 
 #if GINPUT_NEED_MOUSE
 	// Include mouse support code
@@ -158,8 +172,8 @@
 // shared IPC context
 struct SDL_UGFXContext {
 	gU32 	framebuf[GDISP_SCREEN_WIDTH*GDISP_SCREEN_HEIGHT];
-	gI16		need_redraw;
-	int		minx,miny,maxx,maxy;
+	int		ndamage;
+	SDL_Rect	damage[GDISP_SDL_DAMAGE_RECTS];
 #if GINPUT_NEED_MOUSE
 	gCoord 	mousex, mousey;
 	gU16 	buttons;
@@ -180,25 +194,37 @@ static sem_t *input_event;
 
 static int SDL_loop (void) {
 	SDL_Window   *window = SDL_CreateWindow("uGFX", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, 0);
-	SDL_Renderer *render = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-	SDL_Texture  *texture = SDL_CreateTexture(render, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT);
+	SDL_Renderer *render = 0;
+	SDL_Texture  *texture = 0;
+	SDL_Rect	damage[GDISP_SDL_DAMAGE_RECTS];
+	Uint32		next, now;
+	int			i, ndamage;
 	int done = 0;
 
+	// Headless video drivers (dummy, offscreen) may only have the software renderer
+	if (window) {
+		if (!(render = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC)))
+			render = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+	}
+	if (render)
+		texture = SDL_CreateTexture(render, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT);
+	if (!texture)
+		fprintf(stderr, "SDL: Unable to create a texture (%s). Running without a display.\n", SDL_GetError());
+
+	next = SDL_GetTicks();
 	while  (!done) {
-		
-		if (context->need_redraw) {
-			context->need_redraw = 0;
-			SDL_Rect r;
-			r.x = context->minx;
-			r.y = context->miny;
-			r.w = context->maxx - context->minx + 1;
-			r.h = context->maxy - context->miny + 1;
-			context->minx = GDISP_SCREEN_WIDTH;
-			context->miny = GDISP_SCREEN_HEIGHT;
-			context->maxx = 0;
-			context->maxy = 0;
-			
-			SDL_UpdateTexture(texture, &r, context->framebuf+r.y*GDISP_SCREEN_WIDTH+r.x, GDISP_SCREEN_WIDTH*sizeof(gU32));
+
+		// Take the list of changed areas
+		sem_wait (ctx_mutex);
+		ndamage = context->ndamage;
+		memcpy (damage, context->damage, ndamage * sizeof(SDL_Rect));
+		context->ndamage = 0;
+		sem_post (ctx_mutex);
+
+		// Upload just those areas and present
+		if (ndamage && texture) {
+			for (i = 0; i < ndamage; i++)
+				SDL_UpdateTexture(texture, &damage[i], context->framebuf+damage[i].y*GDISP_SCREEN_WIDTH+damage[i].x, GDISP_SCREEN_WIDTH*sizeof(gU32));
 			SDL_RenderCopy(render, texture, 0, 0);
 			SDL_RenderPresent(render);
 		}
@@ -282,12 +308,22 @@ static int SDL_loop (void) {
 				break;
 			}
 		}
-		SDL_Delay(40);
+
+		// Wait for the next frame
+		next += GDISP_SDL_FRAME_PERIOD;
+		now = SDL_GetTicks();
+		if ((Sint32)(next - now) > 0)
+			SDL_Delay(next - now);
+		else
+			next = now;
 	}
-	
-	SDL_DestroyTexture (texture);
-	SDL_DestroyRenderer (render);
-	SDL_DestroyWindow (window);
+
+	if (texture)
+		SDL_DestroyTexture (texture);
+	if (render)
+		SDL_DestroyRenderer (render);
+	if (window)
+		SDL_DestroyWindow (window);
     return 0;
 }
 
@@ -321,6 +357,14 @@ void sdl_driver_init (void) {
 		exit(1);
 	}
 
+	// The whole window needs drawing initially. This must be set up before the ugfx process starts drawing.
+	memset (context,0,sizeof (*context));
+	context->ndamage = 1;
+	context->damage[0].x = 0;
+	context->damage[0].y = 0;
+	context->damage[0].w = GDISP_SCREEN_WIDTH;
+	context->damage[0].h = GDISP_SCREEN_HEIGHT;
+
 	// Create mutex for locking shared context
 	sem_unlink (CTX_MUTEX_NAME);
 	if((ctx_mutex = sem_open(CTX_MUTEX_NAME,O_CREAT,0666,1)) == SEM_FAILED) {
@@ -339,12 +383,6 @@ void sdl_driver_init (void) {
 	if (gui_pid) {
 		// Main proccess. It's for host UI and SDL
 		int status;
-		memset (context,0,sizeof (*context));
-		context->need_redraw = 1;
-		context->maxx = GDISP_SCREEN_WIDTH-1;
-		context->maxy = GDISP_SCREEN_HEIGHT-1;
-		context->minx = 0;
-		context->miny = 0;
 		SDL_loop ();
 		// cleanup
 		kill(gui_pid,SIGKILL);
@@ -384,23 +422,60 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 }
 
 
-static void SDL_extendUpdateRect (int x,int y) {
-	if (context->minx > x)
-		context->minx = x;
-	if (context->miny > y)
-		context->miny = y;
-	if (context->maxx < x)
-		context->maxx = x;
-	if (context->maxy < y)
-		context->maxy = y;
+// Record a changed area for the SDL process to upload on its next frame
+static void SDL_damage (int x, int y, int cx, int cy) {
+	SDL_Rect	*r;
+	int			i, best, area, bestarea;
+	int			x0, y0, x1, y1;
+
+	sem_wait (ctx_mutex);
+	best = -1;
+	bestarea = 0;
+	for (i = 0, r = context->damage; i < context->ndamage; i++, r++) {
+		x0 = r->x < x ? r->x : x;
+		y0 = r->y < y ? r->y : y;
+		x1 = r->x+r->w > x+cx ? r->x+r->w : x+cx;
+		y1 = r->y+r->h > y+cy ? r->y+r->h : y+cy;
+
+		// Merge with a rectangle it overlaps or touches
+		if (x <= r->x+r->w && x+cx >= r->x && y <= r->y+r->h && y+cy >= r->y)
+			break;
+
+		// Otherwise remember which rectangle would grow the least
+		area = (x1-x0)*(y1-y0) - r->w*r->h;
+		if (best < 0 || area < bestarea) {
+			best = i;
+			bestarea = area;
+		}
+	}
+	if (i >= context->ndamage) {
+		if (context->ndamage < GDISP_SDL_DAMAGE_RECTS) {
+			r = context->damage + context->ndamage++;
+			r->x = x;
+			r->y = y;
+			r->w = cx;
+			r->h = cy;
+			sem_post (ctx_mutex);
+			return;
+		}
+		r = context->damage + best;
+		x0 = r->x < x ? r->x : x;
+		y0 = r->y < y ? r->y : y;
+		x1 = r->x+r->w > x+cx ? r->x+r->w : x+cx;
+		y1 = r->y+r->h > y+cy ? r->y+r->h : y+cy;
+	}
+	r->x = x0;
+	r->y = y0;
+	r->w = x1 - x0;
+	r->h = y1 - y0;
+	sem_post (ctx_mutex);
 }
 
 LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 {
 	if (context) {
 		context->framebuf[(g->p.y*GDISP_SCREEN_WIDTH)+g->p.x] = gdispColor2Native(g->p.color);
-		SDL_extendUpdateRect (g->p.x,g->p.y);
-		context->need_redraw = 1;
+		SDL_damage (g->p.x, g->p.y, 1, 1);
 	}
 }
 
@@ -410,18 +485,61 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 		if (context) {
 			int x,y;
 			gU32 *pbuf = context->framebuf + g->p.y*GDISP_SCREEN_WIDTH + g->p.x;
-			int dy = GDISP_SCREEN_WIDTH - g->p.cx;
-			for (y = 0; y < g->p.cy; ++y) {
-				for (x = 0; x < g->p.cx; ++x)
-					*pbuf++ = c;
-				pbuf += dy;
+
+			// Fill the first line and then copy it
+			for (x = 0; x < g->p.cx; ++x)
+				pbuf[x] = c;
+			for (y = 1; y < g->p.cy; ++y)
+				memcpy (pbuf + y*GDISP_SCREEN_WIDTH, pbuf, g->p.cx * sizeof(gU32));
+			SDL_damage (g->p.x, g->p.y, g->p.cx, g->p.cy);
+		}
+	}
+#endif
+
+#if GDISP_HARDWARE_BITFILLS
+	LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+		if (context) {
+			const gPixel *src = (const gPixel *)g->p.ptr + g->p.y1 * g->p.x2 + g->p.x1;
+			gU32 *pbuf = context->framebuf + g->p.y*GDISP_SCREEN_WIDTH + g->p.x;
+			int y;
+
+			for (y = 0; y < g->p.cy; ++y, pbuf += GDISP_SCREEN_WIDTH, src += g->p.x2) {
+				#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+					memcpy (pbuf, src, g->p.cx * sizeof(gU32));
+				#else
+					int x;
+					for (x = 0; x < g->p.cx; ++x)
+						pbuf[x] = gdispColor2Native(src[x]);
+				#endif
 			}
-			SDL_extendUpdateRect (g->p.x,g->p.y);
-			SDL_extendUpdateRect (g->p.x+g->p.cx-1,g->p.y+g->p.cy-1);
-			context->need_redraw = 1;
+			SDL_damage (g->p.x, g->p.y, g->p.cx, g->p.cy);
 		}
 	}
+#endif
+
+#if GDISP_HARDWARE_STREAM_READ
+	// There is only ever one SDL display so the read position can be kept here
+	static int	readx, ready;
+
+	LLDSPEC void gdisp_lld_read_start(GDisplay *g) {
+		readx = g->p.x;
+		ready = g->p.y;
+	}
+	LLDSPEC	gColor gdisp_lld_read_color(GDisplay *g) {
+		gU32	c;
 
+		if (!context)
+			return 0;
+		c = context->framebuf[ready*GDISP_SCREEN_WIDTH + readx];
+		if (++readx >= g->p.x + g->p.cx) {
+			readx = g->p.x;
+			ready++;
+		}
+		return gdispNative2Color(c);
+	}
+	LLDSPEC void gdisp_lld_read_stop(GDisplay *g) {
+		(void) g;
+	}
 #endif
 
 #if GDISP_HARDWARE_PIXELREAD
@@ -432,6 +550,26 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 	}
 #endif
 
+#if GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL
+	LLDSPEC void gdisp_lld_vertical_scroll(GDisplay *g) {
+		if (context) {
+			gU32 *pbuf = context->framebuf + g->p.y*GDISP_SCREEN_WIDTH + g->p.x;
+			int lines = g->p.y1;
+			int y;
+
+			// The area left behind is cleared by the high level code
+			if (lines > 0) {
+				for (y = 0; y < g->p.cy - lines; ++y)
+					memcpy (pbuf + y*GDISP_SCREEN_WIDTH, pbuf + (y+lines)*GDISP_SCREEN_WIDTH, g->p.cx * sizeof(gU32));
+			} else {
+				for (y = g->p.cy-1; y >= -lines; --y)
+					memcpy (pbuf + y*GDISP_SCREEN_WIDTH, pbuf + (y+lines)*GDISP_SCREEN_WIDTH, g->p.cx * sizeof(gU32));
+			}
+			SDL_damage (g->p.x, g->p.y, g->p.cx, g->p.cy);
+		}
+	}
+#endif
+
 #if GINPUT_NEED_MOUSE
 	static gBool SDL_MouseInit(GMouse *m, unsigned driverinstance) {
 		mouse = m;
@@ -14,8 +14,9 @@
 
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
 #define GDISP_HARDWARE_FILLS			GFXON
-#define GDISP_HARDWARE_BITFILLS			GFXOFF
-#define GDISP_HARDWARE_SCROLL			GFXOFF
+#define GDISP_HARDWARE_BITFILLS			GFXON
+#define GDISP_HARDWARE_SCROLL			GFXON
+#define GDISP_HARDWARE_STREAM_READ		GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXOFF
 
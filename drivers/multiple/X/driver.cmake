@@ -10,5 +10,6 @@ list(APPEND ugfx_SOURCES
 
 list(APPEND ugfx_LIBS
 	X11
+	Xext
 )
 
@@ -1,3 +1,3 @@
 GFXINC += $(GFXLIB)/drivers/multiple/X
 GFXSRC += $(GFXLIB)/drivers/multiple/X/gdisp_lld_X.c
-GFXLIBS += X11
+GFXLIBS += X11 Xext
@@ -26,6 +26,39 @@
 #ifndef GDISP_FORCE_24BIT
 	#define GDISP_FORCE_24BIT			GFXOFF
 #endif
+#ifndef GDISP_X_USE_XIMAGE
+	/**
+	 * Setting this to GFXON draws into a client side XImage and only sends the changed
+	 * area to the X server when the display is flushed or on the frame timer.
+	 * If the X visual does not use 32 bit RGB888 pixels the driver falls back to drawing
+	 * directly on the X server.
+	 */
+	#define GDISP_X_USE_XIMAGE			GFXON
+#endif
+#ifndef GDISP_X_USE_SHM
+	/**
+	 * Setting this to GFXON shares the XImage with the X server using the MIT-SHM extension
+	 * when it is available (a local X server). Otherwise the image is sent over the X connection.
+	 */
+	#define GDISP_X_USE_SHM				GFXON
+#endif
+#ifndef GDISP_X_FRAME_PERIOD
+	/**
+	 * How often (in milliseconds) changes are sent to the X server when the application
+	 * doesn't call gdispFlush() itself.
+	 */
+	#define GDISP_X_FRAME_PERIOD		20
+#endif
+#if !GDISP_X_USE_XIMAGE
+	#undef GDISP_X_USE_SHM
+	#define GDISP_X_USE_SHM				GFXOFF
+#endif
+#if GDISP_X_USE_SHM
+	#include <sys/ipc.h>
+	#include <sys/shm.h>
+	#include <X11/extensions/XShm.h>
+#endif
+#include <string.h>
 #ifndef GDISP_SCREEN_WIDTH
 	#define GDISP_SCREEN_WIDTH			640
 #endif
@@ -180,6 +213,19 @@ typedef struct xPriv {
 	Pixmap			pix;
 	GC 				gc;
 	Window			win;
+	#if GDISP_X_USE_XIMAGE
+		struct xPriv *	next;			// The next display using an XImage
+		XImage *		img;			// The client side image (or 0 if drawing directly on the server)
+		gU32 *			pixels;			// The image pixels
+		int				stride;			// Pixels per image line
+		gCoord			dx0, dy0;		// The area changed since the last present
+		gCoord			dx1, dy1;		//		(exclusive - empty when dx0 >= dx1)
+		gMutex			dlock;			// Protects the changed area
+		#if GDISP_X_USE_SHM
+			XShmSegmentInfo	shm;
+			gBool		useshm;
+		#endif
+	#endif
 	#if GINPUT_NEED_MOUSE
 		gCoord		mousex, mousey;
 		gU16	buttons;
@@ -187,6 +233,138 @@ typedef struct xPriv {
 	#endif
 } xPriv;
 
+#if GDISP_X_USE_XIMAGE
+	static xPriv *			ximglist;			// The displays using an XImage
+
+	#if GDISP_X_USE_SHM
+		static gBool		shmfailed;
+
+		static int ShmErrorHandler(Display *d, XErrorEvent *e) {
+			(void) d;
+			(void) e;
+			shmfailed = gTrue;
+			return 0;
+		}
+	#endif
+
+	// Create the client side image. Returns gFalse if the visual can't be used this way.
+	static gBool XImageCreate(xPriv *priv) {
+		Visual	*v;
+
+		v = vis.visual == CopyFromParent ? DefaultVisual(dis, scr) : vis.visual;
+		if (vis.depth != 24 || v->red_mask != 0xFF0000 || v->green_mask != 0x00FF00 || v->blue_mask != 0x0000FF)
+			return gFalse;
+
+		#if GDISP_X_USE_SHM
+			priv->useshm = gFalse;
+			if (XShmQueryExtension(dis)) {
+				priv->img = XShmCreateImage(dis, v, vis.depth, ZPixmap, 0, &priv->shm, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT);
+				if (priv->img) {
+					priv->shm.shmid = shmget(IPC_PRIVATE, priv->img->bytes_per_line * priv->img->height, IPC_CREAT|0600);
+					if (priv->shm.shmid >= 0) {
+						int (*olderr)(Display *, XErrorEvent *);
+
+						priv->shm.shmaddr = priv->img->data = shmat(priv->shm.shmid, 0, 0);
+						priv->shm.readOnly = False;
+
+						// Attaching fails (asynchronously) if the server is not local
+						shmfailed = gFalse;
+						olderr = XSetErrorHandler(ShmErrorHandler);
+						XShmAttach(dis, &priv->shm);
+						XSync(dis, False);
+						XSetErrorHandler(olderr);
+
+						// The segment is freed once both sides have detached (eg. when we exit)
+						shmctl(priv->shm.shmid, IPC_RMID, 0);
+						if (!shmfailed && priv->img->data != (char *)-1)
+							priv->useshm = gTrue;
+						else if (priv->img->data != (char *)-1)
+							shmdt(priv->shm.shmaddr);
+					}
+					if (!priv->useshm) {
+						priv->img->data = 0;
+						XDestroyImage(priv->img);
+						priv->img = 0;
+					}
+				}
+			}
+			if (!priv->useshm)
+		#endif
+		{
+			priv->img = XCreateImage(dis, v, vis.depth, ZPixmap, 0, 0, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, 32, 0);
+			if (!priv->img)
+				return gFalse;
+			if (!(priv->img->data = malloc(priv->img->bytes_per_line * priv->img->height))) {
+				XDestroyImage(priv->img);
+				priv->img = 0;
+				return gFalse;
+			}
+		}
+
+		if (priv->img->bits_per_pixel != 32) {
+			#if GDISP_X_USE_SHM
+				if (priv->useshm) {
+					XShmDetach(dis, &priv->shm);
+					shmdt(priv->shm.shmaddr);
+					priv->img->data = 0;
+				}
+			#endif
+			XDestroyImage(priv->img);
+			priv->img = 0;
+			return gFalse;
+		}
+
+		priv->pixels = (gU32 *)priv->img->data;
+		priv->stride = priv->img->bytes_per_line / 4;
+		priv->dx0 = priv->dy0 = 0;
+		priv->dx1 = GDISP_SCREEN_WIDTH;
+		priv->dy1 = GDISP_SCREEN_HEIGHT;
+		gfxMutexInit(&priv->dlock);
+		return gTrue;
+	}
+
+	// Send part of the image to the window
+	static void XImagePut(xPriv *priv, int x, int y, int cx, int cy) {
+		#if GDISP_X_USE_SHM
+			if (priv->useshm)
+				XShmPutImage(dis, priv->win, priv->gc, priv->img, x, y, x, y, cx, cy, False);
+			else
+		#endif
+			XPutImage(dis, priv->win, priv->gc, priv->img, x, y, x, y, cx, cy);
+	}
+
+	// Remember an area that has changed
+	static void XImageDamage(xPriv *priv, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+		gfxMutexEnter(&priv->dlock);
+		if (priv->dx0 >= priv->dx1) {
+			priv->dx0 = x;			priv->dy0 = y;
+			priv->dx1 = x + cx;		priv->dy1 = y + cy;
+		} else {
+			if (x < priv->dx0)			priv->dx0 = x;
+			if (y < priv->dy0)			priv->dy0 = y;
+			if (x + cx > priv->dx1)		priv->dx1 = x + cx;
+			if (y + cy > priv->dy1)		priv->dy1 = y + cy;
+		}
+		gfxMutexExit(&priv->dlock);
+	}
+
+	// Send the changed area to the window
+	static void XImagePresent(xPriv *priv) {
+		gCoord	x0, y0, x1, y1;
+
+		gfxMutexEnter(&priv->dlock);
+		x0 = priv->dx0;		y0 = priv->dy0;
+		x1 = priv->dx1;		y1 = priv->dy1;
+		priv->dx0 = priv->dx1 = 0;
+		gfxMutexExit(&priv->dlock);
+
+		if (x0 >= x1)
+			return;
+		XImagePut(priv, x0, y0, x1 - x0, y1 - y0);
+		XFlush(dis);
+	}
+#endif
+
 static void ProcessEvent(GDisplay *g, xPriv *priv) {
 	switch(evt.type) {
 	case MapNotify:
@@ -205,6 +383,12 @@ static void ProcessEvent(GDisplay *g, xPriv *priv) {
 		}
 		break;
 	case Expose:
+		#if GDISP_X_USE_XIMAGE
+			if (priv->img) {
+				XImagePut(priv, evt.xexpose.x, evt.xexpose.y, evt.xexpose.width, evt.xexpose.height);
+				break;
+			}
+		#endif
 		XCopyArea(dis, priv->pix, evt.xexpose.window, priv->gc,
 			evt.xexpose.x, evt.xexpose.y,
 			evt.xexpose.width, evt.xexpose.height,
@@ -276,12 +460,23 @@ static GFX_THREAD_FUNCTION(ThreadX, arg) {
 	(void)arg;
 
 	while(1) {
-		gfxSleepMilliseconds(100);
+		#if GDISP_X_USE_XIMAGE
+			xPriv	*priv;
+
+			gfxSleepMilliseconds(GDISP_X_FRAME_PERIOD);
+		#else
+			gfxSleepMilliseconds(100);
+		#endif
 		while(XPending(dis)) {
 			XNextEvent(dis, &evt);
 			XFindContext(evt.xany.display, evt.xany.window, cxt, (XPointer*)&g);
 			ProcessEvent(g, (xPriv *)g->priv);
 		}
+		#if GDISP_X_USE_XIMAGE
+			// Send any changes the application hasn't flushed itself
+			for(priv = ximglist; priv; priv = priv->next)
+				XImagePresent(priv);
+		#endif
 	}
 	return 0;
 }
@@ -376,9 +571,18 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	XFree(pSH);
 	XSync(dis, TRUE);
 
-	priv->pix = XCreatePixmap(dis, priv->win,
-				GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, vis.depth);
-	XSync(dis, TRUE);
+	#if GDISP_X_USE_XIMAGE
+		if (!XImageCreate(priv)) {
+			fprintf(stderr, "Your display can't use a client side image - drawing directly on the X server\n");
+			priv->img = 0;
+		}
+		if (!priv->img)
+	#endif
+	{
+		priv->pix = XCreatePixmap(dis, priv->win,
+					GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT, vis.depth);
+		XSync(dis, TRUE);
+	}
 
 	priv->gc = XCreateGC(dis, priv->win, 0, 0);
 	XSetBackground(dis, priv->gc, BlackPixel(dis, scr));
@@ -404,14 +608,43 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
     g->g.Width = GDISP_SCREEN_WIDTH;
     g->g.Height = GDISP_SCREEN_HEIGHT;
 
+	// Let the X thread present this display
+	#if GDISP_X_USE_XIMAGE
+		if (priv->img) {
+			priv->next = ximglist;
+			ximglist = priv;
+		}
+	#endif
+
     return gTrue;
 }
 
+#if GDISP_HARDWARE_FLUSH
+	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		#if GDISP_X_USE_XIMAGE
+			xPriv *	priv = (xPriv *)g->priv;
+
+			if (priv->img)
+				XImagePresent(priv);
+		#else
+			(void) g;
+		#endif
+	}
+#endif
+
 LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 {
 	xPriv *	priv = (xPriv *)g->priv;
 	XColor	col;
 
+	#if GDISP_X_USE_XIMAGE
+		if (priv->img) {
+			priv->pixels[g->p.y * priv->stride + g->p.x] = gdispColor2Native(g->p.color);
+			XImageDamage(priv, g->p.x, g->p.y, 1, 1);
+			return;
+		}
+	#endif
+
 	col.red = RED_OF(g->p.color) << 8;
 	col.green = GREEN_OF(g->p.color) << 8;
 	col.blue = BLUE_OF(g->p.color) << 8;
@@ -427,6 +660,22 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 		xPriv *	priv = (xPriv *)g->priv;
 		XColor	col;
 
+		#if GDISP_X_USE_XIMAGE
+			if (priv->img) {
+				gU32	*p, c;
+				gCoord	x, y;
+
+				c = gdispColor2Native(g->p.color);
+				p = priv->pixels + g->p.y * priv->stride + g->p.x;
+				for(x = 0; x < g->p.cx; x++)
+					p[x] = c;
+				for(y = 1; y < g->p.cy; y++)
+					memcpy(p + y * priv->stride, p, g->p.cx * sizeof(gU32));
+				XImageDamage(priv, g->p.x, g->p.y, g->p.cx, g->p.cy);
+				return;
+			}
+		#endif
+
 		col.red = RED_OF(g->p.color) << 8;
 		col.green = GREEN_OF(g->p.color) << 8;
 		col.blue = BLUE_OF(g->p.color) << 8;
@@ -438,16 +687,60 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 	}
 #endif
 
-#if 0 && GDISP_HARDWARE_BITFILLS
+#if GDISP_HARDWARE_BITFILLS
 	LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
-		// Start of Bitblit code
-
-		//XImage			bitmap;
-		//gPixel			*bits;
-		//	bits = malloc(vis.depth * GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT);
-		//	bitmap = XCreateImage(dis, vis, vis.depth, ZPixmap,
-		//				0, bits, GDISP_SCREEN_WIDTH, GDISP_SCREEN_HEIGHT,
-		//				0, 0);
+		xPriv *			priv = (xPriv *)g->priv;
+		const gPixel *	src;
+		gCoord			x, y;
+
+		src = (const gPixel *)g->p.ptr + g->p.y1 * g->p.x2 + g->p.x1;
+
+		#if GDISP_X_USE_XIMAGE
+			if (priv->img) {
+				gU32	*p;
+
+				p = priv->pixels + g->p.y * priv->stride + g->p.x;
+				for(y = 0; y < g->p.cy; y++, p += priv->stride, src += g->p.x2) {
+					#if GDISP_PIXELFORMAT == GDISP_LLD_PIXELFORMAT
+						memcpy(p, src, g->p.cx * sizeof(gU32));
+					#else
+						for(x = 0; x < g->p.cx; x++)
+							p[x] = gdispColor2Native(src[x]);
+					#endif
+				}
+				XImageDamage(priv, g->p.x, g->p.y, g->p.cx, g->p.cy);
+				return;
+			}
+		#endif
+
+		// Drawing directly on the server - send it a line at a time
+		{
+			XImage	*line;
+			char	*bits;
+
+			if (!(bits = malloc(g->p.cx * 4)))
+				return;
+			line = XCreateImage(dis, vis.visual == CopyFromParent ? DefaultVisual(dis, scr) : vis.visual, vis.depth, ZPixmap, 0, bits, g->p.cx, 1, 32, 0);
+			if (!line) {
+				free(bits);
+				return;
+			}
+			for(y = 0; y < g->p.cy; y++, src += g->p.x2) {
+				for(x = 0; x < g->p.cx; x++) {
+					XColor	col;
+
+					col.red = RED_OF(src[x]) << 8;
+					col.green = GREEN_OF(src[x]) << 8;
+					col.blue = BLUE_OF(src[x]) << 8;
+					XAllocColor(dis, cmap, &col);
+					XPutPixel(line, x, 0, col.pixel);
+				}
+				XPutImage(dis, priv->pix, priv->gc, line, 0, 0, g->p.x, g->p.y+y, g->p.cx, 1);
+				XPutImage(dis, priv->win, priv->gc, line, 0, 0, g->p.x, g->p.y+y, g->p.cx, 1);
+			}
+			XDestroyImage(line);
+			XFlush(dis);
+		}
 	}
 #endif
 
@@ -457,6 +750,11 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 		XColor	color;
 		XImage *img;
 
+		#if GDISP_X_USE_XIMAGE
+			if (priv->img)
+				return gdispNative2Color(priv->pixels[g->p.y * priv->stride + g->p.x]);
+		#endif
+
 		img = XGetImage (dis, priv->pix, g->p.x, g->p.y, 1, 1, AllPlanes, XYPixmap);
 		color.pixel = XGetPixel (img, 0, 0);
 		XFree(img);
@@ -469,6 +767,25 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g)
 	LLDSPEC void gdisp_lld_vertical_scroll(GDisplay *g) {
 		xPriv *	priv = (xPriv *)g->priv;
 
+		#if GDISP_X_USE_XIMAGE
+			if (priv->img) {
+				gU32	*p;
+				gCoord	y;
+
+				if (g->p.y1 > 0) {
+					p = priv->pixels + g->p.y * priv->stride + g->p.x;
+					for(y = g->p.y1; y < g->p.cy; y++, p += priv->stride)
+						memcpy(p, p + g->p.y1 * priv->stride, g->p.cx * sizeof(gU32));
+				} else {
+					p = priv->pixels + (g->p.y + g->p.cy - 1) * priv->stride + g->p.x;
+					for(y = -g->p.y1; y < g->p.cy; y++, p -= priv->stride)
+						memcpy(p, p + g->p.y1 * priv->stride, g->p.cx * sizeof(gU32));
+				}
+				XImageDamage(priv, g->p.x, g->p.y, g->p.cx, g->p.cy);
+				return;
+			}
+		#endif
+
 		if (g->p.y1 > 0) {
 			XCopyArea(dis, priv->pix, priv->pix, priv->gc, g->p.x, g->p.y+g->p.y1, g->p.cx, g->p.cy-g->p.y1, g->p.x, g->p.y);
 			XCopyArea(dis, priv->pix, priv->win, priv->gc, g->p.x, g->p.y, g->p.cx, g->p.cy-g->p.y1, g->p.x, g->p.y);
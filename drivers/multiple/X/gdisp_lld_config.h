@@ -14,9 +14,10 @@
 /* Driver hardware support.                                                  */
 /*===========================================================================*/
 
+#define GDISP_HARDWARE_FLUSH			GFXON
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
 #define GDISP_HARDWARE_FILLS			GFXON
-#define GDISP_HARDWARE_BITFILLS			GFXOFF
+#define GDISP_HARDWARE_BITFILLS			GFXON
 #define GDISP_HARDWARE_SCROLL			GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXOFF
@@ -24,9 +24,62 @@
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_SCROLL			GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
+#define GDISP_HARDWARE_QUERY			GFXON
 
 #define GDISP_LLD_PIXELFORMAT			GDISP_PIXELFORMAT_RGB565
 
+/*===========================================================================*/
+/* Driver specific queries.                                                  */
+/*===========================================================================*/
+
+// gdispGQuery(g, GDISP_GFXNET_QUERY_STATS) returns a (gdispNetStats *) for the display. It is a snapshot taken by the query.
+//	Use GDISP_GFXNET_CONTROL_RESETSTATS to restart the counters.
+#define GDISP_GFXNET_QUERY_STATS		(GDISP_CONTROL_LLD+0)
+
+typedef struct gdispNetStats {
+	gU32	blits;				// The number of blits sent
+	gU32	blitPixels;			// The number of pixels in those blits
+	gU32	blitRawBytes;		// The bytes those blits would have needed as GNETCODE_BLIT
+	gU32	blitBytes;			// The bytes actually used for those blits
+	gU32	tilesRaw;			// The number of blocks of pixels sent unencoded
+	gU32	tilesRLE;			// The number of blocks of pixels sent with each encoding
+	gU32	tilesPalette;
+	gU32	tilesLZ;
+	gU32	encodeTime;			// The time spent choosing and running encoders in GDISP_STATISTICS_CLOCK() units
+	gU32	wireBytes;			// The total number of bytes sent to the display
+} gdispNetStats;
+
+// gdispGQuery(g, GDISP_GFXNET_QUERY_VIEWERS) returns a (gdispNetViewerStats *) array with an entry for each
+//	of the GDISP_GFXNET_VIEWERS viewers of the display. It is a snapshot taken by the query.
+#define GDISP_GFXNET_QUERY_VIEWERS		(GDISP_CONTROL_LLD+1)
+
+#define GDISP_GFXNET_VIEWER_FREE		0	// Nobody is connected
+#define GDISP_GFXNET_VIEWER_RESYNC		1	// The viewer is being sent the shadow copy of the display
+#define GDISP_GFXNET_VIEWER_LIVE		2	// The viewer is up to date and is sent the drawing commands
+
+typedef struct gdispNetViewerStats {
+	gU16	state;				// GDISP_GFXNET_VIEWER_FREE, GDISP_GFXNET_VIEWER_RESYNC or GDISP_GFXNET_VIEWER_LIVE
+	gBool	input;				// The mouse of this viewer is the one being used
+	gU32	queued;				// The bytes waiting to be sent to the viewer
+	gU32	maxQueued;			// The most bytes that have been waiting
+	gU32	lag;				// The system ticks since nothing was waiting to be sent to the viewer
+	gU32	bytesSent;			// The bytes sent to the viewer
+	gU32	resyncs;			// The number of times the viewer fell behind and was resent the display
+} gdispNetViewerStats;
+
+/*===========================================================================*/
+/* Driver specific controls.                                                 */
+/*===========================================================================*/
+
+// gdispGControl(g, GDISP_GFXNET_CONTROL_INPUT, (void *)n) uses the mouse of viewer n (0 to GDISP_GFXNET_VIEWERS-1).
+//	Initially it is the first viewer to connect and it passes to another viewer if that one disconnects.
+//	Only this viewer can send GNETCODE_KILL.
+#define GDISP_GFXNET_CONTROL_INPUT		(GDISP_CONTROL_LLD+0)
+
+// gdispGControl(g, GDISP_GFXNET_CONTROL_RESETSTATS, 0) zeroes the traffic counters of the display and its viewers.
+//	The net thread updates them too so they must not be changed any other way.
+#define GDISP_GFXNET_CONTROL_RESETSTATS	(GDISP_CONTROL_LLD+1)
+
 #endif	/* GFX_USE_GDISP */
 
 #endif	/* _GDISP_LLD_CONFIG_H */
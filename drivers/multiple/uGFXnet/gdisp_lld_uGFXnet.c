@@ -35,6 +35,41 @@
 #ifndef GDISP_GFXNET_BROKEN_LWIP_ACCEPT
 	#define GDISP_GFXNET_BROKEN_LWIP_ACCEPT		GFXOFF
 #endif
+#ifndef GDISP_GFXNET_SENDBUF
+	#define GDISP_GFXNET_SENDBUF	4096		// Bytes of drawing commands collected before they are sent
+#endif
+#ifndef GDISP_GFXNET_LATENCY
+	#define GDISP_GFXNET_LATENCY	20			// Milliseconds before unflushed drawing commands are sent anyway
+#endif
+#ifndef GDISP_GFXNET_COMPRESS
+	#define GDISP_GFXNET_COMPRESS	GFXON		// Compress blits for displays that can decode them
+#endif
+#ifndef GDISP_GFXNET_COMPRESS_PIXELS
+	#define GDISP_GFXNET_COMPRESS_PIXELS	2048	// The most pixels compressed at a time. Each display needs about 4 bytes per pixel for this.
+#endif
+#ifndef GDISP_GFXNET_SHADOW
+	// Keep a copy of the display so reads are local and a reconnected display can be sent everything.
+	//	This costs a full frame of RAM per display so it is only on by default on desktop operating systems.
+	#if GFX_USE_OS_WIN32 || GFX_USE_OS_LINUX || GFX_USE_OS_OSX
+		#define GDISP_GFXNET_SHADOW	GFXON
+	#else
+		#define GDISP_GFXNET_SHADOW	GFXOFF
+	#endif
+#endif
+#ifndef GDISP_GFXNET_VIEWERS
+	#define GDISP_GFXNET_VIEWERS	1			// The number of remote displays that can show each display at the same time
+#endif
+#ifndef GDISP_GFXNET_QUEUE
+	#define GDISP_GFXNET_QUEUE		65536		// Bytes that can wait to be sent to each viewer when there is more than one
+#endif
+#ifndef GDISP_GFXNET_EPOLL
+	// Use epoll and non-blocking sockets in the net thread rather than select
+	#if GFX_USE_OS_LINUX
+		#define GDISP_GFXNET_EPOLL	GFXON
+	#else
+		#define GDISP_GFXNET_EPOLL	GFXOFF
+	#endif
+#endif
 
 #if GINPUT_NEED_MOUSE
 	// Include mouse support code
@@ -78,12 +113,30 @@
 	}};
 #endif
 
-#if GNETCODE_VERSION != GNETCODE_VERSION_1_0
-	#error "GDISP: uGFXnet - This driver only support protocol V1.0"
+#if GNETCODE_VERSION != GNETCODE_VERSION_2_0
+	#error "GDISP: uGFXnet - This driver only support protocol V1.0 and V2.0"
+#endif
+#if GDISP_GFXNET_SENDBUF < 16 || (GDISP_GFXNET_SENDBUF & 1)
+	#error "GDISP: uGFXnet - GDISP_GFXNET_SENDBUF must be an even number of at least 16 bytes"
 #endif
 #if GDISP_LLD_PIXELFORMAT != GNETCODE_PIXELFORMAT
 	#error "GDISP: uGFXnet - The driver pixel format must match the protocol"
 #endif
+#if GDISP_GFXNET_VIEWERS < 1
+	#error "GDISP: uGFXnet - GDISP_GFXNET_VIEWERS must be at least 1"
+#endif
+#if GDISP_GFXNET_VIEWERS > 1 && !GDISP_GFXNET_SHADOW
+	#error "GDISP: uGFXnet - GDISP_GFXNET_VIEWERS above 1 needs GDISP_GFXNET_SHADOW"
+#endif
+#if GDISP_GFXNET_VIEWERS > 1 && GDISP_GFXNET_SENDBUF < 256
+	#error "GDISP: uGFXnet - GDISP_GFXNET_VIEWERS above 1 needs a GDISP_GFXNET_SENDBUF of at least 256 bytes"
+#endif
+#if GDISP_GFXNET_EPOLL && !GFX_USE_OS_LINUX
+	#error "GDISP: uGFXnet - GDISP_GFXNET_EPOLL is only supported on Linux"
+#endif
+#if GDISP_GFXNET_COMPRESS && (GDISP_GFXNET_COMPRESS_PIXELS < 64 || GDISP_GFXNET_COMPRESS_PIXELS > 32767)
+	#error "GDISP: uGFXnet - GDISP_GFXNET_COMPRESS_PIXELS must be between 64 and 32767"
+#endif
 
 #include <stdio.h>
 #include <string.h>
@@ -92,6 +145,7 @@
 #if defined(WIN32) || GFX_USE_OS_WIN32
 	#include <winsock.h>
 	#define SOCKET_TYPE				SOCKET
+	#define NBIO_TYPE				u_long
 	#define socklen_t		int
 
 	static void StopSockets(void) {
@@ -110,11 +164,22 @@
 	#include <netinet/in.h>
 	#include <arpa/inet.h>
 	#include <netdb.h>
+	#include <sys/ioctl.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+	#if GDISP_GFXNET_EPOLL
+		#include <sys/epoll.h>
+		#include <sys/eventfd.h>
+		#include <poll.h>
+		#include <errno.h>
+	#endif
 
 	#define closesocket(fd)			close(fd)
 	#define ioctlsocket(fd,cmd,arg)	ioctl(fd,cmd,arg)
 	#define StartSockets()
 	#define SOCKET_TYPE				int
+	#define NBIO_TYPE				int
+	#define SOCKET_SENDMSG			GFXON		// Vectored sends are available
 
 #else
 	#include <lwip/sockets.h>
@@ -134,6 +199,7 @@
 		#error "GDISP: uGFXnet - LWIP_COMPAT_SOCKETS must be defined in your lwipopts.h file"
 	#endif
 	#define SOCKET_TYPE				int
+	#define NBIO_TYPE				int
 
 	// Mutex protection is required for LWIP
 	#if !GDISP_GFXNET_UNSAFE_SOCKETS
@@ -147,17 +213,125 @@
 	#endif
 #endif
 
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL			0
+#endif
+#ifndef SOCKET_SENDMSG
+	#define SOCKET_SENDMSG			GFXOFF
+#endif
+
+
 #define GDISP_FLG_CONNECTED			(GDISP_FLG_DRIVER<<0)
-#define GDISP_FLG_HAVEDATA			(GDISP_FLG_DRIVER<<1)
+
+#define GFXNET_RXWORDS				32			// Words read from a viewer at a time. Must be even.
+#define GFXNET_REPLIES				4			// Replies that can wait for a reader
+
+// With more than one viewer each gets its own queue and nothing waits for replies
+#define GFXNET_BROADCAST			(GDISP_GFXNET_VIEWERS > 1)
+#if GFXNET_BROADCAST
+	#define GFXNET_CMD_WORDS		(GDISP_GFXNET_SENDBUF/2)	// Commands are never split between batches
+	#define GFXNET_RAW_PIXELS		(GFXNET_CMD_WORDS-5)		// The most pixels in one GNETCODE_BLIT
+#else
+	#define GFXNET_RAW_PIXELS		0xFFFFFFFFUL
+#endif
+
+#if GDISP_GFXNET_COMPRESS
+	#define GFXNET_ENCODINGS		(GNETCODE_ENC_RLE|GNETCODE_ENC_PALETTE|GNETCODE_ENC_LZ)
+	#define GFXNET_ENC_MINPIXELS	32			// Smaller blits are always sent unencoded
+	#define GFXNET_PAL_HASHSIZE		512			// Must be a power of 2 bigger than 256
+	#define GFXNET_LZ_HASHSIZE		1024		// Must be a power of 2
+	#define GFXNET_LZ_MINMATCH		3			// Shorter matches cost more than the pixels they replace
+	#if GFXNET_BROADCAST && GDISP_GFXNET_COMPRESS_PIXELS > GFXNET_CMD_WORDS-7
+		#define GFXNET_TILE_PIXELS	(GFXNET_CMD_WORDS-7)
+	#else
+		#define GFXNET_TILE_PIXELS	GDISP_GFXNET_COMPRESS_PIXELS
+	#endif
+#endif
+#if GDISP_GFXNET_SHADOW
+	#define GFXNET_KEYFRAME_WAIT	250			// Milliseconds to wait for a new display to say which encodings it accepts
+
+	// The shadow copy is resent to a viewer in bands of whole rows
+	#if GDISP_GFXNET_COMPRESS
+		#define GFXNET_BAND_PIXELS	GFXNET_TILE_PIXELS
+	#elif GFXNET_BROADCAST
+		#define GFXNET_BAND_PIXELS	GFXNET_RAW_PIXELS
+	#else
+		#define GFXNET_BAND_PIXELS	2048
+	#endif
+	#define GFXNET_BAND_ROWS		(GFXNET_BAND_PIXELS >= GDISP_SCREEN_WIDTH ? GFXNET_BAND_PIXELS/GDISP_SCREEN_WIDTH : 1)
+	#define GFXNET_BANDS			((GDISP_SCREEN_HEIGHT + GFXNET_BAND_ROWS - 1) / GFXNET_BAND_ROWS)
+#endif
+#if GFXNET_BROADCAST
+	// The queue space needed before another band is sent to a viewer
+	#define GFXNET_RESYNC_ROOM		(GFXNET_BAND_ROWS * GDISP_SCREEN_WIDTH * 2 + 2 * GDISP_GFXNET_SENDBUF)
+	#if GDISP_GFXNET_QUEUE < 2 * GFXNET_RESYNC_ROOM
+		#error "GDISP: uGFXnet - GDISP_GFXNET_QUEUE is too small for the screen width and GDISP_GFXNET_SENDBUF"
+	#endif
+#endif
 
 /*===========================================================================*/
 /* Driver local routines    .                                                */
 /*===========================================================================*/
 
+typedef struct netViewer {
+	GDisplay *		display;				// The display being viewed
+	SOCKET_TYPE		netfd;					// The socket
+	gU16			state;					// GDISP_GFXNET_VIEWER_FREE, GDISP_GFXNET_VIEWER_RESYNC or GDISP_GFXNET_VIEWER_LIVE
+	gU16			version;				// The protocol version being used on this connection
+	gU16			encodings;				// The GNETCODE_ENC_xxx blit encodings the viewer accepts
+	unsigned		rxbytes;				// How many bytes are in rxbuf
+	gU16			rxbuf[GFXNET_RXWORDS];	// Buffer for storing data read.
+	gdispNetViewerStats	stats;				// The counters for GDISP_GFXNET_QUERY_VIEWERS
+	#if GDISP_GFXNET_SHADOW
+		gBool		hello;					// The viewer has said which encodings it accepts
+		gBool		unrotate;				// The viewer may be rotated and must be set back to gOrientation0
+		gTicks		conntime;				// When the viewer connected
+		unsigned	ignorereplies;			// Replies to commands the driver sent itself
+		unsigned	ndirty;					// The number of bands still to be sent
+		gU8			dirty[GFXNET_BANDS];	// The bands of the shadow copy the viewer doesn't have
+	#endif
+	#if GFXNET_BROADCAST
+		char *		queue;					// Bytes waiting to be sent. A ring buffer of GDISP_GFXNET_QUEUE bytes.
+		unsigned	qhead;					// Where the oldest waiting byte is
+		unsigned	qlen;					// The number of bytes waiting
+		gTicks		qtime;					// When the queue was last empty
+		#if GDISP_GFXNET_EPOLL
+			gBool	pollout;				// epoll is watching for room to send
+		#endif
+	#endif
+} netViewer;
+
 typedef struct netPriv {
-	SOCKET_TYPE		netfd;					// The current socket
-	unsigned		databytes;				// How many bytes have been read
-	gU16		data[2];				// Buffer for storing data read.
+	netViewer		viewers[GDISP_GFXNET_VIEWERS];	// The remote displays showing this display
+	netViewer *		target;					// The viewer the send buffer is for. 0 = all the live viewers.
+	netViewer *		controller;				// The viewer whose mouse is used
+	unsigned		nviewers;				// The number of connected viewers
+	unsigned		nlive;					// The number of viewers that are up to date
+	gMutex			sendlock;				// Protects the send buffer and the viewers
+	gTicks			sendtime;				// When the oldest unsent command was added
+	unsigned		sendlen;				// The number of bytes of commands in the send buffer
+	gU16			sendbuf[2+GDISP_GFXNET_SENDBUF/2];	// The frame header (V2.0) followed by the commands
+	gdispNetStats	stats;					// Traffic counters. They are only changed with the send lock held.
+	gdispNetStats	statsnap;				// What GDISP_GFXNET_QUERY_STATS returns
+	gdispNetViewerStats	vstats[GDISP_GFXNET_VIEWERS];	// What GDISP_GFXNET_QUERY_VIEWERS returns
+	#if !GFXNET_BROADCAST
+		gSem		replysem;				// Counts the replies waiting in replies[]
+		unsigned	replyhead;				// The oldest waiting reply
+		unsigned	replycount;				// The number of waiting replies
+		gU16		replies[GFXNET_REPLIES][2];	// READ and CONTROL replies. A code of 0 means the viewer disconnected.
+	#endif
+	#if GDISP_GFXNET_SHADOW
+		gPixel *	shadow;					// A copy of the display in unrotated coordinates
+	#endif
+	#if GDISP_GFXNET_COMPRESS
+		gU16		encodings;				// The GNETCODE_ENC_xxx blit encodings all the live viewers accept
+		unsigned	palcount;				// The number of colors in palette[]
+		gU16		palette[256];			// The colors found in the current block of pixels
+		gU16		palhash[GFXNET_PAL_HASHSIZE];	// Palette index + 1 by color hash. 0 = unused.
+		gU16		lzhash[GFXNET_LZ_HASHSIZE];		// The last position of each hashed pair of pixels
+		gU16		tile[GDISP_GFXNET_COMPRESS_PIXELS];	// The block of pixels being encoded
+		gU16		enc[GDISP_GFXNET_COMPRESS_PIXELS];	// The encoded block
+	#endif
 	#if GINPUT_NEED_MOUSE
 		gCoord		mousex, mousey;
 		gU16	mousebuttons;
@@ -166,6 +340,13 @@ typedef struct netPriv {
 } netPriv;
 
 static gThread	hThread;
+#if GDISP_GFXNET_EPOLL
+	static int		epollfd;				// The net thread's epoll instance
+	static int		wakefd;					// An eventfd that wakes the net thread
+#elif GFXNET_BROADCAST
+	static SOCKET_TYPE			wakefd = (SOCKET_TYPE)-1;	// A loopback UDP socket that wakes select() by sending to itself
+	static struct sockaddr_in	wakeaddr;					// Where it is bound
+#endif
 
 #if GDISP_GFXNET_UNSAFE_SOCKETS
 	static gMutex	uGFXnetMutex;
@@ -178,67 +359,900 @@ static gThread	hThread;
 	#define MUTEX_EXIT
 #endif
 
+#define SEND_LOCK(priv)		gfxMutexEnter(&(priv)->sendlock)
+#define SEND_UNLOCK(priv)	gfxMutexExit(&(priv)->sendlock)
+
+#if GFXNET_BROADCAST
+	/**
+	 * Wake the net thread so it runs sendservice()
+	 */
+	static void netwake(void) {
+		#if GDISP_GFXNET_EPOLL
+			eventfd_write(wakefd, 1);
+		#else
+			// Without the wake socket the data waits for the select() timeout
+			if (wakefd != (SOCKET_TYPE)-1) {
+				MUTEX_ENTER;
+				sendto(wakefd, "", 1, 0, (struct sockaddr *)&wakeaddr, sizeof(wakeaddr));
+				MUTEX_EXIT;
+			}
+		#endif
+	}
+#endif
+
 /**
- * Send a whole packet of data.
+ * Get the next uGFXnet display
+ */
+static GDisplay *nextdisplay(GDisplay *g) {
+	while((g = (GDisplay *)gdriverGetNext(GDRIVER_TYPE_DISPLAY, (GDriver *)g))) {
+		// Ignore pixmaps and displays for other controllers
+		if (gvmt(g) != GDISP_DRIVER_VMT)
+			continue;
+		break;
+	}
+	return g;
+}
+
+/**
+ * Work out the encodings that all the live viewers accept.
+ * The send lock must be held.
+ */
+static void commonencodings(netPriv *priv) {
+	#if GDISP_GFXNET_COMPRESS
+		netViewer *	v;
+
+		priv->encodings = GFXNET_ENCODINGS;
+		for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++) {
+			if (v->state == GDISP_GFXNET_VIEWER_LIVE)
+				priv->encodings &= v->encodings;
+		}
+	#else
+		(void) priv;
+	#endif
+}
+
+#if GFXNET_BROADCAST
+	/**
+	 * A viewer has fallen too far behind. Rather than making the drawing wait it is
+	 * resent the shadow copy once its queue has room.
+	 * The send lock must be held.
+	 */
+	static void dropviewer(netPriv *priv, netViewer *v) {
+		if (v->state == GDISP_GFXNET_VIEWER_LIVE) {
+			v->state = GDISP_GFXNET_VIEWER_RESYNC;
+			priv->nlive--;
+			commonencodings(priv);
+		}
+		memset(v->dirty, 1, sizeof(v->dirty));
+		v->ndirty = GFXNET_BANDS;
+		v->unrotate = gTrue;
+		v->stats.resyncs++;
+	}
+
+	/**
+	 * Send as much of a viewer's queue as the socket will take without blocking.
+	 * Errors are left for the receive side to find.
+	 * The send lock must be held.
+	 */
+	static void sendqueue(netViewer *v) {
+		unsigned	len;
+		int			i;
+		#if SOCKET_SENDMSG
+			struct msghdr	msg;
+			struct iovec	iov[2];
+		#endif
+
+		while(v->qlen) {
+			len = GDISP_GFXNET_QUEUE - v->qhead;
+			if (len > v->qlen)
+				len = v->qlen;
+			MUTEX_ENTER;
+			#if SOCKET_SENDMSG
+				// Send both parts of a queue that wraps in one call
+				iov[0].iov_base = v->queue + v->qhead;
+				iov[0].iov_len = len;
+				iov[1].iov_base = v->queue;
+				iov[1].iov_len = v->qlen - len;
+				memset(&msg, 0, sizeof(msg));
+				msg.msg_iov = iov;
+				msg.msg_iovlen = iov[1].iov_len ? 2 : 1;
+				i = sendmsg(v->netfd, &msg, MSG_NOSIGNAL);
+			#else
+				i = send(v->netfd, v->queue + v->qhead, len, MSG_NOSIGNAL);
+			#endif
+			MUTEX_EXIT;
+			if (i <= 0)
+				break;
+			v->qhead = (v->qhead + i) % GDISP_GFXNET_QUEUE;
+			v->qlen -= i;
+			v->stats.bytesSent += i;
+		}
+
+		#if GDISP_GFXNET_EPOLL
+			// Only ask to be told about room to send while there is something waiting
+			if ((v->qlen != 0) != v->pollout && v->state != GDISP_GFXNET_VIEWER_FREE) {
+				struct epoll_event	ev;
+
+				v->pollout = !v->pollout;
+				ev.events = v->pollout ? (EPOLLIN|EPOLLOUT) : EPOLLIN;
+				ev.data.ptr = v;
+				epoll_ctl(epollfd, EPOLL_CTL_MOD, v->netfd, &ev);
+			}
+		#endif
+	}
+#else
+	/**
+	 * Send a block of bytes.
+	 * If the connection closes before we send all the data - the call returns gFalse.
+	 */
+	static gBool sendall(SOCKET_TYPE netfd, const char *p, int len) {
+		int		i;
+
+		MUTEX_ENTER;
+		while(len > 0) {
+			if ((i = send(netfd, p, len, MSG_NOSIGNAL)) <= 0) {
+				#if GDISP_GFXNET_EPOLL
+					// The socket is non-blocking so wait for room
+					if (i < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+						struct pollfd	pfd;
+
+						pfd.fd = netfd;
+						pfd.events = POLLOUT;
+						if (poll(&pfd, 1, -1) >= 0)
+							continue;
+					}
+				#endif
+				MUTEX_EXIT;
+				return gFalse;
+			}
+			p += i;
+			len -= i;
+		}
+		MUTEX_EXIT;
+		return gTrue;
+	}
+#endif
+
+/**
+ * Send the send buffer to one viewer.
+ * In protocol V2.0 the commands are sent as a frame prefixed by their length.
+ * With more than one viewer the frame is queued for the net thread to send.
+ * The send lock must be held.
+ */
+static void sendframe(netPriv *priv, netViewer *v) {
+	const char *	p;
+	unsigned		len;
+
+	if (v->version >= GNETCODE_VERSION_2_0) {
+		priv->sendbuf[0] = htons((gU16)(priv->sendlen >> 16));
+		priv->sendbuf[1] = htons((gU16)priv->sendlen);
+		p = (const char *)priv->sendbuf;
+		len = priv->sendlen + 2*sizeof(gU16);
+	} else {
+		p = (const char *)(priv->sendbuf+2);
+		len = priv->sendlen;
+	}
+
+	#if GFXNET_BROADCAST
+		{
+			unsigned	pos, n;
+
+			if (v->qlen + len > GDISP_GFXNET_QUEUE) {
+				dropviewer(priv, v);
+				return;
+			}
+			if (!v->qlen) {
+				v->qtime = gfxSystemTicks();
+				// Get the net thread sending straight away
+				netwake();
+			}
+			pos = (v->qhead + v->qlen) % GDISP_GFXNET_QUEUE;
+			n = GDISP_GFXNET_QUEUE - pos;
+			if (n > len)
+				n = len;
+			memcpy(v->queue + pos, p, n);
+			memcpy(v->queue, p + n, len - n);
+			v->qlen += len;
+			if (v->qlen > v->stats.maxQueued)
+				v->stats.maxQueued = v->qlen;
+		}
+	#else
+		sendall(v->netfd, p, len);
+		v->stats.bytesSent += len;
+	#endif
+	priv->stats.wireBytes += len;
+}
+
+/**
+ * Send everything in the send buffer to the target viewer or to all the live viewers.
+ * The send lock must be held.
+ */
+static void sendflush(netPriv *priv) {
+	netViewer *	v;
+
+	if (!priv->sendlen)
+		return;
+	if (priv->target)
+		sendframe(priv, priv->target);
+	else {
+		for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++) {
+			if (v->state == GDISP_GFXNET_VIEWER_LIVE)
+				sendframe(priv, v);
+		}
+	}
+	priv->sendlen = 0;
+}
+
+/**
+ * Make room in the send buffer for a command of len words.
+ * Commands are kept whole within a batch so a viewer can be dropped between batches.
+ * The send lock must be held.
+ */
+static GFXINLINE void sendcmd(netPriv *priv, unsigned len) {
+	if (priv->sendlen + len * sizeof(gU16) > GDISP_GFXNET_SENDBUF)
+		sendflush(priv);
+}
+
+/**
+ * Add a word to the send buffer, sending the buffer if it is full.
+ * The send lock must be held.
+ */
+static GFXINLINE void sendword(netPriv *priv, gU16 w) {
+	if (priv->sendlen >= GDISP_GFXNET_SENDBUF)
+		sendflush(priv);
+	if (!priv->sendlen)
+		priv->sendtime = gfxSystemTicks();
+	priv->sendbuf[2+priv->sendlen/2] = htons(w);
+	priv->sendlen += sizeof(gU16);
+}
+
+/**
+ * Add a whole packet of data to the send buffer.
  * Len is specified in the number of gU16's we want to send as our protocol only talks gU16's.
- * Note that contents of the packet are modified to ensure it will cross the wire in the correct format.
- * If the connection closes before we send all the data - the call returns gFalse.
+ * The send lock must be held.
  */
-static gBool sendpkt(SOCKET_TYPE netfd, gU16 *pkt, int len) {
-	int		i;
+static void sendpkt(netPriv *priv, const gU16 *pkt, int len) {
+	for(; len; len--)
+		sendword(priv, *pkt++);
+}
 
-	// Convert each gU16 to network order
-	for(i = 0; i < len; i++)
-		pkt[i] = htons(pkt[i]);
+#if GDISP_GFXNET_COMPRESS
+	/**
+	 * Find a color in the palette for the current block of pixels, adding it if it is new.
+	 * Returns the palette index or -1 if the palette is full.
+	 */
+	static int palindex(netPriv *priv, gU16 c) {
+		unsigned	h;
+
+		for(h = ((c * 0x9E37U) >> 7) & (GFXNET_PAL_HASHSIZE-1); priv->palhash[h]; h = (h+1) & (GFXNET_PAL_HASHSIZE-1)) {
+			if (priv->palette[priv->palhash[h]-1] == c)
+				return priv->palhash[h]-1;
+		}
+		if (priv->palcount >= 256)
+			return -1;
+		priv->palette[priv->palcount++] = c;
+		priv->palhash[h] = priv->palcount;
+		return priv->palcount-1;
+	}
+
+	/**
+	 * LZ encode the current block of pixels.
+	 * Returns the number of words used or 0 if the result would not be smaller than limit words.
+	 */
+	static unsigned lzencode(netPriv *priv, unsigned n, unsigned limit) {
+		const gU16 *	p;
+		gU16 *			o;
+		unsigned		i, lit, cand, len, h, cnt;
+
+		p = priv->tile;
+		o = priv->enc;
+		memset(priv->lzhash, 0xFF, sizeof(priv->lzhash));
+
+		// Emit the literal pixels between lit and i
+		#define LZ_LITERALS()																	\
+			for(; lit < i; lit += cnt) {														\
+				cnt = i - lit > 0x7FFF ? 0x7FFF : i - lit;										\
+				if ((unsigned)(o - priv->enc) + 1 + cnt >= limit)								\
+					return 0;																	\
+				*o++ = cnt;																		\
+				memcpy(o, p + lit, cnt * sizeof(gU16));											\
+				o += cnt;																		\
+			}
+
+		for(i = lit = 0; i + GFXNET_LZ_MINMATCH <= n;) {
+			// Look for the last place this pair of pixels was seen
+			h = ((p[i] * 0x9E37U) ^ (p[i+1] * 0x85EBU)) >> 6 & (GFXNET_LZ_HASHSIZE-1);
+			cand = priv->lzhash[h];
+			priv->lzhash[h] = i;
+			if (cand == 0xFFFF || p[cand] != p[i] || p[cand+1] != p[i+1] || p[cand+2] != p[i+2]) {
+				i++;
+				continue;
+			}
+
+			// Extend the match as far as it goes
+			for(len = GFXNET_LZ_MINMATCH; i + len < n && len < 0x7FFF && p[cand+len] == p[i+len]; len++);
+
+			LZ_LITERALS();
+			if ((unsigned)(o - priv->enc) + 2 >= limit)
+				return 0;
+			*o++ = 0x8000 | len;
+			*o++ = i - cand;
+			i += len;
+			lit = i;
+		}
+		i = n;
+		LZ_LITERALS();
+		#undef LZ_LITERALS
+		return o - priv->enc;
+	}
+
+	/**
+	 * Choose the cheapest encoding for the current block of pixels and encode it into priv->enc.
+	 * Returns the number of words used and the encoding or 0 if it should be sent unencoded.
+	 */
+	static unsigned encodetile(netPriv *priv, unsigned n, gU16 *pencoding) {
+		const gU16 *	p;
+		gU16 *			o;
+		unsigned		i, runs, bits, best, len;
+		gU32			acc;
+		int				idx;
+		gU16			last;
+		gBool			palok;
+
+		p = priv->tile;
+
+		// Count the runs and the colors. This only costs anything where the color changes.
+		priv->palcount = 0;
+		memset(priv->palhash, 0, sizeof(priv->palhash));
+		palok = palindex(priv, p[0]) >= 0;
+		for(runs = 1, last = p[0], i = 1; i < n; i++) {
+			if (p[i] == last)
+				continue;
+			last = p[i];
+			runs++;
+			if (palok && palindex(priv, last) < 0)
+				palok = gFalse;
+		}
+		bits = priv->palcount <= 2 ? 1 : (priv->palcount <= 4 ? 2 : (priv->palcount <= 16 ? 4 : 8));
+
+		// Work out which of the cheap encodings is best
+		best = n;
+		*pencoding = 0;
+		if ((priv->encodings & GNETCODE_ENC_RLE) && runs*2 < best) {
+			best = runs*2;
+			*pencoding = GNETCODE_ENC_RLE;
+		}
+		if ((priv->encodings & GNETCODE_ENC_PALETTE) && palok && 1 + priv->palcount + (n*bits+15)/16 < best) {
+			best = 1 + priv->palcount + (n*bits+15)/16;
+			*pencoding = GNETCODE_ENC_PALETTE;
+		}
+
+		// LZ is only worth trying when the others don't do well. It gives up if it can't beat them.
+		if ((priv->encodings & GNETCODE_ENC_LZ) && best > n/4 && (len = lzencode(priv, n, best))) {
+			*pencoding = GNETCODE_ENC_LZ;
+			return len;
+		}
+
+		o = priv->enc;
+		switch(*pencoding) {
+		case GNETCODE_ENC_RLE:
+			for(i = 0; i < n; o += 2) {
+				o[1] = p[i];
+				for(len = i++; i < n && p[i] == o[1]; i++);
+				o[0] = i - len;
+			}
+			break;
+		case GNETCODE_ENC_PALETTE:
+			*o++ = priv->palcount;
+			memcpy(o, priv->palette, priv->palcount * sizeof(gU16));
+			o += priv->palcount;
+			for(acc = 0, len = 0, idx = 0, last = p[0] ^ 1, i = 0; i < n; i++) {
+				if (p[i] != last) {
+					last = p[i];
+					idx = palindex(priv, last);
+				}
+				acc = (acc << bits) | idx;
+				if ((len += bits) == 16) {
+					*o++ = (gU16)acc;
+					acc = len = 0;
+				}
+			}
+			if (len)
+				*o++ = (gU16)(acc << (16 - len));
+			break;
+		default:
+			return 0;
+		}
+		return o - priv->enc;
+	}
 
-	// Send it
-	len *= sizeof(gU16);
-	return send(netfd, (const char *)pkt, len, 0) == len;
+	/**
+	 * Send a block of pixels using the best encoding the display accepts.
+	 * The send lock must be held.
+	 */
+	static void sendtile(netPriv *priv, const gPixel *buffer, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord stride) {
+		gU16 *		t;
+		unsigned	n, len;
+		gU32		start;
+		gU16		encoding;
+		gCoord		i, j;
+
+		start = GDISP_STATISTICS_CLOCK();
+		for(t = priv->tile, j = 0; j < cy; j++, buffer += stride) {
+			for(i = 0; i < cx; i++)
+				*t++ = gdispColor2Native(buffer[i]);
+		}
+		n = (unsigned)cx * cy;
+		len = encodetile(priv, n, &encoding);
+		priv->stats.encodeTime += GDISP_STATISTICS_CLOCK() - start;
+
+		sendcmd(priv, encoding ? 7 + len : 5 + n);
+		sendword(priv, encoding ? GNETCODE_BLITENC : GNETCODE_BLIT);
+		sendword(priv, x);
+		sendword(priv, y);
+		sendword(priv, cx);
+		sendword(priv, cy);
+		switch(encoding) {
+		case GNETCODE_ENC_RLE:		priv->stats.tilesRLE++;		break;
+		case GNETCODE_ENC_PALETTE:	priv->stats.tilesPalette++;	break;
+		case GNETCODE_ENC_LZ:		priv->stats.tilesLZ++;		break;
+		default:
+			priv->stats.tilesRaw++;
+			priv->stats.blitBytes += (5 + n) * sizeof(gU16);
+			sendpkt(priv, priv->tile, n);
+			return;
+		}
+		sendword(priv, encoding);
+		sendword(priv, len);
+		sendpkt(priv, priv->enc, len);
+		priv->stats.blitBytes += (7 + len) * sizeof(gU16);
+	}
+#endif
+
+/**
+ * Send a block of pixels unencoded.
+ * The send lock must be held.
+ */
+static void sendraw(netPriv *priv, const gPixel *buffer, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord stride) {
+	gU16	buf[5];
+	gCoord		i, j;
+
+	buf[0] = GNETCODE_BLIT;
+	buf[1] = x;
+	buf[2] = y;
+	buf[3] = cx;
+	buf[4] = cy;
+	sendcmd(priv, 5 + (unsigned)cx * cy);
+	sendpkt(priv, buf, 5);
+
+	for(j = 0; j < cy; j++, buffer += stride - cx) {
+		for(i = 0; i < cx; i++, buffer++)
+			sendword(priv, gdispColor2Native(buffer[0]));
+	}
+	priv->stats.tilesRaw++;
+	priv->stats.blitBytes += (5 + (gU32)cx * cy) * sizeof(gU16);
 }
 
-static gBool newconnection(SOCKET_TYPE clientfd) {
-	GDisplay *	g;
-    netPriv *	priv;
+/**
+ * Send a blit, encoding it if the display accepts that.
+ * The send lock must be held.
+ */
+static void sendblit(netPriv *priv, const gPixel *buffer, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord stride) {
+	gCoord		i, j, tx, ty, w, h;
+	gU32		maxpixels;
+	#if GDISP_GFXNET_COMPRESS
+		gBool	encode;
+	#endif
+
+	priv->stats.blits++;
+	priv->stats.blitPixels += (gU32)cx * cy;
+	priv->stats.blitRawBytes += (5 + (gU32)cx * cy) * sizeof(gU16);
+
+	maxpixels = GFXNET_RAW_PIXELS;
+	#if GDISP_GFXNET_COMPRESS
+		encode = priv->encodings && (gU32)cx * cy >= GFXNET_ENC_MINPIXELS;
+		if (encode)
+			maxpixels = GFXNET_TILE_PIXELS;
+	#endif
+
+	// Send the blit in blocks of rows (or parts of rows for very wide blits)
+	tx = (gU32)cx > maxpixels ? (gCoord)maxpixels : cx;
+	ty = (gU32)cy > maxpixels / tx ? (gCoord)(maxpixels / tx) : cy;
+	for(j = 0; j < cy; j += ty) {
+		h = cy - j < ty ? cy - j : ty;
+		for(i = 0; i < cx; i += tx) {
+			w = cx - i < tx ? cx - i : tx;
+			#if GDISP_GFXNET_COMPRESS
+				if (encode) {
+					sendtile(priv, buffer + j*stride + i, x + i, y + j, w, h, stride);
+					continue;
+				}
+			#endif
+			sendraw(priv, buffer + j*stride + i, x + i, y + j, w, h, stride);
+		}
+	}
+}
+
+#if GDISP_GFXNET_SHADOW
+	/**
+	 * Get the shadow copy of a pixel.
+	 * xstep and ystep are set to what moves one pixel right and one pixel down on the display.
+	 * The pixel must be on the display.
+	 */
+	static gPixel *shadow_pos(GDisplay *g, gCoord x, gCoord y, int *xstep, int *ystep) {
+		gPixel	*	shadow;
+
+		shadow = ((netPriv *)g->priv)->shadow;
+		#if GDISP_NEED_CONTROL
+			switch(g->g.Orientation) {
+			case gOrientation90:
+				*xstep = -GDISP_SCREEN_WIDTH;
+				*ystep = 1;
+				return shadow + (g->g.Width-x-1)*GDISP_SCREEN_WIDTH + y;
+			case gOrientation180:
+				*xstep = -1;
+				*ystep = -GDISP_SCREEN_WIDTH;
+				return shadow + (g->g.Height-y-1)*GDISP_SCREEN_WIDTH + g->g.Width-x-1;
+			case gOrientation270:
+				*xstep = GDISP_SCREEN_WIDTH;
+				*ystep = -1;
+				return shadow + x*GDISP_SCREEN_WIDTH + g->g.Height-y-1;
+			case gOrientation0:
+			default:
+				break;
+			}
+		#endif
+		*xstep = 1;
+		*ystep = GDISP_SCREEN_WIDTH;
+		return shadow + y*GDISP_SCREEN_WIDTH + x;
+	}
 
-	// Look for a display that isn't connected
-	for(g = 0; (g = (GDisplay *)gdriverGetNext(GDRIVER_TYPE_DISPLAY, (GDriver *)g));) {
-		// Ignore displays for other controllers
-		#ifdef GDISP_DRIVER_LIST
-			if (gvmt(g) != &GDISPVMT_uGFXnet)
+	/**
+	 * Mark the bands of the shadow copy under an area as still to be sent to the viewers that are catching up.
+	 * The send lock must be held.
+	 */
+	static void shadow_dirty(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+		netPriv	*	priv;
+		netViewer *	v;
+		unsigned	b, e;
+
+		// Work out the unrotated rows
+		#if GDISP_NEED_CONTROL
+			switch(g->g.Orientation) {
+			case gOrientation90:
+				y = g->g.Width - x - cx;
+				cy = cx;
+				break;
+			case gOrientation180:
+				y = g->g.Height - y - cy;
+				break;
+			case gOrientation270:
+				y = x;
+				cy = cx;
+				break;
+			case gOrientation0:
+			default:
+				break;
+			}
+		#else
+			(void) x;
+			(void) cx;
+		#endif
+
+		priv = g->priv;
+		e = (y + cy - 1) / GFXNET_BAND_ROWS;
+		for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++) {
+			if (v->state != GDISP_GFXNET_VIEWER_RESYNC)
 				continue;
+			for(b = y / GFXNET_BAND_ROWS; b <= e; b++) {
+				if (!v->dirty[b]) {
+					v->dirty[b] = 1;
+					v->ndirty++;
+				}
+			}
+		}
+	}
+
+	#if GDISP_NEED_CONTROL
+		/**
+		 * Send a viewer a control command the driver makes itself. Its reply is ignored.
+		 * The send lock must be held and the viewer must be the target.
+		 */
+		static void sendsetting(netPriv *priv, netViewer *v, gU16 what, gU16 value) {
+			sendcmd(priv, 3);
+			sendword(priv, GNETCODE_CONTROL);
+			sendword(priv, what);
+			sendword(priv, value);
+			v->ignorereplies++;
+		}
+	#endif
+
+	/**
+	 * Send a viewer the bands of the shadow copy it doesn't have. When it has them all
+	 * it is sent the display settings and starts getting the drawing commands.
+	 * With more than one viewer this stops when the viewer's queue is getting full.
+	 * The send lock must be held.
+	 */
+	static void sendresync(GDisplay *g, netViewer *v) {
+		netPriv	*	priv;
+		unsigned	b;
+		gCoord		y, h;
+
+		priv = g->priv;
+
+		// Anything in the send buffer is for the live viewers
+		sendflush(priv);
+		priv->target = v;
+		#if GDISP_GFXNET_COMPRESS
+			priv->encodings = v->encodings;
+		#endif
+
+		// The shadow copy is unrotated
+		#if GDISP_NEED_CONTROL
+			if (v->unrotate) {
+				v->unrotate = gFalse;
+				sendsetting(priv, v, GDISP_CONTROL_ORIENTATION, gOrientation0);
+			}
+		#endif
+
+		for(b = 0; b < GFXNET_BANDS && v->ndirty; b++) {
+			if (!v->dirty[b])
+				continue;
+			#if GFXNET_BROADCAST
+				if (GDISP_GFXNET_QUEUE - v->qlen < GFXNET_RESYNC_ROOM)
+					break;
+			#endif
+			v->dirty[b] = 0;
+			v->ndirty--;
+			y = b * GFXNET_BAND_ROWS;
+			h = GDISP_SCREEN_HEIGHT - y < GFXNET_BAND_ROWS ? GDISP_SCREEN_HEIGHT - y : GFXNET_BAND_ROWS;
+			sendblit(priv, priv->shadow + y*GDISP_SCREEN_WIDTH, 0, y, GDISP_SCREEN_WIDTH, h, GDISP_SCREEN_WIDTH);
+			#if GFXNET_BROADCAST
+				sendflush(priv);
+			#endif
+		}
+
+		// Then it gets the settings that were changed before it connected
+		#if GDISP_NEED_CONTROL
+			if (!v->ndirty) {
+				if (g->g.Orientation != gOrientation0)
+					sendsetting(priv, v, GDISP_CONTROL_ORIENTATION, g->g.Orientation);
+				if (g->g.Powermode != gPowerOn)
+					sendsetting(priv, v, GDISP_CONTROL_POWER, g->g.Powermode);
+				if (g->g.Backlight != 100)
+					sendsetting(priv, v, GDISP_CONTROL_BACKLIGHT, g->g.Backlight);
+			}
 		#endif
+		sendflush(priv);
+
+		// The viewer could have been dropped again while this was being queued
+		if (!v->ndirty) {
+			v->state = GDISP_GFXNET_VIEWER_LIVE;
+			priv->nlive++;
+		}
+		priv->target = 0;
+		commonencodings(priv);
+	}
+#endif
+
+/**
+ * Get ready to send drawing commands to a display.
+ * The area is what the drawing changes.
+ * Returns gFalse if there is nothing to send them to. Otherwise the send lock is held.
+ */
+static gBool senddrawing(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+	netPriv	*	priv;
+
+	#if GDISP_GFXNET_SHADOW || GDISP_DONT_WAIT_FOR_NET_DISPLAY
+		// With a shadow copy nothing is lost as a display gets everything when it connects
 		if (!(g->flags & GDISP_FLG_CONNECTED))
-			break;
+			return gFalse;
+	#else
+		while(!(g->flags & GDISP_FLG_CONNECTED))
+			gfxSleepMilliseconds(200);
+	#endif
+
+	priv = g->priv;
+	SEND_LOCK(priv);
+	#if GDISP_GFXNET_SHADOW
+		// Viewers that are catching up get this area from the shadow copy
+		if (priv->nlive < priv->nviewers && cx > 0 && cy > 0)
+			shadow_dirty(g, x, y, cx, cy);
+		if (!priv->nlive) {
+			SEND_UNLOCK(priv);
+			return gFalse;
+		}
+	#else
+		(void) x;
+		(void) y;
+		(void) cx;
+		(void) cy;
+	#endif
+	return gTrue;
+}
+
+/**
+ * Send any commands that have been waiting longer than GDISP_GFXNET_LATENCY,
+ * catch up viewers that don't have the whole display and send what is queued for each viewer.
+ */
+static void sendservice(void) {
+	GDisplay *	g;
+	netPriv *	priv;
+	netViewer *	v;
+
+	for(g = 0; (g = nextdisplay(g));) {
+		priv = g->priv;
+		if (!priv->nviewers)
+			continue;
+		SEND_LOCK(priv);
+		if (priv->sendlen && gfxSystemTicks() - priv->sendtime >= gfxMillisecondsToTicks(GDISP_GFXNET_LATENCY))
+			sendflush(priv);
+		for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++) {
+			#if GDISP_GFXNET_SHADOW
+				// A new viewer gets a chance to say which encodings it accepts first
+				if (v->state == GDISP_GFXNET_VIEWER_RESYNC
+						&& (v->hello || gfxSystemTicks() - v->conntime >= gfxMillisecondsToTicks(GFXNET_KEYFRAME_WAIT)))
+					sendresync(g, v);
+			#endif
+			#if GFXNET_BROADCAST
+				if (v->qlen)
+					sendqueue(v);
+			#endif
+		}
+		SEND_UNLOCK(priv);
 	}
+}
 
-	// Was anything found?
-	if (!g)
-		return gFalse;
+/**
+ * Choose the viewer whose mouse is used. v can be 0.
+ * The send lock must be held.
+ */
+static void setcontroller(netPriv *priv, netViewer *v) {
+	priv->controller = v;
+	#if GINPUT_NEED_MOUSE
+		// Let go of anything the previous viewer was holding down
+		if (priv->mousebuttons) {
+			priv->mousebuttons = 0;
+			_gmouseWakeup(priv->mouse);
+		}
+	#endif
+}
+
+#if !GFXNET_BROADCAST
+	/**
+	 * Pass a READ or CONTROL reply to whoever is waiting for it.
+	 * The send lock must be held.
+	 */
+	static void putreply(netPriv *priv, gU16 code, gU16 value) {
+		gU16 *	r;
+
+		// If nobody is reading the replies lose the oldest
+		if (priv->replycount >= GFXNET_REPLIES) {
+			priv->replyhead = (priv->replyhead + 1) % GFXNET_REPLIES;
+			priv->replycount--;
+		} else
+			gfxSemSignal(&priv->replysem);
+		r = priv->replies[(priv->replyhead + priv->replycount++) % GFXNET_REPLIES];
+		r[0] = code;
+		r[1] = value;
+	}
+
+	/**
+	 * Wait for the reply to a READ or CONTROL command.
+	 * Returns gFalse if the viewer disconnected first.
+	 */
+	static gBool getreply(netPriv *priv, gU16 code, gU16 *pvalue) {
+		gU16	rcode;
+
+		// Skip anything that isn't the reply wanted
+		do {
+			gfxSemWait(&priv->replysem, gDelayForever);
+			SEND_LOCK(priv);
+			rcode = priv->replies[priv->replyhead][0];
+			*pvalue = priv->replies[priv->replyhead][1];
+			priv->replyhead = (priv->replyhead + 1) % GFXNET_REPLIES;
+			priv->replycount--;
+			SEND_UNLOCK(priv);
+		} while(rcode && rcode != code);
+		return rcode != 0;
+	}
+#endif
+
+static gBool newconnection(SOCKET_TYPE clientfd) {
+	GDisplay *	g;
+	netPriv *	priv;
+	netViewer *	v;
+
+	// Look for a display that nobody is viewing and then for one with room for another viewer
+	for(g = 0; (g = nextdisplay(g)) && ((netPriv *)g->priv)->nviewers;);
+	if (!g) {
+		for(g = 0; (g = nextdisplay(g)) && ((netPriv *)g->priv)->nviewers >= GDISP_GFXNET_VIEWERS;);
+		if (!g)
+			return gFalse;
+	}
 
-	// Reset the priv area
 	priv = g->priv;
-	priv->netfd = clientfd;
-	priv->databytes = 0;
-	priv->mousebuttons = 0;
-
-	// Send the initialisation data (2 words at a time)
-	priv->data[0] = GNETCODE_INIT;
-	priv->data[1] = GNETCODE_VERSION;
-	sendpkt(priv->netfd, priv->data, 2);
-	priv->data[0] = GDISP_SCREEN_WIDTH;
-	priv->data[1] = GDISP_SCREEN_HEIGHT;
-	sendpkt(priv->netfd, priv->data, 2);
-	priv->data[0] = GDISP_LLD_PIXELFORMAT;
-	priv->data[1] = 1;							// We have a mouse
-	MUTEX_ENTER;
-	sendpkt(priv->netfd, priv->data, 2);
-	MUTEX_EXIT;
+	SEND_LOCK(priv);
+	for(v = priv->viewers; v->state != GDISP_GFXNET_VIEWER_FREE; v++);
+
+	// Anything in the send buffer is for the existing viewers
+	sendflush(priv);
+
+	// Reset the viewer
+	v->netfd = clientfd;
+	v->rxbytes = 0;
+	v->version = GNETCODE_VERSION_1_0;
+	v->encodings = 0;
+	memset(&v->stats, 0, sizeof(v->stats));
+	#if GFXNET_BROADCAST || GDISP_GFXNET_EPOLL
+		{
+			NBIO_TYPE	nb;
+
+			// The net thread never waits for a viewer
+			nb = 1;
+			ioctlsocket(clientfd, FIONBIO, &nb);
+		}
+	#endif
+	#if GFXNET_BROADCAST
+		v->qhead = v->qlen = 0;
+	#endif
+	#if GDISP_GFXNET_EPOLL
+		{
+			struct epoll_event	ev;
+
+			ev.events = EPOLLIN;
+			ev.data.ptr = v;
+			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, clientfd, &ev) == -1)
+				gfxHalt("GDISP: uGFXnet - Epoll failed");
+			#if GFXNET_BROADCAST
+				v->pollout = gFalse;
+			#endif
+		}
+	#endif
+	#if !GFXNET_BROADCAST
+		// Forget replies from an earlier connection
+		priv->replycount = 0;
+		while(gfxSemWait(&priv->replysem, gDelayNone));
+	#endif
+	priv->nviewers++;
+	if (!priv->controller)
+		setcontroller(priv, v);
+
+	// Send the initialisation data.
+	//	We always start with V1.0 - the display asks for anything newer.
+	priv->target = v;
+	sendcmd(priv, 6);
+	sendword(priv, GNETCODE_INIT);
+	sendword(priv, GNETCODE_VERSION_1_0);
+	sendword(priv, GDISP_SCREEN_WIDTH);
+	sendword(priv, GDISP_SCREEN_HEIGHT);
+	sendword(priv, GDISP_LLD_PIXELFORMAT);
+	sendword(priv, 1);							// We have a mouse
+	sendflush(priv);
+	priv->target = 0;
+
+	#if GDISP_GFXNET_SHADOW
+		// Send everything from the shadow copy. If the display can decode encoded blits
+		//	it tells us in its reply so give it a chance to do that first.
+		v->state = GDISP_GFXNET_VIEWER_RESYNC;
+		v->hello = GDISP_GFXNET_COMPRESS ? gFalse : gTrue;
+		v->unrotate = gFalse;
+		v->conntime = gfxSystemTicks();
+		v->ignorereplies = 0;
+		memset(v->dirty, 1, sizeof(v->dirty));
+		v->ndirty = GFXNET_BANDS;
+	#else
+		v->state = GDISP_GFXNET_VIEWER_LIVE;
+		priv->nlive++;
+		commonencodings(priv);
+	#endif
+	SEND_UNLOCK(priv);
 
 	// The display is now working
 	g->flags |= GDISP_FLG_CONNECTED;
 
 	// Send a redraw all
-	#if GFX_USE_GWIN && GWIN_NEED_WINDOWMANAGER
+	#if !GDISP_GFXNET_SHADOW && GFX_USE_GWIN && GWIN_NEED_WINDOWMANAGER
 		gdispGClear(g, gwinGetDefaultBgColor());
 		gwinRedrawDisplay(g, gFalse);
 	#endif
@@ -246,94 +1260,199 @@ static gBool newconnection(SOCKET_TYPE clientfd) {
 	return gTrue;
 }
 
-static gBool rxdata(SOCKET_TYPE fd) {
-	GDisplay *	g;
-    netPriv *	priv;
-    int			len;
-
-	// Look for a display that is connected and the socket descriptor matches
-	for(g = 0; (g = (GDisplay *)gdriverGetNext(GDRIVER_TYPE_DISPLAY, (GDriver *)g));) {
-		// Ignore displays for other controllers
-		#ifdef GDISP_DRIVER_LIST
-			if (gvmt(g) != &GDISPVMT_uGFXnet)
-				continue;
-		#endif
-		priv = g->priv;
-		if ((g->flags & GDISP_FLG_CONNECTED) && priv->netfd == fd)
-			break;
-	}
-	if (!g)
-		gfxHalt("GDISP: uGFXnet - Got data from unrecognized connection");
-
-	if ((g->flags & GDISP_FLG_HAVEDATA)) {
-		// The higher level is still processing the previous data.
-		//	Give it a chance to run by coming back to this data.
-		gfxSleepMilliseconds(1);
-		return gTrue;
-	}
+static void closeviewer(GDisplay *g, netViewer *v) {
+	netPriv *	priv;
 
-	/* handle data from a client */
-	MUTEX_ENTER;
-	if ((len = recv(fd, ((char *)priv->data)+priv->databytes, sizeof(priv->data)-priv->databytes, 0)) <= 0) {
-		// Socket closed or in error state
-		MUTEX_EXIT;
+	priv = g->priv;
+	SEND_LOCK(priv);
+	#if GDISP_GFXNET_EPOLL
+		epoll_ctl(epollfd, EPOLL_CTL_DEL, v->netfd, 0);
+	#endif
+	closesocket(v->netfd);
+	#if !GFXNET_BROADCAST
+		// Don't leave anyone waiting for a reply
+		putreply(priv, 0, 0);
+	#endif
+	if (v->state == GDISP_GFXNET_VIEWER_LIVE)
+		priv->nlive--;
+	v->state = GDISP_GFXNET_VIEWER_FREE;
+	#if GFXNET_BROADCAST
+		v->qlen = 0;
+	#endif
+	if (!--priv->nviewers)
 		g->flags &= ~GDISP_FLG_CONNECTED;
-		return gFalse;
-	}
-	MUTEX_EXIT;
+	commonencodings(priv);
 
-	// Do we have a full reply yet
-	priv->databytes += len;
-	if (priv->databytes < sizeof(priv->data))
-		return gTrue;
-	priv->databytes = 0;
+	// Hand the mouse to another viewer
+	if (priv->controller == v) {
+		for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS && v->state == GDISP_GFXNET_VIEWER_FREE; v++);
+		setcontroller(priv, v < priv->viewers + GDISP_GFXNET_VIEWERS ? v : 0);
+	}
+	SEND_UNLOCK(priv);
+}
 
-	// Convert network byte or to host byte order
-	priv->data[0] = ntohs(priv->data[0]);
-	priv->data[1] = ntohs(priv->data[1]);
+/**
+ * Act on a message from a viewer
+ */
+static void rxmessage(GDisplay *g, netViewer *v, gU16 code, gU16 value) {
+	netPriv *	priv;
 
-	// Process the data received
-	switch(priv->data[0]) {
+	priv = g->priv;
+	switch(code) {
 	#if GINPUT_NEED_MOUSE
-		case GNETCODE_MOUSE_X:		priv->mousex = priv->data[1];		break;
-		case GNETCODE_MOUSE_Y:		priv->mousey = priv->data[1];		break;
+		case GNETCODE_MOUSE_X:
+			if (v == priv->controller)
+				priv->mousex = value;
+			break;
+		case GNETCODE_MOUSE_Y:
+			if (v == priv->controller)
+				priv->mousey = value;
+			break;
 		case GNETCODE_MOUSE_B:
-			priv->mousebuttons = priv->data[1];
-			// Treat the button event as the sync signal
-			_gmouseWakeup(priv->mouse);
+			if (v == priv->controller) {
+				priv->mousebuttons = value;
+				// Treat the button event as the sync signal
+				_gmouseWakeup(priv->mouse);
+			}
 			break;
 	#endif
 	case GNETCODE_CONTROL:
 	case GNETCODE_READ:
-		g->flags |= GDISP_FLG_HAVEDATA;
+		#if !GFXNET_BROADCAST
+			SEND_LOCK(priv);
+			#if GDISP_GFXNET_SHADOW
+				// Was this a reply to a command the driver sent itself
+				if (code == GNETCODE_CONTROL && v->ignorereplies)
+					v->ignorereplies--;
+				else
+			#endif
+				putreply(priv, code, value);
+			SEND_UNLOCK(priv);
+		#endif
+		// Nothing waits for replies when there can be more than one viewer
+		break;
+	case GNETCODE_INIT:
+		// The display wants a newer protocol version. Tell it where in the command stream we switch.
+		if (value >= GNETCODE_VERSION_2_0 && v->version < GNETCODE_VERSION_2_0) {
+			SEND_LOCK(priv);
+			sendflush(priv);
+			priv->target = v;
+			sendcmd(priv, 2);
+			sendword(priv, GNETCODE_INIT);
+			sendword(priv, GNETCODE_VERSION_2_0);
+			sendflush(priv);
+			priv->target = 0;
+			v->version = GNETCODE_VERSION_2_0;
+			SEND_UNLOCK(priv);
+		}
+		break;
+	case GNETCODE_ENCODINGS:
+		SEND_LOCK(priv);
+		#if GDISP_GFXNET_COMPRESS
+			v->encodings = value & GFXNET_ENCODINGS;
+			commonencodings(priv);
+		#endif
+		#if GDISP_GFXNET_SHADOW
+			v->hello = gTrue;
+		#endif
+		SEND_UNLOCK(priv);
 		break;
 	case GNETCODE_KILL:
-		gfxHalt("GDISP: uGFXnet - Display sent KILL command");
+		if (v == priv->controller)
+			gfxHalt("GDISP: uGFXnet - Display sent KILL command");
 		break;
 
 	default:
 		// Just ignore unrecognised data
 		break;
 	}
+}
+
+/**
+ * Read what a viewer has sent.
+ * Returns gFalse if the connection has closed.
+ */
+static gBool rxdata(GDisplay *g, netViewer *v) {
+	gU16 *		p;
+	int			len;
+
+	/* handle data from a client */
+	MUTEX_ENTER;
+	len = recv(v->netfd, ((char *)v->rxbuf)+v->rxbytes, sizeof(v->rxbuf)-v->rxbytes, 0);
+	MUTEX_EXIT;
+	if (len <= 0) {
+		#if GDISP_GFXNET_EPOLL
+			// There was nothing to read after all
+			if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+				return gTrue;
+		#endif
+		// Socket closed or in error state
+		return gFalse;
+	}
+
+	// Process every complete message and keep any part message for next time
+	v->rxbytes += len;
+	for(p = v->rxbuf; v->rxbytes >= 2*sizeof(gU16); p += 2, v->rxbytes -= 2*sizeof(gU16))
+		rxmessage(g, v, ntohs(p[0]), ntohs(p[1]));
+	if (v->rxbytes && p != v->rxbuf)
+		memmove(v->rxbuf, p, v->rxbytes);
 	return gTrue;
 }
 
+/**
+ * Accept a connection and give it to a display
+ */
+static void rxconnection(SOCKET_TYPE listenfd) {
+	SOCKET_TYPE			clientfd;
+	socklen_t			len;
+	struct sockaddr_in	addr;
+
+	// Accept the connection
+	len = sizeof(addr);
+	if((clientfd = accept(listenfd, (struct sockaddr *)&addr, &len)) == (SOCKET_TYPE)-1)
+		gfxHalt("GDISP: uGFXnet - Accept failed");
+	//printf("New connection from %s on socket %d\n", inet_ntoa(addr.sin_addr), clientfd);
+
+	// Can we handle it?
+	if (!newconnection(clientfd)) {
+
+		// No - Just close the connection
+		closesocket(clientfd);
+
+		//printf("Rejected connection as all displays are already connected\n");
+	}
+}
+
 static GFX_THREAD_STACK(waNetThread, 512);
 static GFX_THREAD_FUNCTION(NetThread, param) {
-	SOCKET_TYPE			listenfd, fdmax, i, clientfd;
-	socklen_t			len;
-	fd_set				master, read_fds;
-    struct sockaddr_in	addr;
+	SOCKET_TYPE			listenfd;
+	struct sockaddr_in	addr;
+	netViewer *			v;
+	#if GDISP_GFXNET_EPOLL
+		struct epoll_event	ev, events[8];
+		eventfd_t			val;
+		int					n, i;
+	#else
+		SOCKET_TYPE			fdmax;
+		fd_set				read_fds, write_fds;
+		struct timeval		tv;
+		GDisplay *			g;
+		#if GFXNET_BROADCAST
+			NBIO_TYPE		nonblocking;
+			socklen_t		addrlen;
+			char			buf[16];
+		#endif
+	#endif
+	#if GDISP_GFXNET_BROKEN_LWIP_ACCEPT
+		SOCKET_TYPE			clientfd;
+		socklen_t			len;
+	#endif
 	(void)param;
 
 	// Start the sockets layer
 	StartSockets();
 	gfxSleepMilliseconds(100);					// Make sure the thread has time to start.
 
-	/* clear the master and temp sets */
-	FD_ZERO(&master);
-	FD_ZERO(&read_fds);
-
 	if ((listenfd = socket(AF_INET, SOCK_STREAM, 0)) == (SOCKET_TYPE)-1)
 		gfxHalt("GDISP: uGFXnet - Socket failed");
 
@@ -348,12 +1467,33 @@ static GFX_THREAD_FUNCTION(NetThread, param) {
     if (listen(listenfd, 10) == -1)
 		gfxHalt("GDISP: uGFXnet - Listen failed");
 
-
-    /* add the listener to the master set */
-    FD_SET(listenfd, &master);
-
-    /* keep track of the biggest file descriptor */
-    fdmax = listenfd; /* so far, it's this one*/
+	#if GDISP_GFXNET_EPOLL
+		// Each viewer is registered with a pointer to it. The listener has no pointer.
+		if ((epollfd = epoll_create1(0)) == -1 || (wakefd = eventfd(0, EFD_NONBLOCK)) == -1)
+			gfxHalt("GDISP: uGFXnet - Epoll failed");
+		ev.events = EPOLLIN;
+		ev.data.ptr = 0;
+		if (epoll_ctl(epollfd, EPOLL_CTL_ADD, listenfd, &ev) == -1)
+			gfxHalt("GDISP: uGFXnet - Epoll failed");
+		ev.data.ptr = &wakefd;
+		if (epoll_ctl(epollfd, EPOLL_CTL_ADD, wakefd, &ev) == -1)
+			gfxHalt("GDISP: uGFXnet - Epoll failed");
+	#elif GFXNET_BROADCAST
+		// A socket that sends to itself wakes select() when something is queued for a viewer.
+		//	It is optional as queued data is sent anyway when select() times out.
+		memset(&wakeaddr, 0, sizeof(wakeaddr));
+		wakeaddr.sin_family = AF_INET;
+		wakeaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addrlen = sizeof(wakeaddr);
+		nonblocking = 1;
+		if ((wakefd = socket(AF_INET, SOCK_DGRAM, 0)) != (SOCKET_TYPE)-1
+				&& (bind(wakefd, (struct sockaddr *)&wakeaddr, sizeof(wakeaddr)) == -1
+					|| getsockname(wakefd, (struct sockaddr *)&wakeaddr, &addrlen) == -1
+					|| ioctlsocket(wakefd, FIONBIO, &nonblocking) == -1)) {
+			closesocket(wakefd);
+			wakefd = (SOCKET_TYPE)-1;
+		}
+	#endif
 
 	#if GDISP_GFXNET_BROKEN_LWIP_ACCEPT
 		#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
@@ -372,55 +1512,82 @@ static GFX_THREAD_FUNCTION(NetThread, param) {
 			gfxHalt("GDISP: uGFXnet - Can't find display for connection");
 			return 0;
 		}
-
-		// Save the descriptor
-		FD_SET(clientfd, &master);
-		if (clientfd > fdmax) fdmax = clientfd;
 	#endif
 
     /* loop */
     for(;;) {
-		/* copy it */
-		read_fds = master;
-		if (select(fdmax+1, &read_fds, 0, 0, 0) == -1)
-			gfxHalt("GDISP: uGFXnet - Select failed");
-
-		// Run through the existing connections looking for data to be read
-		for(i = 0; i <= fdmax; i++) {
-			if(!FD_ISSET(i, &read_fds))
-				continue;
-
-			// Handle new connections
-			if(i == listenfd) {
-
-				// Accept the connection
-				len = sizeof(addr);
-				if((clientfd = accept(listenfd, (struct sockaddr *)&addr, &len)) == (SOCKET_TYPE)-1)
-					gfxHalt("GDISP: uGFXnet - Accept failed");
-				//printf("New connection from %s on socket %d\n", inet_ntoa(addr.sin_addr), clientfd);
-
-				// Can we handle it?
-				if (!newconnection(clientfd)) {
-
-					// No - Just close the connection
-					closesocket(clientfd);
+		#if GDISP_GFXNET_EPOLL
+			// Wait for something to happen but never for longer than the latency
+			if ((n = epoll_wait(epollfd, events, sizeof(events)/sizeof(events[0]), GDISP_GFXNET_LATENCY)) == -1) {
+				if (errno != EINTR)
+					gfxHalt("GDISP: uGFXnet - Epoll failed");
+				n = 0;
+			}
+			for(i = 0; i < n; i++) {
+				v = events[i].data.ptr;
+				if (!v)
+					rxconnection(listenfd);
+				else if (v == (netViewer *)&wakefd)
+					eventfd_read(wakefd, &val);
+				else if ((events[i].events & (EPOLLIN|EPOLLERR|EPOLLHUP)) && v->state != GDISP_GFXNET_VIEWER_FREE && !rxdata(v->display, v))
+					closeviewer(v->display, v);
+			}
 
-					//printf("Rejected connection as all displays are already connected\n");
-					continue;
+			// Send drawing commands that the application hasn't flushed and anything queued
+			sendservice();
+		#else
+			// Wait for new connections, data from the viewers or room to send what is queued for them
+			FD_ZERO(&read_fds);
+			FD_ZERO(&write_fds);
+			FD_SET(listenfd, &read_fds);
+			fdmax = listenfd;
+			#if GFXNET_BROADCAST
+				if (wakefd != (SOCKET_TYPE)-1) {
+					FD_SET(wakefd, &read_fds);
+					if (wakefd > fdmax) fdmax = wakefd;
+				}
+			#endif
+			for(g = 0; (g = nextdisplay(g));) {
+				for(v = ((netPriv *)g->priv)->viewers; v < ((netPriv *)g->priv)->viewers + GDISP_GFXNET_VIEWERS; v++) {
+					if (v->state == GDISP_GFXNET_VIEWER_FREE)
+						continue;
+					FD_SET(v->netfd, &read_fds);
+					#if GFXNET_BROADCAST
+						if (v->qlen)
+							FD_SET(v->netfd, &write_fds);
+					#endif
+					if (v->netfd > fdmax) fdmax = v->netfd;
 				}
-
-				// Save the descriptor
-				FD_SET(clientfd, &master);
-				if (clientfd > fdmax) fdmax = clientfd;
-				continue;
 			}
+			tv.tv_sec = GDISP_GFXNET_LATENCY / 1000;
+			tv.tv_usec = (GDISP_GFXNET_LATENCY % 1000) * 1000;
+			if (select(fdmax+1, &read_fds, &write_fds, 0, &tv) == -1)
+				gfxHalt("GDISP: uGFXnet - Select failed");
+
+			#if GFXNET_BROADCAST
+				// Empty the wake socket
+				if (wakefd != (SOCKET_TYPE)-1 && FD_ISSET(wakefd, &read_fds)) {
+					MUTEX_ENTER;
+					while(recv(wakefd, buf, sizeof(buf), 0) > 0);
+					MUTEX_EXIT;
+				}
+			#endif
 
-			// Handle data from a client
-			if (!rxdata(i)) {
-				closesocket(i);
-				FD_CLR(clientfd, &master);
+			// Handle data from the viewers
+			for(g = 0; (g = nextdisplay(g));) {
+				for(v = ((netPriv *)g->priv)->viewers; v < ((netPriv *)g->priv)->viewers + GDISP_GFXNET_VIEWERS; v++) {
+					if (v->state != GDISP_GFXNET_VIEWER_FREE && FD_ISSET(v->netfd, &read_fds) && !rxdata(g, v))
+						closeviewer(g, v);
+				}
 			}
-		}
+
+			// Send drawing commands that the application hasn't flushed and anything queued
+			sendservice();
+
+			// Handle new connections
+			if (FD_ISSET(listenfd, &read_fds))
+				rxconnection(listenfd);
+		#endif
 	}
     return 0;
 }
@@ -443,6 +1610,26 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	if (!(priv = gfxAlloc(sizeof(netPriv))))
 		gfxHalt("GDISP: uGFXnet - Memory allocation failed");
 	memset(priv, 0, sizeof(netPriv));
+	gfxMutexInit(&priv->sendlock);
+	#if GDISP_GFXNET_SHADOW
+		if (!(priv->shadow = gfxAlloc(GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT * sizeof(gPixel))))
+			gfxHalt("GDISP: uGFXnet - Memory allocation failed");
+		memset(priv->shadow, 0, GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT * sizeof(gPixel));
+	#endif
+	{
+		unsigned	i;
+
+		for(i = 0; i < GDISP_GFXNET_VIEWERS; i++) {
+			priv->viewers[i].display = g;
+			#if GFXNET_BROADCAST
+				if (!(priv->viewers[i].queue = gfxAlloc(GDISP_GFXNET_QUEUE)))
+					gfxHalt("GDISP: uGFXnet - Memory allocation failed");
+			#endif
+		}
+	}
+	#if !GFXNET_BROADCAST
+		gfxSemInit(&priv->replysem, 0, GFXNET_REPLIES);
+	#endif
 	g->priv = priv;
 	g->board = 0;			// no board interface for this controller
 
@@ -465,21 +1652,14 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 #if GDISP_HARDWARE_FLUSH
 	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
 		netPriv	*	priv;
-		gU16	buf[1];
-
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
-				return;
-		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
-		#endif
 
+		if (!senddrawing(g, 0, 0, 0, 0))
+			return;
 		priv = g->priv;
-		buf[0] = GNETCODE_FLUSH;
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 1);
-		MUTEX_EXIT;
+		sendcmd(priv, 1);
+		sendword(priv, GNETCODE_FLUSH);
+		sendflush(priv);
+		SEND_UNLOCK(priv);
 	}
 #endif
 
@@ -488,22 +1668,24 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		netPriv	*	priv;
 		gU16	buf[4];
 
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
-				return;
-		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
+		#if GDISP_GFXNET_SHADOW
+			{
+				int		xs, ys;
+
+				*shadow_pos(g, g->p.x, g->p.y, &xs, &ys) = g->p.color;
+			}
 		#endif
 
+		if (!senddrawing(g, g->p.x, g->p.y, 1, 1))
+			return;
 		priv = g->priv;
 		buf[0] = GNETCODE_PIXEL;
 		buf[1] = g->p.x;
 		buf[2] = g->p.y;
 		buf[3] = gdispColor2Native(g->p.color);
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 4);
-		MUTEX_EXIT;
+		sendcmd(priv, 4);
+		sendpkt(priv, buf, 4);
+		SEND_UNLOCK(priv);
 	}
 #endif
 
@@ -514,14 +1696,23 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		netPriv	*	priv;
 		gU16	buf[6];
 
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
-				return;
-		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
+		#if GDISP_GFXNET_SHADOW
+			{
+				gPixel *	p;
+				gPixel *	q;
+				int			xs, ys;
+				gCoord		x, y;
+
+				p = shadow_pos(g, g->p.x, g->p.y, &xs, &ys);
+				for(y = 0; y < g->p.cy; y++, p += ys) {
+					for(q = p, x = 0; x < g->p.cx; x++, q += xs)
+						*q = g->p.color;
+				}
+			}
 		#endif
 
+		if (!senddrawing(g, g->p.x, g->p.y, g->p.cx, g->p.cy))
+			return;
 		priv = g->priv;
 		buf[0] = GNETCODE_FILL;
 		buf[1] = g->p.x;
@@ -529,80 +1720,85 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		buf[3] = g->p.cx;
 		buf[4] = g->p.cy;
 		buf[5] = gdispColor2Native(g->p.color);
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 6);
-		MUTEX_EXIT;
+		sendcmd(priv, 6);
+		sendpkt(priv, buf, 6);
+		SEND_UNLOCK(priv);
 	}
 #endif
 
 #if GDISP_HARDWARE_BITFILLS
 	LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
-		netPriv	*	priv;
-		gPixel	*	buffer;
-		gU16	buf[5];
-		gCoord		x, y;
-
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
-				return;
-		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
-		#endif
+		const gPixel *	buffer;
 
 		// Make everything relative to the start of the line
 		buffer = g->p.ptr;
-		buffer += g->p.x2*g->p.y1;
-
-		priv = g->priv;
-		buf[0] = GNETCODE_BLIT;
-		buf[1] = g->p.x;
-		buf[2] = g->p.y;
-		buf[3] = g->p.cx;
-		buf[4] = g->p.cy;
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 5);
-
-		for(y = 0; y < g->p.cy; y++, buffer += g->p.x2 - g->p.cx) {
-			for(x = 0; x < g->p.cx; x++, buffer++) {
-				buf[0] = gdispColor2Native(buffer[0]);
-				sendpkt(priv->netfd, buf, 1);
+		buffer += g->p.x2*g->p.y1 + g->p.x1;
+
+		#if GDISP_GFXNET_SHADOW
+			{
+				const gPixel *	src;
+				gPixel *		p;
+				gPixel *		q;
+				int				xs, ys;
+				gCoord			x, y;
+
+				p = shadow_pos(g, g->p.x, g->p.y, &xs, &ys);
+				for(src = buffer, y = 0; y < g->p.cy; y++, p += ys, src += g->p.x2) {
+					if (xs == 1)
+						memcpy(p, src, g->p.cx * sizeof(gPixel));
+					else {
+						for(q = p, x = 0; x < g->p.cx; x++, q += xs)
+							*q = src[x];
+					}
+				}
 			}
-		}
-		MUTEX_EXIT;
+		#endif
+
+		if (!senddrawing(g, g->p.x, g->p.y, g->p.cx, g->p.cy))
+			return;
+		sendblit(g->priv, buffer, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.x2);
+		SEND_UNLOCK((netPriv *)g->priv);
 	}
 #endif
 
 #if GDISP_HARDWARE_PIXELREAD
 	LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
-		netPriv	*	priv;
-		gU16	buf[3];
-		gColor		data;
+		#if GDISP_GFXNET_SHADOW
+			int			xs, ys;
 
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
+			// Anti-aliased text reads pixels beyond the clipping area
+			if (g->p.x < 0 || g->p.x >= g->g.Width || g->p.y < 0 || g->p.y >= g->g.Height)
 				return 0;
+
+			// Answer from the shadow copy rather than asking the display
+			return *shadow_pos(g, g->p.x, g->p.y, &xs, &ys);
 		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
+			netPriv	*	priv;
+			gU16	buf[3];
+
+			#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
+				if (!(g->flags & GDISP_FLG_CONNECTED))
+					return 0;
+			#else
+				while(!(g->flags & GDISP_FLG_CONNECTED))
+					gfxSleepMilliseconds(200);
+			#endif
+
+			priv = g->priv;
+			buf[0] = GNETCODE_READ;
+			buf[1] = g->p.x;
+			buf[2] = g->p.y;
+			SEND_LOCK(priv);
+			sendcmd(priv, 3);
+			sendpkt(priv, buf, 3);
+			sendflush(priv);
+			SEND_UNLOCK(priv);
+
+			// Now wait for a reply
+			if (!getreply(priv, GNETCODE_READ, buf))
+				return 0;
+			return gdispNative2Color(buf[0]);
 		#endif
-
-		priv = g->priv;
-		buf[0] = GNETCODE_READ;
-		buf[1] = g->p.x;
-		buf[2] = g->p.y;
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 3);
-		MUTEX_EXIT;
-
-		// Now wait for a reply
-		while(!(g->flags & GDISP_FLG_HAVEDATA) || priv->data[0] != GNETCODE_READ)
-			gfxSleepMilliseconds(1);
-
-		data = gdispNative2Color(priv->data[1]);
-		g->flags &= ~GDISP_FLG_HAVEDATA;
-
-		return data;
 	}
 #endif
 
@@ -611,14 +1807,38 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		netPriv	*	priv;
 		gU16	buf[6];
 
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
-			if (!(g->flags & GDISP_FLG_CONNECTED))
-				return;
-		#else
-			while(!(g->flags & GDISP_FLG_CONNECTED))
-				gfxSleepMilliseconds(200);
+		#if GDISP_GFXNET_SHADOW
+			{
+				gPixel *	p;
+				gPixel *	d;
+				gPixel *	s;
+				int			xs, ys;
+				gCoord		x, y, lines;
+
+				// Move each display line. The area left behind is cleared by the high level code.
+				p = shadow_pos(g, g->p.x, g->p.y, &xs, &ys);
+				lines = g->p.y1;
+				if (lines < 0) {
+					// Work from the bottom up
+					p += (g->p.cy-1) * ys;
+					ys = -ys;
+					lines = -lines;
+				}
+				for(y = lines; y < g->p.cy; y++, p += ys) {
+					d = p;
+					s = p + lines * ys;
+					if (xs == 1)
+						memcpy(d, s, g->p.cx * sizeof(gPixel));
+					else {
+						for(x = 0; x < g->p.cx; x++, d += xs, s += xs)
+							*d = *s;
+					}
+				}
+			}
 		#endif
 
+		if (!senddrawing(g, g->p.x, g->p.y, g->p.cx, g->p.cy))
+			return;
 		priv = g->priv;
 		buf[0] = GNETCODE_SCROLL;
 		buf[1] = g->p.x;
@@ -626,9 +1846,9 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		buf[3] = g->p.cx;
 		buf[4] = g->p.cy;
 		buf[5] = g->p.y1;
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 6);
-		MUTEX_EXIT;
+		sendcmd(priv, 6);
+		sendpkt(priv, buf, 6);
+		SEND_UNLOCK(priv);
 	}
 #endif
 
@@ -638,7 +1858,32 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		gU16	buf[3];
 		gBool		allgood;
 
-		#if GDISP_DONT_WAIT_FOR_NET_DISPLAY
+		priv = g->priv;
+
+		// Choose which viewer's mouse is used
+		if (g->p.x == GDISP_GFXNET_CONTROL_INPUT) {
+			SEND_LOCK(priv);
+			if ((unsigned)(gPtrDiff)g->p.ptr < GDISP_GFXNET_VIEWERS && priv->viewers[(unsigned)(gPtrDiff)g->p.ptr].state != GDISP_GFXNET_VIEWER_FREE)
+				setcontroller(priv, priv->viewers + (unsigned)(gPtrDiff)g->p.ptr);
+			SEND_UNLOCK(priv);
+			return;
+		}
+
+		// Restart the traffic counters
+		if (g->p.x == GDISP_GFXNET_CONTROL_RESETSTATS) {
+			netViewer *	v;
+
+			SEND_LOCK(priv);
+			memset(&priv->stats, 0, sizeof(priv->stats));
+			for(v = priv->viewers; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++)
+				memset(&v->stats, 0, sizeof(v->stats));
+			SEND_UNLOCK(priv);
+			return;
+		}
+
+		#if GFXNET_BROADCAST || GDISP_GFXNET_SHADOW
+			// Nothing waits for the viewers. Viewers that connect later are sent the settings along with the shadow copy.
+		#elif GDISP_DONT_WAIT_FOR_NET_DISPLAY
 			if (!(g->flags & GDISP_FLG_CONNECTED))
 				return;
 		#else
@@ -657,9 +1902,9 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 				return;
 			break;
 		case GDISP_CONTROL_BACKLIGHT:
-			if (g->g.Backlight == (gU16)(int)g->p.ptr)
+			if (g->g.Backlight == (gU16)(gPtrDiff)g->p.ptr)
 				return;
-			if ((gU16)(int)g->p.ptr > 100)
+			if ((gU16)(gPtrDiff)g->p.ptr > 100)
 				g->p.ptr = (void *)100;
 			break;
 		default:
@@ -667,21 +1912,42 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 		}
 
 		// Send the command
-		priv = g->priv;
 		buf[0] = GNETCODE_CONTROL;
 		buf[1] = g->p.x;
-		buf[2] = (gU16)(int)g->p.ptr;
-		MUTEX_ENTER;
-		sendpkt(priv->netfd, buf, 3);
-		MUTEX_EXIT;
-
-		// Now wait for a reply
-		while(!(g->flags & GDISP_FLG_HAVEDATA) || priv->data[0] != GNETCODE_CONTROL)
-			gfxSleepMilliseconds(1);
-
-		// Extract the return status
-		allgood = priv->data[1] ? gTrue : gFalse;
-		g->flags &= ~GDISP_FLG_HAVEDATA;
+		buf[2] = (gU16)(gPtrDiff)g->p.ptr;
+		SEND_LOCK(priv);
+		#if GFXNET_BROADCAST
+			// Only the live viewers are told and the replies are ignored
+			if (priv->nlive) {
+				sendcmd(priv, 3);
+				sendpkt(priv, buf, 3);
+				sendflush(priv);
+			}
+			SEND_UNLOCK(priv);
+			allgood = gTrue;
+		#else
+			#if GDISP_GFXNET_SHADOW
+				if (!priv->nviewers) {
+					// Only the shadow copy changes. The display is sent the setting when it connects.
+					SEND_UNLOCK(priv);
+					allgood = gTrue;
+				} else
+			#endif
+			{
+				#if GDISP_GFXNET_SHADOW
+					// The display must be up to date before it is changed
+					if (priv->viewers[0].state == GDISP_GFXNET_VIEWER_RESYNC)
+						sendresync(g, priv->viewers);
+				#endif
+				sendcmd(priv, 3);
+				sendpkt(priv, buf, 3);
+				sendflush(priv);
+				SEND_UNLOCK(priv);
+
+				// Now wait for a reply and extract the return status
+				allgood = getreply(priv, GNETCODE_CONTROL, buf) && buf[0] ? gTrue : gFalse;
+			}
+		#endif
 
 		// Do nothing more if the operation failed
 		if (!allgood) return;
@@ -709,12 +1975,51 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 			g->g.Powermode = (gPowermode)g->p.ptr;
 			break;
 		case GDISP_CONTROL_BACKLIGHT:
-			g->g.Backlight = (gU16)(int)g->p.ptr;
+			g->g.Backlight = (gU16)(gPtrDiff)g->p.ptr;
 			break;
 		}
 	}
 #endif
 
+#if GDISP_NEED_QUERY && GDISP_HARDWARE_QUERY
+	LLDSPEC void *gdisp_lld_query(GDisplay *g) {
+		switch(g->p.x) {
+		case GDISP_GFXNET_QUERY_STATS:
+			{
+				netPriv *	priv;
+
+				priv = g->priv;
+				SEND_LOCK(priv);
+				priv->statsnap = priv->stats;
+				SEND_UNLOCK(priv);
+				return &priv->statsnap;
+			}
+		case GDISP_GFXNET_QUERY_VIEWERS:
+			{
+				netPriv *				priv;
+				netViewer *				v;
+				gdispNetViewerStats *	s;
+
+				// Take a snapshot so the application sees consistent numbers
+				priv = g->priv;
+				SEND_LOCK(priv);
+				for(v = priv->viewers, s = priv->vstats; v < priv->viewers + GDISP_GFXNET_VIEWERS; v++, s++) {
+					*s = v->stats;
+					s->state = v->state;
+					s->input = v == priv->controller && v->state != GDISP_GFXNET_VIEWER_FREE;
+					#if GFXNET_BROADCAST
+						s->queued = v->qlen;
+						s->lag = v->qlen ? gfxSystemTicks() - v->qtime : 0;
+					#endif
+				}
+				SEND_UNLOCK(priv);
+				return priv->vstats;
+			}
+		}
+		return (void *)-1;
+	}
+#endif
+
 #if GINPUT_NEED_MOUSE
 	static gBool NMouseInit(GMouse *m, unsigned driverinstance) {
 		(void)	m;
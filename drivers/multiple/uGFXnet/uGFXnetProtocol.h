@@ -5,10 +5,11 @@
  *              http://ugfx.io/license.html
  */
 
-#define GNETCODE_VERSION			GNETCODE_VERSION_1_0		// The current protocol version
+#define GNETCODE_VERSION			GNETCODE_VERSION_2_0		// The current protocol version
 
 // The list of possible protocol version numbers
 #define GNETCODE_VERSION_1_0		0x0100		// V1.0
+#define GNETCODE_VERSION_2_0		0x0200		// V2.0 - Commands from the host are batched into length prefixed frames
 
 // The required pixel format
 #define GNETCODE_PIXELFORMAT		GDISP_PIXELFORMAT_RGB565
@@ -19,8 +20,17 @@
 /**
  * All commands are sent in 16 bit blocks (2 bytes) in network order (BigEndian)
  * Across all uGFXnet protocol versions, the stream will always start with GNETCODE_INIT (0xFFFF) and then the version number.
+ * The host always starts with version 1.0 so that V1.0 displays keep working.
+ *
+ * Version 2.0:
+ * A display that understands V2.0 sends GNETCODE_INIT,GNETCODE_VERSION_2_0 after the initial header.
+ * The host replies (in V1.0 format) with GNETCODE_INIT,GNETCODE_VERSION_2_0 at the point in the command stream where it switches.
+ * After that everything from the host is sent in frames. Each frame is the number of bytes that follow as two 16 bit blocks
+ * (most significant first) followed by that many bytes of commands in the V1.0 format. A command may be split across frames.
+ * Everything sent by the display is unchanged.
  */
 #define GNETCODE_INIT			0xFFFF		// Followed by version,width,height,pixelformat,hasmouse
+											//	or by a version when requesting or confirming a protocol upgrade.
 #define GNETCODE_FLUSH			0x0000		// No following data
 #define GNETCODE_PIXEL			0x0001		// Followed by x,y,color
 #define GNETCODE_FILL			0x0002		// Followed by x,y,cx,cy,color
@@ -31,4 +41,21 @@
 #define GNETCODE_MOUSE_X		0x0007		// This is only ever received - never sent. Response is GNETCODE_MOUSE_X,x
 #define GNETCODE_MOUSE_Y		0x0008		// This is only ever received - never sent. Response is GNETCODE_MOUSE_Y,y
 #define GNETCODE_MOUSE_B		0x0009		// This is only ever received - never sent. Response is GNETCODE_MOUSE_B,buttons. This is also the sync signal for mouse updates.
+#define GNETCODE_ENCODINGS		0x000A		// This is only ever received - never sent. Followed by a GNETCODE_ENC_xxx mask of the blit encodings the display can decode. No response.
+#define GNETCODE_BLITENC		0x000B		// Followed by x,y,cx,cy,encoding,length,data - Only sent to displays that asked for the encoding. Length is the number of 16 bit blocks of data.
 #define GNETCODE_KILL			0xFFFE		// This is only ever received - never sent. Response is GNETCODE_KILL,retcode
+
+/**
+ * Blit encodings for GNETCODE_BLITENC. All data is in 16 bit blocks like everything else.
+ *
+ * GNETCODE_ENC_RLE:		Pairs of count,color. The counts add up to cx * cy.
+ * GNETCODE_ENC_PALETTE:	The number of colors (1 to 256), the colors and then a palette index for each pixel.
+ *							The indexes are 1, 2, 4 or 8 bits (the smallest that holds the number of colors) packed
+ *							most significant bits first with no padding between rows. The last block is padded with zeros.
+ * GNETCODE_ENC_LZ:			A list of tokens. A token with the top bit clear is followed by that many colors.
+ *							A token with the top bit set is followed by a distance and copies (token & 0x7FFF) pixels
+ *							starting that many pixels back in the decoded output. A copy may overlap the pixels it writes.
+ */
+#define GNETCODE_ENC_RLE		0x0001
+#define GNETCODE_ENC_PALETTE	0x0002
+#define GNETCODE_ENC_LZ			0x0004
@@ -78,6 +78,9 @@
 
 //#define GDISP_NEED_AUTOFLUSH                         GFXOFF
 //#define GDISP_NEED_TIMERFLUSH                        GFXOFF
+//#define GDISP_NEED_FRAMECLOCK                        GFXOFF
+//    #define GDISP_FRAMECLOCK_RATE                    30
+//    #define GDISP_FRAMECLOCK_BUCKETS                 8
 //#define GDISP_NEED_VALIDATION                        GFXON
 //#define GDISP_NEED_CLIP                              GFXON
 //#define GDISP_NEED_CIRCLE                            GFXOFF
@@ -158,12 +161,36 @@
 
 //#define GDISP_NEED_PIXMAP                            GFXOFF
 //    #define GDISP_NEED_PIXMAP_IMAGE                  GFXOFF
+//#define GDISP_NEED_LAYERS                            GFXOFF
+//    #define GDISP_LAYER_DAMAGE_RECTS                 8
+//#define GDISP_NEED_MIRROR                            GFXOFF
+//#define GDISP_NEED_SPRITES                           GFXOFF
+//#define GDISP_NEED_STATISTICS                        GFXOFF
+//    #define GDISP_STATISTICS_CLOCK()                 ((gU32)gfxSystemTicks())
+//#define GDISP_NEED_PATHCAL                           GFXOFF
+//    #define GDISP_PATHCAL_STARTUP                    GFXON
+//    #define GDISP_PATHCAL_TIME                       4
+//#define GDISP_NEED_TRACE                             GFXOFF
+//    #define GDISP_TRACE_BUFSIZE                      512
+//#define GDISP_NEED_ASYNCFLUSH                        GFXOFF
+//    #define GDISP_ASYNCFLUSH_THREAD_STACKSIZE        1024
+//    #define GDISP_ASYNCFLUSH_THREAD_PRIORITY         gThreadpriorityNormal
+//#define GDISP_NEED_ACCEL                             GFXOFF
+//    #define GDISP_ACCEL_MINAREA                      256
+//    #define GDISP_ACCEL_QUEUE                        8
+//    #define GDISP_ACCEL_THREAD_STACKSIZE             1024
+//    #define GDISP_ACCEL_THREAD_PRIORITY              gThreadpriorityLow
 
 //#define GDISP_DEFAULT_ORIENTATION                    gOrientationLandscape    // If not defined the native hardware orientation is used.
 //#define GDISP_LINEBUF_SIZE                           128
 //#define GDISP_STARTUP_COLOR                          GFX_BLACK
 //#define GDISP_NEED_STARTUP_LOGO                      GFXON
 
+//#define GDISP_EPAPER_WINDOWS                         4
+//#define GDISP_EPAPER_GHOSTBUDGET                     300
+//#define GDISP_EPAPER_MAXPARTIALS                     20
+//#define GDISP_EPAPER_FULLAREA                        60
+
 //#define GDISP_TOTAL_DISPLAYS                         1
 
 //#define GDISP_DRIVER_LIST                            GDISPVMT_Win32, GDISPVMT_Win32
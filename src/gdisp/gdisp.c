@@ -12,6 +12,10 @@
 /* Include the low level driver information */
 #include "gdisp_driver.h"
 
+#if GDISP_NEED_STATISTICS || GDISP_NEED_FRAMECLOCK || GDISP_NEED_PATHCAL
+	#include <string.h>			// for memset()
+#endif
+
 // Number of milliseconds for the startup logo - 0 means disabled.
 #if GDISP_NEED_STARTUP_LOGO
 	#define GDISP_STARTUP_LOGO_TIMEOUT		1000
@@ -28,12 +32,40 @@
 	static GTimer	FlushTimer;
 #endif
 
+#if GDISP_NEED_FRAMECLOCK
+	static gMutex		frameLock;					// Protects the frame clock counters and statistics of every display
+	static gSem			frameTick;					// Signalled once for each waiter at each tick of any frame clock
+	static unsigned		frameWaiters;
+#endif
+
+#if GDISP_NEED_ASYNCFLUSH
+	#define FLUSH_PENDING		0x01				// An asynchronous flush is waiting to start
+	#define FLUSH_RUNNING		0x02				// The flush thread is flushing the display
+
+	static gMutex		flushLock;					// Protects the flush state of every display
+	static gSem			flushJobs;					// Signalled when a flush is asked for
+	static gSem			flushDone;					// Signalled once for each waiter when a flush finishes
+	static unsigned		flushWaiters;
+	static gThread		flushThread;
+
+	#define FLUSHMUTEX_ENTER(g)		gfxMutexEnter(&(g)->flushmutex)
+	#define FLUSHMUTEX_EXIT(g)		gfxMutexExit(&(g)->flushmutex)
+#else
+	#define FLUSHMUTEX_ENTER(g)
+	#define FLUSHMUTEX_EXIT(g)
+#endif
+
 GDisplay	*GDISP;
 
 #if GDISP_NEED_MULTITHREAD
 	#define MUTEX_INIT(g)		gfxMutexInit(&(g)->mutex)
 	#define MUTEX_ENTER(g)		gfxMutexEnter(&(g)->mutex)
-	#define MUTEX_EXIT(g)		gfxMutexExit(&(g)->mutex)
+	#if GDISP_NEED_LAYERS
+		// A layer that was flushed while it was locked is composed once it is unlocked
+		#define MUTEX_EXIT(g)	{ if (((g)->flags & GDISP_FLG_LAYERFLUSH)) layerunlock(g); else gfxMutexExit(&(g)->mutex); }
+	#else
+		#define MUTEX_EXIT(g)	gfxMutexExit(&(g)->mutex)
+	#endif
 	#define MUTEX_DEINIT(g)		gfxMutexDestroy(&(g)->mutex)
 #else
 	#define MUTEX_INIT(g)
@@ -42,6 +74,210 @@ GDisplay	*GDISP;
 	#define MUTEX_DEINIT(g)
 #endif
 
+#if GDISP_NEED_STATISTICS
+	// Record which primitive is running so pixels can be attributed to it
+	#define STAT_PRIMITIVE(g, prim)		{ (g)->statprim = (prim); (g)->stats.calls[prim]++; }
+	#define STAT_LLD_START()			gU32 stattime = GDISP_STATISTICS_CLOCK()
+	#define STAT_LLD_END(g, type, px)	{ (g)->stats.lldtime += GDISP_STATISTICS_CLOCK() - stattime; (g)->stats.lldcalls[type]++; (g)->stats.pixels[(g)->statprim] += (px); }
+
+	// Time spent waiting for the display
+	#if GDISP_NEED_MULTITHREAD
+		#undef MUTEX_ENTER
+		#define MUTEX_ENTER(g)		{ gU32 statwait = GDISP_STATISTICS_CLOCK(); gfxMutexEnter(&(g)->mutex); (g)->stats.mutexwait += GDISP_STATISTICS_CLOCK() - statwait; }
+	#endif
+
+	// Wrap each low level driver call. Each wrapper is defined before the driver call is redirected to it
+	//	so that it calls the real driver routine.
+	#if GDISP_HARDWARE_FLUSH
+		static void stat_lld_flush(GDisplay *g) { STAT_LLD_START(); gdisp_lld_flush(g); STAT_LLD_END(g, gdispStatLLDOther, 0); }
+		#undef gdisp_lld_flush
+		#define gdisp_lld_flush(g)				stat_lld_flush(g)
+	#endif
+	#if GDISP_HARDWARE_STREAM_WRITE
+		static void stat_lld_write_start(GDisplay *g) { STAT_LLD_START(); gdisp_lld_write_start(g); STAT_LLD_END(g, gdispStatLLDStream, 0); }
+		static void stat_lld_write_color(GDisplay *g) { STAT_LLD_START(); gdisp_lld_write_color(g); STAT_LLD_END(g, gdispStatLLDStream, 1); }
+		static void stat_lld_write_stop(GDisplay *g) { STAT_LLD_START(); gdisp_lld_write_stop(g); STAT_LLD_END(g, gdispStatLLDStream, 0); }
+		#undef gdisp_lld_write_start
+		#undef gdisp_lld_write_color
+		#undef gdisp_lld_write_stop
+		#define gdisp_lld_write_start(g)		stat_lld_write_start(g)
+		#define gdisp_lld_write_color(g)		stat_lld_write_color(g)
+		#define gdisp_lld_write_stop(g)			stat_lld_write_stop(g)
+		#if GDISP_HARDWARE_STREAM_POS
+			static void stat_lld_write_pos(GDisplay *g) { STAT_LLD_START(); gdisp_lld_write_pos(g); STAT_LLD_END(g, gdispStatLLDStream, 0); }
+			#undef gdisp_lld_write_pos
+			#define gdisp_lld_write_pos(g)		stat_lld_write_pos(g)
+		#endif
+		#if GDISP_HARDWARE_STREAM_BUFFER
+			static void stat_lld_write_buffer(GDisplay *g) { STAT_LLD_START(); gdisp_lld_write_buffer(g); STAT_LLD_END(g, gdispStatLLDStream, g->p.cx); }
+			#undef gdisp_lld_write_buffer
+			#define gdisp_lld_write_buffer(g)	stat_lld_write_buffer(g)
+		#endif
+	#endif
+	#if GDISP_HARDWARE_STREAM_READ
+		static void stat_lld_read_start(GDisplay *g) { STAT_LLD_START(); gdisp_lld_read_start(g); STAT_LLD_END(g, gdispStatLLDStream, 0); }
+		static gColor stat_lld_read_color(GDisplay *g) { gColor c; STAT_LLD_START(); c = gdisp_lld_read_color(g); STAT_LLD_END(g, gdispStatLLDStream, 1); return c; }
+		static void stat_lld_read_stop(GDisplay *g) { STAT_LLD_START(); gdisp_lld_read_stop(g); STAT_LLD_END(g, gdispStatLLDStream, 0); }
+		#undef gdisp_lld_read_start
+		#undef gdisp_lld_read_color
+		#undef gdisp_lld_read_stop
+		#define gdisp_lld_read_start(g)			stat_lld_read_start(g)
+		#define gdisp_lld_read_color(g)			stat_lld_read_color(g)
+		#define gdisp_lld_read_stop(g)			stat_lld_read_stop(g)
+	#endif
+	#if GDISP_HARDWARE_DRAWPIXEL
+		static void stat_lld_draw_pixel(GDisplay *g) { STAT_LLD_START(); gdisp_lld_draw_pixel(g); STAT_LLD_END(g, gdispStatLLDPixel, 1); }
+		#undef gdisp_lld_draw_pixel
+		#define gdisp_lld_draw_pixel(g)			stat_lld_draw_pixel(g)
+	#endif
+	#if GDISP_HARDWARE_CLEARS
+		static void stat_lld_clear(GDisplay *g) { STAT_LLD_START(); gdisp_lld_clear(g); STAT_LLD_END(g, gdispStatLLDFill, (gU32)g->g.Width * g->g.Height); }
+		#undef gdisp_lld_clear
+		#define gdisp_lld_clear(g)				stat_lld_clear(g)
+	#endif
+	#if GDISP_HARDWARE_FILLS
+		static void stat_lld_fill_area(GDisplay *g) { STAT_LLD_START(); gdisp_lld_fill_area(g); STAT_LLD_END(g, gdispStatLLDFill, (gU32)g->p.cx * g->p.cy); }
+		#undef gdisp_lld_fill_area
+		#define gdisp_lld_fill_area(g)			stat_lld_fill_area(g)
+	#endif
+	#if GDISP_HARDWARE_BITFILLS
+		static void stat_lld_blit_area(GDisplay *g) { STAT_LLD_START(); gdisp_lld_blit_area(g); STAT_LLD_END(g, gdispStatLLDBlit, (gU32)g->p.cx * g->p.cy); }
+		#undef gdisp_lld_blit_area
+		#define gdisp_lld_blit_area(g)			stat_lld_blit_area(g)
+	#endif
+	#if GDISP_HARDWARE_PIXELREAD
+		static gColor stat_lld_get_pixel_color(GDisplay *g) { gColor c; STAT_LLD_START(); c = gdisp_lld_get_pixel_color(g); STAT_LLD_END(g, gdispStatLLDRead, 1); return c; }
+		#undef gdisp_lld_get_pixel_color
+		#define gdisp_lld_get_pixel_color(g)	stat_lld_get_pixel_color(g)
+	#endif
+	#if GDISP_HARDWARE_SCROLL && GDISP_NEED_SCROLL
+		static void stat_lld_vertical_scroll(GDisplay *g) { STAT_LLD_START(); gdisp_lld_vertical_scroll(g); STAT_LLD_END(g, gdispStatLLDScroll, (gU32)g->p.cx * g->p.cy); }
+		#undef gdisp_lld_vertical_scroll
+		#define gdisp_lld_vertical_scroll(g)	stat_lld_vertical_scroll(g)
+	#endif
+	#if GDISP_HARDWARE_CONTROL && GDISP_NEED_CONTROL
+		static void stat_lld_control(GDisplay *g) { STAT_LLD_START(); gdisp_lld_control(g); STAT_LLD_END(g, gdispStatLLDOther, 0); }
+		#undef gdisp_lld_control
+		#define gdisp_lld_control(g)			stat_lld_control(g)
+	#endif
+	#if GDISP_HARDWARE_QUERY && GDISP_NEED_QUERY
+		static void *stat_lld_query(GDisplay *g) { void *r; STAT_LLD_START(); r = gdisp_lld_query(g); STAT_LLD_END(g, gdispStatLLDOther, 0); return r; }
+		#undef gdisp_lld_query
+		#define gdisp_lld_query(g)				stat_lld_query(g)
+	#endif
+	#if GDISP_HARDWARE_CLIP && (GDISP_NEED_CLIP || GDISP_NEED_VALIDATION)
+		static void stat_lld_set_clip(GDisplay *g) { STAT_LLD_START(); gdisp_lld_set_clip(g); STAT_LLD_END(g, gdispStatLLDOther, 0); }
+		#undef gdisp_lld_set_clip
+		#define gdisp_lld_set_clip(g)			stat_lld_set_clip(g)
+	#endif
+#else
+	#define STAT_PRIMITIVE(g, prim)
+#endif
+
+#if GDISP_NEED_TRACE
+	// Record each low level driver call before making it. As with the statistics each wrapper is
+	//	defined before the driver call is redirected to it.
+	#define TRACE_LLD(g, code)		{ if ((g)->trace) _gdispTrace(g, code); }
+
+	#if GDISP_HARDWARE_FLUSH
+		static void trace_lld_flush(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_FLUSH); gdisp_lld_flush(g); }
+		#undef gdisp_lld_flush
+		#define gdisp_lld_flush(g)				trace_lld_flush(g)
+	#endif
+	#if GDISP_HARDWARE_STREAM_WRITE
+		static void trace_lld_write_start(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_WRITESTART); gdisp_lld_write_start(g); }
+		static void trace_lld_write_color(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_WRITECOLOR); gdisp_lld_write_color(g); }
+		static void trace_lld_write_stop(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_WRITESTOP); gdisp_lld_write_stop(g); }
+		#undef gdisp_lld_write_start
+		#undef gdisp_lld_write_color
+		#undef gdisp_lld_write_stop
+		#define gdisp_lld_write_start(g)		trace_lld_write_start(g)
+		#define gdisp_lld_write_color(g)		trace_lld_write_color(g)
+		#define gdisp_lld_write_stop(g)			trace_lld_write_stop(g)
+		#if GDISP_HARDWARE_STREAM_POS
+			static void trace_lld_write_pos(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_WRITEPOS); gdisp_lld_write_pos(g); }
+			#undef gdisp_lld_write_pos
+			#define gdisp_lld_write_pos(g)		trace_lld_write_pos(g)
+		#endif
+		#if GDISP_HARDWARE_STREAM_BUFFER
+			// Recorded as a run of stream writes so the trace replays on any driver
+			static void trace_lld_write_buffer(GDisplay *g) {
+				const gPixel	*p;
+				gColor			c;
+				gCoord			i;
+
+				if (g->trace) {
+					c = g->p.color;
+					for(p = (const gPixel *)g->p.ptr, i = 0; i < g->p.cx; i++) {
+						g->p.color = p[i];
+						_gdispTrace(g, GDISP_TRACE_WRITECOLOR);
+					}
+					g->p.color = c;
+				}
+				gdisp_lld_write_buffer(g);
+			}
+			#undef gdisp_lld_write_buffer
+			#define gdisp_lld_write_buffer(g)	trace_lld_write_buffer(g)
+		#endif
+	#endif
+	#if GDISP_HARDWARE_STREAM_READ
+		static void trace_lld_read_start(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_READSTART); gdisp_lld_read_start(g); }
+		static gColor trace_lld_read_color(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_READCOLOR); return gdisp_lld_read_color(g); }
+		static void trace_lld_read_stop(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_READSTOP); gdisp_lld_read_stop(g); }
+		#undef gdisp_lld_read_start
+		#undef gdisp_lld_read_color
+		#undef gdisp_lld_read_stop
+		#define gdisp_lld_read_start(g)			trace_lld_read_start(g)
+		#define gdisp_lld_read_color(g)			trace_lld_read_color(g)
+		#define gdisp_lld_read_stop(g)			trace_lld_read_stop(g)
+	#endif
+	#if GDISP_HARDWARE_DRAWPIXEL
+		static void trace_lld_draw_pixel(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_PIXEL); gdisp_lld_draw_pixel(g); }
+		#undef gdisp_lld_draw_pixel
+		#define gdisp_lld_draw_pixel(g)			trace_lld_draw_pixel(g)
+	#endif
+	#if GDISP_HARDWARE_CLEARS
+		static void trace_lld_clear(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_CLEAR); gdisp_lld_clear(g); }
+		#undef gdisp_lld_clear
+		#define gdisp_lld_clear(g)				trace_lld_clear(g)
+	#endif
+	#if GDISP_HARDWARE_FILLS
+		static void trace_lld_fill_area(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_FILL); gdisp_lld_fill_area(g); }
+		#undef gdisp_lld_fill_area
+		#define gdisp_lld_fill_area(g)			trace_lld_fill_area(g)
+	#endif
+	#if GDISP_HARDWARE_BITFILLS
+		static void trace_lld_blit_area(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_BLIT); gdisp_lld_blit_area(g); }
+		#undef gdisp_lld_blit_area
+		#define gdisp_lld_blit_area(g)			trace_lld_blit_area(g)
+	#endif
+	#if GDISP_HARDWARE_PIXELREAD
+		static gColor trace_lld_get_pixel_color(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_GET); return gdisp_lld_get_pixel_color(g); }
+		#undef gdisp_lld_get_pixel_color
+		#define gdisp_lld_get_pixel_color(g)	trace_lld_get_pixel_color(g)
+	#endif
+	#if GDISP_HARDWARE_SCROLL && GDISP_NEED_SCROLL
+		static void trace_lld_vertical_scroll(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_SCROLL); gdisp_lld_vertical_scroll(g); }
+		#undef gdisp_lld_vertical_scroll
+		#define gdisp_lld_vertical_scroll(g)	trace_lld_vertical_scroll(g)
+	#endif
+	#if GDISP_HARDWARE_CONTROL && GDISP_NEED_CONTROL
+		static void trace_lld_control(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_CONTROL); gdisp_lld_control(g); }
+		#undef gdisp_lld_control
+		#define gdisp_lld_control(g)			trace_lld_control(g)
+	#endif
+	#if GDISP_HARDWARE_QUERY && GDISP_NEED_QUERY
+		static void *trace_lld_query(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_QUERY); return gdisp_lld_query(g); }
+		#undef gdisp_lld_query
+		#define gdisp_lld_query(g)				trace_lld_query(g)
+	#endif
+	#if GDISP_HARDWARE_CLIP && (GDISP_NEED_CLIP || GDISP_NEED_VALIDATION)
+		static void trace_lld_set_clip(GDisplay *g) { TRACE_LLD(g, GDISP_TRACE_SETCLIP); gdisp_lld_set_clip(g); }
+		#undef gdisp_lld_set_clip
+		#define gdisp_lld_set_clip(g)			trace_lld_set_clip(g)
+	#endif
+#endif
+
 #define NEED_CLIPPING	(GDISP_HARDWARE_CLIP != GFXON && (GDISP_NEED_VALIDATION || GDISP_NEED_CLIP))
 
 #if !NEED_CLIPPING
@@ -64,10 +300,38 @@ GDisplay	*GDISP;
 		if ((g)->p.cx > 0 && (g)->p.cy > 0)
 #endif
 
+// With path calibration every way of drawing the driver has is compiled in and
+//	the calibration picks between them. Otherwise the first one the driver has is used.
+#if GDISP_NEED_PATHCAL
+	#define PATHCAL_SMALL			16			// The largest pixel count in the first size class
+	#define PATHCAL_MEDIUM			256			// The largest pixel count in the second size class
+	#define PATH_FOR(g, op, n)		((g)->pathcal.path[op][(n) <= PATHCAL_SMALL ? 0 : ((n) <= PATHCAL_MEDIUM ? 1 : 2)])
+	#define PATH_USE(path, p)		((path) == gdispPathAuto || (path) == (p))
+	#define PATH_FIXED(hw)			GFXOFF
+#else
+	#define PATH_FIXED(hw)			((hw) == GFXON)
+#endif
+
 /*==========================================================================*/
 /* Internal functions.														*/
 /*==========================================================================*/
 
+#if GDISP_NEED_MULTITHREAD && GDISP_NEED_LAYERS
+	/**
+	 * Unlock a layer that was flushed while it was locked and compose its display.
+	 * Composing locks every layer of the display so it has to wait until the layer is unlocked.
+	 */
+	static void layerunlock(GDisplay *g) {
+		GDisplay	*d;
+
+		g->flags &= ~GDISP_FLG_LAYERFLUSH;
+		d = _gdispLayerGetDisplay(g);
+		gfxMutexExit(&g->mutex);
+		if (d)
+			gdispGLayerCompose(d);
+	}
+#endif
+
 #if GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
 	static GFXINLINE void setglobalwindow(GDisplay *g) {
 		gCoord	x, y;
@@ -80,10 +344,46 @@ GDisplay	*GDISP;
 	}
 #endif
 
-#if GDISP_NEED_AUTOFLUSH && GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
-	#define autoflush_stopdone(g)	if (gvmt(g)->flush) gdisp_lld_flush(g)
+#if GDISP_HARDWARE_FLUSH
+	/**
+	 * Flush a locked display.
+	 * If unlock is gTrue the display is unlocked before this returns. When the driver sends the
+	 * frame from a back buffer the display is unlocked while that happens.
+	 */
+	static void doflush(GDisplay *g, gBool unlock) {
+		#if GDISP_NEED_FRAMECLOCK
+			g->flags &= ~GDISP_FLG_FRAMEDIRTY;
+		#endif
+
+		// Any earlier frame must be sent before the driver reuses its back buffer
+		FLUSHMUTEX_ENTER(g);
+		gdisp_lld_flush(g);
+		#if GDISP_HARDWARE_FLUSHSEND
+			#if GDISP_HARDWARE_FLUSHSEND == HARDWARE_AUTODETECT
+				if (gvmt(g)->flushsend)
+			#endif
+			{
+				if (unlock) {
+					MUTEX_EXIT(g);
+					unlock = gFalse;
+				}
+				gdisp_lld_flush_send(g);
+			}
+		#endif
+		FLUSHMUTEX_EXIT(g);
+		if (unlock) {
+			MUTEX_EXIT(g);
+		}
+	}
+#endif
+
+#if GDISP_NEED_FRAMECLOCK
+	// Leave the flush to the next tick of the frame clock
+	#define autoflush_stopdone(g)	g->flags |= GDISP_FLG_FRAMEDIRTY
+#elif GDISP_NEED_AUTOFLUSH && GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
+	#define autoflush_stopdone(g)	if (gvmt(g)->flush) doflush(g, gFalse)
 #elif GDISP_NEED_AUTOFLUSH && GDISP_HARDWARE_FLUSH
-	#define autoflush_stopdone(g)	gdisp_lld_flush(g)
+	#define autoflush_stopdone(g)	doflush(g, gFalse)
 #else
 	#define autoflush_stopdone(g)
 #endif
@@ -172,12 +472,20 @@ static GFXINLINE void drawpixel(GDisplay *g) {
 // Note:		This is not clipped
 // Resets the streaming area if GDISP_HARDWARE_STREAM_WRITE and GDISP_HARDWARE_STREAM_POS is set.
 static GFXINLINE void fillarea(GDisplay *g) {
+	#if GDISP_NEED_PATHCAL
+		gU8		path;
+
+		path = PATH_FOR(g, gdispPathOpFill, (gU32)g->p.cx * g->p.cy);
+	#endif
 
 	// Best is hardware accelerated area fill
 	#if GDISP_HARDWARE_FILLS
 		#if GDISP_HARDWARE_FILLS == HARDWARE_AUTODETECT
 			if (gvmt(g)->fill)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathFill))
+		#endif
 		{
 			#if GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
 				if ((g->flags & GDISP_FLG_SCRSTREAM)) {
@@ -191,10 +499,13 @@ static GFXINLINE void fillarea(GDisplay *g) {
 	#endif
 
 	// Next best is hardware streaming
-	#if GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE
+	#if !PATH_FIXED(GDISP_HARDWARE_FILLS) && GDISP_HARDWARE_STREAM_WRITE
 		#if GDISP_HARDWARE_STREAM_WRITE == HARDWARE_AUTODETECT
 			if (gvmt(g)->writestart)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathStream))
+		#endif
 		{
 			gU32	area;
 
@@ -221,7 +532,7 @@ static GFXINLINE void fillarea(GDisplay *g) {
 	#endif
 
 	// Worst is pixel drawing
-	#if GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE != GFXON && GDISP_HARDWARE_DRAWPIXEL
+	#if !PATH_FIXED(GDISP_HARDWARE_FILLS) && !PATH_FIXED(GDISP_HARDWARE_STREAM_WRITE) && GDISP_HARDWARE_DRAWPIXEL
 		// The following test is unneeded because we are guaranteed to have draw pixel if we don't have streaming
 		//#if GDISP_HARDWARE_DRAWPIXEL == HARDWARE_AUTODETECT
 		//	if (gvmt(g)->pixel)
@@ -229,6 +540,12 @@ static GFXINLINE void fillarea(GDisplay *g) {
 		{
 			gCoord x0, y0, x1, y1;
 
+			#if GDISP_NEED_PATHCAL && GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
+				if ((g->flags & GDISP_FLG_SCRSTREAM)) {
+					gdisp_lld_write_stop(g);
+					g->flags &= ~GDISP_FLG_SCRSTREAM;
+				}
+			#endif
 			x0 = g->p.x;
 			y0 = g->p.y;
 			x1 = g->p.x + g->p.cx;
@@ -247,6 +564,10 @@ static GFXINLINE void fillarea(GDisplay *g) {
 // Assumes the window covers the screen and a write_stop() will occur later
 //	if GDISP_HARDWARE_STREAM_WRITE and GDISP_HARDWARE_STREAM_POS is set.
 static void hline_clip(GDisplay *g) {
+	#if GDISP_NEED_PATHCAL
+		gU8		path;
+	#endif
+
 	// Swap the points if necessary so it always goes from x to x1
 	if (g->p.x1 < g->p.x) {
 		g->p.cx = g->p.x; g->p.x = g->p.x1; g->p.x1 = g->p.cx;
@@ -275,12 +596,25 @@ static void hline_clip(GDisplay *g) {
 		}
 	#endif
 
+	#if GDISP_NEED_PATHCAL
+		path = PATH_FOR(g, gdispPathOpLine, g->p.x1 - g->p.x + 1);
+	#endif
+
 	// Best is hardware accelerated area fill
 	#if GDISP_HARDWARE_FILLS
 		#if GDISP_HARDWARE_FILLS == HARDWARE_AUTODETECT
 			if (gvmt(g)->fill)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathFill))
+		#endif
 		{
+			#if GDISP_NEED_PATHCAL && GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
+				if ((g->flags & GDISP_FLG_SCRSTREAM)) {
+					gdisp_lld_write_stop(g);
+					g->flags &= ~GDISP_FLG_SCRSTREAM;
+				}
+			#endif
 			g->p.cx = g->p.x1 - g->p.x + 1;
 			g->p.cy = 1;
 			gdisp_lld_fill_area(g);
@@ -289,10 +623,13 @@ static void hline_clip(GDisplay *g) {
 	#endif
 
 	// Next best is cursor based streaming
-	#if GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
+	#if !PATH_FIXED(GDISP_HARDWARE_FILLS) && GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
 		#if GDISP_HARDWARE_STREAM_POS == HARDWARE_AUTODETECT
 			if (gvmt(g)->writepos)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathStream))
+		#endif
 		{
 			if (!(g->flags & GDISP_FLG_SCRSTREAM))
 				setglobalwindow(g);
@@ -304,10 +641,13 @@ static void hline_clip(GDisplay *g) {
 	#endif
 
 	// Next best is streaming
-	#if GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_STREAM_POS != GFXON && GDISP_HARDWARE_STREAM_WRITE
+	#if !PATH_FIXED(GDISP_HARDWARE_FILLS) && GDISP_HARDWARE_STREAM_POS != GFXON && GDISP_HARDWARE_STREAM_WRITE
 		#if GDISP_HARDWARE_STREAM_WRITE == HARDWARE_AUTODETECT
 			if (gvmt(g)->writestart)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathStream))
+		#endif
 		{
 			g->p.cx = g->p.x1 - g->p.x + 1;
 			g->p.cy = 1;
@@ -319,12 +659,18 @@ static void hline_clip(GDisplay *g) {
 	#endif
 
 	// Worst is drawing pixels
-	#if GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE != GFXON && GDISP_HARDWARE_DRAWPIXEL
+	#if !PATH_FIXED(GDISP_HARDWARE_FILLS) && !PATH_FIXED(GDISP_HARDWARE_STREAM_WRITE) && GDISP_HARDWARE_DRAWPIXEL
 		// The following test is unneeded because we are guaranteed to have draw pixel if we don't have streaming
 		//#if GDISP_HARDWARE_DRAWPIXEL == HARDWARE_AUTODETECT
 		//	if (gvmt(g)->pixel)
 		//#endif
 		{
+			#if GDISP_NEED_PATHCAL && GDISP_HARDWARE_STREAM_POS && GDISP_HARDWARE_STREAM_WRITE
+				if ((g->flags & GDISP_FLG_SCRSTREAM)) {
+					gdisp_lld_write_stop(g);
+					g->flags &= ~GDISP_FLG_SCRSTREAM;
+				}
+			#endif
 			for(; g->p.x <= g->p.x1; g->p.x++)
 				gdisp_lld_draw_pixel(g);
 			return;
@@ -551,6 +897,67 @@ static void line_clip(GDisplay *g) {
 	}
 #endif
 
+#if GDISP_NEED_FRAMECLOCK
+	static void FrameClockFn(void *param) {
+		GDisplay *	g;
+		gTicks		t, period;
+		unsigned	n;
+		gBool		flushed;
+
+		g = (GDisplay *)param;
+		t = 0;
+		flushed = gFalse;
+
+		// After a late frame GTIMER may tick straight away for the period that was missed. Skip it.
+		period = gfxMillisecondsToTicks(g->frameperiod);
+		if (gfxSystemTicks() - g->frameend < period/2)
+			return;
+
+		// Flush only if something has been drawn
+		MUTEX_ENTER(g);
+		#if GDISP_HARDWARE_FLUSH
+			#if GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
+				if (gvmt(g)->flush)
+			#endif
+			{
+				if ((g->flags & GDISP_FLG_FRAMEDIRTY)) {
+					gTicks	start;
+
+					STAT_PRIMITIVE(g, gdispStatOther);
+					start = gfxSystemTicks();
+					doflush(g, gTrue);
+					t = gfxSystemTicks() - start;
+					flushed = gTrue;
+				}
+			}
+		#endif
+		if (!flushed) {
+			g->flags &= ~GDISP_FLG_FRAMEDIRTY;
+			MUTEX_EXIT(g);
+		}
+
+		gfxMutexEnter(&frameLock);
+		g->frameend = gfxSystemTicks();
+		if (flushed) {
+			g->framestats.frames++;
+			if (t > g->framestats.longest)
+				g->framestats.longest = t;
+			if (t > period)
+				g->framestats.late++;
+			n = period ? (unsigned)(t * 4 / period) : GDISP_FRAMECLOCK_BUCKETS-1;
+			g->framestats.histogram[n < GDISP_FRAMECLOCK_BUCKETS ? n : GDISP_FRAMECLOCK_BUCKETS-1]++;
+		} else
+			g->framestats.skipped++;
+		g->frameseq++;
+
+		// Wake anyone waiting - they check their own display
+		n = frameWaiters;
+		gfxMutexExit(&frameLock);
+		for(; n; n--)
+			gfxSemSignal(&frameTick);
+	}
+#endif
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -565,6 +972,16 @@ static void line_clip(GDisplay *g) {
 
 void _gdispInit(void)
 {
+	#if GDISP_NEED_FRAMECLOCK
+		gfxMutexInit(&frameLock);
+		gfxSemInit(&frameTick, 0, gSemMaxCount);
+	#endif
+	#if GDISP_NEED_ASYNCFLUSH
+		gfxMutexInit(&flushLock);
+		gfxSemInit(&flushJobs, 0, gSemMaxCount);
+		gfxSemInit(&flushDone, 0, gSemMaxCount);
+	#endif
+
 	// GDISP_DRIVER_LIST is defined - create each driver instance
 	#if defined(GDISP_DRIVER_LIST)
 		{
@@ -634,6 +1051,16 @@ gBool _gdispInitDriver(GDriver *g, void *param, unsigned driverinstance, unsigne
 	gd->flags = 0;
 	gd->priv = param;
 	MUTEX_INIT(gd);
+	#if GDISP_NEED_ASYNCFLUSH
+		gfxMutexInit(&gd->flushmutex);
+	#endif
+	#if GDISP_NEED_FRAMECLOCK
+		gtimerInit(&gd->frametimer);
+	#endif
+	#if GDISP_NEED_PATHCAL
+		gd->pathcal.version = GDISP_PATHCAL_VERSION;
+		memset(gd->pathcal.path, gdispPathAuto, sizeof(gd->pathcal.path));
+	#endif
 
 	// Call the driver init
 	MUTEX_ENTER(gd);
@@ -659,6 +1086,12 @@ void _gdispPostInitDriver(GDriver *g) {
 		gdispGSetClip(gd, 0, 0, gd->g.Width, gd->g.Height);
 	#endif
 
+	// Find the fastest way of drawing on a real display
+	#if GDISP_NEED_PATHCAL && GDISP_PATHCAL_STARTUP
+		if (!(gvmt(gd)->d.flags & GDISP_VFLG_DYNAMICONLY))
+			gdispGCalibratePaths(gd);
+	#endif
+
 	// Clear the Screen
 	gdispGClear(gd, GDISP_STARTUP_COLOR);
 
@@ -673,6 +1106,14 @@ void _gdispPostInitDriver(GDriver *g) {
 		gdispGFlush(gd);
 	#endif
 
+	// Start the frame clock of displays that need flushing
+	#if GDISP_NEED_FRAMECLOCK && GDISP_HARDWARE_FLUSH
+		#if GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
+			if (gvmt(gd)->flush)
+		#endif
+			gdispGSetFrameRate(gd, GDISP_FRAMECLOCK_RATE);
+	#endif
+
 	// If this is the first driver set GDISP
 	if (!GDISP)
 		GDISP = gd;
@@ -686,6 +1127,35 @@ void _gdispDeInitDriver(GDriver *g) {
 	if (GDISP == gd)
 		GDISP = (GDisplay *)gdriverGetInstance(GDRIVER_TYPE_DISPLAY, 0);
 
+	#if GDISP_NEED_TRACE
+		gdispGTraceStop(gd);
+	#endif
+
+	#if GDISP_NEED_ACCEL
+		gdispGAccelSync(gd);
+	#endif
+
+	#if GDISP_NEED_ASYNCFLUSH
+		gdispGFlushWait(gd, gDelayForever);
+	#endif
+
+	#if GDISP_NEED_FRAMECLOCK
+		gdispGSetFrameRate(gd, 0);
+		gtimerDeinit(&gd->frametimer);
+	#endif
+
+	// A layer is taken off its display before it is locked for the driver as that locks the layers of the display.
+	//	Any layers left on this display become plain pixmaps.
+	#if GDISP_NEED_LAYERS
+		{
+			struct gdispLayer	*l;
+
+			if ((l = _gdispPixmapGetLayer(gd)))
+				_gdispLayerDestroy(l);
+		}
+		_gdispLayerStackDestroy(gd);
+	#endif
+
 	#if GDISP_HARDWARE_DEINIT
 		#if GDISP_HARDWARE_DEINIT == HARDWARE_AUTODETECT
 			if (gvmt(gd)->deinit)
@@ -697,6 +1167,9 @@ void _gdispDeInitDriver(GDriver *g) {
 		}
 	#endif
 	MUTEX_DEINIT(gd);
+	#if GDISP_NEED_ASYNCFLUSH
+		gfxMutexDestroy(&gd->flushmutex);
+	#endif
 
 	#undef gd
 }
@@ -727,17 +1200,246 @@ void gdispGFlush(GDisplay *g) {
 		#endif
 		{
 			MUTEX_ENTER(g);
-			gdisp_lld_flush(g);
-			MUTEX_EXIT(g);
+			STAT_PRIMITIVE(g, gdispStatOther);
+			doflush(g, gTrue);
 		}
 	#else
 		(void) g;
 	#endif
 }
 
+#if GDISP_NEED_ASYNCFLUSH || GDISP_NEED_FRAMECLOCK
+	/**
+	 * The part of a timeout of ms milliseconds (period system ticks) that is left since start.
+	 * There are no functions to turn ticks back into milliseconds so the period is used to scale them.
+	 */
+	static gDelay timeleft(gDelay ms, gTicks start, gTicks period) {
+		gTicks		elapsed;
+
+		elapsed = gfxSystemTicks() - start;
+		if (elapsed >= period)
+			return gDelayNone;
+		if (period >= ms)
+			return ms - (gDelay)(elapsed / (period / ms));
+		return ms - (gDelay)(elapsed * (ms / period));
+	}
+#endif
+
+#if GDISP_NEED_ASYNCFLUSH
+	#if GFX_USE_GEVENT
+		GSourceHandle gdispGGetFlushSource(GDisplay *g) {
+			return (GSourceHandle)g;
+		}
+
+		static void sendFlushEvent(GDisplay *g) {
+			GSourceListener		*psl;
+			GEventGDispFlush	*pe;
+
+			psl = 0;
+			while ((psl = geventGetSourceListener((GSourceHandle)g, psl))) {
+				if (!(pe = (GEventGDispFlush *)geventGetEventBuffer(psl)))
+					continue;
+				pe->type = GEVENT_GDISP_FLUSH;
+				pe->display = g;
+				geventSendEvent(psl);
+			}
+		}
+	#else
+		#define sendFlushEvent(g)
+	#endif
+
+	static GFX_THREAD_FUNCTION(FlushThreadFn, param) {
+		GDisplay			*g;
+		gdispFlushCallback	fn;
+		void				*fnparam;
+		unsigned			n;
+		(void)				param;
+
+		while(1) {
+			gfxSemWait(&flushJobs, gDelayForever);
+
+			while(1) {
+				// Find a display waiting to be flushed.
+				//	Start from the first display each time as once it is done a display may be deinitialised.
+				gfxMutexEnter(&flushLock);
+				for(g = (GDisplay *)gdriverGetNext(GDRIVER_TYPE_DISPLAY, 0); g; g = (GDisplay *)gdriverGetNext(GDRIVER_TYPE_DISPLAY, (GDriver *)g)) {
+					if ((g->flushstate & FLUSH_PENDING))
+						break;
+				}
+				if (!g) {
+					gfxMutexExit(&flushLock);
+					break;
+				}
+				g->flushstate = FLUSH_RUNNING;
+				fn = g->flushfn;
+				fnparam = g->flushparam;
+				g->flushfn = 0;
+				gfxMutexExit(&flushLock);
+
+				#if GDISP_HARDWARE_FLUSH
+					MUTEX_ENTER(g);
+					STAT_PRIMITIVE(g, gdispStatOther);
+					doflush(g, gTrue);
+				#endif
+				if (fn)
+					fn(g, fnparam);
+				sendFlushEvent(g);
+
+				// Wake anyone waiting - they check their own display
+				gfxMutexEnter(&flushLock);
+				g->flushstate &= ~FLUSH_RUNNING;
+				n = flushWaiters;
+				gfxMutexExit(&flushLock);
+				for(; n; n--)
+					gfxSemSignal(&flushDone);
+			}
+		}
+		gfxThreadReturn(0);
+	}
+
+	gBool gdispGFlushAsync(GDisplay *g, gdispFlushCallback fn, void *param) {
+		// Nothing to do if the display doesn't need flushing
+		#if GDISP_HARDWARE_FLUSH == HARDWARE_AUTODETECT
+			if (!gvmt(g)->flush)
+		#endif
+		#if GDISP_HARDWARE_FLUSH != GFXON
+			{
+				if (fn)
+					fn(g, param);
+				sendFlushEvent(g);
+				return gTrue;
+			}
+		#endif
+
+		gfxMutexEnter(&flushLock);
+
+		// Start our thread if not already going
+		if (!flushThread) {
+			if (!(flushThread = gfxThreadCreate(0, GDISP_ASYNCFLUSH_THREAD_STACKSIZE, GDISP_ASYNCFLUSH_THREAD_PRIORITY, FlushThreadFn, 0))) {
+				gfxMutexExit(&flushLock);
+				return gFalse;
+			}
+			gfxThreadClose(flushThread);		// We never really need the handle again
+		}
+
+		if (fn) {
+			g->flushfn = fn;
+			g->flushparam = param;
+		}
+		if (!(g->flushstate & FLUSH_PENDING)) {
+			g->flushstate |= FLUSH_PENDING;
+			gfxSemSignal(&flushJobs);
+		}
+		gfxMutexExit(&flushLock);
+		return gTrue;
+	}
+
+	gBool gdispGFlushWait(GDisplay *g, gDelay ms) {
+		gTicks		start, period;
+		gBool		ret;
+
+		start = period = 0;
+		if (ms != gDelayForever && ms != gDelayNone) {
+			start = gfxSystemTicks();
+			period = gfxMillisecondsToTicks(ms);
+		}
+
+		gfxMutexEnter(&flushLock);
+		while(!(ret = !g->flushstate) && ms != gDelayNone) {
+			flushWaiters++;
+			gfxMutexExit(&flushLock);
+			ret = gfxSemWait(&flushDone, ms == gDelayForever ? ms : timeleft(ms, start, period));
+			gfxMutexEnter(&flushLock);
+			flushWaiters--;
+
+			// Other displays finishing also wake us so check the time has not run out
+			if (ms != gDelayForever && (!ret || gfxSystemTicks() - start >= period)) {
+				ret = !g->flushstate;
+				break;
+			}
+		}
+		gfxMutexExit(&flushLock);
+		return ret;
+	}
+#endif
+
+#if GDISP_NEED_FRAMECLOCK
+	void gdispGSetFrameRate(GDisplay *g, unsigned fps) {
+		unsigned	n;
+
+		gfxMutexEnter(&frameLock);
+		g->framerate = fps;
+		if (fps) {
+			g->frameperiod = (1000 + fps/2) / fps;
+			if (!g->frameperiod)
+				g->frameperiod = 1;
+			g->frameend = gfxSystemTicks() - gfxMillisecondsToTicks(g->frameperiod);
+			gtimerStart(&g->frametimer, FrameClockFn, g, gTrue, g->frameperiod);
+		} else
+			gtimerStop(&g->frametimer);
+
+		// Don't leave anyone waiting on a stopped clock
+		n = fps ? 0 : frameWaiters;
+		gfxMutexExit(&frameLock);
+		for(; n; n--)
+			gfxSemSignal(&frameTick);
+	}
+
+	unsigned gdispGGetFrameRate(GDisplay *g) {
+		return g->framerate;
+	}
+
+	gBool gdispGFrameWait(GDisplay *g, gDelay ms) {
+		gTicks		start, period;
+		gU32		seq;
+		gBool		ret;
+
+		start = period = 0;
+		if (ms != gDelayForever && ms != gDelayNone) {
+			start = gfxSystemTicks();
+			period = gfxMillisecondsToTicks(ms);
+		}
+
+		gfxMutexEnter(&frameLock);
+		seq = g->frameseq;
+		while(1) {
+			if (g->frameseq != seq) {
+				ret = gTrue;
+				break;
+			}
+			if (ms == gDelayNone || !g->framerate || (ms != gDelayForever && gfxSystemTicks() - start >= period)) {
+				ret = gFalse;
+				break;
+			}
+
+			// Other displays ticking also wake us so check again
+			frameWaiters++;
+			gfxMutexExit(&frameLock);
+			gfxSemWait(&frameTick, ms == gDelayForever ? ms : timeleft(ms, start, period));
+			gfxMutexEnter(&frameLock);
+			frameWaiters--;
+		}
+		gfxMutexExit(&frameLock);
+		return ret;
+	}
+
+	void gdispGGetFrameStats(GDisplay *g, gdispFrameStats *stats) {
+		gfxMutexEnter(&frameLock);
+		*stats = g->framestats;
+		gfxMutexExit(&frameLock);
+	}
+
+	void gdispGResetFrameStats(GDisplay *g) {
+		gfxMutexEnter(&frameLock);
+		memset(&g->framestats, 0, sizeof(g->framestats));
+		gfxMutexExit(&frameLock);
+	}
+#endif
+
 #if GDISP_NEED_STREAMING
 	void gdispGStreamStart(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatStream);
 
 		#if NEED_CLIPPING
 			#if GDISP_HARDWARE_CLIP == HARDWARE_AUTODETECT
@@ -984,6 +1686,7 @@ void gdispGFlush(GDisplay *g) {
 
 void gdispGDrawPixel(GDisplay *g, gCoord x, gCoord y, gColor color) {
 	MUTEX_ENTER(g);
+	STAT_PRIMITIVE(g, gdispStatPixel);
 	g->p.x		= x;
 	g->p.y		= y;
 	g->p.color	= color;
@@ -994,6 +1697,7 @@ void gdispGDrawPixel(GDisplay *g, gCoord x, gCoord y, gColor color) {
 
 void gdispGDrawLine(GDisplay *g, gCoord x0, gCoord y0, gCoord x1, gCoord y1, gColor color) {
 	MUTEX_ENTER(g);
+	STAT_PRIMITIVE(g, gdispStatLine);
 	g->p.x = x0;
 	g->p.y = y0;
 	g->p.x1 = x1;
@@ -1007,6 +1711,7 @@ void gdispGDrawLine(GDisplay *g, gCoord x0, gCoord y0, gCoord x1, gCoord y1, gCo
 void gdispGClear(GDisplay *g, gColor color) {
 	// Note - clear() ignores the clipping area. It clears the screen.
 	MUTEX_ENTER(g);
+	STAT_PRIMITIVE(g, gdispStatClear);
 
 	// Best is hardware accelerated clear
 	#if GDISP_HARDWARE_CLEARS
@@ -1089,6 +1794,7 @@ void gdispGClear(GDisplay *g, gColor color) {
 
 void gdispGFillArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor color) {
 	MUTEX_ENTER(g);
+	STAT_PRIMITIVE(g, gdispStatFill);
 	g->p.x = x;
 	g->p.y = y;
 	g->p.cx = cx;
@@ -1101,8 +1807,15 @@ void gdispGFillArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColo
 	MUTEX_EXIT(g);
 }
 
-void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord srcx, gCoord srcy, gCoord srccx, const gPixel *buffer) {
-	MUTEX_ENTER(g);
+// blitarea(g, ...)
+// The display must be locked.
+// Returns gFalse if nothing was drawn because the area is clipped away.
+static gBool blitarea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord srcx, gCoord srcy, gCoord srccx, const gPixel *buffer) {
+	#if GDISP_NEED_PATHCAL
+		gU8		path;
+	#endif
+
+	STAT_PRIMITIVE(g, gdispStatBlit);
 
 	#if NEED_CLIPPING
 		#if GDISP_HARDWARE_CLIP == HARDWARE_AUTODETECT
@@ -1111,19 +1824,26 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		{
 			// This is a different clipping to fillarea(g) as it needs to take into account srcx,srcy
 			if (x < g->clipx0) { cx -= g->clipx0 - x; srcx += g->clipx0 - x; x = g->clipx0; }
-			if (y < g->clipy0) { cy -= g->clipy0 - y; srcy += g->clipy0 - x; y = g->clipy0; }
+			if (y < g->clipy0) { cy -= g->clipy0 - y; srcy += g->clipy0 - y; y = g->clipy0; }
 			if (x+cx > g->clipx1)	cx = g->clipx1 - x;
 			if (y+cy > g->clipy1)	cy = g->clipy1 - y;
 			if (srcx+cx > srccx) cx = srccx - srcx;
-			if (cx <= 0 || cy <= 0) { MUTEX_EXIT(g); return; }
+			if (cx <= 0 || cy <= 0) return gFalse;
 		}
 	#endif
 
+	#if GDISP_NEED_PATHCAL
+		path = PATH_FOR(g, gdispPathOpBlit, (gU32)cx * cy);
+	#endif
+
 	// Best is hardware bitfills
 	#if GDISP_HARDWARE_BITFILLS
 		#if GDISP_HARDWARE_BITFILLS == HARDWARE_AUTODETECT
 			if (gvmt(g)->blit)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathBitfill))
+		#endif
 		{
 			g->p.x = x;
 			g->p.y = y;
@@ -1134,17 +1854,18 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 			g->p.x2 = srccx;
 			g->p.ptr = (void *)buffer;
 			gdisp_lld_blit_area(g);
-			autoflush_stopdone(g);
-			MUTEX_EXIT(g);
-			return;
+			return gTrue;
 		}
 	#endif
 
 	// Next best is hardware streaming
-	#if GDISP_HARDWARE_BITFILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE
+	#if !PATH_FIXED(GDISP_HARDWARE_BITFILLS) && GDISP_HARDWARE_STREAM_WRITE
 		#if GDISP_HARDWARE_STREAM_WRITE == HARDWARE_AUTODETECT
 			if (gvmt(g)->writestart)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathStream))
+		#endif
 		{
 			// Translate buffer to the real image data, use srcx,srcy as the end point, srccx as the buffer line gap
 			buffer += srcy*srccx+srcx;
@@ -1164,24 +1885,38 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 				gdisp_lld_write_pos(g);
 			#endif
 			for(g->p.y = y; g->p.y < srcy; g->p.y++, buffer += srccx) {
+				// Hand the whole row to the driver if it can take it
+				#if GDISP_HARDWARE_STREAM_BUFFER
+					#if GDISP_HARDWARE_STREAM_BUFFER == HARDWARE_AUTODETECT
+						if (gvmt(g)->writebuffer)
+					#endif
+					{
+						g->p.ptr = (void *)buffer;
+						gdisp_lld_write_buffer(g);
+						buffer += cx;
+						continue;
+					}
+				#endif
 				for(g->p.x = x; g->p.x < srcx; g->p.x++) {
 					g->p.color = *buffer++;
 					gdisp_lld_write_color(g);
 				}
 			}
 			gdisp_lld_write_stop(g);
-			autoflush_stopdone(g);
-			MUTEX_EXIT(g);
-			return;
+			return gTrue;
 		}
 	#endif
 
 	// Only slightly better than drawing pixels is to look for runs and use fill area
-	#if GDISP_HARDWARE_BITFILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE != GFXON && GDISP_HARDWARE_FILLS
+	#if !PATH_FIXED(GDISP_HARDWARE_BITFILLS) && !PATH_FIXED(GDISP_HARDWARE_STREAM_WRITE) && GDISP_HARDWARE_FILLS && GDISP_HARDWARE_DRAWPIXEL
 		// We don't need to test for auto-detect on drawpixel as we know we have it because we don't have streaming.
+		//	A calibration only picks this when the driver has draw pixel.
 		#if GDISP_HARDWARE_FILLS == HARDWARE_AUTODETECT
 			if (gvmt(g)->fill)
 		#endif
+		#if GDISP_NEED_PATHCAL
+			if (PATH_USE(path, gdispPathFill))
+		#endif
 		{
 			// Translate buffer to the real image data, use srcx,srcy as the end point, srccx as the buffer line gap
 			buffer += srcy*srccx+srcx;
@@ -1205,14 +1940,12 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 					}
 				}
 			}
-			autoflush_stopdone(g);
-			MUTEX_EXIT(g);
-			return;
+			return gTrue;
 		}
 	#endif
 
 	// Worst is drawing pixels
-	#if GDISP_HARDWARE_BITFILLS != GFXON && GDISP_HARDWARE_STREAM_WRITE != GFXON && GDISP_HARDWARE_FILLS != GFXON && GDISP_HARDWARE_DRAWPIXEL
+	#if !PATH_FIXED(GDISP_HARDWARE_BITFILLS) && !PATH_FIXED(GDISP_HARDWARE_STREAM_WRITE) && !PATH_FIXED(GDISP_HARDWARE_FILLS) && GDISP_HARDWARE_DRAWPIXEL
 		// The following test is unneeded because we are guaranteed to have draw pixel if we don't have streaming
 		//#if GDISP_HARDWARE_DRAWPIXEL == HARDWARE_AUTODETECT
 		//	if (gvmt(g)->pixel)
@@ -1230,16 +1963,24 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 					gdisp_lld_draw_pixel(g);
 				}
 			}
-			autoflush_stopdone(g);
-			MUTEX_EXIT(g);
-			return;
+			return gTrue;
 		}
 	#endif
+	return gFalse;
+}
+
+void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord srcx, gCoord srcy, gCoord srccx, const gPixel *buffer) {
+	MUTEX_ENTER(g);
+	if (blitarea(g, x, y, cx, cy, srcx, srcy, srccx, buffer)) {
+		autoflush_stopdone(g);
+	}
+	MUTEX_EXIT(g);
 }
 
 #if GDISP_NEED_CLIP || GDISP_NEED_VALIDATION
 	void gdispGSetClip(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy) {
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatOther);
 
 		// Best is using hardware clipping
 		#if GDISP_HARDWARE_CLIP
@@ -1279,6 +2020,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gCoord a, b, P;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatCircle);
 
 		// Calculate intermediates
 		a = 1;
@@ -1321,6 +2063,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gCoord a, b, P;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatCircle);
 
 		// Calculate intermediates
 		a = 1;
@@ -1365,6 +2108,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gCoord a, b1, b2, p1, p2;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatCircle);
 
 		// Do the combined circle where the inner circle < 45 deg (and outer circle)
 		g->p.color = color1;
@@ -1436,6 +2180,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gI32	err, e2;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatCircle);
 
 		// Calculate intermediates
 		dx = 0;
@@ -1475,6 +2220,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gI32	err, e2;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatCircle);
 
 		// Calculate intermediates
 		dx = 0;
@@ -1510,6 +2256,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gCoord a, b, P;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatArc);
 
 		// Calculate intermediates
 		a = 1;              // x in many explanations
@@ -1554,6 +2301,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gCoord a, b, P;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatArc);
 
 		// Calculate intermediates
 		a = 1;              // x in many explanations
@@ -1763,6 +2511,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		tbit = start%45 == 0 ? sbit : 0;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatArc);
 		g->p.color = color;
 
 		if (full) {
@@ -1969,6 +2718,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		#endif
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatArc);
 		g->p.color = color;
 
 		//Draw concentric circles using Andres algorithm
@@ -2043,6 +2793,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		gU8	qtr;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatArc);
 
 		// We add a half pixel so that we are drawing from the centre of the pixel
 		//	instead of the left edge of the pixel. This also fixes the implied floor()
@@ -2594,6 +3345,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 
 		/* Always synchronous as it must return a value */
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatRead);
 		#if GDISP_HARDWARE_PIXELREAD
 			#if GDISP_HARDWARE_PIXELREAD == HARDWARE_AUTODETECT
 				if (gvmt(g)->get)
@@ -2633,6 +3385,83 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 			return 0;
 		#endif
 	}
+
+	// readarea(g, ...)
+	// The display must be locked.
+	static void readarea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gPixel *buffer) {
+		gCoord		stride, ix, iy;
+
+		// Clip to the display (reads are not affected by the clipping region)
+		stride = cx;
+		if (x < 0) { cx += x; buffer -= x; x = 0; }
+		if (y < 0) { cy += y; buffer -= y * stride; y = 0; }
+		if (x + cx > g->g.Width)	cx = g->g.Width - x;
+		if (y + cy > g->g.Height)	cy = g->g.Height - y;
+		if (cx <= 0 || cy <= 0) return;
+
+		STAT_PRIMITIVE(g, gdispStatRead);
+		#if GDISP_HARDWARE_STREAM_READ
+			#if GDISP_HARDWARE_STREAM_READ == HARDWARE_AUTODETECT
+				if (gvmt(g)->readcolor)
+			#endif
+			{
+				// Best is hardware streaming - the whole area in one go
+				g->p.x = x;
+				g->p.y = y;
+				g->p.cx = cx;
+				g->p.cy = cy;
+				gdisp_lld_read_start(g);
+				for(iy = 0; iy < cy; iy++, buffer += stride) {
+					for(ix = 0; ix < cx; ix++)
+						buffer[ix] = gdisp_lld_read_color(g);
+				}
+				gdisp_lld_read_stop(g);
+				return;
+			}
+		#endif
+		#if GDISP_HARDWARE_STREAM_READ != GFXON && GDISP_HARDWARE_PIXELREAD
+			#if GDISP_HARDWARE_PIXELREAD == HARDWARE_AUTODETECT
+				if (gvmt(g)->get)
+			#endif
+			{
+				// Next best is direct pixel reads (with the display locked only once)
+				for(iy = 0; iy < cy; iy++, buffer += stride) {
+					g->p.y = y + iy;
+					for(ix = 0; ix < cx; ix++) {
+						g->p.x = x + ix;
+						buffer[ix] = gdisp_lld_get_pixel_color(g);
+					}
+				}
+				return;
+			}
+		#endif
+	}
+
+	void gdispGReadArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gPixel *buffer) {
+		MUTEX_ENTER(g);
+		readarea(g, x, y, cx, cy, buffer);
+		MUTEX_EXIT(g);
+	}
+#endif
+
+#if GDISP_NEED_SPRITES
+	// A sprite update reads what is under it and draws over it as one operation
+	void _gdispSpriteLock(GDisplay *g) {
+		MUTEX_ENTER(g);
+	}
+
+	void _gdispSpriteUnlock(GDisplay *g) {
+		autoflush_stopdone(g);
+		MUTEX_EXIT(g);
+	}
+
+	void _gdispSpriteRead(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gPixel *buffer) {
+		readarea(g, x, y, cx, cy, buffer);
+	}
+
+	void _gdispSpriteBlit(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord srcx, gCoord srcy, gCoord srccx, const gPixel *buffer) {
+		blitarea(g, x, y, cx, cy, srcx, srcy, srccx, buffer);
+	}
 #endif
 
 #if GDISP_NEED_SCROLL
@@ -2645,6 +3474,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 		if (!lines) return;
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatScroll);
 		#if NEED_CLIPPING
 			#if GDISP_HARDWARE_CLIP == HARDWARE_AUTODETECT
 				if (!gvmt(g)->setclip)
@@ -2690,7 +3520,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 				{
 					cy -= abslines;
 					if (lines < 0) {
-						fy = y+cy-1;
+						fy = y+cy+abslines-1;
 						dy = -1;
 					} else {
 						fy = y;
@@ -2875,6 +3705,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 					return;
 			#endif
 			MUTEX_ENTER(g);
+			STAT_PRIMITIVE(g, gdispStatOther);
 			g->p.x = what;
 			g->p.ptr = value;
 			if (what == GDISP_CONTROL_ORIENTATION) {
@@ -2893,7 +3724,10 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 					break;
 				}
 			}
+			// The controller must not be sent commands while a frame is being sent
+			FLUSHMUTEX_ENTER(g);
 			gdisp_lld_control(g);
+			FLUSHMUTEX_EXIT(g);
 			#if GDISP_NEED_CLIP || GDISP_NEED_VALIDATION
 				if (what == GDISP_CONTROL_ORIENTATION) {
 					// Best is hardware clipping
@@ -2946,6 +3780,7 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 					return -1;
 			#endif
 			MUTEX_ENTER(g);
+			STAT_PRIMITIVE(g, gdispStatOther);
 			g->p.x = (gCoord)what;
 			res = gdisp_lld_query(g);
 			MUTEX_EXIT(g);
@@ -2959,6 +3794,209 @@ void gdispGBlitArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoor
 	#endif
 #endif
 
+#if GDISP_NEED_STATISTICS
+	void gdispGGetStatistics(GDisplay *g, gdispStats *stats) {
+		MUTEX_ENTER(g);
+		*stats = g->stats;
+		MUTEX_EXIT(g);
+	}
+
+	void gdispGResetStatistics(GDisplay *g) {
+		MUTEX_ENTER(g);
+		memset(&g->stats, 0, sizeof(gdispStats));
+		MUTEX_EXIT(g);
+	}
+#endif
+
+#if GDISP_NEED_PATHCAL
+	#define PATHCAL_MAXREPS		0x4000			// The most times a measurement draws its shape (a power of 2)
+	#define PATHCAL_BLITSIZE	48				// The side of the largest square measured
+
+	// The ways of drawing in the order they are used without a calibration
+	static const gU8 pathOrder[gdispPathOps][4] = {
+		{ gdispPathFill, gdispPathStream, gdispPathPixel, gdispPathAuto },						// Line
+		{ gdispPathFill, gdispPathStream, gdispPathPixel, gdispPathAuto },						// Fill
+		{ gdispPathBitfill, gdispPathStream, gdispPathFill, gdispPathPixel }					// Blit
+	};
+
+	// The length of the line or the side of the square measured for each size class
+	static const gCoord pathSizes[gdispPathOps][GDISP_PATHCAL_SIZES] = {
+		{ 12, 128, 512 },				// Line
+		{ 3, 12, 48 },					// Fill
+		{ 3, 12, PATHCAL_BLITSIZE }		// Blit
+	};
+
+	static gBool pathAvailable(GDisplay *g, gdispPathOp op, gU8 path) {
+		switch(path) {
+		case gdispPathAuto:
+			return gTrue;
+		case gdispPathBitfill:
+			if (op != gdispPathOpBlit)
+				return gFalse;
+			#if GDISP_HARDWARE_BITFILLS == HARDWARE_AUTODETECT
+				return gvmt(g)->blit != 0;
+			#else
+				return GDISP_HARDWARE_BITFILLS ? gTrue : gFalse;
+			#endif
+		case gdispPathFill:
+			// Blits use draw pixel for runs of one pixel
+			if (op == gdispPathOpBlit && !pathAvailable(g, op, gdispPathPixel))
+				return gFalse;
+			#if GDISP_HARDWARE_FILLS == HARDWARE_AUTODETECT
+				return gvmt(g)->fill != 0;
+			#else
+				return GDISP_HARDWARE_FILLS ? gTrue : gFalse;
+			#endif
+		case gdispPathStream:
+			#if GDISP_HARDWARE_STREAM_WRITE == HARDWARE_AUTODETECT
+				return gvmt(g)->writestart != 0;
+			#else
+				return GDISP_HARDWARE_STREAM_WRITE ? gTrue : gFalse;
+			#endif
+		case gdispPathPixel:
+			#if GDISP_HARDWARE_DRAWPIXEL == HARDWARE_AUTODETECT
+				return gvmt(g)->pixel != 0;
+			#else
+				return GDISP_HARDWARE_DRAWPIXEL ? gTrue : gFalse;
+			#endif
+		}
+		return gFalse;
+	}
+
+	// Time drawing a shape of n pixels along and down with one way of drawing.
+	//	Returns the time to draw it PATHCAL_MAXREPS times.
+	static gU32 pathMeasure(GDisplay *g, gdispPathOp op, unsigned sz, gU8 path, gCoord n, const gPixel *buffer) {
+		gTicks		limit, start;
+		gU32		t, reps, i;
+
+		MUTEX_ENTER(g);
+		g->pathcal.path[op][sz] = path;
+		MUTEX_EXIT(g);
+
+		limit = gfxMillisecondsToTicks(GDISP_PATHCAL_TIME);
+		for(reps = 1; ; reps <<= 1) {
+			// Start on a tick boundary so a coarse clock doesn't cut the measurement short
+			start = gfxSystemTicks();
+			while(gfxSystemTicks() == start);
+			start = gfxSystemTicks();
+
+			for(i = 0; i < reps; i++) {
+				switch(op) {
+				case gdispPathOpLine:
+					gdispGDrawLine(g, 0, 0, n-1, 0, GDISP_STARTUP_COLOR);
+					break;
+				case gdispPathOpFill:
+					gdispGFillArea(g, 0, 0, n, n, GDISP_STARTUP_COLOR);
+					break;
+				default:
+					gdispGBlitArea(g, 0, 0, n, n, 0, 0, PATHCAL_BLITSIZE, buffer);
+					break;
+				}
+			}
+			t = gfxSystemTicks() - start;
+			if (t >= limit || reps >= PATHCAL_MAXREPS)
+				return t * (PATHCAL_MAXREPS / reps);
+		}
+	}
+
+	void gdispGCalibratePaths(GDisplay *g) {
+		gdispPathCal	cal;
+		gPixel			*buffer;
+		gCoord			n;
+		gU32			t, best;
+		unsigned		op, sz, i, avail;
+		gU8				path;
+
+		cal.version = GDISP_PATHCAL_VERSION;
+		memset(cal.path, gdispPathAuto, sizeof(cal.path));
+
+		// The blit source is short runs of two colors so that no way of drawing gets an easy ride
+		buffer = gfxAlloc(PATHCAL_BLITSIZE*PATHCAL_BLITSIZE*sizeof(gPixel));
+		if (buffer) {
+			for(i = 0; i < PATHCAL_BLITSIZE*PATHCAL_BLITSIZE; i++)
+				buffer[i] = (i & 4) ? GDISP_STARTUP_COLOR : (GDISP_STARTUP_COLOR ^ 1);
+		}
+
+		for(op = 0; op < gdispPathOps; op++) {
+			if (op == gdispPathOpBlit && !buffer)
+				break;
+
+			// Don't bother if there is no choice
+			for(avail = i = 0; i < 4; i++) {
+				if (pathOrder[op][i] != gdispPathAuto && pathAvailable(g, (gdispPathOp)op, pathOrder[op][i]))
+					avail++;
+			}
+			if (avail < 2)
+				continue;
+
+			for(sz = 0; sz < GDISP_PATHCAL_SIZES; sz++) {
+				// Fit the shape on the display
+				n = pathSizes[op][sz];
+				if (n > g->g.Width)
+					n = g->g.Width;
+				if (op != gdispPathOpLine && n > g->g.Height)
+					n = g->g.Height;
+
+				// If it is now in a smaller size class the result is the same as for that class
+				t = op == gdispPathOpLine ? (gU32)n : (gU32)n * n;
+				if (sz && (t <= PATHCAL_SMALL || (sz == 2 && t <= PATHCAL_MEDIUM))) {
+					cal.path[op][sz] = cal.path[op][sz-1];
+					continue;
+				}
+
+				// Only use a later way if it is clearly faster
+				path = gdispPathAuto;
+				best = 0;
+				for(i = 0; i < 4; i++) {
+					if (pathOrder[op][i] == gdispPathAuto || !pathAvailable(g, (gdispPathOp)op, pathOrder[op][i]))
+						continue;
+					t = pathMeasure(g, (gdispPathOp)op, sz, pathOrder[op][i], n, buffer);
+					if (path == gdispPathAuto) {
+						path = pathOrder[op][i];
+						best = t;
+						cal.path[op][sz] = gdispPathAuto;
+					} else if (t < best - best/8) {
+						best = t;
+						cal.path[op][sz] = pathOrder[op][i];
+					}
+				}
+			}
+		}
+		if (buffer)
+			gfxFree(buffer);
+
+		MUTEX_ENTER(g);
+		g->pathcal = cal;
+		#if GDISP_NEED_STATISTICS
+			memset(&g->stats, 0, sizeof(gdispStats));
+		#endif
+		MUTEX_EXIT(g);
+	}
+
+	void gdispGGetPathCal(GDisplay *g, gdispPathCal *cal) {
+		MUTEX_ENTER(g);
+		*cal = g->pathcal;
+		MUTEX_EXIT(g);
+	}
+
+	gBool gdispGSetPathCal(GDisplay *g, const gdispPathCal *cal) {
+		unsigned	op, sz;
+
+		if (cal->version != GDISP_PATHCAL_VERSION)
+			return gFalse;
+		for(op = 0; op < gdispPathOps; op++) {
+			for(sz = 0; sz < GDISP_PATHCAL_SIZES; sz++) {
+				if (!pathAvailable(g, (gdispPathOp)op, cal->path[op][sz]))
+					return gFalse;
+			}
+		}
+		MUTEX_ENTER(g);
+		g->pathcal = *cal;
+		MUTEX_EXIT(g);
+		return gTrue;
+	}
+#endif
+
 /*===========================================================================*/
 /* High Level Driver Routines.                                               */
 /*===========================================================================*/
@@ -2968,6 +4006,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 	cx = x+cx-1; cy = y+cy-1;			// cx, cy are now the end point.
 
 	MUTEX_ENTER(g);
+	STAT_PRIMITIVE(g, gdispStatBox);
 
 	g->p.color = color;
 
@@ -2999,6 +4038,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		epnt = &pntarray[cnt-1];
 
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatPoly);
 		g->p.color = color;
 		for(p = pntarray; p < epnt; p++) {
 			g->p.x=tx+p->x; g->p.y=ty+p->y; g->p.x1=tx+p[1].x; g->p.y1=ty+p[1].y; line_clip(g);
@@ -3045,6 +4085,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 
 		// Do all the line segments
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatPoly);
 		g->p.color = color;
 		while(1) {
 			/* Determine our boundary */
@@ -3261,6 +4302,276 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 			gdispGFillConvexPoly(g, x0, y0, pntarray, 8, color);
 		}
 	}
+
+	/* Thick polyline support.
+	 * The outline of the whole polyline is built as a single (possibly self-overlapping) polygon
+	 * which is then filled with a non-zero winding scanline fill. Every pixel is therefore
+	 * drawn exactly once irrespective of how many segments, joins or caps cover it.
+	 */
+	#define THICK_SUBPIXEL		16		// Sub-pixel precision of the offset vectors (1/16th pixel)
+	#define THICK_MITERLIMIT	4		// Maximum miter length as a multiple of the line width (as per SVG)
+
+	typedef struct thickPoint {
+		fixed	x, y;
+	} thickPoint;
+
+	typedef struct thickCrossing {
+		fixed	x;
+		int		dir;
+	} thickCrossing;
+
+	// Add the point (x,y) + (ox,oy) where the offset is in sub-pixel units of a half line width
+	static thickPoint *thick_point(thickPoint *p, gCoord x, gCoord y, gCoord ox, gCoord oy) {
+		p->x = FIXED(x) + (fixed)ox * (FIXED(1) / (2*THICK_SUBPIXEL));
+		p->y = FIXED(y) + (fixed)oy * (FIXED(1) / (2*THICK_SUBPIXEL));
+		return p+1;
+	}
+
+	// Add the intermediate points of the arc from offset a to offset b (exclusive) by recursive bisection
+	static thickPoint *thick_arc(thickPoint *p, gCoord x, gCoord y, gCoord ax, gCoord ay, gCoord bx, gCoord by, gCoord r, unsigned depth) {
+		gCoord	mx, my;
+
+		if (!depth || (ax+bx == 0 && ay+by == 0))
+			return p;
+
+		// The bisector of a and b scaled to the radius
+		get_normal_vector(-(ay+by), ax+bx, r, &mx, &my);
+
+		p = thick_arc(p, x, y, ax, ay, mx, my, r, depth-1);
+		p = thick_point(p, x, y, mx, my);
+		return thick_arc(p, x, y, mx, my, bx, by, r, depth-1);
+	}
+
+	// Add a half circle from offset n around the direction (dx,dy) to offset -n (both exclusive)
+	static thickPoint *thick_halfcircle(thickPoint *p, gCoord x, gCoord y, gCoord nx, gCoord ny, gCoord dx, gCoord dy, gCoord r, unsigned depth) {
+		gCoord	mx, my;
+
+		get_normal_vector(-dy, dx, r, &mx, &my);
+		p = thick_arc(p, x, y, nx, ny, mx, my, r, depth);
+		p = thick_point(p, x, y, mx, my);
+		return thick_arc(p, x, y, mx, my, -nx, -ny, r, depth);
+	}
+
+	// Add the points joining two segments at (x,y) on one side of the polyline.
+	// (ux,uy) and (vx,vy) are the incoming and outgoing directions along the outline.
+	// (o1x,o1y) and (o2x,o2y) are the offsets of that side for the incoming and outgoing segments.
+	static thickPoint *thick_join(thickPoint *p, gCoord x, gCoord y, gCoord ux, gCoord uy, gCoord vx, gCoord vy,
+								gCoord o1x, gCoord o1y, gCoord o2x, gCoord o2y, gCoord r, gLineJoin join, unsigned depth) {
+		gI32	cross;
+
+		cross = (gI32)ux * vy - (gI32)uy * vx;
+
+		// Continuing in the same direction - nothing to join
+		if (!cross && (gI32)ux * vx + (gI32)uy * vy > 0)
+			return thick_point(p, x, y, o1x, o1y);
+
+		// The inside of the turn - go via the center point. The non-zero winding fill takes care of the overlap.
+		if (cross < 0) {
+			p = thick_point(p, x, y, o1x, o1y);
+			p = thick_point(p, x, y, 0, 0);
+			return thick_point(p, x, y, o2x, o2y);
+		}
+
+		// The outside of the turn
+		switch(join) {
+		case gLineJoinMiter:
+			if (cross) {
+				long long	ox, oy, wx, wy, lim;
+
+				// Intersect the two offset lines
+				wx = (long long)(o2x - o1x) * (FIXED(1) / (2*THICK_SUBPIXEL));
+				wy = (long long)(o2y - o1y) * (FIXED(1) / (2*THICK_SUBPIXEL));
+				ox = (long long)o1x * (FIXED(1) / (2*THICK_SUBPIXEL)) + ux * (wx * vy - wy * vx) / cross;
+				oy = (long long)o1y * (FIXED(1) / (2*THICK_SUBPIXEL)) + uy * (wx * vy - wy * vx) / cross;
+
+				// Only use the miter point if it is within the miter limit
+				lim = (long long)r * (THICK_MITERLIMIT * FIXED(1) / (2*THICK_SUBPIXEL));
+				if (ox * ox + oy * oy <= lim * lim) {
+					p->x = FIXED(x) + (fixed)ox;
+					p->y = FIXED(y) + (fixed)oy;
+					return p+1;
+				}
+			}
+			// Otherwise fall back to a bevel
+			break;
+
+		case gLineJoinRound:
+			p = thick_point(p, x, y, o1x, o1y);
+			if (cross)
+				p = thick_arc(p, x, y, o1x, o1y, o2x, o2y, r, depth);
+			else
+				p = thick_halfcircle(p, x, y, o1x, o1y, ux, uy, r, depth);
+			return thick_point(p, x, y, o2x, o2y);
+
+		case gLineJoinBevel:
+		default:
+			break;
+		}
+
+		p = thick_point(p, x, y, o1x, o1y);
+		return thick_point(p, x, y, o2x, o2y);
+	}
+
+	// Fill a polygon (specified in fixed point) using the non-zero winding rule.
+	// Pixels are filled if their center is inside the polygon.
+	static void thick_fillpoly(GDisplay *g, const thickPoint *pts, unsigned cnt, thickCrossing *xings) {
+		const thickPoint	*p0, *p1, *epnt;
+		fixed				ymin, ymax, yc;
+		gCoord				y, y1;
+		unsigned			i, j, nx;
+		int					winding;
+		thickCrossing		t;
+
+		epnt = &pts[cnt-1];
+
+		/* Find the vertical extent */
+		ymin = ymax = pts->y;
+		for(p0 = pts+1; p0 <= epnt; p0++) {
+			if (p0->y < ymin) ymin = p0->y;
+			if (p0->y > ymax) ymax = p0->y;
+		}
+		y = NONFIXED(ymin - FIXED0_5 + (FIXED(1)-1));
+		y1 = NONFIXED(ymax - FIXED0_5 + (FIXED(1)-1));
+		#if NEED_CLIPPING
+			#if GDISP_HARDWARE_CLIP == HARDWARE_AUTODETECT
+				if (!gvmt(g)->setclip)
+			#endif
+			{
+				if (y < g->clipy0) y = g->clipy0;
+				if (y1 > g->clipy1) y1 = g->clipy1;
+			}
+		#endif
+
+		for(; y < y1; y++) {
+			yc = FIXED(y) + FIXED0_5;
+
+			/* Find the edge crossings for this scanline (using insertion sort as there are normally very few) */
+			nx = 0;
+			for(p0 = epnt, p1 = pts; p1 <= epnt; p0 = p1++) {
+				if (p0->y <= yc && yc < p1->y)
+					t.dir = 1;
+				else if (p1->y <= yc && yc < p0->y)
+					t.dir = -1;
+				else
+					continue;
+				t.x = p0->x + (fixed)(((long long)(yc - p0->y) * (p1->x - p0->x)) / (p1->y - p0->y));
+				for(j = nx++; j && xings[j-1].x > t.x; j--)
+					xings[j] = xings[j-1];
+				xings[j] = t;
+			}
+
+			/* Draw each span where the winding is non-zero - each pixel once only */
+			for(i = 0, winding = 0; i < nx; i++) {
+				if (!winding)
+					g->p.x = NONFIXED(xings[i].x - FIXED0_5 + (FIXED(1)-1));
+				winding += xings[i].dir;
+				if (!winding) {
+					g->p.x1 = NONFIXED(xings[i].x - FIXED0_5 + (FIXED(1)-1)) - 1;
+					if (g->p.x1 >= g->p.x) {
+						g->p.y = y;
+						hline_clip(g);
+					}
+				}
+			}
+		}
+	}
+
+	void gdispGDrawThickPolyline(GDisplay *g, gCoord tx, gCoord ty, const gPoint *pntarray, unsigned cnt, gColor color, gCoord width, gLineJoin join, gBool round) {
+		gPoint			*pts, *nrm, *dir;
+		thickPoint		*outline, *p;
+		unsigned		i, n, depth, arcpts, maxpts;
+		gCoord			r;
+
+		if (!cnt || width <= 0)
+			return;
+
+		// Space for the points, normals and directions
+		if (!(pts = gfxAlloc(cnt * 3 * sizeof(gPoint))))
+			return;
+		nrm = pts + cnt;
+		dir = nrm + cnt;
+
+		/* Remove duplicate points as they have no direction */
+		pts[0].x = tx + pntarray[0].x;
+		pts[0].y = ty + pntarray[0].y;
+		for(i = 1, n = 0; i < cnt; i++) {
+			if (pntarray[i].x + tx != pts[n].x || pntarray[i].y + ty != pts[n].y) {
+				n++;
+				pts[n].x = tx + pntarray[i].x;
+				pts[n].y = ty + pntarray[i].y;
+			}
+		}
+
+		/* n is now the number of segments. Draw the same dot as a zero length thick line if there are none. */
+		if (!n) {
+			tx = pts[0].x;
+			ty = pts[0].y;
+			gfxFree(pts);
+			gdispGDrawThickLine(g, tx, ty, tx, ty, color, width, round);
+			return;
+		}
+		for(i = 0; i < n; i++) {
+			dir[i].x = pts[i+1].x - pts[i].x;
+			dir[i].y = pts[i+1].y - pts[i].y;
+		}
+
+		/* Compute a normal vector for each segment with length 'width' in sub-pixel units */
+		r = width * THICK_SUBPIXEL;
+		for(i = 0; i < n; i++)
+			get_normal_vector(dir[i].x, dir[i].y, r, &nrm[i].x, &nrm[i].y);
+
+		/* More arc points for wider lines */
+		depth = width < 4 ? 1 : (width < 12 ? 2 : 3);
+		arcpts = (1 << depth) - 1;
+
+		/* Work out the maximum number of outline points */
+		maxpts = round ? 4 + 2 * (2*arcpts + 1) : 4;
+		for(i = 1; i < n; i++) {
+			if (join != gLineJoinRound)
+				maxpts += 5;
+			else if ((gI32)dir[i-1].x * dir[i].y != (gI32)dir[i-1].y * dir[i].x)
+				maxpts += arcpts + 5;
+			else
+				maxpts += 2 * (2*arcpts + 3);
+		}
+		if (!(outline = gfxAlloc(maxpts * (sizeof(thickPoint) + sizeof(thickCrossing))))) {
+			gfxFree(pts);
+			return;
+		}
+
+		/* The left side going forward */
+		p = thick_point(outline, pts[0].x, pts[0].y, nrm[0].x, nrm[0].y);
+		for(i = 1; i < n; i++)
+			p = thick_join(p, pts[i].x, pts[i].y, dir[i-1].x, dir[i-1].y, dir[i].x, dir[i].y,
+							nrm[i-1].x, nrm[i-1].y, nrm[i].x, nrm[i].y, r, join, depth);
+		p = thick_point(p, pts[n].x, pts[n].y, nrm[n-1].x, nrm[n-1].y);
+
+		/* The end cap */
+		if (round)
+			p = thick_halfcircle(p, pts[n].x, pts[n].y, nrm[n-1].x, nrm[n-1].y, dir[n-1].x, dir[n-1].y, r, depth);
+
+		/* The right side going backward */
+		p = thick_point(p, pts[n].x, pts[n].y, -nrm[n-1].x, -nrm[n-1].y);
+		for(i = n-1; i > 0; i--)
+			p = thick_join(p, pts[i].x, pts[i].y, -dir[i].x, -dir[i].y, -dir[i-1].x, -dir[i-1].y,
+							-nrm[i].x, -nrm[i].y, -nrm[i-1].x, -nrm[i-1].y, r, join, depth);
+		p = thick_point(p, pts[0].x, pts[0].y, -nrm[0].x, -nrm[0].y);
+
+		/* The start cap */
+		if (round)
+			p = thick_halfcircle(p, pts[0].x, pts[0].y, -nrm[0].x, -nrm[0].y, -dir[0].x, -dir[0].y, r, depth);
+
+		/* Fill the outline */
+		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatPoly);
+		g->p.color = color;
+		thick_fillpoly(g, outline, p - outline, (thickCrossing *)(outline + maxpts));
+		autoflush(g);
+		MUTEX_EXIT(g);
+
+		gfxFree(outline);
+		gfxFree(pts);
+	}
 #endif
 
 #if GDISP_NEED_TEXT
@@ -3375,6 +4686,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 		g->t.font = font;
 		g->t.clipx0 = x;
 		g->t.clipy0 = y;
@@ -3390,6 +4702,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 		g->p.cx = mf_character_width(font, c) + font->baseline_x;
 		g->p.cy = font->height;
 		g->t.font = font;
@@ -3412,6 +4725,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 		g->t.font = font;
 		g->t.clipx0 = x;
 		g->t.clipy0 = y;
@@ -3428,6 +4742,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 		g->p.cx = mf_get_string_width(font, str, 0, 0) + font->baseline_x;
 		g->p.cy = font->height;
 		g->t.font = font;
@@ -3453,6 +4768,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 
 		// Apply padding
 		#if GDISP_NEED_TEXT_BOXPADLR != 0 || GDISP_NEED_TEXT_BOXPADTB != 0
@@ -3531,6 +4847,7 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 		if (!font)
 			return;
 		MUTEX_ENTER(g);
+		STAT_PRIMITIVE(g, gdispStatText);
 
 		g->p.x = x;
 		g->p.y = y;
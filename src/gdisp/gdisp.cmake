@@ -9,6 +9,11 @@ list(APPEND ugfx_SOURCES
     ${ROOT_PATH}/gdisp.c
     ${ROOT_PATH}/gdisp_fonts.c
     ${ROOT_PATH}/gdisp_pixmap.c
+    ${ROOT_PATH}/gdisp_layer.c
+    ${ROOT_PATH}/gdisp_mirror.c
+    ${ROOT_PATH}/gdisp_sprite.c
+    ${ROOT_PATH}/gdisp_trace.c
+    ${ROOT_PATH}/gdisp_accel.c
     ${ROOT_PATH}/gdisp_image.c
     ${ROOT_PATH}/gdisp_image_native.c
     ${ROOT_PATH}/gdisp_image_gif.c
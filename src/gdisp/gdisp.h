@@ -72,6 +72,16 @@ typedef enum gJustify {
 #define JUSTIFYMASK_HORIZONTAL	(gJustifyLeft|gJustifyCenter|gJustifyRight)
 #define JUSTIFYMASK_VERTICAL	(gJustifyTop|gJustifyMiddle|gJustifyBottom)
 
+/**
+ * @enum gLineJoin
+ * @brief   Type for the way thick line segments are joined.
+ */
+typedef enum gLineJoin {
+	gLineJoinMiter,				/**< Extend the outer edges until they meet (limited to a bevel for very sharp angles) */
+	gLineJoinBevel,				/**< Cut off the outer corner */
+	gLineJoinRound				/**< Round off the outer corner */
+} gLineJoin;
+
 /**
  * @enum gFontmetric
  * @brief   Type for the font metric.
@@ -118,6 +128,119 @@ typedef enum gPowermode {
 	gPowerOn							/**< Turn the display on. */
 } gPowermode;
 
+#if GDISP_NEED_STATISTICS || defined(__DOXYGEN__)
+	/**
+	 * @brief   The groups of drawing primitives that statistics are kept for
+	 * @pre		GDISP_NEED_STATISTICS must be GFXON in your gfxconf.h
+	 */
+	typedef enum gdispStatPrimitive {
+		gdispStatOther,					/**< Flush, control, query, clipping and anything outside a primitive */
+		gdispStatPixel,					/**< gdispGDrawPixel() */
+		gdispStatLine,					/**< gdispGDrawLine() */
+		gdispStatClear,					/**< gdispGClear() */
+		gdispStatFill,					/**< gdispGFillArea() */
+		gdispStatBlit,					/**< gdispGBlitArea() (including most image drawing) */
+		gdispStatBox,					/**< gdispGDrawBox() */
+		gdispStatCircle,				/**< Circles and ellipses */
+		gdispStatArc,					/**< Arcs and arc sectors */
+		gdispStatPoly,					/**< Polygons, thick lines and thick polylines */
+		gdispStatText,					/**< Characters and strings */
+		gdispStatStream,				/**< gdispGStreamStart() etc */
+		gdispStatRead,					/**< gdispGGetPixelColor() and gdispGReadArea() */
+		gdispStatScroll,				/**< gdispGVerticalScroll() */
+		gdispStatPrimitives				/**< The number of primitive groups */
+	} gdispStatPrimitive;
+
+	/**
+	 * @brief   The types of low level driver calls that statistics are kept for
+	 * @pre		GDISP_NEED_STATISTICS must be GFXON in your gfxconf.h
+	 */
+	typedef enum gdispStatLLD {
+		gdispStatLLDPixel,				/**< Single pixel writes */
+		gdispStatLLDFill,				/**< Area fills and clears */
+		gdispStatLLDBlit,				/**< Bitmap blits */
+		gdispStatLLDStream,				/**< Each streaming read or write call */
+		gdispStatLLDRead,				/**< Single pixel reads */
+		gdispStatLLDScroll,				/**< Hardware scrolling */
+		gdispStatLLDOther,				/**< Flush, control, query and clipping */
+		gdispStatLLDTypes				/**< The number of driver call types */
+	} gdispStatLLD;
+
+	/**
+	 * @brief   The performance statistics for a display
+	 * @pre		GDISP_NEED_STATISTICS must be GFXON in your gfxconf.h
+	 * @note	Times are measured using GDISP_STATISTICS_CLOCK() which defaults to gfxSystemTicks().
+	 */
+	typedef struct gdispStats {
+		gU32	calls[gdispStatPrimitives];		/**< The number of calls to each primitive group */
+		gU32	pixels[gdispStatPrimitives];	/**< The number of pixels each primitive group sent to (or read from) the driver */
+		gU32	lldcalls[gdispStatLLDTypes];	/**< The number of low level driver calls of each type */
+		gU32	lldtime;						/**< The time spent inside the low level driver */
+		gU32	mutexwait;						/**< The time spent waiting for the display lock (GDISP_NEED_MULTITHREAD only) */
+	} gdispStats;
+#endif
+
+#if GDISP_NEED_FRAMECLOCK || defined(__DOXYGEN__)
+	/**
+	 * @brief   The frame clock statistics for a display
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 * @note	Frame times are the time taken to flush a frame measured in system ticks.
+	 */
+	typedef struct gdispFrameStats {
+		gU32	frames;								/**< The number of frames flushed */
+		gU32	skipped;							/**< The number of clock ticks where nothing had been drawn */
+		gU32	late;								/**< The number of frames that took longer than the frame period */
+		gU32	longest;							/**< The longest frame time */
+		gU32	histogram[GDISP_FRAMECLOCK_BUCKETS];	/**< The frames in each quarter of a frame period. The last bucket counts all longer frames. */
+	} gdispFrameStats;
+#endif
+
+#if GDISP_NEED_PATHCAL || defined(__DOXYGEN__)
+	/**
+	 * @brief   The ways a driver can be asked to draw
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 */
+	typedef enum gdispPath {
+		gdispPathAuto,					/**< The way used without a calibration. Bitfill, stream, fill then pixel for blits; fill, stream then pixel otherwise. */
+		gdispPathBitfill,				/**< A bitmap blit (blits only) */
+		gdispPathFill,					/**< Area fills (blits are drawn as runs of the same color) */
+		gdispPathStream,				/**< A streamed write */
+		gdispPathPixel					/**< Single pixels */
+	} gdispPath;
+
+	/**
+	 * @brief   The drawing operations that are calibrated
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 */
+	typedef enum gdispPathOp {
+		gdispPathOpLine,				/**< Horizontal lines (including the lines of filled shapes) */
+		gdispPathOpFill,				/**< gdispGFillArea() and boxes */
+		gdispPathOpBlit,				/**< gdispGBlitArea() */
+		gdispPathOps					/**< The number of operations */
+	} gdispPathOp;
+
+	/**
+	 * @brief   The number of size classes each operation is calibrated for
+	 * @details	Up to 16 pixels, up to 256 pixels and more than 256 pixels
+	 */
+	#define GDISP_PATHCAL_SIZES		3
+
+	/**
+	 * @brief   The version of the gdispPathCal layout. Saved calibrations of another version are rejected.
+	 */
+	#define GDISP_PATHCAL_VERSION	1
+
+	/**
+	 * @brief   The calibration of a display
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 * @note	This holds only bytes so it can be saved and reloaded as it is.
+	 */
+	typedef struct gdispPathCal {
+		gU8		version;								/**< GDISP_PATHCAL_VERSION */
+		gU8		path[gdispPathOps][GDISP_PATHCAL_SIZES];	/**< The gdispPath used for each operation and size class */
+	} gdispPathCal;
+#endif
+
 /*
  * Our black box display structure.
  */
@@ -384,6 +507,151 @@ gU8 gdispGGetContrast(GDisplay *g);
 void gdispGFlush(GDisplay *g);
 #define gdispFlush()									gdispGFlush(GDISP)
 
+#if GDISP_NEED_ASYNCFLUSH || defined(__DOXYGEN__)
+	/**
+	 * @brief	A function called when an asynchronous flush has finished
+	 *
+	 * @param[in] g		The display that was flushed
+	 * @param[in] param	The parameter passed to @p gdispGFlushAsync()
+	 *
+	 * @note	This is called on the GDISP flush thread. It must not wait for a flush of the display.
+	 */
+	typedef void (*gdispFlushCallback)(GDisplay *g, void *param);
+
+	#if GFX_USE_GEVENT || defined(__DOXYGEN__)
+		#define GEVENT_GDISP_FLUSH		(GEVENT_GDISP_FIRST+0)
+
+		/**
+		 * @brief	The event sent when an asynchronous flush has finished
+		 */
+		typedef struct GEventGDispFlush {
+			GEventType		type;				/**< The type of this event (GEVENT_GDISP_FLUSH) */
+			GDisplay *		display;			/**< The display that was flushed */
+		} GEventGDispFlush;
+	#endif
+
+	/**
+	 * @brief   Flush the display without waiting for the flush to finish
+	 *
+	 * @param[in] g 	The display to use
+	 * @param[in] fn	A function to call when the flush has finished (or 0)
+	 * @param[in] param	A parameter for the function
+	 *
+	 * @return	gFalse if the GDISP flush thread could not be started
+	 *
+	 * @note	The flush is done by a GDISP thread. Drivers that can send a frame from a back buffer
+	 * 			(GDISP_HARDWARE_FLUSHSEND) only keep the display locked while the changes are copied
+	 * 			so the application can draw the next frame while this one is sent. For other drivers
+	 * 			drawing on the display waits until the flush has finished.
+	 * @note	A flush asked for while an earlier one for the display has not yet started is merged
+	 * 			with it. If both have a callback only the later one is called.
+	 * @note	If the display does not need flushing the callback is called before this returns.
+	 * @note	Listeners on the source returned by @p gdispGGetFlushSource() are sent a
+	 * 			GEVENT_GDISP_FLUSH event after the callback.
+	 *
+	 * @api
+	 */
+	gBool gdispGFlushAsync(GDisplay *g, gdispFlushCallback fn, void *param);
+	#define gdispFlushAsync(fn, param)					gdispGFlushAsync(GDISP,fn,param)
+
+	/**
+	 * @brief   Wait for asynchronous flushes of the display to finish
+	 *
+	 * @param[in] g 	The display to use
+	 * @param[in] ms	The maximum time to wait
+	 *
+	 * @return	gTrue if there is no asynchronous flush waiting or running
+	 *
+	 * @api
+	 */
+	gBool gdispGFlushWait(GDisplay *g, gDelay ms);
+	#define gdispFlushWait(ms)							gdispGFlushWait(GDISP,ms)
+
+	#if GFX_USE_GEVENT || defined(__DOXYGEN__)
+		/**
+		 * @brief   Get the source of GEVENT_GDISP_FLUSH events for a display
+		 *
+		 * @param[in] g 	The display to use
+		 *
+		 * @api
+		 */
+		GSourceHandle gdispGGetFlushSource(GDisplay *g);
+		#define gdispGetFlushSource()					gdispGGetFlushSource(GDISP)
+	#endif
+#endif
+
+#if GDISP_NEED_FRAMECLOCK || defined(__DOXYGEN__)
+	/**
+	 * @brief   Set the target frame rate of a display
+	 *
+	 * @param[in] g 	The display to use
+	 * @param[in] fps	The frames per second. 0 stops the frame clock.
+	 *
+	 * @note	The display is flushed at each tick of its frame clock but only if something has
+	 * 			been drawn since the last flush.
+	 * @note	Flushes are done on the GTIMER thread.
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	void gdispGSetFrameRate(GDisplay *g, unsigned fps);
+	#define gdispSetFrameRate(fps)						gdispGSetFrameRate(GDISP,fps)
+
+	/**
+	 * @brief   Get the target frame rate of a display
+	 *
+	 * @param[in] g 	The display to use
+	 *
+	 * @return	The frames per second or 0 if the frame clock is stopped
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	unsigned gdispGGetFrameRate(GDisplay *g);
+	#define gdispGetFrameRate()							gdispGGetFrameRate(GDISP)
+
+	/**
+	 * @brief   Wait for the next tick of the frame clock of a display
+	 *
+	 * @param[in] g 	The display to use
+	 * @param[in] ms	The maximum time to wait
+	 *
+	 * @return	gTrue if the tick happened (and anything drawn before it has been flushed)
+	 *
+	 * @note	Calling this after drawing each frame paces the application to the frame clock.
+	 * 			When flushing takes longer than a frame the missed ticks are skipped so the
+	 * 			application is slowed to the rate the display can be flushed at.
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	gBool gdispGFrameWait(GDisplay *g, gDelay ms);
+	#define gdispFrameWait(ms)							gdispGFrameWait(GDISP,ms)
+
+	/**
+	 * @brief   Get the frame clock statistics of a display
+	 *
+	 * @param[in] g 	The display to use
+	 * @param[out] stats	The statistics
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	void gdispGGetFrameStats(GDisplay *g, gdispFrameStats *stats);
+	#define gdispGetFrameStats(stats)					gdispGGetFrameStats(GDISP,stats)
+
+	/**
+	 * @brief   Reset the frame clock statistics of a display
+	 *
+	 * @param[in] g 	The display to use
+	 * @pre		GDISP_NEED_FRAMECLOCK must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	void gdispGResetFrameStats(GDisplay *g);
+	#define gdispResetFrameStats()						gdispGResetFrameStats(GDISP)
+#endif
+
 /**
  * @brief   Clear the display to the specified color.
  *
@@ -782,6 +1050,26 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 	 */
 	gColor gdispGGetPixelColor(GDisplay *g, gCoord x, gCoord y);
 	#define gdispGetPixelColor(x,y)							gdispGGetPixelColor(GDISP,x,y)
+
+	/**
+	 * @brief   Read a rectangular area of the display into a buffer.
+	 * @pre		GDISP_NEED_PIXELREAD must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the area to read
+	 * @param[out] buffer	The buffer to fill. It must hold cx * cy pixels and is filled row by row.
+	 *
+	 * @note	The buffer uses the same layout as @p gdispGBlitArea() so the area can be put back
+	 * 			with a single blit.
+	 * @note	Pixels outside the display are not read and the corresponding buffer entries are left unchanged.
+	 * @note	This is much faster than calling @p gdispGGetPixelColor() for each pixel, particularly
+	 * 			on displays that support streamed reads.
+	 *
+	 * @api
+	 */
+	void gdispGReadArea(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gPixel *buffer);
+	#define gdispReadArea(x,y,cx,cy,b)						gdispGReadArea(GDISP,x,y,cx,cy,b)
 #endif
 
 /* Scrolling Function - clears the area scrolled out */
@@ -842,6 +1130,81 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 	#define gdispQuery(w)									gdispGQuery(GDISP,w)
 #endif
 
+/* Performance statistics */
+
+#if GDISP_NEED_STATISTICS || defined(__DOXYGEN__)
+	/**
+	 * @brief   Get the performance statistics for a display.
+	 * @pre		GDISP_NEED_STATISTICS must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 * @param[out] stats	Filled with a copy of the current statistics
+	 *
+	 * @api
+	 */
+	void gdispGGetStatistics(GDisplay *g, gdispStats *stats);
+	#define gdispGetStatistics(s)							gdispGGetStatistics(GDISP,s)
+
+	/**
+	 * @brief   Reset the performance statistics for a display to zero.
+	 * @pre		GDISP_NEED_STATISTICS must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 *
+	 * @api
+	 */
+	void gdispGResetStatistics(GDisplay *g);
+	#define gdispResetStatistics()							gdispGResetStatistics(GDISP)
+#endif
+
+/* Driver path calibration */
+
+#if GDISP_NEED_PATHCAL || defined(__DOXYGEN__)
+	/**
+	 * @brief   Measure the fastest way for a display to draw lines, fills and blits.
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 *
+	 * @note	Each way the driver has is timed drawing a few sizes in the top left corner of the
+	 * 			display using GDISP_STARTUP_COLOR. The display should not be in use while this runs
+	 * 			and it is left with that area filled.
+	 * @note	A way later in the gdispPath order is only chosen when it is clearly faster.
+	 * @note	This is done when each display is initialised if GDISP_PATHCAL_STARTUP is GFXON.
+	 *
+	 * @api
+	 */
+	void gdispGCalibratePaths(GDisplay *g);
+	#define gdispCalibratePaths()							gdispGCalibratePaths(GDISP)
+
+	/**
+	 * @brief   Get the calibration of a display so it can be saved.
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 * @param[out] cal		Filled with the calibration
+	 *
+	 * @api
+	 */
+	void gdispGGetPathCal(GDisplay *g, gdispPathCal *cal);
+	#define gdispGetPathCal(cal)							gdispGGetPathCal(GDISP,cal)
+
+	/**
+	 * @brief   Load a saved calibration into a display.
+	 * @pre		GDISP_NEED_PATHCAL must be GFXON in your gfxconf.h
+	 *
+	 * @param[in] g 		The display to use
+	 * @param[in] cal		The calibration
+	 *
+	 * @return	gFalse if the calibration is for another version or uses a way of drawing the
+	 * 			driver doesn't have. The display is then unchanged.
+	 *
+	 * @api
+	 */
+	gBool gdispGSetPathCal(GDisplay *g, const gdispPathCal *cal);
+	#define gdispSetPathCal(cal)							gdispGSetPathCal(GDISP,cal)
+#endif
+
 #if GDISP_NEED_CONVEX_POLYGON || defined(__DOXYGEN__)
 	/**
 	 * @brief   Draw an enclosed polygon (convex, non-convex or complex).
@@ -900,6 +1263,33 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 	 */
 	void gdispGDrawThickLine(GDisplay *g, gCoord x0, gCoord y0, gCoord x1, gCoord y1, gColor color, gCoord width, gBool round);
 	#define gdispDrawThickLine(x0,y0,x1,y1,c,w,r)			gdispGDrawThickLine(GDISP,x0,y0,x1,y1,c,w,r)
+
+	/**
+	 * @brief   Draw a connected series of lines with a specified thickness
+	 * @details The line thickness is specified in pixels. The points are joined using
+	 *          the specified join style and the line ends can be selected to be either flat or round.
+	 * @pre		GDISP_NEED_CONVEX_POLYGON must be GFXON in your gfxconf.h
+	 * @note	The outline of the entire polyline is filled in a single pass so each pixel is drawn
+	 * 			only once. This is much faster than calling gdispGDrawThickLine() for each segment and
+	 * 			doesn't overdraw at the joints.
+	 * @note	Miter joins that would extend beyond 4 times the line width are drawn as bevel joins.
+	 * @note	A single point (or points that are all the same) is drawn as the same dot as a zero
+	 * 			length gdispGDrawThickLine().
+	 * @note	This routine allocates memory for the outline. If there is not enough memory nothing is drawn.
+	 *
+	 * @param[in] g			The display to use
+	 * @param[in] tx, ty	Transform all points in pntarray by tx, ty
+	 * @param[in] pntarray	An array of points
+	 * @param[in] cnt		The number of points in the array
+	 * @param[in] color		The color to use
+	 * @param[in] width		The width of the line
+	 * @param[in] join		How the line segments are joined
+	 * @param[in] round		Use round ends for the line
+	 *
+	 * @api
+	 */
+	void gdispGDrawThickPolyline(GDisplay *g, gCoord tx, gCoord ty, const gPoint *pntarray, unsigned cnt, gColor color, gCoord width, gLineJoin join, gBool round);
+	#define gdispDrawThickPolyline(x,y,p,i,c,w,j,r)			gdispGDrawThickPolyline(GDISP,x,y,p,i,c,w,j,r)
 #endif
 
 /* Text Functions */
@@ -1227,6 +1617,21 @@ void gdispGDrawBox(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor
 #if GDISP_NEED_PIXMAP || defined(__DOXYGEN__)
 	#include "gdisp_pixmap.h"
 #endif
+#if GDISP_NEED_LAYERS || defined(__DOXYGEN__)
+	#include "gdisp_layer.h"
+#endif
+#if GDISP_NEED_MIRROR || defined(__DOXYGEN__)
+	#include "gdisp_mirror.h"
+#endif
+#if GDISP_NEED_SPRITES || defined(__DOXYGEN__)
+	#include "gdisp_sprite.h"
+#endif
+#if GDISP_NEED_TRACE || defined(__DOXYGEN__)
+	#include "gdisp_trace.h"
+#endif
+#if GDISP_NEED_ACCEL || defined(__DOXYGEN__)
+	#include "gdisp_accel.h"
+#endif
 
 /* V2 compatibility */
 #if GFX_COMPAT_V2
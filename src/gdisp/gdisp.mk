@@ -6,6 +6,11 @@
 GFXSRC +=   $(GFXLIB)/src/gdisp/gdisp.c \
 			$(GFXLIB)/src/gdisp/gdisp_fonts.c \
 			$(GFXLIB)/src/gdisp/gdisp_pixmap.c \
+			$(GFXLIB)/src/gdisp/gdisp_layer.c \
+			$(GFXLIB)/src/gdisp/gdisp_mirror.c \
+			$(GFXLIB)/src/gdisp/gdisp_sprite.c \
+			$(GFXLIB)/src/gdisp/gdisp_trace.c \
+			$(GFXLIB)/src/gdisp/gdisp_accel.c \
 			$(GFXLIB)/src/gdisp/gdisp_image.c \
 			$(GFXLIB)/src/gdisp/gdisp_image_native.c \
 			$(GFXLIB)/src/gdisp/gdisp_image_gif.c \
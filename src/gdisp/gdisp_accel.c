@@ -0,0 +1,470 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "../../gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_ACCEL
+
+#include "gdisp_driver.h"
+
+#include <string.h>			// for memmove()
+
+/*===========================================================================*/
+/* Runtime pixel formats.                                                    */
+/*===========================================================================*/
+
+// How to unpack and pack the pixels of a surface
+typedef struct accelFormat {
+	gU8		bytes;				// Bytes per pixel (1, 2 or 4) or 0 if the format is not supported
+	gU8		gray;				// Gray scale rather than true color
+	gU8		bits[3];			// The bits of red, green and blue (or just bits[0] for gray scale)
+	gU8		shift[3];			// Where red, green and blue are in the pixel
+} accelFormat;
+
+static gBool accelGetFormat(gU16 format, accelFormat *f) {
+	unsigned	total;
+
+	switch(format & GDISP_COLORSYSTEM_MASK) {
+	case GDISP_COLORSYSTEM_RGB:
+	case GDISP_COLORSYSTEM_BGR:
+		f->gray = gFalse;
+		f->bits[0] = (format >> 8) & 0x0F;
+		f->bits[1] = (format >> 4) & 0x0F;
+		f->bits[2] = format & 0x0F;
+		if (!f->bits[0] || !f->bits[1] || !f->bits[2] || f->bits[0] > 8 || f->bits[1] > 8 || f->bits[2] > 8)
+			return gFalse;
+		if ((format & GDISP_COLORSYSTEM_MASK) == GDISP_COLORSYSTEM_RGB) {
+			f->shift[0] = f->bits[1] + f->bits[2];
+			f->shift[1] = f->bits[2];
+			f->shift[2] = 0;
+		} else {
+			f->shift[0] = 0;
+			f->shift[1] = f->bits[0];
+			f->shift[2] = f->bits[0] + f->bits[1];
+		}
+		total = f->bits[0] + f->bits[1] + f->bits[2];
+		break;
+	case GDISP_COLORSYSTEM_GRAYSCALE:
+		// One pixel per byte as the GDISP color type stores them
+		f->gray = gTrue;
+		f->bits[0] = format & 0xFF;
+		if (!f->bits[0] || f->bits[0] > 8)
+			return gFalse;
+		f->shift[0] = 0;
+		total = 8;
+		break;
+	default:
+		return gFalse;
+	}
+	f->bytes = total <= 8 ? 1 : (total <= 16 ? 2 : 4);
+	return gTrue;
+}
+
+static GFXINLINE gU32 accelGet(const gU8 *p, unsigned bytes) {
+	switch(bytes) {
+	case 1:		return *p;
+	case 2:		return *(const gU16 *)p;
+	default:	return *(const gU32 *)p;
+	}
+}
+
+static GFXINLINE void accelPut(gU8 *p, unsigned bytes, gU32 v) {
+	switch(bytes) {
+	case 1:		*p = (gU8)v;			break;
+	case 2:		*(gU16 *)p = (gU16)v;	break;
+	default:	*(gU32 *)p = v;			break;
+	}
+}
+
+// Expand a component of n bits to 8 bits
+static GFXINLINE gU8 accelExpand(gU32 v, unsigned n) {
+	v &= (1 << n) - 1;
+	return (gU8)((v * 255 + ((1 << n) - 1) / 2) / ((1 << n) - 1));
+}
+
+// Unpack a pixel to 0xRRGGBB
+static gU32 accelUnpack(const accelFormat *f, gU32 v) {
+	gU32	l;
+
+	if (f->gray) {
+		l = accelExpand(v, f->bits[0]);
+		return (l << 16) | (l << 8) | l;
+	}
+	return ((gU32)accelExpand(v >> f->shift[0], f->bits[0]) << 16)
+		|  ((gU32)accelExpand(v >> f->shift[1], f->bits[1]) << 8)
+		|  accelExpand(v >> f->shift[2], f->bits[2]);
+}
+
+// Pack 0xRRGGBB into a pixel
+static gU32 accelPack(const accelFormat *f, gU32 rgb) {
+	gU32	r, g, b;
+
+	r = (rgb >> 16) & 0xFF;
+	g = (rgb >> 8) & 0xFF;
+	b = rgb & 0xFF;
+	if (f->gray)
+		return ((r + g + g + b) >> 2) >> (8 - f->bits[0]);
+	return ((r >> (8 - f->bits[0])) << f->shift[0])
+		|  ((g >> (8 - f->bits[1])) << f->shift[1])
+		|  ((b >> (8 - f->bits[2])) << f->shift[2]);
+}
+
+// Blend two 0xRRGGBB colors. alpha is the weight of fg.
+static gU32 accelBlend(gU32 fg, gU32 bg, gU8 alpha) {
+	gU32	res, x;
+	int		i;
+
+	res = 0;
+	for(i = 0; i < 24; i += 8) {
+		x = ((fg >> i) & 0xFF) * alpha + ((bg >> i) & 0xFF) * (255 - alpha) + 128;
+		res |= ((x + (x >> 8)) >> 8) << i;
+	}
+	return res;
+}
+
+static gBool accelValidRect(const gdispSurface *s, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+	return s->pixels && x >= 0 && y >= 0 && cx > 0 && cy > 0 && x + cx <= s->width && y + cy <= s->height;
+}
+
+static gBool accelValid(const gdispAccelJob *job) {
+	accelFormat		f;
+
+	if (!accelGetFormat(job->dst.format, &f) || !accelValidRect(&job->dst, job->dx, job->dy, job->cx, job->cy))
+		return gFalse;
+	switch(job->op) {
+	case GDISP_ACCEL_FILL:
+		// The color is a gColor so the system pixel format must be one the engines understand
+		return accelGetFormat(GDISP_PIXELFORMAT, &f);
+	case GDISP_ACCEL_COPY:
+		if (job->src.format != job->dst.format)
+			return gFalse;
+		break;
+	case GDISP_ACCEL_CONVERT:
+	case GDISP_ACCEL_BLEND:
+		if (!accelGetFormat(job->src.format, &f))
+			return gFalse;
+		break;
+	default:
+		return gFalse;
+	}
+	return accelValidRect(&job->src, job->sx, job->sy, job->cx, job->cy);
+}
+
+/*===========================================================================*/
+/* The CPU reference implementation.                                         */
+/*===========================================================================*/
+
+#define ACCEL_ADDR(s, x, y, bytes)		((gU8 *)(s)->pixels + (y) * (s)->linelen + (x) * (bytes))
+
+void gdispAccelRun(const gdispAccelJob *job) {
+	accelFormat		df, sf;
+	gU8				*d;
+	const gU8		*s;
+	gCoord			x, y;
+	gU32			v;
+	accelFormat		cf;
+
+	accelGetFormat(job->dst.format, &df);
+	d = ACCEL_ADDR(&job->dst, job->dx, job->dy, df.bytes);
+
+	switch(job->op) {
+	case GDISP_ACCEL_FILL:
+		if (!accelGetFormat(GDISP_PIXELFORMAT, &cf))
+			return;
+		v = accelPack(&df, accelUnpack(&cf, (gU32)job->color));
+		for(y = 0; y < job->cy; y++, d += job->dst.linelen) {
+			for(x = 0; x < job->cx; x++)
+				accelPut(d + x * df.bytes, df.bytes, v);
+		}
+		return;
+
+	case GDISP_ACCEL_COPY:
+		s = ACCEL_ADDR(&job->src, job->sx, job->sy, df.bytes);
+		// Move the rows in the right order if the rectangles overlap
+		if (job->src.pixels == job->dst.pixels && d > s) {
+			d += (job->cy - 1) * job->dst.linelen;
+			s += (job->cy - 1) * job->src.linelen;
+			for(y = 0; y < job->cy; y++, d -= job->dst.linelen, s -= job->src.linelen)
+				memmove(d, s, job->cx * df.bytes);
+		} else {
+			for(y = 0; y < job->cy; y++, d += job->dst.linelen, s += job->src.linelen)
+				memmove(d, s, job->cx * df.bytes);
+		}
+		return;
+
+	case GDISP_ACCEL_CONVERT:
+		accelGetFormat(job->src.format, &sf);
+		s = ACCEL_ADDR(&job->src, job->sx, job->sy, sf.bytes);
+		for(y = 0; y < job->cy; y++, d += job->dst.linelen, s += job->src.linelen) {
+			for(x = 0; x < job->cx; x++)
+				accelPut(d + x * df.bytes, df.bytes, accelPack(&df, accelUnpack(&sf, accelGet(s + x * sf.bytes, sf.bytes))));
+		}
+		return;
+
+	case GDISP_ACCEL_BLEND:
+		accelGetFormat(job->src.format, &sf);
+		s = ACCEL_ADDR(&job->src, job->sx, job->sy, sf.bytes);
+		for(y = 0; y < job->cy; y++, d += job->dst.linelen, s += job->src.linelen) {
+			for(x = 0; x < job->cx; x++) {
+				v = accelBlend(accelUnpack(&sf, accelGet(s + x * sf.bytes, sf.bytes)), accelUnpack(&df, accelGet(d + x * df.bytes, df.bytes)), job->alpha);
+				accelPut(d + x * df.bytes, df.bytes, accelPack(&df, v));
+			}
+		}
+		return;
+	}
+}
+
+/*===========================================================================*/
+/* Fences.                                                                   */
+/*===========================================================================*/
+
+// Has fence f been reached by done? This copes with the counters wrapping.
+#define FENCE_REACHED(done, f)		((gI32)((done) - (f)) >= 0)
+
+void _gdispAccelInit(gdispAccel *a, const gdispAccelVMT *vmt) {
+	a->vmt = vmt;
+	gfxMutexInit(&a->submitlock);
+	gfxMutexInit(&a->lock);
+	gfxSemInit(&a->donesem, 0, gSemMaxCount);
+	a->submitted = a->done = 0;
+	a->waiters = 0;
+}
+
+void _gdispAccelDone(gdispAccel *a) {
+	unsigned	n;
+
+	gfxMutexEnter(&a->lock);
+	if (!++a->done)								// Fence 0 is never used
+		a->done++;
+	n = a->waiters;
+	gfxMutexExit(&a->lock);
+
+	// Wake everyone waiting - they check their own fence
+	for(; n; n--)
+		gfxSemSignal(&a->donesem);
+}
+
+gdispAccelFence gdispAccelSubmit(gdispAccel *a, const gdispAccelJob *job) {
+	gdispAccelFence	f, prev;
+
+	if (!accelValid(job))
+		return 0;
+
+	gfxMutexEnter(&a->submitlock);
+	prev = a->submitted;
+	if (!(f = ++a->submitted))					// Fence 0 is never used
+		f = ++a->submitted;
+	if (!(a->vmt->ops & (1 << job->op)) || !a->vmt->start(a, job)) {
+		// The engine can't do it. Do it on the CPU once everything before it is done.
+		gdispAccelWait(a, prev, gDelayForever);
+		gdispAccelRun(job);
+		_gdispAccelDone(a);
+	}
+	gfxMutexExit(&a->submitlock);
+	return f;
+}
+
+gBool gdispAccelWait(gdispAccel *a, gdispAccelFence fence, gDelay ms) {
+	gTicks		start, period;
+	gBool		ret;
+
+	if (!fence)
+		return gTrue;
+	start = period = 0;
+	if (ms != gDelayForever && ms != gDelayNone) {
+		start = gfxSystemTicks();
+		period = gfxMillisecondsToTicks(ms);
+	}
+
+	gfxMutexEnter(&a->lock);
+	while(!(ret = FENCE_REACHED(a->done, fence)) && ms != gDelayNone) {
+		a->waiters++;
+		gfxMutexExit(&a->lock);
+		ret = gfxSemWait(&a->donesem, ms);
+		gfxMutexEnter(&a->lock);
+		a->waiters--;
+
+		// Other jobs finishing also wake us so check the time has not run out
+		if (ms != gDelayForever && (!ret || gfxSystemTicks() - start >= period)) {
+			ret = FENCE_REACHED(a->done, fence);
+			break;
+		}
+	}
+	gfxMutexExit(&a->lock);
+	return ret;
+}
+
+void gdispAccelSync(gdispAccel *a) {
+	gdispAccelWait(a, a->submitted, gDelayForever);
+}
+
+void gdispAccelDelete(gdispAccel *a) {
+	gdispAccelSync(a);
+	gfxSemDestroy(&a->donesem);
+	gfxMutexDestroy(&a->lock);
+	gfxMutexDestroy(&a->submitlock);
+	a->vmt->deinit(a);
+}
+
+/*===========================================================================*/
+/* The software engine.                                                      */
+/*===========================================================================*/
+
+typedef struct swAccel {
+	gdispAccel		a;						// Must be first
+	gThread			thread;
+	gSem			jobsem;					// The jobs waiting in the queue
+	gSem			freesem;				// The free slots in the queue
+	unsigned		head, tail;
+	gBool			quit;
+	gdispAccelJob	queue[GDISP_ACCEL_QUEUE];
+	} swAccel;
+
+static GFX_THREAD_FUNCTION(swAccelThread, param) {
+	swAccel		*sw;
+
+	sw = (swAccel *)param;
+	while(1) {
+		gfxSemWait(&sw->jobsem, gDelayForever);
+		if (sw->quit)
+			break;
+		gdispAccelRun(&sw->queue[sw->tail]);
+		sw->tail = (sw->tail + 1) % GDISP_ACCEL_QUEUE;
+		gfxSemSignal(&sw->freesem);
+		_gdispAccelDone(&sw->a);
+	}
+	gfxThreadReturn(0);
+}
+
+static gBool swAccelStart(gdispAccel *a, const gdispAccelJob *job) {
+	swAccel		*sw;
+
+	// Only the submitting thread (holding the submit lock) changes head
+	sw = (swAccel *)a;
+	gfxSemWait(&sw->freesem, gDelayForever);
+	sw->queue[sw->head] = *job;
+	sw->head = (sw->head + 1) % GDISP_ACCEL_QUEUE;
+	gfxSemSignal(&sw->jobsem);
+	return gTrue;
+}
+
+static void swAccelDeinit(gdispAccel *a) {
+	swAccel		*sw;
+
+	sw = (swAccel *)a;
+	sw->quit = gTrue;
+	gfxSemSignal(&sw->jobsem);
+	gfxThreadWait(sw->thread);
+	gfxSemDestroy(&sw->jobsem);
+	gfxSemDestroy(&sw->freesem);
+	gfxFree(sw);
+}
+
+static const gdispAccelVMT swAccelVMT = {
+	"Software",
+	(1 << GDISP_ACCEL_FILL) | (1 << GDISP_ACCEL_COPY) | (1 << GDISP_ACCEL_CONVERT) | (1 << GDISP_ACCEL_BLEND),
+	swAccelStart,
+	swAccelDeinit
+};
+
+gdispAccel *gdispAccelSoftwareCreate(void) {
+	swAccel		*sw;
+
+	if (!(sw = gfxAlloc(sizeof(swAccel))))
+		return 0;
+	_gdispAccelInit(&sw->a, &swAccelVMT);
+	gfxSemInit(&sw->jobsem, 0, GDISP_ACCEL_QUEUE);
+	gfxSemInit(&sw->freesem, GDISP_ACCEL_QUEUE, GDISP_ACCEL_QUEUE);
+	sw->head = sw->tail = 0;
+	sw->quit = gFalse;
+	if (!(sw->thread = gfxThreadCreate(0, GDISP_ACCEL_THREAD_STACKSIZE, GDISP_ACCEL_THREAD_PRIORITY, swAccelThread, sw))) {
+		gfxSemDestroy(&sw->jobsem);
+		gfxSemDestroy(&sw->freesem);
+		gfxSemDestroy(&sw->a.donesem);
+		gfxMutexDestroy(&sw->a.lock);
+		gfxMutexDestroy(&sw->a.submitlock);
+		gfxFree(sw);
+		return 0;
+	}
+	return &sw->a;
+}
+
+/*===========================================================================*/
+/* Displays.                                                                 */
+/*===========================================================================*/
+
+#if GDISP_NEED_MULTITHREAD
+	#define ACCEL_ENTER(g)		gfxMutexEnter(&(g)->mutex)
+	#define ACCEL_EXIT(g)		gfxMutexExit(&(g)->mutex)
+#else
+	#define ACCEL_ENTER(g)
+	#define ACCEL_EXIT(g)
+#endif
+
+void gdispGSetAccel(GDisplay *g, gdispAccel *a) {
+	ACCEL_ENTER(g);
+	if (g->accel)
+		gdispAccelSync(g->accel);
+	g->accel = a;
+	ACCEL_EXIT(g);
+}
+
+gBool gdispGGetSurface(GDisplay *g, gdispSurface *s) {
+	if (!g->surface.pixels)
+		return gFalse;
+	*s = g->surface;
+	return gTrue;
+}
+
+void gdispGAccelSync(GDisplay *g) {
+	if (g->accel)
+		gdispAccelSync(g->accel);
+}
+
+gBool _gdispAccelFill(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor color) {
+	gdispAccelJob	job;
+
+	if (!g->accel || !g->surface.pixels || (gI32)cx * cy < GDISP_ACCEL_MINAREA)
+		return gFalse;
+	job.op = GDISP_ACCEL_FILL;
+	job.dst = g->surface;
+	job.dx = x;
+	job.dy = y;
+	job.cx = cx;
+	job.cy = cy;
+	job.color = color;
+	return gdispAccelSubmit(g->accel, &job) != 0;
+}
+
+gBool _gdispAccelBlit(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, const gPixel *buffer, gCoord srcx, gCoord srcy, gCoord srccx) {
+	gdispAccelJob	job;
+	gdispAccelFence	f;
+
+	if (!g->accel || !g->surface.pixels || (gI32)cx * cy < GDISP_ACCEL_MINAREA)
+		return gFalse;
+	job.op = g->surface.format == GDISP_PIXELFORMAT ? GDISP_ACCEL_COPY : GDISP_ACCEL_CONVERT;
+	job.dst = g->surface;
+	job.dx = x;
+	job.dy = y;
+	job.cx = cx;
+	job.cy = cy;
+	job.src.pixels = (void *)buffer;
+	job.src.width = srccx;
+	job.src.height = srcy + cy;
+	job.src.linelen = srccx * sizeof(gPixel);
+	job.src.format = GDISP_PIXELFORMAT;
+	job.sx = srcx;
+	job.sy = srcy;
+	if (!(f = gdispAccelSubmit(g->accel, &job)))
+		return gFalse;
+
+	// The buffer belongs to the caller so it must be finished with before we return
+	gdispAccelWait(g->accel, f, gDelayForever);
+	return gTrue;
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_ACCEL */
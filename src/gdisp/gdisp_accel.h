@@ -0,0 +1,250 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_accel.h
+ *
+ * @defgroup Accel Accel
+ * @ingroup GDISP
+ *
+ * @brief   Sub-Module for handing fills, copies, format conversions and blends of memory surfaces to a 2D engine.
+ *
+ * @note	An accelerator (such as the STM32 DMA2D) works on rectangles of memory while the CPU gets on
+ * 			with something else. Jobs are submitted to the accelerator and each submission returns a fence.
+ * 			Waiting on the fence waits until that job and every job submitted before it has finished.
+ * @note	Each kind of engine provides a gdispAccelVMT. The software engine is the reference implementation.
+ * 			It runs the jobs on its own thread so that, for example, an image can be decoded into one pixmap
+ * 			while another pixmap is being copied to the display.
+ * @note	Drivers with the display in memory (the framebuffer driver and pixmaps) describe that memory with
+ * 			a gdispSurface. When an accelerator is set for such a display with @p gdispGSetAccel() large fills
+ * 			are done by the accelerator without waiting. The driver waits for the accelerator before the CPU
+ * 			next touches the display memory.
+ * @note	Surfaces hold one pixel in each 1, 2 or 4 bytes in any true color format or in a gray scale format.
+ * 			Packed and palette formats are not supported.
+ * @pre		GDISP_NEED_ACCEL must be GFXON in your gfxconf.h
+ * @{
+ */
+
+#ifndef _GDISP_ACCEL_H
+#define _GDISP_ACCEL_H
+
+#if (GFX_USE_GDISP && GDISP_NEED_ACCEL) || defined(__DOXYGEN__)
+
+/**
+ * @brief	An area of memory holding pixels
+ */
+typedef struct gdispSurface {
+	void *			pixels;			/**< The top left pixel */
+	gCoord			width;			/**< The width in pixels */
+	gCoord			height;			/**< The height in pixels */
+	gCoord			linelen;		/**< The number of bytes from one line to the next */
+	gU16			format;			/**< The pixel format (a GDISP_PIXELFORMAT_xxx) */
+} gdispSurface;
+
+/**
+ * @name	Accelerator operations
+ * @{
+ */
+#define GDISP_ACCEL_FILL		0		/**< Fill the destination rectangle with color */
+#define GDISP_ACCEL_COPY		1		/**< Copy the source rectangle to the destination. The formats must be the same. The rectangles may overlap. */
+#define GDISP_ACCEL_CONVERT		2		/**< Copy the source rectangle to the destination converting the pixel format */
+#define GDISP_ACCEL_BLEND		3		/**< Blend the source rectangle onto the destination using alpha */
+/** @} */
+
+/**
+ * @brief	A job for an accelerator
+ */
+typedef struct gdispAccelJob {
+	gU8				op;				/**< The GDISP_ACCEL_xxx operation */
+	gU8				alpha;			/**< BLEND: The weight of the source pixels (0 to 255) */
+	gCoord			cx, cy;			/**< The size of the rectangle */
+	gdispSurface	dst;			/**< The destination surface */
+	gCoord			dx, dy;			/**< The top left of the destination rectangle */
+	gdispSurface	src;			/**< The source surface. Not used by FILL. */
+	gCoord			sx, sy;			/**< The top left of the source rectangle. Not used by FILL. */
+	gColor			color;			/**< FILL: The color */
+} gdispAccelJob;
+
+/**
+ * @brief	A fence for a submitted job.
+ * @note	0 is never returned for a job that was done. Waiting on it returns immediately.
+ */
+typedef gU32	gdispAccelFence;
+
+typedef struct gdispAccel	gdispAccel;
+
+/**
+ * @brief	The entry points of a kind of accelerator
+ */
+typedef struct gdispAccelVMT {
+	const char *	name;			/**< The name of the engine */
+	gU8				ops;			/**< The operations the engine can do. Bit n is set for operation n. */
+	/**
+	 * @brief	Start (or queue) a job
+	 * @return	gFalse if the engine can't do this job. It is then done by the CPU once all earlier jobs have finished.
+	 * @note	Jobs must finish in the order they were started. The engine calls @p _gdispAccelDone() for each one.
+	 * @note	The job structure belongs to the caller and may change as soon as this returns.
+	 */
+	gBool (*start)(gdispAccel *a, const gdispAccelJob *job);
+	/**
+	 * @brief	Free the engine
+	 * @note	There are no jobs running when this is called.
+	 */
+	void (*deinit)(gdispAccel *a);
+} gdispAccelVMT;
+
+/**
+ * @brief	An accelerator
+ * @note	Engines put this at the start of their own structure.
+ */
+struct gdispAccel {
+	const gdispAccelVMT *	vmt;
+	gMutex					submitlock;		// Keeps fences in the same order as the jobs
+	gMutex					lock;			// Protects done and waiters
+	gSem					donesem;		// Signalled once for each waiter when a job finishes
+	gdispAccelFence			submitted;		// The fence of the last job submitted
+	gdispAccelFence			done;			// The fence of the last job finished
+	unsigned				waiters;
+};
+
+/**
+ * @brief	Create an accelerator that does its jobs on its own thread
+ *
+ * @return	The accelerator or 0 if there is not enough memory
+ *
+ * @note	Jobs are queued to the thread. When GDISP_ACCEL_QUEUE jobs are waiting a submission
+ * 			waits for a free slot.
+ * @note	This is the reference for other engines and can do every operation.
+ *
+ * @api
+ */
+gdispAccel *gdispAccelSoftwareCreate(void);
+
+/**
+ * @brief	Delete an accelerator
+ *
+ * @param[in] a			The accelerator
+ *
+ * @note	This waits for all its jobs to finish. It must not be in use by any display.
+ *
+ * @api
+ */
+void gdispAccelDelete(gdispAccel *a);
+
+/**
+ * @brief	Submit a job
+ *
+ * @param[in] a			The accelerator
+ * @param[in] job		The job. It is copied so it can be changed as soon as this returns.
+ *
+ * @return	The fence for the job or 0 if the job is not valid (a format is not supported or
+ * 			a rectangle is not inside its surface).
+ *
+ * @note	The memory of the surfaces must not be touched by the CPU until the job has finished.
+ *
+ * @api
+ */
+gdispAccelFence gdispAccelSubmit(gdispAccel *a, const gdispAccelJob *job);
+
+/**
+ * @brief	Wait for a job
+ *
+ * @param[in] a			The accelerator
+ * @param[in] fence		The fence returned by @p gdispAccelSubmit()
+ * @param[in] ms		The maximum time to wait
+ *
+ * @return	gTrue if the job and all jobs submitted before it have finished
+ *
+ * @api
+ */
+gBool gdispAccelWait(gdispAccel *a, gdispAccelFence fence, gDelay ms);
+
+/**
+ * @brief	Has a job finished
+ *
+ * @param[in] a			The accelerator
+ * @param[in] fence		The fence returned by @p gdispAccelSubmit()
+ *
+ * @api
+ */
+#define gdispAccelIsDone(a, fence)			gdispAccelWait(a, fence, gDelayNone)
+
+/**
+ * @brief	Wait for all submitted jobs to finish
+ *
+ * @param[in] a			The accelerator
+ *
+ * @api
+ */
+void gdispAccelSync(gdispAccel *a);
+
+/**
+ * @brief	Do a job on the CPU
+ *
+ * @param[in] job		The job. It must be valid.
+ *
+ * @note	This is what the software engine runs. Other engines can use it for jobs they can't do.
+ *
+ * @api
+ */
+void gdispAccelRun(const gdispAccelJob *job);
+
+/**
+ * @brief	Set the accelerator that draws into the memory of a display
+ *
+ * @param[in] g			The display
+ * @param[in] a			The accelerator or 0 to draw with the CPU only
+ *
+ * @note	This only has an effect on displays that have a memory surface (see @p gdispGGetSurface()).
+ * @note	Fills of at least GDISP_ACCEL_MINAREA pixels are then done by the accelerator without waiting.
+ * 			Blits of that size are also done by the accelerator but the driver waits for them as the
+ * 			source buffer belongs to the caller.
+ *
+ * @api
+ */
+void gdispGSetAccel(GDisplay *g, gdispAccel *a);
+#define gdispSetAccel(a)					gdispGSetAccel(GDISP,a)
+
+/**
+ * @brief	Get the memory surface of a display
+ *
+ * @param[in] g			The display
+ * @param[out] s		The surface
+ *
+ * @return	gFalse if the display driver does not keep the display in memory
+ *
+ * @note	The surface is the memory as it is laid out. It does not change with the display orientation.
+ * @note	Jobs submitted directly to the display's accelerator are waited for by the driver before
+ * 			it next touches the memory. Jobs submitted to another accelerator must be waited for
+ * 			before drawing on the display again.
+ *
+ * @api
+ */
+gBool gdispGGetSurface(GDisplay *g, gdispSurface *s);
+#define gdispGetSurface(s)					gdispGGetSurface(GDISP,s)
+
+/**
+ * @brief	Wait for the accelerator of a display to finish
+ *
+ * @param[in] g			The display
+ *
+ * @note	Use this before reading or writing the display memory directly (eg. the bits of a pixmap).
+ *
+ * @api
+ */
+void gdispGAccelSync(GDisplay *g);
+#define gdispAccelSyncDisplay()				gdispGAccelSync(GDISP)
+
+/* Internal routines used by the accelerator engines and the drivers */
+void _gdispAccelInit(gdispAccel *a, const gdispAccelVMT *vmt);		// @notapi - Engines call this when creating an accelerator
+void _gdispAccelDone(gdispAccel *a);								// @notapi - Engines call this as each job finishes
+gBool _gdispAccelFill(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gColor color);	// @notapi - Fill in surface coordinates. gFalse if the CPU should do it.
+gBool _gdispAccelBlit(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, const gPixel *buffer, gCoord srcx, gCoord srcy, gCoord srccx);	// @notapi - gFalse if the CPU should do it.
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_ACCEL */
+#endif /* _GDISP_ACCEL_H */
+/** @} */
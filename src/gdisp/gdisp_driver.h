@@ -36,7 +36,7 @@
 #endif
 
 // Do we need to use VMT calling rather than direct calls to the driver?
-#if IS_MULTIPLE || GDISP_NEED_PIXMAP
+#if IS_MULTIPLE || GDISP_NEED_PIXMAP || GDISP_NEED_MIRROR
 	#define USE_VMT				GFXON
 #else
 	#define USE_VMT				GFXOFF
@@ -47,6 +47,11 @@
 	#define IN_PIXMAP_DRIVER	GFXOFF
 #endif
 
+// Are we in the mirror virtual driver
+#ifndef IN_MIRROR_DRIVER
+	#define IN_MIRROR_DRIVER	GFXOFF
+#endif
+
 //------------------------------------------------------------------------------------------------------------
 
 // Our special auto-detect hardware code which uses the VMT.
@@ -88,6 +93,19 @@
 		#define GDISP_HARDWARE_FLUSH		HARDWARE_DEFAULT
 	#endif
 
+	/**
+	 * @brief   The driver can send a flushed frame without the display being locked.
+	 * @details Can be set to GFXON, GFXOFF or HARDWARE_AUTODETECT
+	 *
+	 * @note	HARDWARE_AUTODETECT is only meaningful when GDISP_DRIVER_LIST is defined
+	 * @note	gdisp_lld_flush() then only copies what has changed into a back buffer and
+	 * 			gdisp_lld_flush_send() sends it to the controller while drawing carries on.
+	 * @note	This is only used when GDISP_NEED_ASYNCFLUSH is GFXON.
+	 */
+	#ifndef GDISP_HARDWARE_FLUSHSEND
+		#define GDISP_HARDWARE_FLUSHSEND	HARDWARE_DEFAULT
+	#endif
+
 	/**
 	 * @brief   Hardware streaming writing is supported.
 	 * @details Can be set to GFXON, GFXOFF or HARDWARE_AUTODETECT
@@ -123,6 +141,20 @@
 		#define GDISP_HARDWARE_STREAM_POS		HARDWARE_DEFAULT
 	#endif
 
+	/**
+	 * @brief   Hardware streaming can write a buffer of pixels in one call.
+	 * @details Can be set to GFXON, GFXOFF or HARDWARE_AUTODETECT
+	 *
+	 * @note	HARDWARE_AUTODETECT is only meaningful when GDISP_DRIVER_LIST is defined
+	 * @note	Blits then hand each row to the driver rather than each pixel. When the pixels
+	 * 			are already in the controller format the driver can pass them straight to the
+	 * 			board's buffer write routine.
+	 * @note	This is only used when GDISP_HARDWARE_STREAM_WRITE is also provided.
+	 */
+	#ifndef GDISP_HARDWARE_STREAM_BUFFER
+		#define GDISP_HARDWARE_STREAM_BUFFER	HARDWARE_DEFAULT
+	#endif
+
 	/**
 	 * @brief   Hardware accelerated draw pixel.
 	 * @details Can be set to GFXON, GFXOFF or HARDWARE_AUTODETECT
@@ -223,9 +255,21 @@
 
 //------------------------------------------------------------------------------------------------------------
 
-// For pixmaps certain routines MUST not be GFXOFF as they are needed for pixmap drawing
-//	Similarly some routines MUST not be GFXON as pixmap's don't provide them.
-#if GDISP_NEED_PIXMAP && !IN_DRIVER
+// Writing a buffer is part of a streamed write
+#if !GDISP_HARDWARE_STREAM_WRITE
+	#undef GDISP_HARDWARE_STREAM_BUFFER
+	#define GDISP_HARDWARE_STREAM_BUFFER	GFXOFF
+#endif
+
+// Sending a flush from a back buffer needs the locking of the asynchronous flush
+#if !GDISP_NEED_ASYNCFLUSH
+	#undef GDISP_HARDWARE_FLUSHSEND
+	#define GDISP_HARDWARE_FLUSHSEND		GFXOFF
+#endif
+
+// For pixmaps and mirrors certain routines MUST not be GFXOFF as they are needed for their drawing
+//	Similarly some routines MUST not be GFXON as they don't provide them.
+#if (GDISP_NEED_PIXMAP || GDISP_NEED_MIRROR) && !IN_DRIVER
 	#if !GDISP_HARDWARE_DEINIT
 		#undef GDISP_HARDWARE_DEINIT
 		#define GDISP_HARDWARE_DEINIT		HARDWARE_AUTODETECT
@@ -242,14 +286,22 @@
 		#undef GDISP_HARDWARE_CONTROL
 		#define GDISP_HARDWARE_CONTROL		HARDWARE_AUTODETECT
 	#endif
-	#if GDISP_HARDWARE_FLUSH == GFXON
+	#if GDISP_HARDWARE_FLUSH == GFXON || ((GDISP_NEED_LAYERS || GDISP_NEED_MIRROR) && !GDISP_HARDWARE_FLUSH)
 		#undef GDISP_HARDWARE_FLUSH
 		#define GDISP_HARDWARE_FLUSH		HARDWARE_AUTODETECT
 	#endif
+	#if GDISP_HARDWARE_FLUSHSEND == GFXON
+		#undef GDISP_HARDWARE_FLUSHSEND
+		#define GDISP_HARDWARE_FLUSHSEND	HARDWARE_AUTODETECT
+	#endif
 	#if GDISP_HARDWARE_STREAM_WRITE == GFXON
 		#undef GDISP_HARDWARE_STREAM_WRITE
 		#define GDISP_HARDWARE_STREAM_WRITE	HARDWARE_AUTODETECT
 	#endif
+	#if GDISP_HARDWARE_STREAM_BUFFER == GFXON
+		#undef GDISP_HARDWARE_STREAM_BUFFER
+		#define GDISP_HARDWARE_STREAM_BUFFER	HARDWARE_AUTODETECT
+	#endif
 	#if GDISP_HARDWARE_STREAM_READ == GFXON
 		#undef GDISP_HARDWARE_STREAM_READ
 		#define GDISP_HARDWARE_STREAM_READ	HARDWARE_AUTODETECT
@@ -334,13 +386,60 @@ struct GDisplay {
 	gU16					flags;
 		#define GDISP_FLG_INSTREAM		0x0001		// We are in a user based stream operation
 		#define GDISP_FLG_SCRSTREAM		0x0002		// The stream area currently covers the whole screen
-		#define GDISP_FLG_DRIVER		0x0004		// This flags and above are for use by the driver
+		#define GDISP_FLG_FRAMEDIRTY	0x0004		// Something has been drawn since the last flush (GDISP_NEED_FRAMECLOCK)
+		#define GDISP_FLG_LAYERFLUSH	0x0008		// The layer has been flushed while it was locked (GDISP_NEED_LAYERS)
+		#define GDISP_FLG_DRIVER		0x0010		// This flags and above are for use by the driver
 
 	// Multithread Mutex
 	#if GDISP_NEED_MULTITHREAD
 		gMutex				mutex;
 	#endif
 
+	// Performance statistics
+	#if GDISP_NEED_STATISTICS
+		gdispStats				stats;
+		gdispStatPrimitive		statprim;			// The primitive currently running
+	#endif
+
+	// The measured fastest way of drawing
+	#if GDISP_NEED_PATHCAL
+		gdispPathCal			pathcal;
+	#endif
+
+	// Low level driver call trace
+	#if GDISP_NEED_TRACE
+		struct gdispTrace		*trace;
+	#endif
+
+	// Frame clock
+	#if GDISP_NEED_FRAMECLOCK
+		GTimer					frametimer;
+		gU16					framerate;			// In frames per second. 0 when the clock is stopped.
+		gDelay					frameperiod;		// In milliseconds
+		gTicks					frameend;			// When the last tick finished
+		gU32					frameseq;			// Counts the clock ticks
+		gdispFrameStats			framestats;
+	#endif
+
+	// Asynchronous flushing
+	#if GDISP_NEED_ASYNCFLUSH
+		gMutex					flushmutex;			// Held from the start of a flush until the frame has been sent
+		gU8						flushstate;			// Protected by the GDISP flush lock
+		gdispFlushCallback		flushfn;			// Called when the waiting flush is done
+		void *					flushparam;
+	#endif
+
+	// 2D accelerator
+	#if GDISP_NEED_ACCEL
+		struct gdispAccel		*accel;				// The engine drawing into the surface (if any)
+		gdispSurface			surface;			// Set by drivers that keep the display in memory
+	#endif
+
+	// Software layers composited onto this display
+	#if GDISP_NEED_LAYERS
+		struct gdispLayerStack	*layers;
+	#endif
+
 	// Software clipping
 	#if GDISP_HARDWARE_CLIP != GFXON && (GDISP_NEED_CLIP || GDISP_NEED_VALIDATION)
 		gCoord					clipx0, clipy0;
@@ -373,7 +472,7 @@ struct GDisplay {
 			#endif
 		} t;
 	#endif
-	#if GDISP_LINEBUF_SIZE != 0 && ((GDISP_NEED_SCROLL && !GDISP_HARDWARE_SCROLL) || (!GDISP_HARDWARE_STREAM_WRITE && GDISP_HARDWARE_BITFILLS))
+	#if GDISP_LINEBUF_SIZE != 0 && ((GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL != GFXON) || (!GDISP_HARDWARE_STREAM_WRITE && GDISP_HARDWARE_BITFILLS))
 		// A pixel line buffer
 		gColor		linebuf[GDISP_LINEBUF_SIZE];
 	#endif
@@ -402,6 +501,8 @@ typedef struct GDISPVMT {
 	void *(*query)(GDisplay *g);					// Uses p.x (=what);
 	void (*setclip)(GDisplay *g);					// Uses p.x,p.y  p.cx,p.cy
 	void (*flush)(GDisplay *g);						// Uses no parameters
+	void (*flushsend)(GDisplay *g);					// Uses no parameters
+	void (*writebuffer)(GDisplay *g);				// Uses p.ptr, p.cx
 } GDISPVMT;
 
 //------------------------------------------------------------------------------------------------------------
@@ -450,6 +551,21 @@ typedef struct GDISPVMT {
 		LLDSPEC	void gdisp_lld_flush(GDisplay *g);
 	#endif
 
+	#if GDISP_HARDWARE_FLUSHSEND || defined(__DOXYGEN__)
+		/**
+		 * @brief   Send the frame saved by the last flush to the display
+		 * @pre		GDISP_HARDWARE_FLUSHSEND is GFXON
+		 *
+		 * @param[in]	g				The driver structure
+		 *
+		 * @note		This is called without the display being locked so drawing can carry on while
+		 * 				it runs. It must only use the back buffer filled by gdisp_lld_flush().
+		 * @note		GDISP ensures gdisp_lld_flush() and gdisp_lld_control() are not called while
+		 * 				this is running.
+		 */
+		LLDSPEC	void gdisp_lld_flush_send(GDisplay *g);
+	#endif
+
 	#if GDISP_HARDWARE_STREAM_WRITE || defined(__DOXYGEN__)
 		/**
 		 * @brief   Start a streamed write operation
@@ -500,6 +616,22 @@ typedef struct GDISPVMT {
 			 */
 			LLDSPEC	void gdisp_lld_write_pos(GDisplay *g);
 		#endif
+
+		#if GDISP_HARDWARE_STREAM_BUFFER || defined(__DOXYGEN__)
+			/**
+			 * @brief   Send a buffer of pixels to the current streaming position and then increment that position
+			 * @pre		GDISP_HARDWARE_STREAM_BUFFER is GFXON and GDISP_HARDWARE_STREAM_WRITE is GFXON
+			 *
+			 * @param[in]	g				The driver structure
+			 * @param[in]	g->p.ptr		The pixels (a const gPixel *)
+			 * @param[in]	g->p.cx			The number of pixels
+			 *
+			 * @note		The pixels are in the GDISP_PIXELFORMAT. When that is the same as the controller
+			 * 				format they can be sent without any conversion.
+			 * @note		The parameter variables must not be altered by the driver.
+			 */
+			LLDSPEC	void gdisp_lld_write_buffer(GDisplay *g);
+		#endif
 	#endif
 
 	#if GDISP_HARDWARE_STREAM_READ || defined(__DOXYGEN__)
@@ -681,9 +813,11 @@ typedef struct GDISPVMT {
 	#define gdisp_lld_init(g)				gvmt(g)->init(g)
 	#define gdisp_lld_deinit(g)				gvmt(g)->deinit(g)
 	#define gdisp_lld_flush(g)				gvmt(g)->flush(g)
+	#define gdisp_lld_flush_send(g)			gvmt(g)->flushsend(g)
 	#define gdisp_lld_write_start(g)		gvmt(g)->writestart(g)
 	#define gdisp_lld_write_pos(g)			gvmt(g)->writepos(g)
 	#define gdisp_lld_write_color(g)		gvmt(g)->writecolor(g)
+	#define gdisp_lld_write_buffer(g)		gvmt(g)->writebuffer(g)
 	#define gdisp_lld_write_stop(g)			gvmt(g)->writestop(g)
 	#define gdisp_lld_read_start(g)			gvmt(g)->readstart(g)
 	#define gdisp_lld_read_color(g)			gvmt(g)->readcolor(g)
@@ -709,8 +843,8 @@ typedef struct GDISPVMT {
 		#error "GDISP Driver: Either GDISP_HARDWARE_STREAM_WRITE or GDISP_HARDWARE_DRAWPIXEL must be GFXON"
 	#endif
 
-	// If we are not using multiple displays then hard-code the VMT name (except for the pixmap driver)
-	#if !IS_MULTIPLE && !IN_PIXMAP_DRIVER
+	// If we are not using multiple displays then hard-code the VMT name (except for the virtual drivers)
+	#if !IS_MULTIPLE && !IN_PIXMAP_DRIVER && !IN_MIRROR_DRIVER
 		#undef GDISP_DRIVER_VMT
 		#define GDISP_DRIVER_VMT		GDISPVMT_OnlyOne
 	#endif
@@ -813,6 +947,16 @@ typedef struct GDISPVMT {
 		#else
 			0,
 		#endif
+		#if GDISP_HARDWARE_FLUSHSEND
+			gdisp_lld_flush_send,
+		#else
+			0,
+		#endif
+		#if GDISP_HARDWARE_STREAM_BUFFER
+			gdisp_lld_write_buffer,
+		#else
+			0,
+		#endif
 	}};
 
 	//--------------------------------------------------------------------------------------------------------
@@ -1052,6 +1196,7 @@ typedef struct GDISPVMT {
 //------------------------------------------------------------------------------------------------------------
 
 #undef IN_PIXMAP_DRIVER
+#undef IN_MIRROR_DRIVER
 #undef IS_MULTIPLE
 #undef IN_DRIVER
 #undef USE_VMT
@@ -0,0 +1,283 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_epaper.h
+ *
+ * @defgroup EPaper EPaper
+ * @ingroup GDISP
+ *
+ * @brief   An update scheduler for the drivers of e-paper controllers.
+ *
+ * @note	Refreshing an e-paper panel takes hundreds of milliseconds and much of that time is the same
+ * 			whatever the size of the refreshed area. These helpers collect the areas drawn since the last
+ * 			refresh and merge them into a few aligned windows, only keeping two areas apart when the pixels
+ * 			saved are worth more than the cost of a second refresh.
+ * @note	Fast partial waveforms leave ghosting behind. The scheduler counts how much of the screen has
+ * 			been refreshed with the partial waveform and asks for a full refresh once that passes
+ * 			GDISP_EPAPER_GHOSTBUDGET percent, after GDISP_EPAPER_MAXPARTIALS partial refreshes or when
+ * 			most of the screen has changed anyway.
+ * @note	All coordinates are controller coordinates ie. after any rotation has been applied.
+ * @note	These routines are for use only by low level drivers. Include this file after gdisp_driver.h.
+ *
+ * @{
+ */
+
+#ifndef _GDISP_EPAPER_H
+#define _GDISP_EPAPER_H
+
+#if GFX_USE_GDISP || defined(__DOXYGEN__)
+
+/**
+ * @name	The refresh that is needed
+ * @{
+ */
+#define GDISP_EPAPER_NONE		0		/**< Nothing has changed */
+#define GDISP_EPAPER_PARTIAL	1		/**< Refresh each window using the fast partial waveform */
+#define GDISP_EPAPER_FULL		2		/**< Refresh the whole screen using the full waveform */
+/** @} */
+
+/**
+ * @brief	An area of the display waiting to be refreshed
+ * @note	x1 and y1 are exclusive
+ */
+typedef struct gdispEpaperWindow {
+	gCoord		x0, y0, x1, y1;
+} gdispEpaperWindow;
+
+/**
+ * @brief	The e-paper update scheduler for one display
+ */
+typedef struct gdispEpaper {
+	gCoord				width, height;			/**< The size of the panel */
+	gCoord				alignx, aligny;			/**< Windows start and end on multiples of these (powers of 2) */
+	gI32				overhead;				/**< The cost of refreshing one more window, measured in pixels */
+	gU32				ghost;					/**< The percent of the screen refreshed with the partial waveform since the last full refresh */
+	unsigned			partials;				/**< The partial refreshes since the last full refresh */
+	gI32				changed;				/**< An estimate of the pixels changed since the last refresh */
+	unsigned			nwin;					/**< The number of windows in use */
+	gdispEpaperWindow	win[GDISP_EPAPER_WINDOWS];
+} gdispEpaper;
+
+static GFXINLINE gI32 gdispEpaperArea(const gdispEpaperWindow *w) {
+	return (gI32)(w->x1 - w->x0) * (gI32)(w->y1 - w->y0);
+}
+
+// Would refreshing the union of a and b cost no more than refreshing them separately?
+static GFXINLINE gBool gdispEpaperShouldMerge(const gdispEpaper *e, const gdispEpaperWindow *a, const gdispEpaperWindow *b) {
+	gdispEpaperWindow	u;
+
+	// Touching or overlapping windows are always merged
+	if (a->x0 <= b->x1 && a->x1 >= b->x0 && a->y0 <= b->y1 && a->y1 >= b->y0)
+		return gTrue;
+	u.x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+	u.y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+	u.x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+	u.y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+	return gdispEpaperArea(&u) <= gdispEpaperArea(a) + gdispEpaperArea(b) + e->overhead;
+}
+
+static GFXINLINE void gdispEpaperUnion(gdispEpaperWindow *a, const gdispEpaperWindow *b) {
+	if (b->x0 < a->x0) a->x0 = b->x0;
+	if (b->y0 < a->y0) a->y0 = b->y0;
+	if (b->x1 > a->x1) a->x1 = b->x1;
+	if (b->y1 > a->y1) a->y1 = b->y1;
+}
+
+/**
+ * @brief	Mark the whole panel as needing a full refresh
+ *
+ * @param[in] e			The scheduler
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispEpaperDamageAll(gdispEpaper *e) {
+	e->nwin = 1;
+	e->win[0].x0 = e->win[0].y0 = 0;
+	e->win[0].x1 = e->width;
+	e->win[0].y1 = e->height;
+	e->changed = (gI32)e->width * (gI32)e->height;
+	e->ghost = GDISP_EPAPER_GHOSTBUDGET;
+}
+
+/**
+ * @brief	Initialise the scheduler
+ *
+ * @param[in] e				The scheduler
+ * @param[in] width, height	The size of the panel
+ * @param[in] alignx, aligny	The alignment the controller needs for a window. They must be powers of 2.
+ * @param[in] overhead		The fixed cost of each refresh window measured as the number of pixels that
+ * 							could be refreshed in the same time. Larger values merge windows more eagerly.
+ *
+ * @note	As the panel is non-volatile the first refresh is a full one.
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispEpaperInit(gdispEpaper *e, gCoord width, gCoord height, gCoord alignx, gCoord aligny, gI32 overhead) {
+	e->width = width;
+	e->height = height;
+	e->alignx = alignx;
+	e->aligny = aligny;
+	e->overhead = overhead;
+	e->partials = 0;
+	gdispEpaperDamageAll(e);
+}
+
+// Add an aligned window that needs refreshing, merging it with the others as needed
+static GFXINLINE void gdispEpaperAddWindow(gdispEpaper *e, gdispEpaperWindow *n) {
+	gdispEpaperWindow	*w, *best;
+	gI32				grow, bestgrow;
+	unsigned			i;
+
+	// Merge with any window where that is cheaper. The merged window may now be worth merging with others so keep going.
+	for(i = 0; i < e->nwin; i++) {
+		w = &e->win[i];
+		if (!gdispEpaperShouldMerge(e, n, w))
+			continue;
+		gdispEpaperUnion(n, w);
+		e->win[i] = e->win[--e->nwin];
+		i = (unsigned)-1;
+	}
+
+	// Room for a new one?
+	if (e->nwin < GDISP_EPAPER_WINDOWS) {
+		e->win[e->nwin++] = *n;
+		return;
+	}
+
+	// Merge it into the window that grows the least
+	best = e->win;
+	bestgrow = 0x7FFFFFFF;
+	for(i = 0; i < e->nwin; i++) {
+		gdispEpaperWindow	u;
+
+		u = e->win[i];
+		gdispEpaperUnion(&u, n);
+		grow = gdispEpaperArea(&u) - gdispEpaperArea(&e->win[i]);
+		if (grow < bestgrow) {
+			bestgrow = grow;
+			best = &e->win[i];
+		}
+	}
+	gdispEpaperUnion(best, n);
+}
+
+/**
+ * @brief	Add an area that needs refreshing
+ *
+ * @param[in] e				The scheduler
+ * @param[in] x0, y0		The top left of the area
+ * @param[in] x1, y1		The bottom right of the area (exclusive)
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispEpaperDamage(gdispEpaper *e, gCoord x0, gCoord y0, gCoord x1, gCoord y1) {
+	gdispEpaperWindow	n;
+
+	// Clip to the panel
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > e->width) x1 = e->width;
+	if (y1 > e->height) y1 = e->height;
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	// Windows grow well beyond what was drawn so keep a separate count of the pixels drawn.
+	// Areas drawn more than once are counted more than once.
+	e->changed += (gI32)(x1 - x0) * (gI32)(y1 - y0);
+
+	// Align
+	n.x0 = x0 & ~(e->alignx-1);
+	n.y0 = y0 & ~(e->aligny-1);
+	n.x1 = (x1 + e->alignx-1) & ~(e->alignx-1);
+	n.y1 = (y1 + e->aligny-1) & ~(e->aligny-1);
+	if (n.x1 > e->width) n.x1 = e->width;
+	if (n.y1 > e->height) n.y1 = e->height;
+	gdispEpaperAddWindow(e, &n);
+}
+
+/**
+ * @brief	Add a single pixel that needs refreshing
+ *
+ * @param[in] e				The scheduler
+ * @param[in] x, y			The pixel
+ *
+ * @note	This is quick when the pixel is already inside a window.
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispEpaperDamagePixel(gdispEpaper *e, gCoord x, gCoord y) {
+	gdispEpaperWindow	n;
+	unsigned			i;
+
+	e->changed++;
+	for(i = 0; i < e->nwin; i++) {
+		if (x >= e->win[i].x0 && x < e->win[i].x1 && y >= e->win[i].y0 && y < e->win[i].y1)
+			return;
+	}
+	n.x0 = x & ~(e->alignx-1);
+	n.y0 = y & ~(e->aligny-1);
+	n.x1 = n.x0 + e->alignx;
+	n.y1 = n.y0 + e->aligny;
+	if (n.x1 > e->width) n.x1 = e->width;
+	if (n.y1 > e->height) n.y1 = e->height;
+	gdispEpaperAddWindow(e, &n);
+}
+
+/**
+ * @brief	Decide what refresh is needed
+ *
+ * @param[in] e			The scheduler
+ *
+ * @return	GDISP_EPAPER_NONE, GDISP_EPAPER_PARTIAL or GDISP_EPAPER_FULL
+ *
+ * @note	For a partial refresh the driver refreshes each of the windows e->win[0 .. e->nwin-1].
+ * 			For a full refresh it still only needs to send the data in those windows to the controller.
+ *
+ * @notapi
+ */
+static GFXINLINE gU8 gdispEpaperPlan(gdispEpaper *e) {
+	if (!e->nwin)
+		return GDISP_EPAPER_NONE;
+	if (e->ghost >= GDISP_EPAPER_GHOSTBUDGET || e->partials >= GDISP_EPAPER_MAXPARTIALS)
+		return GDISP_EPAPER_FULL;
+
+	// A full refresh when most of the screen has changed anyway clears the ghosting for very little extra
+	if (e->changed / GDISP_EPAPER_FULLAREA >= (gI32)e->width * (gI32)e->height / 100)
+		return GDISP_EPAPER_FULL;
+	return GDISP_EPAPER_PARTIAL;
+}
+
+/**
+ * @brief	Record that a refresh has been done
+ *
+ * @param[in] e			The scheduler
+ * @param[in] mode		The refresh that was done
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispEpaperDone(gdispEpaper *e, gU8 mode) {
+	gI32		screen;
+
+	if (mode == GDISP_EPAPER_FULL) {
+		e->ghost = 0;
+		e->partials = 0;
+	} else if (mode == GDISP_EPAPER_PARTIAL) {
+		// The ghosting is left by the pixels that changed
+		screen = (gI32)e->width * (gI32)e->height;
+		if (e->changed > screen)
+			e->changed = screen;
+		e->ghost += (gU32)(e->changed / (screen / 100) + 1);
+		e->partials++;
+	}
+	e->changed = 0;
+	e->nwin = 0;
+}
+
+#endif /* GFX_USE_GDISP */
+#endif /* _GDISP_EPAPER_H */
+/** @} */
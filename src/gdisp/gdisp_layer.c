@@ -0,0 +1,503 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "../../gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_LAYERS
+
+#include "gdisp_driver.h"
+
+#include <string.h>			// for memcpy()
+
+#define LAYER_FLG_VISIBLE		0x0001
+#define LAYER_FLG_COLORKEY		0x0002
+
+typedef struct gdispLayer {
+	struct gdispLayer		*next;			// The next layer up
+	struct gdispLayerStack	*stack;			// The stack this layer belongs to
+	GDisplay				*display;		// The pixmap holding the layer contents
+	gCoord					x, y;			// The position on the real display
+	int						z;				// The z-order
+	gU16					flags;
+	gU8						alpha;
+	gColor					key;
+	gCoord					dx0, dy0, dx1, dy1;	// The area drawn since the last compose (layer coordinates). dx1 and dy1 are exclusive.
+	} gdispLayer;
+
+typedef struct layerRect {
+	gCoord					x0, y0, x1, y1;	// x1 and y1 are exclusive
+	} layerRect;
+
+typedef struct gdispLayerStack {
+	GDisplay				*display;		// The real display
+	gdispLayer				*layers;		// The bottom-most layer
+	gColor					background;
+	unsigned				ndamage;
+	layerRect				damage[GDISP_LAYER_DAMAGE_RECTS];
+	unsigned				bufsize;		// In pixels
+	gPixel					*buf;
+	#if GDISP_NEED_MULTITHREAD
+		gMutex				mutex;
+	#endif
+	} gdispLayerStack;
+
+// The stack is always locked before any of its layers. The layers are locked in stack order.
+#if GDISP_NEED_MULTITHREAD
+	#define STACK_ENTER(s)		gfxMutexEnter(&(s)->mutex)
+	#define STACK_EXIT(s)		gfxMutexExit(&(s)->mutex)
+	#define LAYER_ENTER(l)		gfxMutexEnter(&(l)->display->mutex)
+	#define LAYER_EXIT(l)		gfxMutexExit(&(l)->display->mutex)
+#else
+	#define STACK_ENTER(s)
+	#define STACK_EXIT(s)
+	#define LAYER_ENTER(l)
+	#define LAYER_EXIT(l)
+#endif
+
+#define LAYER_W(l)				((l)->display->g.Width)
+#define LAYER_H(l)				((l)->display->g.Height)
+
+/*===========================================================================*/
+/* Damage tracking.                                                          */
+/*===========================================================================*/
+
+static gI32 rectArea(const layerRect *r) {
+	return (gI32)(r->x1 - r->x0) * (gI32)(r->y1 - r->y0);
+}
+
+// Add a rectangle (in real display coordinates) to the damage list. The stack must be locked.
+static void stackDamage(gdispLayerStack *s, gCoord x0, gCoord y0, gCoord x1, gCoord y1) {
+	layerRect	*r, *best;
+	layerRect	u;
+	gI32		grow, bestgrow;
+	unsigned	i;
+
+	// Clip to the display
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > s->display->g.Width) x1 = s->display->g.Width;
+	if (y1 > s->display->g.Height) y1 = s->display->g.Height;
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	// Merge with any rectangle it overlaps or touches. The merged rectangle may now touch others so keep going.
+	for(i = 0; i < s->ndamage; i++) {
+		r = &s->damage[i];
+		if (x0 > r->x1 || x1 < r->x0 || y0 > r->y1 || y1 < r->y0)
+			continue;
+		if (r->x0 < x0) x0 = r->x0;
+		if (r->y0 < y0) y0 = r->y0;
+		if (r->x1 > x1) x1 = r->x1;
+		if (r->y1 > y1) y1 = r->y1;
+		s->damage[i] = s->damage[--s->ndamage];
+		i = (unsigned)-1;
+	}
+
+	// Room for a new one?
+	if (s->ndamage < GDISP_LAYER_DAMAGE_RECTS) {
+		r = &s->damage[s->ndamage++];
+		r->x0 = x0; r->y0 = y0; r->x1 = x1; r->y1 = y1;
+		return;
+	}
+
+	// Merge it into the rectangle that grows the least
+	best = s->damage;
+	bestgrow = 0x7FFFFFFF;
+	for(i = 0; i < s->ndamage; i++) {
+		r = &s->damage[i];
+		u.x0 = r->x0 < x0 ? r->x0 : x0;
+		u.y0 = r->y0 < y0 ? r->y0 : y0;
+		u.x1 = r->x1 > x1 ? r->x1 : x1;
+		u.y1 = r->y1 > y1 ? r->y1 : y1;
+		grow = rectArea(&u) - rectArea(r);
+		if (grow < bestgrow) {
+			bestgrow = grow;
+			best = r;
+		}
+	}
+	if (x0 < best->x0) best->x0 = x0;
+	if (y0 < best->y0) best->y0 = y0;
+	if (x1 > best->x1) best->x1 = x1;
+	if (y1 > best->y1) best->y1 = y1;
+}
+
+static void layerDamageAll(gdispLayer *l) {
+	stackDamage(l->stack, l->x, l->y, l->x + LAYER_W(l), l->y + LAYER_H(l));
+}
+
+// Move the area drawn on each layer into the damage list. The stack and the layers must be locked.
+static void stackCollectDamage(gdispLayerStack *s) {
+	gdispLayer	*l;
+
+	for(l = s->layers; l; l = l->next) {
+		if (l->dx0 >= l->dx1)
+			continue;
+		if ((l->flags & LAYER_FLG_VISIBLE))
+			stackDamage(s, l->x + l->dx0, l->y + l->dy0, l->x + l->dx1, l->y + l->dy1);
+		l->dx0 = l->dx1 = 0;
+	}
+}
+
+/*===========================================================================*/
+/* Compositing.                                                              */
+/*===========================================================================*/
+
+// Does this layer completely hide everything beneath it within the rectangle
+static gBool layerCovers(gdispLayer *l, const layerRect *r) {
+	return (l->flags & (LAYER_FLG_VISIBLE|LAYER_FLG_COLORKEY)) == LAYER_FLG_VISIBLE
+		&& l->alpha == 255
+		&& l->x <= r->x0 && l->y <= r->y0
+		&& l->x + LAYER_W(l) >= r->x1 && l->y + LAYER_H(l) >= r->y1;
+}
+
+// Composite one rectangle of the display into the buffer and send it. The stack and the layers must be locked.
+static void stackComposeRect(gdispLayerStack *s, const layerRect *r) {
+	gdispLayer		*l, *first;
+	const gColor	*src;
+	gPixel			*dst;
+	gCoord			cx, rows, y, yr, x0, x1, i;
+
+	cx = r->x1 - r->x0;
+
+	// Find the top-most layer that hides everything under it - there is no point drawing anything beneath that
+	first = 0;
+	for(l = s->layers; l; l = l->next) {
+		if (layerCovers(l, r))
+			first = l;
+	}
+
+	// Do as many lines in each pass as will fit in our buffer
+	rows = s->bufsize / cx;
+	for(y = r->y0; y < r->y1; y += rows) {
+		if (y + rows > r->y1)
+			rows = r->y1 - y;
+
+		for(yr = 0; yr < rows; yr++) {
+			dst = s->buf + yr * cx;
+
+			// The background
+			if (!first) {
+				for(i = 0; i < cx; i++)
+					dst[i] = s->background;
+			}
+
+			// Each layer from the bottom-most up
+			for(l = first ? first : s->layers; l; l = l->next) {
+				if (!(l->flags & LAYER_FLG_VISIBLE) || !l->alpha)
+					continue;
+				if (y + yr < l->y || y + yr >= l->y + LAYER_H(l))
+					continue;
+				x0 = l->x > r->x0 ? l->x : r->x0;
+				x1 = l->x + LAYER_W(l) < r->x1 ? l->x + LAYER_W(l) : r->x1;
+				if (x0 >= x1)
+					continue;
+
+				src = gdispPixmapGetBits(l->display) + (y + yr - l->y) * LAYER_W(l) + (x0 - l->x);
+				if (l->alpha == 255) {
+					if (!(l->flags & LAYER_FLG_COLORKEY)) {
+						memcpy(dst + (x0 - r->x0), src, (x1 - x0) * sizeof(gPixel));
+						continue;
+					}
+					for(i = x0 - r->x0; x0 < x1; x0++, i++, src++) {
+						if (*src != l->key)
+							dst[i] = *src;
+					}
+				} else {
+					for(i = x0 - r->x0; x0 < x1; x0++, i++, src++) {
+						if (!(l->flags & LAYER_FLG_COLORKEY) || *src != l->key)
+							dst[i] = gdispBlendColor(*src, dst[i], l->alpha);
+					}
+				}
+			}
+		}
+
+		gdispGBlitArea(s->display, r->x0, y, cx, rows, 0, 0, cx, s->buf);
+	}
+}
+
+static void stackCompose(gdispLayerStack *s) {
+	#if GDISP_NEED_MULTITHREAD
+		gdispLayer	*l;
+	#endif
+	unsigned	i;
+
+	// Nothing can be drawn on the layers while they are read
+	STACK_ENTER(s);
+	#if GDISP_NEED_MULTITHREAD
+		for(l = s->layers; l; l = l->next)
+			LAYER_ENTER(l);
+	#endif
+	stackCollectDamage(s);
+	for(i = 0; i < s->ndamage; i++)
+		stackComposeRect(s, &s->damage[i]);
+	s->ndamage = 0;
+	#if GDISP_NEED_MULTITHREAD
+		for(l = s->layers; l; l = l->next)
+			LAYER_EXIT(l);
+	#endif
+	STACK_EXIT(s);
+}
+
+/*===========================================================================*/
+/* Layer list management.                                                    */
+/*===========================================================================*/
+
+// Insert a layer into the stack in z-order. The stack must be locked.
+static void stackInsert(gdispLayerStack *s, gdispLayer *l) {
+	gdispLayer	**pl;
+
+	for(pl = &s->layers; *pl && (*pl)->z <= l->z; pl = &(*pl)->next);
+	l->next = *pl;
+	*pl = l;
+}
+
+// Remove a layer from the stack. The stack must be locked.
+static void stackRemove(gdispLayerStack *s, gdispLayer *l) {
+	gdispLayer	**pl;
+
+	for(pl = &s->layers; *pl; pl = &(*pl)->next) {
+		if (*pl == l) {
+			*pl = l->next;
+			break;
+		}
+	}
+}
+
+static gdispLayerStack *stackGet(GDisplay *g) {
+	gdispLayerStack		*s;
+
+	if (g->layers)
+		return g->layers;
+
+	if (!(s = gfxAlloc(sizeof(gdispLayerStack))))
+		return 0;
+
+	// The buffer must hold at least one full line in any orientation
+	s->bufsize = g->g.Width > g->g.Height ? g->g.Width : g->g.Height;
+	if (!(s->buf = gfxAlloc(s->bufsize * sizeof(gPixel)))) {
+		gfxFree(s);
+		return 0;
+	}
+	s->display = g;
+	s->layers = 0;
+	s->background = GDISP_STARTUP_COLOR;
+	s->ndamage = 0;
+	#if GDISP_NEED_MULTITHREAD
+		gfxMutexInit(&s->mutex);
+	#endif
+	g->layers = s;
+	return s;
+}
+
+// Free the stack of a display. Any layers left become plain pixmaps.
+static void stackFree(gdispLayerStack *s) {
+	gdispLayer		*l;
+
+	while((l = s->layers)) {
+		s->layers = l->next;
+		_gdispPixmapSetLayer(l->display, 0);
+		gfxFree(l);
+	}
+	s->display->layers = 0;
+	#if GDISP_NEED_MULTITHREAD
+		gfxMutexDestroy(&s->mutex);
+	#endif
+	gfxFree(s->buf);
+	gfxFree(s);
+}
+
+/*===========================================================================*/
+/* Internal routines called by the pixmap driver.                            */
+/*===========================================================================*/
+
+// This is called for every drawing operation on the layer so it only grows the layer's drawn area.
+//	The layer display is locked by the caller. The area is added to the stack when it is composed.
+void _gdispLayerDamage(gdispLayer *l, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+	if (l->dx0 >= l->dx1) {
+		l->dx0 = x;
+		l->dy0 = y;
+		l->dx1 = x + cx;
+		l->dy1 = y + cy;
+		return;
+	}
+	if (x < l->dx0) l->dx0 = x;
+	if (y < l->dy0) l->dy0 = y;
+	if (x + cx > l->dx1) l->dx1 = x + cx;
+	if (y + cy > l->dy1) l->dy1 = y + cy;
+}
+
+// The layer display is locked by the caller.
+void _gdispLayerFlush(gdispLayer *l) {
+	#if GDISP_NEED_MULTITHREAD
+		// Composing locks every layer so leave it until this layer is unlocked
+		l->display->flags |= GDISP_FLG_LAYERFLUSH;
+	#else
+		gdispGLayerCompose(l->stack->display);
+	#endif
+}
+
+GDisplay *_gdispLayerGetDisplay(GDisplay *g) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(g)))
+		return 0;
+	return l->stack->display;
+}
+
+// The layer display must not be locked by the caller.
+void _gdispLayerDestroy(gdispLayer *l) {
+	gdispLayerStack		*s;
+
+	s = l->stack;
+	STACK_ENTER(s);
+	_gdispPixmapSetLayer(l->display, 0);
+	if ((l->flags & LAYER_FLG_VISIBLE))
+		layerDamageAll(l);
+	stackRemove(s, l);
+	STACK_EXIT(s);
+	gfxFree(l);
+
+	// Without layers the stack is no longer needed. Put the background back where the layers were first.
+	if (!s->layers) {
+		stackCompose(s);
+		stackFree(s);
+	}
+}
+
+void _gdispLayerStackDestroy(GDisplay *g) {
+	if (g->layers)
+		stackFree(g->layers);
+}
+
+/*===========================================================================*/
+/* API routines.                                                             */
+/*===========================================================================*/
+
+GDisplay *gdispGLayerCreate(GDisplay *g, gCoord x, gCoord y, gCoord width, gCoord height, int z) {
+	gdispLayerStack		*s;
+	gdispLayer			*l;
+
+	if (!(s = stackGet(g)))
+		return 0;
+	if (!(l = gfxAlloc(sizeof(gdispLayer))))
+		return 0;
+	if (!(l->display = gdispPixmapCreate(width, height))) {
+		gfxFree(l);
+		return 0;
+	}
+	l->stack = s;
+	l->x = x;
+	l->y = y;
+	l->z = z;
+	l->flags = LAYER_FLG_VISIBLE;
+	l->alpha = 255;
+	l->key = 0;
+	l->dx0 = l->dy0 = l->dx1 = l->dy1 = 0;
+	_gdispPixmapSetLayer(l->display, l);
+
+	STACK_ENTER(s);
+	stackInsert(s, l);
+	layerDamageAll(l);
+	STACK_EXIT(s);
+	return l->display;
+}
+
+void gdispLayerMove(GDisplay *layer, gCoord x, gCoord y) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(layer)))
+		return;
+	STACK_ENTER(l->stack);
+	if ((l->flags & LAYER_FLG_VISIBLE)) {
+		layerDamageAll(l);
+		l->x = x;
+		l->y = y;
+		layerDamageAll(l);
+	} else {
+		l->x = x;
+		l->y = y;
+	}
+	STACK_EXIT(l->stack);
+}
+
+void gdispLayerSetZOrder(GDisplay *layer, int z) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(layer)))
+		return;
+	STACK_ENTER(l->stack);
+	stackRemove(l->stack, l);
+	l->z = z;
+	stackInsert(l->stack, l);
+	if ((l->flags & LAYER_FLG_VISIBLE))
+		layerDamageAll(l);
+	STACK_EXIT(l->stack);
+}
+
+void gdispLayerSetAlpha(GDisplay *layer, gU8 alpha) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(layer)) || l->alpha == alpha)
+		return;
+	STACK_ENTER(l->stack);
+	l->alpha = alpha;
+	if ((l->flags & LAYER_FLG_VISIBLE))
+		layerDamageAll(l);
+	STACK_EXIT(l->stack);
+}
+
+void gdispLayerSetColorKey(GDisplay *layer, gBool enable, gColor key) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(layer)))
+		return;
+	STACK_ENTER(l->stack);
+	l->key = key;
+	if (enable)
+		l->flags |= LAYER_FLG_COLORKEY;
+	else
+		l->flags &= ~LAYER_FLG_COLORKEY;
+	if ((l->flags & LAYER_FLG_VISIBLE))
+		layerDamageAll(l);
+	STACK_EXIT(l->stack);
+}
+
+void gdispLayerSetVisible(GDisplay *layer, gBool visible) {
+	gdispLayer	*l;
+
+	if (!(l = _gdispPixmapGetLayer(layer)))
+		return;
+	if (!visible == !(l->flags & LAYER_FLG_VISIBLE))
+		return;
+	STACK_ENTER(l->stack);
+	if (visible)
+		l->flags |= LAYER_FLG_VISIBLE;
+	else
+		l->flags &= ~LAYER_FLG_VISIBLE;
+	layerDamageAll(l);
+	STACK_EXIT(l->stack);
+}
+
+void gdispGLayerSetBackground(GDisplay *g, gColor color) {
+	gdispLayerStack		*s;
+
+	if (!(s = g->layers))
+		return;
+	STACK_ENTER(s);
+	s->background = color;
+	stackDamage(s, 0, 0, g->g.Width, g->g.Height);
+	STACK_EXIT(s);
+}
+
+void gdispGLayerCompose(GDisplay *g) {
+	if (!g->layers)
+		return;
+	stackCompose(g->layers);
+	gdispGFlush(g);
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_LAYERS */
@@ -0,0 +1,159 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_layer.h
+ *
+ * @defgroup Layers Layers
+ * @ingroup GDISP
+ *
+ * @brief   Sub-Module for software composited display layers.
+ *
+ * @note	A layer is a pixmap that is attached to a real display at a position and z-order.
+ * 			It can be drawn to using the standard gdispGxxxx calls. Only the rectangle bounding what
+ * 			has been drawn on each layer is composited onto the real display when the layer (or the
+ * 			real display) is flushed.
+ * @note	Layers are composited bottom-most first. Each layer can have a global alpha value and/or a
+ * 			transparent color key. A layer that is fully opaque hides everything underneath it and
+ * 			the compositor does not need to touch the lower layers at all for those areas.
+ * @note	A layer must stay in its created orientation (gOrientation0). The real display may be
+ * 			in any orientation.
+ * @pre		GDISP_NEED_LAYERS must be GFXON in your gfxconf.h
+ * @{
+ */
+
+#ifndef _GDISP_LAYER_H
+#define _GDISP_LAYER_H
+
+#if (GFX_USE_GDISP && GDISP_NEED_LAYERS) || defined(__DOXYGEN__)
+
+/**
+ * @brief	Create a new layer on a display
+ *
+ * @param[in] g			The display the layer is composited onto
+ * @param[in] x, y		The position of the layer on the display
+ * @param[in] width		The width of the layer
+ * @param[in] height	The height of the layer
+ * @param[in] z			The z-order of the layer. Higher numbers are on top. Layers with the
+ * 						same z-order are stacked in creation order.
+ *
+ * @return 	The GDisplay to draw on for this layer or 0 if the layer couldn't be created.
+ *
+ * @note	The layer is initially visible, fully opaque and has no color key.
+ * @note	The layer is a pixmap so the same RAM considerations apply as for @p gdispPixmapCreate()
+ * @note	Drawing to the layer does not update the display until @p gdispGFlush() is called on the
+ * 			layer or @p gdispGLayerCompose() is called on the display. If GDISP_NEED_AUTOFLUSH or
+ * 			GDISP_NEED_TIMERFLUSH are set this happens automatically.
+ *
+ * @api
+ */
+GDisplay *gdispGLayerCreate(GDisplay *g, gCoord x, gCoord y, gCoord width, gCoord height, int z);
+#define gdispLayerCreate(x,y,w,h,z)		gdispGLayerCreate(GDISP,x,y,w,h,z)
+
+/**
+ * @brief	Delete a layer
+ *
+ * @param[in] layer		The layer to delete
+ *
+ * @note	The area the layer covered is recomposited on the next flush. When the last layer
+ * 			of a display is deleted the background is put back straight away.
+ * @note	This is the same as calling @p gdispPixmapDelete() on the layer.
+ *
+ * @api
+ */
+#define gdispLayerDelete(layer)			gdispPixmapDelete(layer)
+
+/**
+ * @brief	Move a layer to a new position on its display
+ *
+ * @param[in] layer		The layer
+ * @param[in] x, y		The new position of the layer on the display
+ *
+ * @api
+ */
+void gdispLayerMove(GDisplay *layer, gCoord x, gCoord y);
+
+/**
+ * @brief	Change the z-order of a layer
+ *
+ * @param[in] layer		The layer
+ * @param[in] z			The new z-order. Higher numbers are on top.
+ *
+ * @api
+ */
+void gdispLayerSetZOrder(GDisplay *layer, int z);
+
+/**
+ * @brief	Set the global alpha of a layer
+ *
+ * @param[in] layer		The layer
+ * @param[in] alpha		The alpha value. 255 is fully opaque and 0 is fully transparent.
+ *
+ * @api
+ */
+void gdispLayerSetAlpha(GDisplay *layer, gU8 alpha);
+
+/**
+ * @brief	Set the transparent color key of a layer
+ *
+ * @param[in] layer		The layer
+ * @param[in] enable	gTrue to enable the color key, gFalse to disable it
+ * @param[in] key		Pixels in the layer of this color are not drawn onto the display
+ *
+ * @api
+ */
+void gdispLayerSetColorKey(GDisplay *layer, gBool enable, gColor key);
+
+/**
+ * @brief	Show or hide a layer
+ *
+ * @param[in] layer		The layer
+ * @param[in] visible	gTrue to show the layer, gFalse to hide it
+ *
+ * @api
+ */
+void gdispLayerSetVisible(GDisplay *layer, gBool visible);
+
+/**
+ * @brief	Set the color shown on a display where no layer covers it
+ *
+ * @param[in] g			The display
+ * @param[in] color		The background color
+ *
+ * @note	This has no effect if no layer has been created on the display.
+ *
+ * @api
+ */
+void gdispGLayerSetBackground(GDisplay *g, gColor color);
+#define gdispLayerSetBackground(c)		gdispGLayerSetBackground(GDISP,c)
+
+/**
+ * @brief	Composite all changed layer areas onto a display
+ *
+ * @param[in] g			The display
+ *
+ * @note	Only areas that have been drawn to, or uncovered by moving, hiding or deleting
+ * 			a layer, are recomposited. The display is then flushed.
+ *
+ * @api
+ */
+void gdispGLayerCompose(GDisplay *g);
+#define gdispLayerCompose()				gdispGLayerCompose(GDISP)
+
+/* Internal routines used by the pixmap driver */
+struct gdispLayer;
+void _gdispPixmapSetLayer(GDisplay *g, struct gdispLayer *layer);			// @notapi
+struct gdispLayer *_gdispPixmapGetLayer(GDisplay *g);						// @notapi
+void _gdispLayerDamage(struct gdispLayer *l, gCoord x, gCoord y, gCoord cx, gCoord cy);	// @notapi
+void _gdispLayerFlush(struct gdispLayer *l);								// @notapi
+GDisplay *_gdispLayerGetDisplay(GDisplay *g);								// @notapi - The display a layer is composed onto
+void _gdispLayerDestroy(struct gdispLayer *l);								// @notapi
+void _gdispLayerStackDestroy(GDisplay *g);									// @notapi - Called when a display with layers is deinitialised
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_LAYERS */
+#endif /* _GDISP_LAYER_H */
+/** @} */
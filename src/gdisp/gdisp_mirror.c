@@ -0,0 +1,309 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "../../gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_MIRROR
+
+// We undef everything because the system may think we are in a single controller situation
+//	but the mirror adds another virtual display
+#undef GDISP_HARDWARE_DEINIT
+#undef GDISP_HARDWARE_FLUSH
+#undef GDISP_HARDWARE_FLUSHSEND
+#undef GDISP_HARDWARE_STREAM_WRITE
+#undef GDISP_HARDWARE_STREAM_READ
+#undef GDISP_HARDWARE_STREAM_POS
+#undef GDISP_HARDWARE_STREAM_BUFFER
+#undef GDISP_HARDWARE_DRAWPIXEL
+#undef GDISP_HARDWARE_CLEARS
+#undef GDISP_HARDWARE_FILLS
+#undef GDISP_HARDWARE_BITFILLS
+#undef GDISP_HARDWARE_SCROLL
+#undef GDISP_HARDWARE_PIXELREAD
+#undef GDISP_HARDWARE_CONTROL
+#undef GDISP_HARDWARE_QUERY
+#undef GDISP_HARDWARE_CLIP
+#define GDISP_HARDWARE_DEINIT			GFXON
+#define GDISP_HARDWARE_FLUSH			GFXON
+#define GDISP_HARDWARE_DRAWPIXEL		GFXON
+#define GDISP_HARDWARE_FILLS			GFXON
+#define GDISP_HARDWARE_BITFILLS			GFXON
+#define GDISP_HARDWARE_PIXELREAD		GFXON
+#define GDISP_HARDWARE_CONTROL			GFXON
+#define IN_MIRROR_DRIVER				GFXON
+#define GDISP_DRIVER_VMT				GDISPVMT_mirror
+#define GDISP_DRIVER_VMT_FLAGS			(GDISP_VFLG_DYNAMICONLY)
+
+#include "gdisp_driver.h"
+#include "../gdriver/gdriver.h"
+
+typedef struct mirrorMember {
+	GDisplay		*display;
+	gTicks			period;			// The minimum time between updates
+	gTicks			last;			// When it was last updated
+	gCoord			x0, y0, x1, y1;	// The area waiting to be sent to it. x1 and y1 are exclusive.
+	} mirrorMember;
+
+typedef struct mirror {
+	GDisplay		*shared;		// The pixmap everything is drawn into (or 0 to draw on each member)
+	gCoord			width, height;
+	gCoord			x0, y0, x1, y1;	// The area drawn since the last flush. x1 and y1 are exclusive.
+	unsigned		count;
+	mirrorMember	members[1];		// We really want members[0] but some compilers don't allow that even though it is C standard.
+	} mirror;
+
+#define MIRROR(g)			((mirror *)(g)->priv)
+
+#if GDISP_NEED_MULTITHREAD
+	#define MIRROR_ENTER(g)	gfxMutexEnter(&(g)->mutex)
+	#define MIRROR_EXIT(g)	gfxMutexExit(&(g)->mutex)
+#else
+	#define MIRROR_ENTER(g)
+	#define MIRROR_EXIT(g)
+#endif
+
+GDisplay *gdispMirrorCreate(unsigned count, GDisplay **members) {
+	GDisplay	*g;
+	mirror		*m;
+	unsigned	i;
+
+	if (!count)
+		return 0;
+	if (!(m = gfxAlloc(sizeof(mirror) + (count-1)*sizeof(mirrorMember))))
+		return 0;
+
+	// The mirror is the size of the smallest member
+	m->width = gdispGGetWidth(members[0]);
+	m->height = gdispGGetHeight(members[0]);
+	m->count = count;
+	for(i = 0; i < count; i++) {
+		if (gdispGGetWidth(members[i]) < m->width)
+			m->width = gdispGGetWidth(members[i]);
+		if (gdispGGetHeight(members[i]) < m->height)
+			m->height = gdispGGetHeight(members[i]);
+		m->members[i].display = members[i];
+		m->members[i].period = 0;
+		m->members[i].last = 0;
+		m->members[i].x0 = m->members[i].y0 = m->members[i].x1 = m->members[i].y1 = 0;
+	}
+	m->x0 = m->y0 = m->x1 = m->y1 = 0;
+
+	// Draw once into a pixmap if we can. If there isn't the RAM we draw on each member instead.
+	#if GDISP_NEED_PIXMAP
+		m->shared = gdispPixmapCreate(m->width, m->height);
+	#else
+		m->shared = 0;
+	#endif
+
+	// Register the driver
+	g = (GDisplay *)gdriverRegister(&GDISPVMT_mirror->d, m);
+	if (!g) {
+		#if GDISP_NEED_PIXMAP
+			if (m->shared)
+				gdispPixmapDelete(m->shared);
+		#endif
+		gfxFree(m);
+	}
+	return g;
+}
+
+void gdispMirrorDelete(GDisplay *g) {
+	if (gvmt(g) != GDISPVMT_mirror)
+		return;
+	gdriverUnRegister(&g->d);
+}
+
+void gdispMirrorSetRate(GDisplay *g, GDisplay *member, gDelay period) {
+	mirrorMember	*mm;
+	unsigned		i;
+
+	if (gvmt(g) != GDISPVMT_mirror)
+		return;
+	MIRROR_ENTER(g);
+	for(mm = MIRROR(g)->members, i = 0; i < MIRROR(g)->count; i++, mm++) {
+		if (mm->display == member) {
+			mm->period = gfxMillisecondsToTicks(period);
+			mm->last = gfxSystemTicks() - mm->period;		// The next update is due now
+			break;
+		}
+	}
+	MIRROR_EXIT(g);
+}
+
+/*===========================================================================*/
+/* Driver local routines.                                                    */
+/*===========================================================================*/
+
+// Add an area to the area drawn since the last flush
+static void mirror_damage(mirror *m, gCoord x, gCoord y, gCoord cx, gCoord cy) {
+	if (m->x0 >= m->x1) {
+		m->x0 = x;
+		m->y0 = y;
+		m->x1 = x + cx;
+		m->y1 = y + cy;
+		return;
+	}
+	if (x < m->x0) m->x0 = x;
+	if (y < m->y0) m->y0 = y;
+	if (x + cx > m->x1) m->x1 = x + cx;
+	if (y + cy > m->y1) m->y1 = y + cy;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
+	// The user api function should have already allocated and initialised the mirror
+	//	structure and put it into the priv member during driver initialisation.
+	if (!g->priv)
+		return gFalse;
+
+	// Initialize the GDISP structure
+	g->g.Width = MIRROR(g)->width;
+	g->g.Height = MIRROR(g)->height;
+	g->g.Backlight = 100;
+	g->g.Contrast = 50;
+	g->g.Orientation = gOrientation0;
+	g->g.Powermode = gPowerOn;
+	g->board = 0;
+	return gTrue;
+}
+
+LLDSPEC	void gdisp_lld_deinit(GDisplay *g) {
+	#if GDISP_NEED_PIXMAP
+		if (MIRROR(g)->shared)
+			gdispPixmapDelete(MIRROR(g)->shared);
+	#endif
+	gfxFree(g->priv);
+}
+
+LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+	mirror			*m;
+	mirrorMember	*mm;
+	gTicks			now;
+	unsigned		i;
+	gBool			waiting;
+
+	m = MIRROR(g);
+	now = gfxSystemTicks();
+	waiting = gFalse;
+	for(mm = m->members, i = 0; i < m->count; i++, mm++) {
+		// Add what has been drawn to what this member is waiting for
+		if (m->x0 < m->x1) {
+			if (mm->x0 >= mm->x1) {
+				mm->x0 = m->x0; mm->y0 = m->y0; mm->x1 = m->x1; mm->y1 = m->y1;
+			} else {
+				if (m->x0 < mm->x0) mm->x0 = m->x0;
+				if (m->y0 < mm->y0) mm->y0 = m->y0;
+				if (m->x1 > mm->x1) mm->x1 = m->x1;
+				if (m->y1 > mm->y1) mm->y1 = m->y1;
+			}
+		}
+		if (mm->x0 >= mm->x1)
+			continue;
+
+		// Leave it for a later flush if it was updated too recently
+		if (mm->period && now - mm->last < mm->period) {
+			waiting = gTrue;
+			continue;
+		}
+
+		// Copy the changed area from the pixmap. Without one the drawing is already there.
+		#if GDISP_NEED_PIXMAP
+			if (m->shared)
+				gdispGBlitArea(mm->display, mm->x0, mm->y0, mm->x1 - mm->x0, mm->y1 - mm->y0, mm->x0, mm->y0, m->width, gdispPixmapGetBits(m->shared));
+		#endif
+		gdispGFlush(mm->display);
+		mm->last = now;
+		mm->x0 = mm->x1 = 0;
+	}
+	m->x0 = m->x1 = 0;
+
+	// Make sure the frame clock comes back for the members that are waiting
+	#if GDISP_NEED_FRAMECLOCK
+		if (waiting)
+			g->flags |= GDISP_FLG_FRAMEDIRTY;
+	#else
+		(void) waiting;
+	#endif
+}
+
+LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
+	unsigned	i;
+
+	mirror_damage(MIRROR(g), g->p.x, g->p.y, 1, 1);
+	if (MIRROR(g)->shared) {
+		gdispGDrawPixel(MIRROR(g)->shared, g->p.x, g->p.y, g->p.color);
+		return;
+	}
+	for(i = 0; i < MIRROR(g)->count; i++)
+		gdispGDrawPixel(MIRROR(g)->members[i].display, g->p.x, g->p.y, g->p.color);
+}
+
+LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
+	unsigned	i;
+
+	mirror_damage(MIRROR(g), g->p.x, g->p.y, g->p.cx, g->p.cy);
+	if (MIRROR(g)->shared) {
+		gdispGFillArea(MIRROR(g)->shared, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.color);
+		return;
+	}
+	for(i = 0; i < MIRROR(g)->count; i++)
+		gdispGFillArea(MIRROR(g)->members[i].display, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.color);
+}
+
+LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+	unsigned	i;
+
+	mirror_damage(MIRROR(g), g->p.x, g->p.y, g->p.cx, g->p.cy);
+	if (MIRROR(g)->shared) {
+		gdispGBlitArea(MIRROR(g)->shared, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.x1, g->p.y1, g->p.x2, (const gPixel *)g->p.ptr);
+		return;
+	}
+	for(i = 0; i < MIRROR(g)->count; i++)
+		gdispGBlitArea(MIRROR(g)->members[i].display, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.x1, g->p.y1, g->p.x2, (const gPixel *)g->p.ptr);
+}
+
+LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
+	#if GDISP_NEED_PIXMAP
+		if (MIRROR(g)->shared)
+			return gdispPixmapGetBits(MIRROR(g)->shared)[g->p.y * MIRROR(g)->width + g->p.x];
+	#endif
+
+	// Every member shows the same picture so read the first one
+	#if GDISP_NEED_PIXELREAD
+		return gdispGGetPixelColor(MIRROR(g)->members[0].display, g->p.x, g->p.y);
+	#else
+		return GFX_BLACK;
+	#endif
+}
+
+#if GDISP_NEED_CONTROL
+	LLDSPEC void gdisp_lld_control(GDisplay *g) {
+		unsigned	i;
+
+		switch(g->p.x) {
+		case GDISP_CONTROL_POWER:
+			g->g.Powermode = (gPowermode)(gPtrDiff)g->p.ptr;
+			break;
+		case GDISP_CONTROL_BACKLIGHT:
+			g->g.Backlight = (gU8)(gPtrDiff)g->p.ptr;
+			break;
+		case GDISP_CONTROL_CONTRAST:
+			g->g.Contrast = (gU8)(gPtrDiff)g->p.ptr;
+			break;
+		default:
+			// The mirror stays in its created orientation
+			return;
+		}
+		for(i = 0; i < MIRROR(g)->count; i++)
+			gdispGControl(MIRROR(g)->members[i].display, g->p.x, g->p.ptr);
+	}
+#endif
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_MIRROR */
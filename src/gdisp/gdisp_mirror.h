@@ -0,0 +1,84 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_mirror.h
+ *
+ * @defgroup Mirror Mirror
+ * @ingroup GDISP
+ *
+ * @brief   Sub-Module for drawing the same picture on several displays at once.
+ *
+ * @note	A mirror is a virtual display with a group of member displays (for example a local LCD
+ * 			and a uGFXnet or SDL display). Everything drawn on the mirror appears on every member.
+ * @note	When GDISP_NEED_PIXMAP is GFXON the mirror draws once into its own pixmap and records the
+ * 			area that has changed. When the mirror is flushed that area is copied to each member and
+ * 			the member is flushed. Each member can be given its own update rate.
+ * @note	Otherwise (or if there is not enough RAM for the pixmap) each drawing operation is repeated
+ * 			on every member as it happens and only the flushing of each member follows its rate.
+ * @note	The mirror stays in its created orientation (gOrientation0). Each member may be in any orientation.
+ * 			Power, backlight and contrast changes are passed on to every member.
+ * @pre		GDISP_NEED_MIRROR must be GFXON in your gfxconf.h
+ * @{
+ */
+
+#ifndef _GDISP_MIRROR_H
+#define _GDISP_MIRROR_H
+
+#if (GFX_USE_GDISP && GDISP_NEED_MIRROR) || defined(__DOXYGEN__)
+
+/**
+ * @brief	Create a mirror display for a group of displays
+ *
+ * @param[in] count		The number of member displays
+ * @param[in] members	The member displays
+ *
+ * @return 	The GDisplay to draw on or 0 if the mirror couldn't be created.
+ *
+ * @note	The mirror is the size of the smallest member. Drawing appears at the same position
+ * 			on every member.
+ * @note	The members are cleared when the mirror is created. Nothing else should draw on a member
+ * 			while it belongs to a mirror.
+ * @note	A pixmap mirror updates the members only when it is flushed. Use @p gdispGFlush(), or
+ * 			GDISP_NEED_AUTOFLUSH, GDISP_NEED_TIMERFLUSH or GDISP_NEED_FRAMECLOCK.
+ *
+ * @api
+ */
+GDisplay *gdispMirrorCreate(unsigned count, GDisplay **members);
+
+/**
+ * @brief	Delete a mirror display
+ *
+ * @param[in] g			The mirror
+ *
+ * @note	The member displays are not affected.
+ * @note	If a display that isn't a mirror is passed to this routine, it will be ignored.
+ *
+ * @api
+ */
+void gdispMirrorDelete(GDisplay *g);
+
+/**
+ * @brief	Limit how often a member display is updated
+ *
+ * @param[in] g			The mirror
+ * @param[in] member	The member display
+ * @param[in] period	The minimum time between updates of the member in milliseconds. 0 updates the
+ * 						member on every flush of the mirror (the default).
+ *
+ * @note	A flush of the mirror that comes too soon after the last update of a member leaves the
+ * 			changes for that member until a later flush. With GDISP_NEED_FRAMECLOCK the mirror's
+ * 			frame clock is kept running until every member has caught up.
+ * @note	Use this to keep a slow member (eg. a network display) from holding up a fast one.
+ *
+ * @api
+ */
+void gdispMirrorSetRate(GDisplay *g, GDisplay *member, gDelay period);
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_MIRROR */
+#endif /* _GDISP_MIRROR_H */
+/** @} */
@@ -21,6 +21,11 @@
 #include "gdisp.c"
 #include "gdisp_fonts.c"
 #include "gdisp_pixmap.c"
+#include "gdisp_layer.c"
+#include "gdisp_mirror.c"
+#include "gdisp_sprite.c"
+#include "gdisp_trace.c"
+#include "gdisp_accel.c"
 #include "gdisp_image.c"
 #include "gdisp_image_native.c"
 #include "gdisp_image_gif.c"
@@ -47,6 +47,28 @@
 	#ifndef GDISP_NEED_TIMERFLUSH
 		#define GDISP_NEED_TIMERFLUSH			GFXOFF
 	#endif
+	/**
+	 * @brief   Should each display be flushed at the boundaries of a frame clock.
+	 * @details	Defaults to GFXOFF
+	 * @note	Each display has a clock running at a target frame rate (see @p gdispGSetFrameRate()).
+	 * 			At each tick the display is flushed if anything has been drawn since the last flush.
+	 * 			When a flush takes longer than a frame the ticks that were missed are skipped.
+	 * @note	Applications can pace their drawing to the clock with @p gdispGFrameWait() and
+	 * 			read the frame times with @p gdispGGetFrameStats().
+	 * @note	If GFXON this takes precedence over GDISP_NEED_AUTOFLUSH and GDISP_NEED_TIMERFLUSH.
+	 */
+	#ifndef GDISP_NEED_FRAMECLOCK
+		#define GDISP_NEED_FRAMECLOCK			GFXOFF
+	#endif
+	/**
+	 * @brief   Can a display be flushed without waiting for the flush to finish.
+	 * @details	Defaults to GFXOFF
+	 * @note	See @p gdispGFlushAsync(). The flushes are done by a GDISP thread.
+	 * @note	This also turns on GDISP_NEED_MULTITHREAD.
+	 */
+	#ifndef GDISP_NEED_ASYNCFLUSH
+		#define GDISP_NEED_ASYNCFLUSH			GFXOFF
+	#endif
 	/**
 	 * @brief   Should all operations be clipped to the screen and colors validated.
 	 * @details	Defaults to GFXON.
@@ -192,6 +214,72 @@
 	#ifndef GDISP_NEED_PIXMAP
 		#define GDISP_NEED_PIXMAP				GFXOFF
 	#endif
+	/**
+	 * @brief   Should per display performance statistics be kept.
+	 * @details	Defaults to GFXOFF
+	 * @note	This counts the calls and pixels for each drawing primitive, the low level driver
+	 * 			calls by type and the time spent in the driver and waiting for the display lock.
+	 * 			See @p gdispGGetStatistics().
+	 * @note	When GFXOFF there is no code or RAM overhead at all.
+	 */
+	#ifndef GDISP_NEED_STATISTICS
+		#define GDISP_NEED_STATISTICS			GFXOFF
+	#endif
+	/**
+	 * @brief   Should the fastest way of drawing lines, fills and blits be measured for each display.
+	 * @details	Defaults to GFXOFF
+	 * @note	A driver can often draw the same thing in more than one way (an area fill, a
+	 * 			streamed write, single pixels or a bitmap blit). Which is fastest depends on the
+	 * 			controller and the bus. When GFXON each way the driver has is timed for a few sizes
+	 * 			and drawing then uses the fastest. See @p gdispGCalibratePaths().
+	 * @note	The measurements can be saved and reloaded with @p gdispGGetPathCal() and @p gdispGSetPathCal().
+	 */
+	#ifndef GDISP_NEED_PATHCAL
+		#define GDISP_NEED_PATHCAL				GFXOFF
+	#endif
+	/**
+	 * @brief   Can the low level driver calls for a display be recorded to a file.
+	 * @details	Defaults to GFXOFF
+	 * @note	See @p gdispGTraceStart(). The trace can be replayed with demos/tools/gdispTraceReplay.
+	 * @note	This also turns on GFX_USE_GFILE.
+	 */
+	#ifndef GDISP_NEED_TRACE
+		#define GDISP_NEED_TRACE				GFXOFF
+	#endif
+	/**
+	 * @brief   Are sprites (save-under overlays such as mouse cursors) required.
+	 * @details	Defaults to GFXOFF
+	 * @note	This also turns on GDISP_NEED_PIXELREAD.
+	 */
+	#ifndef GDISP_NEED_SPRITES
+		#define GDISP_NEED_SPRITES				GFXOFF
+	#endif
+	/**
+	 * @brief   Are software display layers required.
+	 * @details	Defaults to GFXOFF
+	 * @note	Each layer is a pixmap so this also turns on GDISP_NEED_PIXMAP.
+	 */
+	#ifndef GDISP_NEED_LAYERS
+		#define GDISP_NEED_LAYERS				GFXOFF
+	#endif
+	/**
+	 * @brief   Are mirror displays (one display drawn on several) required.
+	 * @details	Defaults to GFXOFF
+	 * @note	When GDISP_NEED_PIXMAP is also GFXON the drawing is done once into a pixmap and
+	 * 			copied to each member display. Otherwise each drawing operation is repeated on
+	 * 			every member. See @p gdispMirrorCreate().
+	 */
+	#ifndef GDISP_NEED_MIRROR
+		#define GDISP_NEED_MIRROR				GFXOFF
+	#endif
+	/**
+	 * @brief   Can fills, copies and blends of memory surfaces be handed to a 2D accelerator.
+	 * @details	Defaults to GFXOFF
+	 * @note	See @p gdispAccelSoftwareCreate() and @p gdispGSetAccel().
+	 */
+	#ifndef GDISP_NEED_ACCEL
+		#define GDISP_NEED_ACCEL				GFXOFF
+	#endif
 /**
  * @}
  *
@@ -622,6 +710,202 @@
 	#ifndef GDISP_NEED_PIXMAP_IMAGE
 		#define GDISP_NEED_PIXMAP_IMAGE			GFXOFF
 	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Statistics Options
+ * @pre		GDISP_NEED_STATISTICS must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The clock used to time low level driver calls and waits for the display lock.
+	 * @details	Defaults to gfxSystemTicks()
+	 * @note	System ticks are usually too coarse to time individual driver calls. Define this
+	 * 			to a higher resolution counter (eg. a CPU cycle counter) if one is available.
+	 * 			It must return a value that can be stored in a gU32 and wraps around cleanly.
+	 */
+	#ifndef GDISP_STATISTICS_CLOCK
+		#define GDISP_STATISTICS_CLOCK()		((gU32)gfxSystemTicks())
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Path Calibration Options
+ * @pre		GDISP_NEED_PATHCAL must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   Should each display be calibrated when it is initialised.
+	 * @details	Defaults to GFXON
+	 * @note	Only displays created by gfxInit() are calibrated. Pixmaps and other dynamically
+	 * 			created displays keep the default order unless @p gdispGCalibratePaths() is called.
+	 * @note	Turn this off to load saved measurements with @p gdispGSetPathCal() instead.
+	 */
+	#ifndef GDISP_PATHCAL_STARTUP
+		#define GDISP_PATHCAL_STARTUP			GFXON
+	#endif
+	/**
+	 * @brief   The shortest time each measurement runs for (in milliseconds).
+	 * @details	Defaults to 4
+	 * @note	Calibrating a display takes up to 9 measurements for each way of drawing the driver has,
+	 * 			and each one can take up to twice this long.
+	 */
+	#ifndef GDISP_PATHCAL_TIME
+		#define GDISP_PATHCAL_TIME				4
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Trace Options
+ * @pre		GDISP_NEED_TRACE must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The bytes of trace records collected for a display before they are written to the file.
+	 * @details	Defaults to 512
+	 * @note	This much RAM is allocated for each display being traced. It must be at least 16.
+	 */
+	#ifndef GDISP_TRACE_BUFSIZE
+		#define GDISP_TRACE_BUFSIZE				512
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Layer Options
+ * @pre		GDISP_NEED_LAYERS must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The maximum number of separate damaged rectangles remembered for each layered display.
+	 * @details	Defaults to 8
+	 * @note	When more areas are damaged they are merged into the rectangle that grows the least.
+	 */
+	#ifndef GDISP_LAYER_DAMAGE_RECTS
+		#define GDISP_LAYER_DAMAGE_RECTS		8
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Frame Clock Options
+ * @pre		GDISP_NEED_FRAMECLOCK must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The frame rate each display starts with (frames per second).
+	 * @details	Defaults to 30
+	 * @note	Set to 0 to start with the frame clocks stopped.
+	 */
+	#ifndef GDISP_FRAMECLOCK_RATE
+		#define GDISP_FRAMECLOCK_RATE			30
+	#endif
+	/**
+	 * @brief   The number of buckets in the frame time histogram.
+	 * @details	Defaults to 8
+	 * @note	Each bucket covers a quarter of the frame period. The last bucket also counts
+	 * 			every frame that took longer.
+	 */
+	#ifndef GDISP_FRAMECLOCK_BUCKETS
+		#define GDISP_FRAMECLOCK_BUCKETS		8
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Asynchronous Flush Options
+ * @pre		GDISP_NEED_ASYNCFLUSH must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The stack size of the GDISP flush thread.
+	 * @details	Defaults to 1024
+	 * @note	Flush callbacks are run on this thread.
+	 */
+	#ifndef GDISP_ASYNCFLUSH_THREAD_STACKSIZE
+		#define GDISP_ASYNCFLUSH_THREAD_STACKSIZE	1024
+	#endif
+	/**
+	 * @brief   The priority of the GDISP flush thread.
+	 * @details	Defaults to gThreadpriorityNormal
+	 */
+	#ifndef GDISP_ASYNCFLUSH_THREAD_PRIORITY
+		#define GDISP_ASYNCFLUSH_THREAD_PRIORITY	gThreadpriorityNormal
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP Accelerator Options
+ * @pre		GDISP_NEED_ACCEL must be GFXON
+ * @{
+ */
+	/**
+	 * @brief   The smallest fill or blit (in pixels) a display hands to its accelerator.
+	 * @details	Defaults to 256
+	 * @note	Smaller areas are quicker to do on the CPU than to queue.
+	 */
+	#ifndef GDISP_ACCEL_MINAREA
+		#define GDISP_ACCEL_MINAREA				256
+	#endif
+	/**
+	 * @brief   The number of jobs the software accelerator can have waiting.
+	 * @details	Defaults to 8
+	 */
+	#ifndef GDISP_ACCEL_QUEUE
+		#define GDISP_ACCEL_QUEUE				8
+	#endif
+	/**
+	 * @brief   The stack size of the software accelerator thread.
+	 * @details	Defaults to 1024
+	 */
+	#ifndef GDISP_ACCEL_THREAD_STACKSIZE
+		#define GDISP_ACCEL_THREAD_STACKSIZE	1024
+	#endif
+	/**
+	 * @brief   The priority of the software accelerator thread.
+	 * @details	Defaults to gThreadpriorityLow
+	 * @note	A low priority lets the thread that submits the jobs keep working while they run.
+	 */
+	#ifndef GDISP_ACCEL_THREAD_PRIORITY
+		#define GDISP_ACCEL_THREAD_PRIORITY		gThreadpriorityLow
+	#endif
+/**
+ * @}
+ *
+ * @name	GDISP E-Paper Options
+ * @note	These are used by the drivers of e-paper controllers that schedule their refreshes
+ * 			(see src/gdisp/gdisp_epaper.h).
+ * @{
+ */
+	/**
+	 * @brief   The maximum number of separate windows refreshed together on an e-paper display.
+	 * @details	Defaults to 4
+	 * @note	When more areas are changed they are merged into the window that grows the least.
+	 */
+	#ifndef GDISP_EPAPER_WINDOWS
+		#define GDISP_EPAPER_WINDOWS			4
+	#endif
+	/**
+	 * @brief   How much partial refreshing is allowed before an e-paper display gets a full refresh.
+	 * @details	Defaults to 300
+	 * @note	This is a percentage of the screen area. 300 means the equivalent of three whole screens
+	 * 			can be refreshed with the partial waveform before the ghosting is cleared.
+	 */
+	#ifndef GDISP_EPAPER_GHOSTBUDGET
+		#define GDISP_EPAPER_GHOSTBUDGET		300
+	#endif
+	/**
+	 * @brief   How many partial refreshes an e-paper display gets before a full refresh.
+	 * @details	Defaults to 20
+	 * @note	This stops small areas that change often (eg. a clock) building up ghosting.
+	 */
+	#ifndef GDISP_EPAPER_MAXPARTIALS
+		#define GDISP_EPAPER_MAXPARTIALS		20
+	#endif
+	/**
+	 * @brief   The percentage of an e-paper screen that must have changed to use a full refresh anyway.
+	 * @details	Defaults to 60
+	 */
+	#ifndef GDISP_EPAPER_FULLAREA
+		#define GDISP_EPAPER_FULLAREA			60
+	#endif
 /**
  * @}
  *
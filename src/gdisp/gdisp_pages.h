@@ -0,0 +1,116 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_pages.h
+ *
+ * @defgroup Pages Pages
+ * @ingroup GDISP
+ *
+ * @brief   Helpers for the drivers of paged monochrome controllers.
+ *
+ * @note	Controllers such as the SSD1306 or ST7565 store 8 vertical pixels in each byte and the display is
+ * 			a set of pages each 8 pixels high. The drivers keep a copy of the display in RAM and send it on a
+ * 			flush. These helpers record the range of columns that has changed in each page so that a flush
+ * 			only needs to send those bytes.
+ * @note	These routines are for use only by low level drivers. Include this file after gdisp_driver.h.
+ *
+ * @{
+ */
+
+#ifndef _GDISP_PAGES_H
+#define _GDISP_PAGES_H
+
+#if GFX_USE_GDISP || defined(__DOXYGEN__)
+
+/**
+ * @brief	The columns of a page that have changed since the page was last sent.
+ * @note	The page is unchanged when start >= end.
+ */
+typedef struct gdispPageDirty {
+	gCoord	start;				/**< The first changed column */
+	gCoord	end;				/**< One past the last changed column */
+} gdispPageDirty;
+
+/**
+ * @brief	Mark all pages as unchanged
+ *
+ * @param[in] d			The array of page ranges
+ * @param[in] pages		The number of pages
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispPagesClean(gdispPageDirty *d, unsigned pages) {
+	for(; pages; pages--, d++)
+		d->start = d->end = 0;
+}
+
+/**
+ * @brief	Mark an area of the display as changed
+ *
+ * @param[in] d			The array of page ranges
+ * @param[in] sx, ex	The first and last columns changed (inclusive)
+ * @param[in] sy, ey	The first and last pixel rows changed (inclusive)
+ *
+ * @note	The coordinates are controller coordinates ie. after any rotation has been applied.
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispPagesMark(gdispPageDirty *d, gCoord sx, gCoord ex, gCoord sy, gCoord ey) {
+	gCoord	p;
+
+	for(p = sy >> 3, d += p; p <= (ey >> 3); p++, d++) {
+		if (d->start >= d->end) {
+			d->start = sx;
+			d->end = ex + 1;
+		} else {
+			if (sx < d->start)
+				d->start = sx;
+			if (ex >= d->end)
+				d->end = ex + 1;
+		}
+	}
+}
+
+/**
+ * @brief	Mark a single pixel of the display as changed
+ *
+ * @param[in] d			The array of page ranges
+ * @param[in] x, y		The pixel in controller coordinates
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispPagesMarkPixel(gdispPageDirty *d, gCoord x, gCoord y) {
+	d += y >> 3;
+	if (d->start >= d->end) {
+		d->start = x;
+		d->end = x + 1;
+	} else if (x < d->start)
+		d->start = x;
+	else if (x >= d->end)
+		d->end = x + 1;
+}
+
+/**
+ * @brief	Mark every page of the display as completely changed
+ *
+ * @param[in] d			The array of page ranges
+ * @param[in] pages		The number of pages
+ * @param[in] width		The number of columns in each page
+ *
+ * @notapi
+ */
+static GFXINLINE void gdispPagesMarkAll(gdispPageDirty *d, unsigned pages, gCoord width) {
+	for(; pages; pages--, d++) {
+		d->start = 0;
+		d->end = width;
+	}
+}
+
+#endif /* GFX_USE_GDISP */
+#endif /* _GDISP_PAGES_H */
+/** @} */
@@ -13,9 +13,11 @@
 //	but the pixmap supports adds another virtual display
 #undef GDISP_HARDWARE_DEINIT
 #undef GDISP_HARDWARE_FLUSH
+#undef GDISP_HARDWARE_FLUSHSEND
 #undef GDISP_HARDWARE_STREAM_WRITE
 #undef GDISP_HARDWARE_STREAM_READ
 #undef GDISP_HARDWARE_STREAM_POS
+#undef GDISP_HARDWARE_STREAM_BUFFER
 #undef GDISP_HARDWARE_DRAWPIXEL
 #undef GDISP_HARDWARE_CLEARS
 #undef GDISP_HARDWARE_FILLS
@@ -27,8 +29,13 @@
 #undef GDISP_HARDWARE_CLIP
 #define GDISP_HARDWARE_DEINIT			GFXON
 #define GDISP_HARDWARE_DRAWPIXEL		GFXON
+#define GDISP_HARDWARE_FILLS			GFXON
+#define GDISP_HARDWARE_BITFILLS			GFXON
 #define GDISP_HARDWARE_PIXELREAD		GFXON
 #define GDISP_HARDWARE_CONTROL			GFXON
+#if GDISP_NEED_LAYERS
+	#define GDISP_HARDWARE_FLUSH		GFXON
+#endif
 #define IN_PIXMAP_DRIVER				GFXON
 #define GDISP_DRIVER_VMT				GDISPVMT_pixmap
 #define GDISP_DRIVER_VMT_FLAGS			(GDISP_VFLG_DYNAMICONLY|GDISP_VFLG_PIXMAP)
@@ -42,7 +49,12 @@
 #include "gdisp_driver.h"
 #include "../gdriver/gdriver.h"
 
+#include <string.h>			// for memcpy()
+
 typedef struct pixmap {
+	#if GDISP_NEED_LAYERS
+		struct gdispLayer	*layer;			// The layer this pixmap belongs to (if any)
+	#endif
 	#if GDISP_NEED_PIXMAP_IMAGE
 		gU8		imghdr[8];			// This field must come just before the data member.
 	#endif
@@ -75,6 +87,10 @@ GDisplay *gdispPixmapCreate(gCoord width, gCoord height) {
 		p->imghdr[7] = (gU8)(GDISP_PIXELFORMAT);
 	#endif
 
+	#if GDISP_NEED_LAYERS
+		p->layer = 0;
+	#endif
+
 	// Save the width and height so the driver can retrieve it.
 	((gCoord *)p->pixels)[0] = width;
 	((gCoord *)p->pixels)[1] = height;
@@ -95,6 +111,10 @@ void gdispPixmapDelete(GDisplay *g) {
 gPixel	*gdispPixmapGetBits(GDisplay *g) {
 	if (gvmt(g) != GDISPVMT_pixmap)
 		return 0;
+	#if GDISP_NEED_ACCEL
+		// The caller is about to use the bits directly
+		gdispGAccelSync(g);
+	#endif
 	return ((pixmap *)g->priv)->pixels;
 }
 
@@ -102,10 +122,61 @@ gPixel	*gdispPixmapGetBits(GDisplay *g) {
 	void *gdispPixmapGetMemoryImage(GDisplay *g) {
 		if (gvmt(g) != GDISPVMT_pixmap)
 			return 0;
+		#if GDISP_NEED_ACCEL
+			gdispGAccelSync(g);
+		#endif
 		return ((pixmap *)g->priv)->imghdr;
 	}
 #endif
 
+#if GDISP_NEED_LAYERS
+	void _gdispPixmapSetLayer(GDisplay *g, struct gdispLayer *layer) {
+		if (gvmt(g) != GDISPVMT_pixmap)
+			return;
+		((pixmap *)g->priv)->layer = layer;
+	}
+
+	struct gdispLayer *_gdispPixmapGetLayer(GDisplay *g) {
+		if (gvmt(g) != GDISPVMT_pixmap)
+			return 0;
+		return ((pixmap *)g->priv)->layer;
+	}
+
+	// Tell the layer compositor that an area has changed
+	#define PIXMAP_DAMAGE(g, x, y, cx, cy)	{ if (((pixmap *)(g)->priv)->layer) _gdispLayerDamage(((pixmap *)(g)->priv)->layer, x, y, cx, cy); }
+#else
+	#define PIXMAP_DAMAGE(g, x, y, cx, cy)
+#endif
+
+// With an accelerator the CPU must wait for it before touching the pixels
+#if GDISP_NEED_ACCEL
+	#define PIXMAP_SYNC(g)					gdispGAccelSync(g)
+#else
+	#define PIXMAP_SYNC(g)
+#endif
+
+/*===========================================================================*/
+/* Driver local routines.                                                    */
+/*===========================================================================*/
+
+static GFXINLINE unsigned pixmap_pos(GDisplay *g, gCoord x, gCoord y) {
+	#if GDISP_NEED_CONTROL
+		switch(g->g.Orientation) {
+		case gOrientation0:
+		default:
+			return y * g->g.Width + x;
+		case gOrientation90:
+			return (g->g.Width-x-1) * g->g.Height + y;
+		case gOrientation180:
+			return (g->g.Height-y-1) * g->g.Width + g->g.Width-x-1;
+		case gOrientation270:
+			return x * g->g.Height + g->g.Height-y-1;
+		}
+	#else
+		return y * g->g.Width + x;
+	#endif
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -126,6 +197,15 @@ LLDSPEC gBool gdisp_lld_init(GDisplay *g) {
 	g->g.Powermode = gPowerOn;
 	g->board = 0;
 
+	// Describe the pixels so they can be drawn on by an accelerator
+	#if GDISP_NEED_ACCEL
+		g->surface.pixels = ((pixmap *)g->priv)->pixels;
+		g->surface.width = g->g.Width;
+		g->surface.height = g->g.Height;
+		g->surface.linelen = g->g.Width * sizeof(gColor);
+		g->surface.format = GDISP_PIXELFORMAT;
+	#endif
+
 	return gTrue;
 }
 
@@ -133,56 +213,90 @@ LLDSPEC	void gdisp_lld_deinit(GDisplay *g) {
 	gfxFree(g->priv);
 }
 
+#if GDISP_NEED_LAYERS
+	LLDSPEC void gdisp_lld_flush(GDisplay *g) {
+		PIXMAP_SYNC(g);
+		if (((pixmap *)g->priv)->layer)
+			_gdispLayerFlush(((pixmap *)g->priv)->layer);
+	}
+#endif
+
 LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
-	unsigned	pos;
+	PIXMAP_SYNC(g);
+	((pixmap *)(g)->priv)->pixels[pixmap_pos(g, g->p.x, g->p.y)] = g->p.color;
+	PIXMAP_DAMAGE(g, g->p.x, g->p.y, 1, 1);
+}
+
+LLDSPEC void gdisp_lld_fill_area(GDisplay *g) {
+	gColor		*p;
+	gCoord		x, y;
+
+	// Large fills go to the accelerator and we don't wait for them
+	#if GDISP_NEED_ACCEL
+		if (g->g.Orientation == gOrientation0 && _gdispAccelFill(g, g->p.x, g->p.y, g->p.cx, g->p.cy, g->p.color)) {
+			PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+			return;
+		}
+		PIXMAP_SYNC(g);
+	#endif
 
 	#if GDISP_NEED_CONTROL
-		switch(g->g.Orientation) {
-		case gOrientation0:
-		default:
-			pos = g->p.y * g->g.Width + g->p.x;
-			break;
-		case gOrientation90:
-			pos = (g->g.Width-g->p.x-1) * g->g.Height + g->p.y;
-			break;
-		case gOrientation180:
-			pos = (g->g.Height-g->p.y-1) * g->g.Width + g->g.Width-g->p.x-1;
-			break;
-		case gOrientation270:
-			pos = g->p.x * g->g.Height + g->g.Height-g->p.y-1;
-			break;
+		if (g->g.Orientation != gOrientation0) {
+			for(y = g->p.y; y < g->p.y + g->p.cy; y++) {
+				for(x = g->p.x; x < g->p.x + g->p.cx; x++)
+					((pixmap *)(g)->priv)->pixels[pixmap_pos(g, x, y)] = g->p.color;
+			}
+			PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+			return;
 		}
-	#else
-		pos = g->p.y * g->g.Width + g->p.x;
 	#endif
 
-	((pixmap *)(g)->priv)->pixels[pos] = g->p.color;
+	p = ((pixmap *)(g)->priv)->pixels + g->p.y * g->g.Width + g->p.x;
+	for(y = 0; y < g->p.cy; y++, p += g->g.Width) {
+		for(x = 0; x < g->p.cx; x++)
+			p[x] = g->p.color;
+	}
+	PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
 }
 
-LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
-	unsigned		pos;
+LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
+	const gPixel	*src;
+	gColor			*p;
+	gCoord			y;
+	#if GDISP_NEED_CONTROL
+		gCoord		x;
+	#endif
+
+	#if GDISP_NEED_ACCEL
+		if (g->g.Orientation == gOrientation0 && _gdispAccelBlit(g, g->p.x, g->p.y, g->p.cx, g->p.cy, (const gPixel *)g->p.ptr, g->p.x1, g->p.y1, g->p.x2)) {
+			PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+			return;
+		}
+		PIXMAP_SYNC(g);
+	#endif
+
+	src = (const gPixel *)g->p.ptr + g->p.y1 * g->p.x2 + g->p.x1;
 
 	#if GDISP_NEED_CONTROL
-		switch(g->g.Orientation) {
-		case gOrientation0:
-		default:
-			pos = g->p.y * g->g.Width + g->p.x;
-			break;
-		case gOrientation90:
-			pos = (g->g.Width-g->p.x-1) * g->g.Height + g->p.y;
-			break;
-		case gOrientation180:
-			pos = (g->g.Height-g->p.y-1) * g->g.Width + g->g.Width-g->p.x-1;
-			break;
-		case gOrientation270:
-			pos = g->p.x * g->g.Height + g->g.Height-g->p.y-1;
-			break;
+		if (g->g.Orientation != gOrientation0) {
+			for(y = g->p.y; y < g->p.y + g->p.cy; y++, src += g->p.x2) {
+				for(x = 0; x < g->p.cx; x++)
+					((pixmap *)(g)->priv)->pixels[pixmap_pos(g, g->p.x + x, y)] = src[x];
+			}
+			PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+			return;
 		}
-	#else
-		pos = g->p.y * g->g.Width + g->p.x;
 	#endif
 
-	return ((pixmap *)(g)->priv)->pixels[pos];
+	p = ((pixmap *)(g)->priv)->pixels + g->p.y * g->g.Width + g->p.x;
+	for(y = 0; y < g->p.cy; y++, p += g->g.Width, src += g->p.x2)
+		memcpy(p, src, g->p.cx * sizeof(gPixel));
+	PIXMAP_DAMAGE(g, g->p.x, g->p.y, g->p.cx, g->p.cy);
+}
+
+LLDSPEC	gColor gdisp_lld_get_pixel_color(GDisplay *g) {
+	PIXMAP_SYNC(g);
+	return ((pixmap *)(g)->priv)->pixels[pixmap_pos(g, g->p.x, g->p.y)];
 }
 
 #if GDISP_NEED_CONTROL
@@ -58,6 +58,8 @@ void gdispPixmapDelete(GDisplay *g);
  * 			by the application code. For any one particular pixmap the pointer will not change over the life of the pixmap
  * 			(although different pixmaps will have different pixel pointers). Once a pixmap is deleted, the pixel pointer
  * 			should not be used by the application.
+ * @note	If the pixmap has an accelerator (see @p gdispGSetAccel()) this waits for it to finish first. Call
+ * 			@p gdispGAccelSync() before touching the pixels again after any later drawing.
  */
 gPixel	*gdispPixmapGetBits(GDisplay *g);
 
@@ -36,6 +36,19 @@
 			#error "GDISP Multiple Drivers: You must specify a value for GDISP_PIXELFORMAT when using GDISP_DRIVER_LIST"
 		#endif
 	#endif
+	#if GDISP_NEED_FRAMECLOCK && (GDISP_NEED_AUTOFLUSH || GDISP_NEED_TIMERFLUSH)
+		#if GFX_DISPLAY_RULE_WARNINGS
+			#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+				#warning "GDISP: GDISP_NEED_FRAMECLOCK replaces GDISP_NEED_AUTOFLUSH and GDISP_NEED_TIMERFLUSH. They have been disabled for you."
+			#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+				COMPILER_WARNING("GDISP: GDISP_NEED_FRAMECLOCK replaces GDISP_NEED_AUTOFLUSH and GDISP_NEED_TIMERFLUSH. They have been disabled for you.")
+			#endif
+		#endif
+		#undef GDISP_NEED_AUTOFLUSH
+		#define GDISP_NEED_AUTOFLUSH		GFXOFF
+		#undef GDISP_NEED_TIMERFLUSH
+		#define GDISP_NEED_TIMERFLUSH		GFXOFF
+	#endif
 	#if GDISP_NEED_AUTOFLUSH && GDISP_NEED_TIMERFLUSH
 		#if GFX_DISPLAY_RULE_WARNINGS
 			#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
@@ -65,6 +78,44 @@
 			#define GDISP_NEED_MULTITHREAD		GFXON
 		#endif
 	#endif
+	#if GDISP_NEED_FRAMECLOCK
+		#if GDISP_FRAMECLOCK_BUCKETS < 1
+			#error "GDISP: GDISP_FRAMECLOCK_BUCKETS must be at least 1."
+		#endif
+		#if !GFX_USE_GTIMER
+			#if GFX_DISPLAY_RULE_WARNINGS
+				#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+					#warning "GDISP: GDISP_NEED_FRAMECLOCK has been set but GFX_USE_GTIMER has not been set. It has been turned on for you."
+				#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+					COMPILER_WARNING("GDISP: GDISP_NEED_FRAMECLOCK has been set but GFX_USE_GTIMER has not been set. It has been turned on for you.")
+				#endif
+			#endif
+			#undef GFX_USE_GTIMER
+			#define GFX_USE_GTIMER				GFXON
+		#endif
+		#if !GDISP_NEED_MULTITHREAD
+			#if GFX_DISPLAY_RULE_WARNINGS
+				#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+					#warning "GDISP: GDISP_NEED_MULTITHREAD is required when GDISP_NEED_FRAMECLOCK is GFXON. It has been turned on for you."
+				#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+					COMPILER_WARNING("GDISP: GDISP_NEED_MULTITHREAD is required when GDISP_NEED_FRAMECLOCK is GFXON. It has been turned on for you.")
+				#endif
+			#endif
+			#undef GDISP_NEED_MULTITHREAD
+			#define GDISP_NEED_MULTITHREAD		GFXON
+		#endif
+	#endif
+	#if GDISP_NEED_SPRITES && !GDISP_NEED_PIXELREAD
+		#if GFX_DISPLAY_RULE_WARNINGS
+			#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+				#warning "GDISP: GDISP_NEED_SPRITES has been set but GDISP_NEED_PIXELREAD has not. It has been turned on for you."
+			#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+				COMPILER_WARNING("GDISP: GDISP_NEED_SPRITES has been set but GDISP_NEED_PIXELREAD has not. It has been turned on for you.")
+			#endif
+		#endif
+		#undef GDISP_NEED_PIXELREAD
+		#define GDISP_NEED_PIXELREAD	GFXON
+	#endif
 	#if GDISP_NEED_ANTIALIAS && !GDISP_NEED_PIXELREAD
 		#if GDISP_HARDWARE_PIXELREAD
 			#if GFX_DISPLAY_RULE_WARNINGS
@@ -99,6 +150,49 @@
 		#undef GDISP_INCLUDE_FONT_UI2
 		#define GDISP_INCLUDE_FONT_UI2		GFXON
 	#endif
+	#if GDISP_NEED_LAYERS && !GDISP_NEED_PIXMAP
+		#if GFX_DISPLAY_RULE_WARNINGS
+			#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+				#warning "GDISP: GDISP_NEED_PIXMAP is required when GDISP_NEED_LAYERS is GFXON. It has been turned on for you."
+			#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+				COMPILER_WARNING("GDISP: GDISP_NEED_PIXMAP is required when GDISP_NEED_LAYERS is GFXON. It has been turned on for you.")
+			#endif
+		#endif
+		#undef GDISP_NEED_PIXMAP
+		#define GDISP_NEED_PIXMAP	GFXON
+	#endif
+	#if GDISP_NEED_TRACE
+		#if !GFX_USE_GFILE
+			#if GFX_DISPLAY_RULE_WARNINGS
+				#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+					#warning "GDISP: GFX_USE_GFILE is required when GDISP_NEED_TRACE is GFXON. It has been turned on for you."
+				#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+					COMPILER_WARNING("GDISP: GFX_USE_GFILE is required when GDISP_NEED_TRACE is GFXON. It has been turned on for you.")
+				#endif
+			#endif
+			#undef GFX_USE_GFILE
+			#define GFX_USE_GFILE	GFXON
+		#endif
+		#if GDISP_TRACE_BUFSIZE < 16
+			#error "GDISP: GDISP_TRACE_BUFSIZE must be at least 16"
+		#endif
+	#endif
+	#if GDISP_NEED_ASYNCFLUSH && !GDISP_NEED_MULTITHREAD
+		#if GFX_DISPLAY_RULE_WARNINGS
+			#if GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_DIRECT
+				#warning "GDISP: GDISP_NEED_MULTITHREAD is required when GDISP_NEED_ASYNCFLUSH is GFXON. It has been turned on for you."
+			#elif GFX_COMPILER_WARNING_TYPE == GFX_COMPILER_WARNING_MACRO
+				COMPILER_WARNING("GDISP: GDISP_NEED_MULTITHREAD is required when GDISP_NEED_ASYNCFLUSH is GFXON. It has been turned on for you.")
+			#endif
+		#endif
+		#undef GDISP_NEED_MULTITHREAD
+		#define GDISP_NEED_MULTITHREAD	GFXON
+	#endif
+	#if GDISP_NEED_ACCEL
+		#if GDISP_ACCEL_QUEUE < 1
+			#error "GDISP: GDISP_ACCEL_QUEUE must be at least 1"
+		#endif
+	#endif
 	#if GDISP_NEED_IMAGE
 		#if !GFX_USE_GFILE
 			#if GFX_DISPLAY_RULE_WARNINGS
@@ -0,0 +1,195 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "../../gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_SPRITES
+
+#include <string.h>			// for memcpy()
+
+#define SPRITE_FLG_VISIBLE		0x0001
+#define SPRITE_FLG_TRANSPARENT	0x0002
+
+struct gSprite {
+	GDisplay	*display;
+	gCoord		x, y;
+	gCoord		width, height;
+	gU16		flags;
+	gColor		key;
+	gPixel		*save;				// What is under the sprite when it is visible
+	gPixel		*work;				// Scratch space - the same size as the sprite
+	gPixel		bits[1];			// The sprite itself. We really want bits[0] but some compilers don't allow that.
+};
+
+static gSprite *spriteAlloc(GDisplay *g, gCoord width, gCoord height) {
+	gSprite		*s;
+	unsigned	area;
+
+	if (width <= 0 || height <= 0)
+		return 0;
+	area = (unsigned)width * height;
+	if (!(s = gfxAlloc(sizeof(gSprite) - sizeof(s->bits) + 3 * area * sizeof(gPixel))))
+		return 0;
+	s->display = g;
+	s->x = s->y = 0;
+	s->width = width;
+	s->height = height;
+	s->flags = 0;
+	s->key = 0;
+	s->save = s->bits + area;
+	s->work = s->save + area;
+	return s;
+}
+
+// Draw the sprite at its current position over what is in the save buffer. The display must be locked.
+static void spriteDraw(gSprite *s) {
+	unsigned	i, area;
+
+	if (!(s->flags & SPRITE_FLG_TRANSPARENT)) {
+		_gdispSpriteBlit(s->display, s->x, s->y, s->width, s->height, 0, 0, s->width, s->bits);
+		return;
+	}
+
+	area = (unsigned)s->width * s->height;
+	for(i = 0; i < area; i++)
+		s->work[i] = s->bits[i] == s->key ? s->save[i] : s->bits[i];
+	_gdispSpriteBlit(s->display, s->x, s->y, s->width, s->height, 0, 0, s->width, s->work);
+}
+
+// Put back part of the save buffer. The area is relative to the sprite. The display must be locked.
+static void spriteRestore(gSprite *s, gCoord x0, gCoord y0, gCoord x1, gCoord y1) {
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	_gdispSpriteBlit(s->display, s->x + x0, s->y + y0, x1 - x0, y1 - y0, x0, y0, s->width, s->save);
+}
+
+gSprite *gdispGSpriteCreate(GDisplay *g, gCoord width, gCoord height, const gPixel *bits) {
+	gSprite		*s;
+
+	if (!(s = spriteAlloc(g, width, height)))
+		return 0;
+	memcpy(s->bits, bits, (unsigned)width * height * sizeof(gPixel));
+	return s;
+}
+
+#if GDISP_NEED_PIXMAP
+	gSprite *gdispGSpriteCreateFromPixmap(GDisplay *g, GDisplay *pixmap) {
+		gPixel		*bits;
+
+		if (!(bits = gdispPixmapGetBits(pixmap)))
+			return 0;
+		return gdispGSpriteCreate(g, gdispGGetWidth(pixmap), gdispGGetHeight(pixmap), bits);
+	}
+#endif
+
+#if GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP
+	gSprite *gdispGSpriteCreateFromImage(GDisplay *g, gImage *img) {
+		GDisplay	*pixmap;
+		gSprite		*s;
+
+		if (!(pixmap = gdispPixmapCreate(img->width, img->height)))
+			return 0;
+		s = 0;
+		if (!(gdispGImageDraw(pixmap, img, 0, 0, img->width, img->height, 0, 0) & GDISP_IMAGE_ERR_UNRECOVERABLE))
+			s = gdispGSpriteCreateFromPixmap(g, pixmap);
+		gdispPixmapDelete(pixmap);
+		return s;
+	}
+#endif
+
+void gdispSpriteDelete(gSprite *s) {
+	gdispSpriteHide(s);
+	gfxFree(s);
+}
+
+void gdispSpriteSetTransparent(gSprite *s, gBool enable, gColor key) {
+	s->key = key;
+	if (enable)
+		s->flags |= SPRITE_FLG_TRANSPARENT;
+	else
+		s->flags &= ~SPRITE_FLG_TRANSPARENT;
+	if ((s->flags & SPRITE_FLG_VISIBLE)) {
+		_gdispSpriteLock(s->display);
+		spriteDraw(s);
+		_gdispSpriteUnlock(s->display);
+	}
+}
+
+void gdispSpriteShow(gSprite *s) {
+	if ((s->flags & SPRITE_FLG_VISIBLE))
+		return;
+	_gdispSpriteLock(s->display);
+	_gdispSpriteRead(s->display, s->x, s->y, s->width, s->height, s->save);
+	spriteDraw(s);
+	_gdispSpriteUnlock(s->display);
+	s->flags |= SPRITE_FLG_VISIBLE;
+}
+
+void gdispSpriteHide(gSprite *s) {
+	if (!(s->flags & SPRITE_FLG_VISIBLE))
+		return;
+	_gdispSpriteLock(s->display);
+	spriteRestore(s, 0, 0, s->width, s->height);
+	_gdispSpriteUnlock(s->display);
+	s->flags &= ~SPRITE_FLG_VISIBLE;
+}
+
+void gdispSpriteMove(gSprite *s, gCoord x, gCoord y) {
+	gPixel		*p;
+	gCoord		dx, dy, ox0, oy0, ox1, oy1, i;
+
+	if (x == s->x && y == s->y)
+		return;
+
+	if (!(s->flags & SPRITE_FLG_VISIBLE)) {
+		s->x = x;
+		s->y = y;
+		return;
+	}
+
+	// The overlap between the old and new positions (relative to the old position)
+	dx = x - s->x;
+	dy = y - s->y;
+	ox0 = dx > 0 ? dx : 0;
+	oy0 = dy > 0 ? dy : 0;
+	ox1 = dx < 0 ? s->width + dx : s->width;
+	oy1 = dy < 0 ? s->height + dy : s->height;
+
+	// Save what is under the new position. Where the old and new positions overlap the display currently
+	//	shows the sprite so take those pixels from the old save buffer instead.
+	_gdispSpriteLock(s->display);
+	_gdispSpriteRead(s->display, x, y, s->width, s->height, s->work);
+	if (ox0 < ox1 && oy0 < oy1) {
+		for(i = oy0; i < oy1; i++)
+			memcpy(s->work + (i - dy) * s->width + (ox0 - dx), s->save + i * s->width + ox0, (ox1 - ox0) * sizeof(gPixel));
+	} else {
+		// No overlap
+		ox0 = ox1 = 0;
+		oy0 = oy1 = 0;
+	}
+
+	// Restore only the vacated pixels - bands above and below the overlap and then either side of it
+	if (oy0 >= oy1) {
+		spriteRestore(s, 0, 0, s->width, s->height);
+	} else {
+		spriteRestore(s, 0, 0, s->width, oy0);
+		spriteRestore(s, 0, oy1, s->width, s->height);
+		spriteRestore(s, 0, oy0, ox0, oy1);
+		spriteRestore(s, ox1, oy0, s->width, oy1);
+	}
+
+	// Swap the save buffers and draw at the new position
+	p = s->save;
+	s->save = s->work;
+	s->work = p;
+	s->x = x;
+	s->y = y;
+	spriteDraw(s);
+	_gdispSpriteUnlock(s->display);
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_SPRITES */
@@ -0,0 +1,154 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_sprite.h
+ *
+ * @defgroup Sprites Sprites
+ * @ingroup GDISP
+ *
+ * @brief   Sub-Module for save-under sprites such as mouse cursors and drag icons.
+ *
+ * @note	A sprite is a small picture drawn over the top of the display. The pixels underneath the
+ * 			sprite are saved when it is shown and put back when it is hidden or moved, so nothing
+ * 			underneath needs to be redrawn. Moving a sprite only restores the pixels it vacates and
+ * 			draws it at its new position.
+ * @note	Anything drawn under a visible sprite will be overwritten when the sprite next moves or is
+ * 			hidden. Hide the sprite before drawing in the area it covers and show it again afterwards.
+ * @note	The display is locked for the whole of each show, hide or move so drawing by other threads
+ * 			happens either before or after it, never between the read and the redraw.
+ * @pre		GDISP_NEED_SPRITES must be GFXON in your gfxconf.h
+ * @{
+ */
+
+#ifndef _GDISP_SPRITE_H
+#define _GDISP_SPRITE_H
+
+#if (GFX_USE_GDISP && GDISP_NEED_SPRITES) || defined(__DOXYGEN__)
+
+/**
+ * @brief	The type of a sprite
+ * @note	The contents of this structure are private.
+ */
+typedef struct gSprite gSprite;
+
+/**
+ * @brief	Create a sprite from an array of pixels
+ *
+ * @param[in] g			The display the sprite is shown on
+ * @param[in] width		The width of the sprite
+ * @param[in] height	The height of the sprite
+ * @param[in] bits		The sprite pixels (width * height pixels, row by row). They are copied into the sprite.
+ *
+ * @return 	The sprite or 0 if there was not enough memory
+ *
+ * @note	The sprite is created hidden at position (0, 0).
+ * @note	Memory for three times the sprite area is allocated - the sprite itself, the save-under
+ * 			buffer and a work buffer.
+ *
+ * @api
+ */
+gSprite *gdispGSpriteCreate(GDisplay *g, gCoord width, gCoord height, const gPixel *bits);
+#define gdispSpriteCreate(w,h,b)				gdispGSpriteCreate(GDISP,w,h,b)
+
+#if GDISP_NEED_PIXMAP || defined(__DOXYGEN__)
+	/**
+	 * @brief	Create a sprite from the contents of a pixmap
+	 *
+	 * @param[in] g			The display the sprite is shown on
+	 * @param[in] pixmap	The pixmap. Its contents are copied so it can be deleted afterwards.
+	 *
+	 * @return 	The sprite or 0 if there was not enough memory or the pixmap is not a pixmap
+	 *
+	 * @pre		GDISP_NEED_PIXMAP must be GFXON in your gfxconf.h
+	 *
+	 * @api
+	 */
+	gSprite *gdispGSpriteCreateFromPixmap(GDisplay *g, GDisplay *pixmap);
+	#define gdispSpriteCreateFromPixmap(p)		gdispGSpriteCreateFromPixmap(GDISP,p)
+#endif
+
+#if (GDISP_NEED_IMAGE && GDISP_NEED_PIXMAP) || defined(__DOXYGEN__)
+	/**
+	 * @brief	Create a sprite from an image
+	 *
+	 * @param[in] g			The display the sprite is shown on
+	 * @param[in] img		An open image. The sprite is the same size as the image.
+	 *
+	 * @return 	The sprite or 0 if there was not enough memory or the image could not be drawn
+	 *
+	 * @pre		GDISP_NEED_IMAGE and GDISP_NEED_PIXMAP must be GFXON in your gfxconf.h
+	 * @note	The image can be closed once the sprite is created.
+	 *
+	 * @api
+	 */
+	gSprite *gdispGSpriteCreateFromImage(GDisplay *g, gImage *img);
+	#define gdispSpriteCreateFromImage(i)		gdispGSpriteCreateFromImage(GDISP,i)
+#endif
+
+/**
+ * @brief	Delete a sprite
+ *
+ * @param[in] s			The sprite
+ *
+ * @note	If the sprite is visible it is hidden first.
+ *
+ * @api
+ */
+void gdispSpriteDelete(gSprite *s);
+
+/**
+ * @brief	Set a transparent color for a sprite
+ *
+ * @param[in] s			The sprite
+ * @param[in] enable	gTrue to make pixels of the key color transparent, gFalse to draw every pixel
+ * @param[in] key		The transparent color
+ *
+ * @api
+ */
+void gdispSpriteSetTransparent(gSprite *s, gBool enable, gColor key);
+
+/**
+ * @brief	Move a sprite
+ *
+ * @param[in] s			The sprite
+ * @param[in] x, y		The new top left position of the sprite. It may be partly off the display.
+ *
+ * @note	If the sprite is visible only the vacated pixels are restored and the sprite is drawn
+ * 			at its new position.
+ *
+ * @api
+ */
+void gdispSpriteMove(gSprite *s, gCoord x, gCoord y);
+
+/**
+ * @brief	Show a sprite
+ *
+ * @param[in] s			The sprite
+ *
+ * @api
+ */
+void gdispSpriteShow(gSprite *s);
+
+/**
+ * @brief	Hide a sprite, restoring the pixels underneath it
+ *
+ * @param[in] s			The sprite
+ *
+ * @api
+ */
+void gdispSpriteHide(gSprite *s);
+
+/* Internal routines used by the sprite module to read and draw with the display locked throughout */
+void _gdispSpriteLock(GDisplay *g);															// @notapi
+void _gdispSpriteUnlock(GDisplay *g);														// @notapi
+void _gdispSpriteRead(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gPixel *buffer);	// @notapi - The display must be locked
+void _gdispSpriteBlit(GDisplay *g, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord srcx, gCoord srcy, gCoord srccx, const gPixel *buffer);	// @notapi - The display must be locked
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_SPRITES */
+#endif /* _GDISP_SPRITE_H */
+/** @} */
@@ -0,0 +1,255 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+#include "../../gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_TRACE
+
+#include "gdisp_driver.h"
+
+#include <string.h>			// for memcpy()
+
+#define TRACE_MAXRUN		255		// The most stream colors in one run record
+
+typedef struct gdispTrace {
+	GFILE		*f;
+	gTicks		last;				// When the previous record was made
+	gBool		failed;				// A write has failed. Nothing more is recorded.
+	gU8			run;				// The code of the run record being added to or 0
+	unsigned	runpos;				// Where the count of the run record is in the buffer
+	unsigned	len;				// Bytes in the buffer
+	gU8			buf[GDISP_TRACE_BUFSIZE];
+	} gdispTrace;
+
+#if GDISP_NEED_MULTITHREAD
+	#define TRACE_ENTER(g)		gfxMutexEnter(&(g)->mutex)
+	#define TRACE_EXIT(g)		gfxMutexExit(&(g)->mutex)
+#else
+	#define TRACE_ENTER(g)
+	#define TRACE_EXIT(g)
+#endif
+
+/*===========================================================================*/
+/* Record encoding.                                                          */
+/*===========================================================================*/
+
+// Write out the buffer. This also ends any run record.
+static void traceFlush(gdispTrace *t) {
+	if (t->len && !t->failed && gfileWrite(t->f, t->buf, t->len) != t->len)
+		t->failed = gTrue;
+	t->len = 0;
+	t->run = 0;
+}
+
+static void tracePut(gdispTrace *t, const void *data, unsigned len) {
+	const gU8	*p;
+	unsigned	n;
+
+	for(p = (const gU8 *)data; len; p += n, len -= n) {
+		if (t->len >= GDISP_TRACE_BUFSIZE)
+			traceFlush(t);
+		n = GDISP_TRACE_BUFSIZE - t->len;
+		if (n > len)
+			n = len;
+		memcpy(t->buf + t->len, p, n);
+		t->len += n;
+	}
+}
+
+static void traceNum(gdispTrace *t, gU32 v) {
+	gU8			b[5];
+	unsigned	n;
+
+	n = 0;
+	do {
+		b[n] = v & 0x7F;
+		v >>= 7;
+		if (v)
+			b[n] |= 0x80;
+		n++;
+	} while(v);
+	tracePut(t, b, n);
+}
+
+static void traceCoord(gdispTrace *t, gCoord c) {
+	// Zig-zag encode so small negative numbers stay small
+	traceNum(t, c < 0 ? ((gU32)-(gI32)c << 1) - 1 : (gU32)c << 1);
+}
+
+static void traceColor(gdispTrace *t, gColor c) {
+	gU8		b[3];
+
+	b[0] = RED_OF(c);
+	b[1] = GREEN_OF(c);
+	b[2] = BLUE_OF(c);
+	tracePut(t, b, 3);
+}
+
+static void traceArea(gdispTrace *t, GDisplay *g) {
+	traceCoord(t, g->p.x);
+	traceCoord(t, g->p.y);
+	traceCoord(t, g->p.cx);
+	traceCoord(t, g->p.cy);
+}
+
+// Start a new record. This also ends any run record.
+static void traceRecord(gdispTrace *t, gU8 code) {
+	gTicks	now;
+
+	t->run = 0;
+	now = gfxSystemTicks();
+	tracePut(t, &code, 1);
+	traceNum(t, now - t->last);
+	t->last = now;
+}
+
+// Add to a run record, starting a new one if needed. Room is left in the buffer for extra bytes.
+static void traceRun(gdispTrace *t, gU8 code, unsigned extra) {
+	if (t->run != code || t->buf[t->runpos] == TRACE_MAXRUN || t->len + extra > GDISP_TRACE_BUFSIZE) {
+		// The code, the time, the count and the extra bytes must all fit in the buffer
+		if (t->len + 1 + 5 + 1 + extra > GDISP_TRACE_BUFSIZE)
+			traceFlush(t);
+		traceRecord(t, code);
+		t->run = code;
+		t->runpos = t->len;
+		t->buf[t->len++] = 0;
+	}
+	t->buf[t->runpos]++;
+}
+
+/*===========================================================================*/
+/* Internal routines used by GDISP.                                          */
+/*===========================================================================*/
+
+void _gdispTrace(GDisplay *g, gU8 code) {
+	gdispTrace		*t;
+	const gPixel	*p;
+	gCoord			x, y;
+
+	if (!(t = g->trace) || t->failed)
+		return;
+
+	switch(code) {
+	case GDISP_TRACE_WRITECOLOR:
+		traceRun(t, code, 3);
+		traceColor(t, g->p.color);
+		return;
+	case GDISP_TRACE_READCOLOR:
+		traceRun(t, code, 0);
+		return;
+	}
+
+	traceRecord(t, code);
+	switch(code) {
+	case GDISP_TRACE_WRITESTART:
+	case GDISP_TRACE_READSTART:
+	case GDISP_TRACE_SETCLIP:
+		traceArea(t, g);
+		break;
+	case GDISP_TRACE_WRITEPOS:
+	case GDISP_TRACE_GET:
+		traceCoord(t, g->p.x);
+		traceCoord(t, g->p.y);
+		break;
+	case GDISP_TRACE_PIXEL:
+		traceCoord(t, g->p.x);
+		traceCoord(t, g->p.y);
+		traceColor(t, g->p.color);
+		break;
+	case GDISP_TRACE_CLEAR:
+		traceColor(t, g->p.color);
+		break;
+	case GDISP_TRACE_FILL:
+		traceArea(t, g);
+		traceColor(t, g->p.color);
+		break;
+	case GDISP_TRACE_BLIT:
+		// Only the pixels being drawn are recorded
+		traceArea(t, g);
+		p = (const gPixel *)g->p.ptr + g->p.y1 * g->p.x2 + g->p.x1;
+		for(y = 0; y < g->p.cy; y++, p += g->p.x2) {
+			for(x = 0; x < g->p.cx; x++)
+				traceColor(t, p[x]);
+		}
+		break;
+	case GDISP_TRACE_SCROLL:
+		traceArea(t, g);
+		traceCoord(t, g->p.y1);
+		traceColor(t, g->p.color);
+		break;
+	case GDISP_TRACE_CONTROL:
+		traceNum(t, (gU32)g->p.x);
+		traceNum(t, (gU32)(gPtrDiff)g->p.ptr);
+		break;
+	case GDISP_TRACE_QUERY:
+		traceNum(t, (gU32)g->p.x);
+		break;
+	}
+}
+
+/*===========================================================================*/
+/* Application routines.                                                     */
+/*===========================================================================*/
+
+gBool gdispGTraceStart(GDisplay *g, const char *filename) {
+	gdispTrace	*t;
+	gU8			version;
+
+	gdispGTraceStop(g);
+
+	if (!(t = gfxAlloc(sizeof(gdispTrace))))
+		return gFalse;
+	if (!(t->f = gfileOpen(filename, "wb"))) {
+		gfxFree(t);
+		return gFalse;
+	}
+	t->failed = gFalse;
+	t->run = 0;
+	t->len = 0;
+
+	// The file header
+	version = GDISP_TRACE_VERSION;
+	tracePut(t, GDISP_TRACE_MAGIC, 4);
+	tracePut(t, &version, 1);
+	traceNum(t, (gU32)gfxMillisecondsToTicks(1000));
+
+	// Describe the display as the first record
+	TRACE_ENTER(g);
+	t->last = gfxSystemTicks();
+	traceRecord(t, GDISP_TRACE_INIT);
+	traceNum(t, (gU32)g->g.Width);
+	traceNum(t, (gU32)g->g.Height);
+	traceNum(t, (gU32)g->g.Orientation);
+	traceNum(t, (gU32)g->g.Powermode);
+	traceNum(t, (gU32)g->g.Backlight);
+	traceNum(t, (gU32)g->g.Contrast);
+	g->trace = t;
+	TRACE_EXIT(g);
+	return gTrue;
+}
+
+gBool gdispGTraceStop(GDisplay *g) {
+	gdispTrace	*t;
+	gBool		ok;
+
+	TRACE_ENTER(g);
+	if ((t = g->trace)) {
+		traceRecord(t, GDISP_TRACE_END);
+		g->trace = 0;
+	}
+	TRACE_EXIT(g);
+	if (!t)
+		return gFalse;
+
+	traceFlush(t);
+	ok = !t->failed;
+	gfileClose(t->f);
+	gfxFree(t);
+	return ok;
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TRACE */
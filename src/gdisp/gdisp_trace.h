@@ -0,0 +1,111 @@
+/*
+ * This file is subject to the terms of the GFX License. If a copy of
+ * the license was not distributed with this file, you can obtain one at:
+ *
+ *              http://ugfx.io/license.html
+ */
+
+/**
+ * @file    src/gdisp/gdisp_trace.h
+ *
+ * @defgroup Trace Trace
+ * @ingroup GDISP
+ *
+ * @brief   Sub-Module for recording the low level driver calls made for a display.
+ *
+ * @note	While a trace is running every call GDISP makes to the display's low level driver is
+ * 			written to a file with its parameters and the time it was made. The trace can later be
+ * 			replayed onto any display (see demos/tools/gdispTraceReplay) to reproduce exactly the
+ * 			same work for the driver, for example to compare driver optimisations on a real workload.
+ * @note	A trace file starts with the 4 bytes "GTRC", a version byte and the number of
+ * 			ticks per second. Each record is then a GDISP_TRACE_xxx code byte, the ticks since the
+ * 			previous record and the parameters for that code. Numbers are stored as variable length
+ * 			unsigned integers (7 bits per byte, least significant first, the top bit set on all but
+ * 			the last byte). Coordinates are signed and are zig-zag encoded first. Colors are stored
+ * 			as 3 bytes of red, green and blue.
+ * @note	The file format definitions are always available so tools can read a trace without
+ * 			recording one themselves.
+ * @pre		GDISP_NEED_TRACE must be GFXON in your gfxconf.h
+ * @pre		GFX_USE_GFILE must be GFXON in your gfxconf.h
+ * @{
+ */
+
+#ifndef _GDISP_TRACE_H
+#define _GDISP_TRACE_H
+
+/**
+ * @name	Trace file format
+ * @{
+ */
+#define GDISP_TRACE_MAGIC			"GTRC"
+#define GDISP_TRACE_VERSION			1
+/** @} */
+
+/**
+ * @name	Trace record codes
+ * @note	The parameters following each code are listed after it.
+ * @{
+ */
+#define GDISP_TRACE_INIT			0x01	/**< width, height, orientation, powermode, backlight, contrast - The display when the trace started */
+#define GDISP_TRACE_END				0x02	/**< The trace was stopped */
+#define GDISP_TRACE_FLUSH			0x03
+#define GDISP_TRACE_WRITESTART		0x04	/**< x, y, cx, cy */
+#define GDISP_TRACE_WRITEPOS		0x05	/**< x, y */
+#define GDISP_TRACE_WRITECOLOR		0x06	/**< count (1 byte), colors - A run of stream writes */
+#define GDISP_TRACE_WRITESTOP		0x07
+#define GDISP_TRACE_READSTART		0x08	/**< x, y, cx, cy */
+#define GDISP_TRACE_READCOLOR		0x09	/**< count (1 byte) - A run of stream reads */
+#define GDISP_TRACE_READSTOP		0x0A
+#define GDISP_TRACE_PIXEL			0x0B	/**< x, y, color */
+#define GDISP_TRACE_CLEAR			0x0C	/**< color */
+#define GDISP_TRACE_FILL			0x0D	/**< x, y, cx, cy, color */
+#define GDISP_TRACE_BLIT			0x0E	/**< x, y, cx, cy, cx * cy colors - Only the pixels drawn are stored */
+#define GDISP_TRACE_GET				0x0F	/**< x, y */
+#define GDISP_TRACE_SCROLL			0x10	/**< x, y, cx, cy, lines, color */
+#define GDISP_TRACE_CONTROL			0x11	/**< what, value */
+#define GDISP_TRACE_QUERY			0x12	/**< what */
+#define GDISP_TRACE_SETCLIP			0x13	/**< x, y, cx, cy */
+/** @} */
+
+#if (GFX_USE_GDISP && GDISP_NEED_TRACE) || defined(__DOXYGEN__)
+
+/**
+ * @brief	Start recording the low level driver calls for a display
+ *
+ * @param[in] g			The display
+ * @param[in] filename	The file to write the trace to. It is created or replaced.
+ *
+ * @return	gTrue if the trace was started
+ *
+ * @note	A trace that is already running on the display is stopped first.
+ * @note	The first record describes the display so a replay can check it is replaying onto
+ * 			a similar display.
+ * @note	Records are collected in a buffer of GDISP_TRACE_BUFSIZE bytes before being written.
+ * 			The write happens inside the drawing call that fills the buffer.
+ *
+ * @api
+ */
+gBool gdispGTraceStart(GDisplay *g, const char *filename);
+#define gdispTraceStart(f)			gdispGTraceStart(GDISP,f)
+
+/**
+ * @brief	Stop recording the low level driver calls for a display
+ *
+ * @param[in] g			The display
+ *
+ * @return	gTrue if the whole trace was written. gFalse if there was no trace running or a
+ * 			write failed (in which case the recording stopped at that point).
+ *
+ * @note	The trace is also stopped if the display is deinitialised.
+ *
+ * @api
+ */
+gBool gdispGTraceStop(GDisplay *g);
+#define gdispTraceStop()			gdispGTraceStop(GDISP)
+
+/* Internal routines used by GDISP */
+void _gdispTrace(GDisplay *g, gU8 code);							// @notapi
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TRACE */
+#endif /* _GDISP_TRACE_H */
+/** @} */
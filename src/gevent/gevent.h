@@ -39,6 +39,7 @@ typedef gU16						GEventType;
 		#define GEVENT_GWIN_FIRST		0x0200				// GWIN events range from 0x0200 to 0x02FF
 		#define GEVENT_GADC_FIRST		0x0300				// GADC events range from 0x0300 to 0x033F
 		#define GEVENT_GAUDIO_FIRST		0x0340				// GAUDIO events range from 0x0340 to 0x037F
+		#define GEVENT_GDISP_FIRST		0x0380				// GDISP events range from 0x0380 to 0x03BF
 		#define GEVENT_USER_FIRST		0x8000				// Any application defined events start at 0x8000
 
 // This object can be typecast to any GEventXxxxx type to allow any sub-system (or the application) to create events.
@@ -400,6 +400,11 @@ void gwinBlitArea(GHandle gh, gCoord x, gCoord y, gCoord cx, gCoord cy, gCoord s
 		gdispGDrawThickLine(gh->display, gh->x+x0, gh->y+y0, gh->x+x1, gh->y+y1, gh->color, width, round);
 		_gwinDrawEnd(gh);
 	}
+	void gwinDrawThickPolyline(GHandle gh, gCoord tx, gCoord ty, const gPoint *pntarray, unsigned cnt, gCoord width, gLineJoin join, gBool round) {
+		if (!_gwinDrawStart(gh)) return;
+		gdispGDrawThickPolyline(gh->display, tx+gh->x, ty+gh->y, pntarray, cnt, gh->color, width, join, round);
+		_gwinDrawEnd(gh);
+	}
 #endif
 
 #if GDISP_NEED_IMAGE
@@ -1028,6 +1028,25 @@ typedef enum { GWIN_NORMAL, GWIN_MAXIMIZE, GWIN_MINIMIZE } GWindowMinMax;
 		 * @api
 		 */
 		void gwinDrawThickLine(GHandle gh, gCoord x0, gCoord y0, gCoord x1, gCoord y1, gCoord width, gBool round);
+
+		/**
+		 * @brief	Draw a connected series of thick lines in the window
+		 * @details	The line thickness is specified in pixels. The points are joined using
+		 *		the specified join style and the line ends can be selected to be either flat or round.
+		 * @note	Uses gdispGDrawThickPolyline() internally to perform the drawing.
+		 * @note	Uses the current foreground color to draw the line
+		 *
+		 * @param[in] gh		The window handle
+		 * @param[in] tx, ty	Transform all points in pntarray by tx, ty
+		 * @param[in] pntarray	An array of points
+		 * @param[in] cnt		The number of points in the array
+		 * @param[in] width		The width of the line
+		 * @param[in] join		How the line segments are joined
+		 * @param[in] round		Use round ends for the line
+		 *
+		 * @api
+		 */
+		void gwinDrawThickPolyline(GHandle gh, gCoord tx, gCoord ty, const gPoint *pntarray, unsigned cnt, gCoord width, gLineJoin join, gBool round);
 	#endif
 
 /*-------------------------------------------------